@@ -107,6 +107,11 @@ OcStartImage (
       }
       FreePool (DevicePathText);
     }
+  //
+  // Write out batched log entries before the image takes over.
+  //
+  OcFlushLogProtocol ();
+
   OldMode = OcConsoleControlSetMode (
     LaunchInText ? EfiConsoleControlScreenText : EfiConsoleControlScreenGraphics
     );
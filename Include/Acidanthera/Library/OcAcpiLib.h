@@ -53,6 +53,114 @@ typedef struct {
   CHAR8   Name[OC_ACPI_NAME_SIZE+1];
 } OC_ACPI_REGION;
 
+//
+// Namespace index node types.
+// Scope and If nodes open a lookup frame closed by the matching end node.
+//
+#define OC_ACPI_NODE_SCOPE        1U
+#define OC_ACPI_NODE_SCOPE_END    2U
+#define OC_ACPI_NODE_IF           3U
+#define OC_ACPI_NODE_ELSE         4U
+#define OC_ACPI_NODE_IF_END       5U
+#define OC_ACPI_NODE_RECOVER      6U
+#define OC_ACPI_NODE_METHOD       7U
+#define OC_ACPI_NODE_FIELD        8U
+#define OC_ACPI_NODE_CREATE_FIELD 9U
+#define OC_ACPI_NODE_BANK_FIELD   10U
+#define OC_ACPI_NODE_INDEX_FIELD  11U
+
+//
+// Namespace index node flags.
+//
+#define OC_ACPI_NODE_ROOT_PATH    BIT0
+#define OC_ACPI_NODE_ERROR_LAST   BIT1
+#define OC_ACPI_NODE_ERROR_NEXT   BIT2
+
+//
+// Namespace index node, an AML object or a lookup state change
+// in the order the parser encounters them.
+//
+typedef struct {
+  //
+  // Node type, OC_ACPI_NODE_*.
+  //
+  UINT8   Type;
+  //
+  // Node flags, OC_ACPI_NODE_ROOT_PATH for root scopes. Bank and index
+  // fields have OC_ACPI_NODE_ERROR_* set when matching their first name
+  // with the last or not the last path identifier fails parsing.
+  //
+  UINT8   Flags;
+  //
+  // Number of name segments at Name.
+  //
+  UINT8   NameLength;
+  //
+  // Object opcode.
+  //
+  UINT8   Opcode;
+  //
+  // Offset of the object opcode, the one reported on match.
+  //
+  UINT32  Offset;
+  //
+  // Object package length or frame depth for OC_ACPI_NODE_RECOVER.
+  //
+  UINT32  Length;
+  //
+  // Offset of the object name segments.
+  //
+  UINT32  Name;
+  //
+  // Offset of the second field name segment or 0.
+  //
+  UINT32  Name2;
+} OC_ACPI_NAMESPACE_NODE;
+
+//
+// Namespace index of one ACPI table, replaces repeated table parsing
+// for entry lookup.
+//
+typedef struct {
+  //
+  // Table the index was last used with.
+  //
+  UINT8                   *Table;
+  //
+  // Length of the indexed table.
+  //
+  UINT32                  TableLength;
+  //
+  // Table contents the index is valid for.
+  //
+  UINT8                   *Shadow;
+  //
+  // Bitmap of table bytes whose values affect parsing (package lengths
+  // and name segment counts).
+  //
+  UINT8                   *ValueMap;
+  //
+  // Index nodes.
+  //
+  OC_ACPI_NAMESPACE_NODE  *Nodes;
+  //
+  // Number of nodes.
+  //
+  UINT32                  NumberOfNodes;
+  //
+  // Number of allocated node slots.
+  //
+  UINT32                  AllocatedNodes;
+  //
+  // Maximum number of simultaneously open frames.
+  //
+  UINT32                  MaxDepth;
+  //
+  // Parsing status reported when no entry matches.
+  //
+  EFI_STATUS              Status;
+} OC_ACPI_NAMESPACE_INDEX;
+
 //
 // Main ACPI context describing current tableset worked on.
 //
@@ -101,6 +209,18 @@ typedef struct {
   // Number of allocated region slots.
   //
   UINT32                                         AllocatedRegions;
+  //
+  // Namespace indices of tables with Base patch lookups.
+  //
+  OC_ACPI_NAMESPACE_INDEX                        *Indices;
+  //
+  // Number of namespace indices.
+  //
+  UINT32                                         NumberOfIndices;
+  //
+  // Number of allocated namespace index slots.
+  //
+  UINT32                                         AllocatedIndices;
 } OC_ACPI_CONTEXT;
 
 //
@@ -247,6 +367,25 @@ AcpiApplyPatch (
   IN     OC_ACPI_PATCH    *Patch
   );
 
+/**
+  Patch ACPI tables with multiple patches. Consecutive patches without Base
+  are grouped per table and applied in a single pass over it, with table
+  checksum refreshed once. Patches with Base are applied one by one in
+  between, so the result matches separate AcpiApplyPatch calls in order.
+
+  @param[in,out] Context        ACPI library context.
+  @param[in]     Patches        ACPI patches.
+  @param[in]     PatchCount     Number of ACPI patches.
+  @param[out]    ReplaceCounts  Replacements performed for every patch in all tables.
+**/
+EFI_STATUS
+AcpiApplyPatches (
+  IN OUT OC_ACPI_CONTEXT  *Context,
+  IN     OC_ACPI_PATCH    *Patches,
+  IN     UINT32           PatchCount,
+     OUT UINT32           *ReplaceCounts
+  );
+
 /**
   Try to load ACPI regions.
 
@@ -346,4 +485,62 @@ AcpiFindEntryInMemory (
   IN     UINT32      TableLength OPTIONAL
   );
 
+/**
+  Builds namespace index of ACPI table by parsing it once.
+
+  @param[out] Index       Namespace index to initialise.
+  @param[in]  Table       Pointer to start of ACPI table.
+  @param[in]  TableLength Length of ACPI table.
+
+  @retval EFI_SUCCESS           Index was built, parsing errors are kept in it.
+  @retval EFI_DEVICE_ERROR      Table header is incorrect.
+  @retval EFI_LOAD_ERROR        Table is too short.
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failure.
+**/
+EFI_STATUS
+AcpiInitNamespaceIndex (
+     OUT OC_ACPI_NAMESPACE_INDEX  *Index,
+  IN     UINT8                    *Table,
+  IN     UINT32                   TableLength OPTIONAL
+  );
+
+/**
+  Free namespace index dynamic resources.
+
+  @param[in,out] Index  Namespace index.
+**/
+VOID
+AcpiFreeNamespaceIndex (
+  IN OUT OC_ACPI_NAMESPACE_INDEX  *Index
+  );
+
+/**
+  Finds offset of required entry in ACPI table by its namespace index
+  with the same result as AcpiFindEntryInMemory. The index is rebuilt
+  when table length or layout changed, renaming names keeps it valid.
+  Zeroed index is built on first use.
+
+  @param[in,out] Index       Namespace index of the table.
+  @param[in]     Table       Pointer to start of ACPI table.
+  @param[in]     PathString  Path to entry which must be found.
+  @param[in]     Entry       Number of entry which must be found.
+  @param[out]    Offset      Offset of the entry if it was found.
+  @param[in]     TableLength Length of ACPI table.
+
+  @retval EFI_SUCCESS           Required entry was found.
+  @retval EFI_NOT_FOUND         Required entry was not found.
+  @retval EFI_DEVICE_ERROR      Error occured during parsing ACPI table.
+  @retval EFI_OUT_OF_RESOURCES  Nesting limit has been reached.
+  @retval EFI_INVALID_PARAMETER Got wrong path to the entry.
+**/
+EFI_STATUS
+AcpiFindEntryInIndex (
+  IN OUT OC_ACPI_NAMESPACE_INDEX  *Index,
+  IN     UINT8                    *Table,
+  IN     CONST CHAR8              *PathString,
+  IN     UINT8                    Entry,
+     OUT UINT32                   *Offset,
+  IN     UINT32                   TableLength OPTIONAL
+  );
+
 #endif // OC_ACPI_LIB_H
@@ -26,6 +26,13 @@ typedef struct OC_APPLE_CHUNKLIST_CONTEXT_ {
   CONST APPLE_CHUNKLIST_CHUNK *Chunks;
   APPLE_CHUNKLIST_SIG         *Signature;
   UINT8                       Hash[SHA256_DIGEST_SIZE];
+  //
+  // Streaming data verification state.
+  //
+  UINTN                       VerifiedChunkCount;
+  UINT32                      ChunkHashedSize;
+  BOOLEAN                     VerifyFailed;
+  SHA256_CONTEXT              ChunkHashContext;
 } OC_APPLE_CHUNKLIST_CONTEXT;
 
 //
@@ -74,4 +81,45 @@ OcAppleChunklistVerifyData (
   IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
   );
 
+/**
+  Starts streaming data verification against a chunklist context.
+  The signature must have been verified beforehand.
+
+  @param[in,out] Context        The Context to verify against.
+**/
+VOID
+OcAppleChunklistVerifyDataStart (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
+  );
+
+/**
+  Verifies the next piece of data against a chunklist context.
+  Chunks are verified as soon as their last byte is provided,
+  data past the last chunk is ignored.
+
+  @param[in,out] Context        The Context to verify against.
+  @param[in]     Data           Data following the previously verified data.
+  @param[in]     Size           Size of Data in bytes.
+
+  @retval TRUE if no chunk failed verification so far.
+**/
+BOOLEAN
+OcAppleChunklistVerifyDataUpdate (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context,
+  IN     CONST VOID                  *Data,
+  IN     UINTN                       Size
+  );
+
+/**
+  Completes streaming data verification against a chunklist context.
+
+  @param[in,out] Context        The Context to verify against.
+
+  @retval TRUE if every chunk was provided and verified successfully.
+**/
+BOOLEAN
+OcAppleChunklistVerifyDataFinal (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
+  );
+
 #endif // APPLE_CHUNKLIST_LIB_H
@@ -19,6 +19,22 @@
 
 #include <Library/OcAppleChunklistLib.h>
 #include <Library/OcAppleRamDiskLib.h>
+#include <Library/OcCompressionLib.h>
+
+//
+// Number of decompressed chunks cached per disk image.
+//
+#define OC_APPLE_DISK_IMAGE_CACHE_SIZE  4
+
+//
+// Decompressed chunk cache entry.
+//
+typedef struct {
+    CONST APPLE_DISK_IMAGE_CHUNK      *Chunk;
+    UINT8                             *Data;
+    UINTN                             DataSize;
+    UINT64                            LastUse;
+} OC_APPLE_DISK_IMAGE_CACHE_ENTRY;
 
 //
 // Disk image context.
@@ -30,6 +46,27 @@ typedef struct {
 
     UINT32                            BlockCount;
     APPLE_DISK_IMAGE_BLOCK_DATA       **Blocks;
+
+    //
+    // Least recently used entry is replaced on cache miss.
+    //
+    OC_APPLE_DISK_IMAGE_CACHE_ENTRY   Cache[OC_APPLE_DISK_IMAGE_CACHE_SIZE];
+    UINT64                            CacheTick;
+    CONST APPLE_DISK_IMAGE_CHUNK      *LastChunk;
+
+    //
+    // Decompression state and compressed chunk buffer reused for all chunks.
+    //
+    OC_ZLIB_DECOMPRESS_STATE          *ZlibState;
+    UINT8                             *CompressedData;
+    UINTN                             CompressedDataSize;
+
+    //
+    // Cache statistics, each miss and read-ahead decompresses a chunk.
+    //
+    UINT64                            CacheHits;
+    UINT64                            CacheMisses;
+    UINT64                            CacheReadAheads;
 } OC_APPLE_DISK_IMAGE_CONTEXT;
 
 BOOLEAN
@@ -39,10 +76,22 @@ OcAppleDiskImageInitializeContext (
   IN  UINTN                              FileSize
   );
 
+/**
+  Load disk image from file into RAM disk and initialise its context.
+
+  @param[out]    Context           Disk image context to initialise.
+  @param[in]     File              File protocol open for reading.
+  @param[in,out] ChunklistContext  Optional chunklist with verified signature,
+                                   disk image data is verified against it
+                                   while it is loaded.
+
+  @retval TRUE on success.
+**/
 BOOLEAN
 OcAppleDiskImageInitializeFromFile (
-  OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  EFI_FILE_PROTOCOL            *File
+  OUT    OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     EFI_FILE_PROTOCOL            *File,
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT   *ChunklistContext OPTIONAL
   );
 
 VOID
@@ -144,6 +144,43 @@ typedef enum KERNEL_CACHE_TYPE_ {
 #define KERNEL_VERSION_CATALINA_MAX         (KERNEL_VERSION_BIG_SUR_MIN - 1)
 #define KERNEL_VERSION_BIG_SUR_MAX          (KERNEL_VERSION_MONTEREY_MIN - 1)
 
+//
+// Kext identifier index entry.
+//
+typedef struct {
+  //
+  // Bundle identifier, owned by the indexed value.
+  //
+  CONST CHAR8              *Identifier;
+  //
+  // Indexed value, e.g. a kext or its plist dictionary.
+  //
+  VOID                     *Value;
+} KEXT_ID_INDEX_ENTRY;
+
+//
+// Open addressing hash index from kext bundle identifiers to values.
+// Zero-initialised index is valid and empty.
+//
+typedef struct {
+  //
+  // Hash table of Mask + 1 entries or NULL.
+  //
+  KEXT_ID_INDEX_ENTRY      *Entries;
+  //
+  // Number of used entries.
+  //
+  UINT32                   Count;
+  //
+  // Hash table size minus one.
+  //
+  UINT32                   Mask;
+  //
+  // Index could not be updated due to allocation failure and must not be used.
+  //
+  BOOLEAN                  Failed;
+} KEXT_ID_INDEX;
+
 //
 // Prelinked context used for kernel modification.
 //
@@ -284,6 +321,15 @@ typedef struct {
   //
   LIST_ENTRY               InjectedKexts;
   //
+  // Index of PrelinkedKexts by bundle identifier.
+  //
+  KEXT_ID_INDEX            PrelinkedKextIndex;
+  //
+  // Index of KextList dictionaries by bundle identifier, built on first miss.
+  //
+  KEXT_ID_INDEX            KextListIndex;
+  BOOLEAN                  KextListIndexValid;
+  //
   // Whether this kernel is a kernel collection (used by macOS 11.0+).
   //
   BOOLEAN                  IsKernelCollection;
@@ -307,6 +353,15 @@ typedef struct {
   // Prelinked is 32-bit.
   //
   BOOLEAN                  Is32Bit;
+  //
+  // Do not build symbol hash indices for dependencies, e.g. for profiling.
+  //
+  BOOLEAN                  DisableSymbolIndex;
+  //
+  // Number of dependency symbol lookups by name and by value.
+  //
+  UINT64                   SymbolNameLookups;
+  UINT64                   SymbolValueLookups;
 } PRELINKED_CONTEXT;
 
 //
@@ -422,6 +477,11 @@ typedef struct {
   //
   LIST_ENTRY            BuiltInKexts;
   //
+  // Index of PatchedKexts and BuiltInKexts by bundle identifier.
+  //
+  KEXT_ID_INDEX         PatchedKextIndex;
+  KEXT_ID_INDEX         BuiltInKextIndex;
+  //
   // Current kernel version.
   //
   UINT32                KernelVersion;
@@ -493,6 +553,15 @@ typedef struct {
   // List of cached kexts, used for patching and blocking.
   //
   LIST_ENTRY               CachedKexts;
+  //
+  // Index of CachedKexts by bundle identifier.
+  //
+  KEXT_ID_INDEX            CachedKextIndex;
+  //
+  // Index of MkextKexts dictionaries by bundle identifier (v2 only), built on first miss.
+  //
+  KEXT_ID_INDEX            MkextKextIndex;
+  BOOLEAN                  MkextKextIndexValid;
 } MKEXT_CONTEXT;
 
 //
@@ -866,6 +935,26 @@ PrelinkedContextApplyPatch (
   IN     PATCHER_GENERIC_PATCH  *Patch
   );
 
+/**
+  Apply multiple kext patches to prelinked, see PatcherApplyGenericPatches.
+
+  @param[in,out] Context         Prelinked context.
+  @param[in]     Identifier      Kext bundle identifier.
+  @param[in]     Patches         Patch descriptions.
+  @param[in]     PatchCount      Number of patches.
+  @param[out]    Results         Per-patch results, PatchCount entries.
+
+  @return  EFI_SUCCESS when all patches were applied.
+**/
+EFI_STATUS
+PrelinkedContextApplyPatches (
+  IN OUT PRELINKED_CONTEXT      *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  );
+
 /**
   Apply kext quirk to prelinked.
 
@@ -1075,6 +1164,26 @@ PatcherApplyGenericPatch (
   IN     PATCHER_GENERIC_PATCH  *Patch
   );
 
+/**
+  Apply multiple generic patches in order. Consecutive patches without
+  symbolic base share a pass over the binary, the result is identical
+  to applying each patch with PatcherApplyGenericPatch.
+
+  @param[in,out] Context         Patcher context.
+  @param[in]     Patches         Patch descriptions.
+  @param[in]     PatchCount      Number of patches.
+  @param[out]    Results         Per-patch results, PatchCount entries.
+
+  @return  EFI_SUCCESS when all patches were applied.
+**/
+EFI_STATUS
+PatcherApplyGenericPatches (
+  IN OUT PATCHER_CONTEXT        *Context,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  );
+
 /**
   Block kext from loading.
 
@@ -1447,6 +1556,26 @@ MkextContextApplyPatch (
   IN     PATCHER_GENERIC_PATCH  *Patch
   );
 
+/**
+  Apply multiple kext patches to mkext, see PatcherApplyGenericPatches.
+
+  @param[in,out] Context         Mkext context.
+  @param[in]     Identifier      Kext bundle identifier.
+  @param[in]     Patches         Patch descriptions.
+  @param[in]     PatchCount      Number of patches.
+  @param[out]    Results         Per-patch results, PatchCount entries.
+
+  @return  EFI_SUCCESS when all patches were applied.
+**/
+EFI_STATUS
+MkextContextApplyPatches (
+  IN OUT MKEXT_CONTEXT          *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  );
+
 /**
   Apply kext quirk to mkext.
 
@@ -1490,4 +1619,48 @@ MkextInjectPatchComplete (
   IN OUT MKEXT_CONTEXT      *Context
   );
 
+/**
+  Find runs of patched kernel bytes differing from the original kernel.
+  Everything past original kernel size is considered to be different.
+
+  @param[in]  Original      Original kernel.
+  @param[in]  OriginalSize  Original kernel size.
+  @param[in]  Patched       Patched kernel.
+  @param[in]  PatchedSize   Patched kernel size.
+  @param[out] Data          Run buffer, optional to only compute the size.
+  @param[out] RunCount      Number of runs.
+
+  @return  Size of run data.
+**/
+UINT32
+KernelPatchCacheDiff (
+  IN  CONST UINT8  *Original,
+  IN  UINT32       OriginalSize,
+  IN  CONST UINT8  *Patched,
+  IN  UINT32       PatchedSize,
+  OUT UINT8        *Data      OPTIONAL,
+  OUT UINT32       *RunCount
+  );
+
+/**
+  Apply run data from KernelPatchCacheDiff to the original kernel.
+  All runs are validated before any of them is applied.
+
+  @param[in,out] Kernel       Original kernel, at least PatchedSize bytes.
+  @param[in]     PatchedSize  Patched kernel size.
+  @param[in]     Data         Run data.
+  @param[in]     DataSize     Run data size.
+  @param[in]     RunCount     Number of runs.
+
+  @return  TRUE if all runs were valid and got applied.
+**/
+BOOLEAN
+KernelPatchCacheApplyRuns (
+  IN OUT UINT8        *Kernel,
+  IN     UINT32       PatchedSize,
+  IN     CONST UINT8  *Data,
+  IN     UINT32       DataSize,
+  IN     UINT32       RunCount
+  );
+
 #endif // OC_APPLE_KERNEL_LIB_H
@@ -68,12 +68,32 @@ OcAppleRamDiskWrite (
   IN CONST VOID                         *Buffer
   );
 
+/**
+  Verify file data while it is loaded into RAM disk.
+
+  @param[in,out]  Context     Verification context.
+  @param[in]      Data        Next piece of file data.
+  @param[in]      Size        Size of Data in bytes.
+
+  @retval TRUE to continue loading.
+**/
+typedef
+BOOLEAN
+(*OC_APPLE_RAM_DISK_LOAD_VERIFY) (
+  IN OUT VOID        *Context,
+  IN     CONST VOID  *Data,
+  IN     UINTN       Size
+  );
+
 /**
   Load file into RAM disk as it is.
 
-  @param[in]  ExtentTable Allocated extent table.
-  @param[in]  File        File protocol open for reading.
-  @param[in]  FileSize    Amount of data to write.
+  @param[in]      ExtentTable   Allocated extent table.
+  @param[in]      File          File protocol open for reading.
+  @param[in]      FileSize      Amount of data to write.
+  @param[in]      Verify        Optional verification callback, called with
+                                file data in order while it is loaded.
+  @param[in,out]  VerifyContext Verification callback context.
 
   @retval TRUE on success.
 **/
@@ -81,7 +101,9 @@ BOOLEAN
 OcAppleRamDiskLoadFile (
   IN OUT CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
   IN     EFI_FILE_PROTOCOL                  *File,
-  IN     UINTN                              FileSize
+  IN     UINTN                              FileSize,
+  IN     OC_APPLE_RAM_DISK_LOAD_VERIFY      Verify         OPTIONAL,
+  IN OUT VOID                               *VerifyContext OPTIONAL
   );
 
 /**
@@ -21,6 +21,30 @@
 **/
 #define OC_COMPRESSION_MAX_LENGTH BASE_1GB
 
+/**
+  Default compressed data block size read at once by streaming decompressors.
+**/
+#define OC_DECOMPRESS_STREAM_BLOCK_SIZE BASE_256KB
+
+/**
+  Read compressed data for streaming decompression.
+
+  @param[in]   Context     Caller context.
+  @param[in]   Offset      Offset within compressed data.
+  @param[in]   Size        Amount of bytes to read.
+  @param[out]  Buffer      Destination buffer of at least Size bytes.
+
+  @return  TRUE on success.
+**/
+typedef
+BOOLEAN
+(*OC_DECOMPRESS_READ) (
+  IN  VOID    *Context,
+  IN  UINT32  Offset,
+  IN  UINT32  Size,
+  OUT UINT8   *Buffer
+  );
+
 /**
   Allow the use of extra adler32 validation.
   Not very useful as dmg has own checks.
@@ -28,7 +52,15 @@
 // #define OC_INFLATE_VERIFY_DATA
 
 /**
-  Compress buffer with LZSS algorithm.
+  LZSS compression effort levels. Higher levels search longer match
+  chains and defer matches when the next position matches better.
+**/
+#define OC_LZSS_EFFORT_MIN      1U
+#define OC_LZSS_EFFORT_DEFAULT  4U
+#define OC_LZSS_EFFORT_MAX      9U
+
+/**
+  Compress buffer with LZSS algorithm at default effort.
 
   @param[out]  Dst         Destination buffer.
   @param[in]   DstLen      Destination buffer size.
@@ -45,6 +77,28 @@ CompressLZSS (
   IN  UINT32  SrcLen
   );
 
+/**
+  Compress buffer with LZSS algorithm.
+  This function keeps no global state and may run concurrently.
+
+  @param[out]  Dst         Destination buffer.
+  @param[in]   DstLen      Destination buffer size.
+  @param[in]   Src         Source buffer.
+  @param[in]   SrcLen      Source buffer size.
+  @param[in]   Effort      Compression effort from OC_LZSS_EFFORT_MIN
+                           to OC_LZSS_EFFORT_MAX.
+
+  @return  Dst + CompressedLen on success otherwise NULL.
+**/
+UINT8 *
+CompressLZSSEx (
+  OUT UINT8   *Dst,
+  IN  UINT32  DstLen,
+  IN  UINT8   *Src,
+  IN  UINT32  SrcLen,
+  IN  UINT32  Effort
+  );
+
 /**
   Decompress buffer with LZSS algorithm.
 
@@ -63,6 +117,31 @@ DecompressLZSS (
   IN  UINT32  SrcLen
   );
 
+/**
+  Decompress LZSS stream, reading compressed data in blocks.
+
+  @param[out]  Dst         Destination buffer.
+  @param[in]   DstLen      Destination buffer size.
+  @param[in]   SrcLen      Compressed data size.
+  @param[in]   BlockSize   Compressed data size read at once, non-zero.
+                           Normally OC_DECOMPRESS_STREAM_BLOCK_SIZE.
+  @param[in]   Read        Compressed data reader.
+  @param[in]   Context     Compressed data reader context.
+  @param[out]  Adler       Adler32 checksum of decompressed data, optional.
+
+  @return  DecompressedLen on success otherwise 0.
+**/
+UINT32
+DecompressLZSSStream (
+  OUT UINT8               *Dst,
+  IN  UINT32              DstLen,
+  IN  UINT32              SrcLen,
+  IN  UINT32              BlockSize,
+  IN  OC_DECOMPRESS_READ  Read,
+  IN  VOID                *Context,
+  OUT UINT32              *Adler  OPTIONAL
+  );
+
 /**
   Decompress buffer with LZVN algorithm.
 
@@ -81,6 +160,31 @@ DecompressLZVN (
   IN  UINTN        SrcLen
   );
 
+/**
+  Decompress LZVN stream, reading compressed data in blocks.
+
+  @param[out]  Dst         Destination buffer.
+  @param[in]   DstLen      Destination buffer size.
+  @param[in]   SrcLen      Compressed data size.
+  @param[in]   BlockSize   Compressed data size read at once, non-zero.
+                           Normally OC_DECOMPRESS_STREAM_BLOCK_SIZE.
+  @param[in]   Read        Compressed data reader.
+  @param[in]   Context     Compressed data reader context.
+  @param[out]  Adler       Adler32 checksum of decompressed data, optional.
+
+  @return  DecompressedLen on success otherwise 0.
+**/
+UINT32
+DecompressLZVNStream (
+  OUT UINT8               *Dst,
+  IN  UINT32              DstLen,
+  IN  UINT32              SrcLen,
+  IN  UINT32              BlockSize,
+  IN  OC_DECOMPRESS_READ  Read,
+  IN  VOID                *Context,
+  OUT UINT32              *Adler  OPTIONAL
+  );
+
 /**
   Compress buffer with ZLIB algorithm.
 
@@ -117,6 +221,52 @@ DecompressZLIB (
   IN  UINTN        SrcLen
   );
 
+/**
+  Reusable ZLIB decompression state.
+**/
+typedef struct OC_ZLIB_DECOMPRESS_STATE_ OC_ZLIB_DECOMPRESS_STATE;
+
+/**
+  Create ZLIB decompression state to be reused for multiple buffers.
+  This avoids allocating decoding tables and window for every buffer.
+
+  @return  Decompression state on success otherwise NULL.
+**/
+OC_ZLIB_DECOMPRESS_STATE *
+CreateZLIBDecompressState (
+  VOID
+  );
+
+/**
+  Free ZLIB decompression state.
+
+  @param[in]  State       Decompression state.
+**/
+VOID
+FreeZLIBDecompressState (
+  IN OC_ZLIB_DECOMPRESS_STATE  *State
+  );
+
+/**
+  Decompress buffer with ZLIB algorithm using existing decompression state.
+
+  @param[in,out]  State       Decompression state.
+  @param[out]     Dst         Destination buffer.
+  @param[in]      DstLen      Destination buffer size.
+  @param[in]      Src         Source buffer.
+  @param[in]      SrcLen      Source buffer size.
+
+  @return  DecompressedLen on success otherwise 0.
+**/
+UINTN
+DecompressZLIBWithState (
+  IN OUT OC_ZLIB_DECOMPRESS_STATE  *State,
+  OUT    UINT8                     *Dst,
+  IN     UINTN                     DstLen,
+  IN     CONST UINT8               *Src,
+  IN     UINTN                     SrcLen
+  );
+
 /**
   Decompress buffer with RLE24 algorithm and 8-bit alpha.
   This algorithm is used for encoding IT32/T8MK images in ICNS.
@@ -154,4 +304,18 @@ Adler32 (
   IN UINT32       BufferLen
   );
 
+/**
+  Updates Adler32 checksum with more data.
+  @param[in]   Adler          Checksum of preceding data, 1 for none.
+  @param[in]   Buffer         Source buffer.
+  @param[in]   BufferLen      Source buffer size.
+  @return  Updated checksum.
+**/
+UINT32
+Adler32Update (
+  IN UINT32       Adler,
+  IN CONST UINT8  *Buffer,
+  IN UINT32       BufferLen
+  );
+
 #endif // OC_COMPRESSION_LIB_H
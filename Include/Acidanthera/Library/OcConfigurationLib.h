@@ -306,10 +306,11 @@
 /// KernelSpace operation scheme.
 ///
 #define OC_KERNEL_SCHEME_FIELDS(_, __) \
-  _(OC_STRING                   , KernelArch       ,     , OC_STRING_CONSTR ("Auto", _, __), OC_DESTR (OC_STRING)) \
-  _(OC_STRING                   , KernelCache      ,     , OC_STRING_CONSTR ("Auto", _, __), OC_DESTR (OC_STRING)) \
-  _(BOOLEAN                     , CustomKernel     ,     , FALSE  , ()) \
-  _(BOOLEAN                     , FuzzyMatch       ,     , FALSE  , ())
+  _(OC_STRING                   , KernelArch         ,     , OC_STRING_CONSTR ("Auto", _, __), OC_DESTR (OC_STRING)) \
+  _(OC_STRING                   , KernelCache        ,     , OC_STRING_CONSTR ("Auto", _, __), OC_DESTR (OC_STRING)) \
+  _(BOOLEAN                     , CachePatchedKernel ,     , FALSE  , ()) \
+  _(BOOLEAN                     , CustomKernel       ,     , FALSE  , ()) \
+  _(BOOLEAN                     , FuzzyMatch         ,     , FALSE  , ())
   OC_DECLARE (OC_KERNEL_SCHEME)
 
 #define OC_KERNEL_CONFIG_FIELDS(_, __) \
@@ -386,6 +387,7 @@ typedef enum {
   _(BOOLEAN                     , EnablePassword              ,      , FALSE                   , ()) \
   _(UINT8                       , PasswordHash                , [64] , {0}                     , ()) \
   _(OC_DATA                     , PasswordSalt                ,      , OC_EDATA_CONSTR (_, __) , OC_DESTR (OC_DATA)) \
+  _(BOOLEAN                     , PreverifyVault              ,      , FALSE                   , ()) \
   _(OC_STRING                   , SecureBootModel             ,      , OC_STRING_CONSTR ("Default", _, __), OC_DESTR (OC_STRING) ) \
   _(UINT64                      , ApECID                      ,      , 0                       , ()) \
   _(UINT64                      , HaltLevel                   ,      , 0x80000000              , ())
@@ -329,6 +329,23 @@ Sha256 (
   UINTN        Len
   );
 
+/**
+  Computes SHA-256 digests of independent messages, hashing several
+  of them at once when vector acceleration is enabled.
+
+  @param[out] Hashes   Count digests of SHA256_DIGEST_SIZE bytes each.
+  @param[in]  Data     Count messages to hash.
+  @param[in]  Lengths  Count message sizes in bytes.
+  @param[in]  Count    Number of messages.
+**/
+VOID
+Sha256Multi (
+  OUT UINT8        *Hashes,
+  IN  CONST UINT8  **Data,
+  IN  CONST UINTN  *Lengths,
+  IN  UINTN        Count
+  );
+
 VOID
 Sha512Init (
   SHA512_CONTEXT  *Context
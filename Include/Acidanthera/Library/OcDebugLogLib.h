@@ -76,6 +76,15 @@ OcConfigureLogProtocol (
   IN EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *LogFileSystem  OPTIONAL
   );
 
+/**
+  Write batched log entries to the log file.
+  Must not be called from event notification functions.
+**/
+VOID
+OcFlushLogProtocol (
+  VOID
+  );
+
 /**
   Install and initialise the Apple Debug Log protocol.
 
@@ -27,6 +27,16 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 ///
 #define MACHO_ALIGN(x) ALIGN_VALUE((x), MACHO_PAGE_SIZE)
 
+///
+/// Address-sorted relocation lookup index, private to OcMachoLib.
+///
+typedef struct OC_MACHO_RELOCATION_INDEX_ OC_MACHO_RELOCATION_INDEX;
+
+///
+/// Symbol name and value lookup index, private to OcMachoLib.
+///
+typedef struct OC_MACHO_SYMBOL_INDEX_ OC_MACHO_SYMBOL_INDEX;
+
 ///
 /// Context used to refer to a Mach-O.  This struct is exposed for reference
 /// only.  Members are not guaranteed to be sane.
@@ -45,6 +55,13 @@ typedef struct {
   MACH_RELOCATION_INFO  *ExternRelocations;
 
   BOOLEAN               Is32Bit;
+  //
+  // Lookup indices built on first use, released by MachoFreeContext.
+  //
+  OC_MACHO_RELOCATION_INDEX *RelocationIndex;
+  BOOLEAN               NoRelocationIndex;
+  OC_MACHO_SYMBOL_INDEX *SymbolIndex;
+  BOOLEAN               UseSymbolIndex;
 } OC_MACHO_CONTEXT;
 
 /**
@@ -142,6 +159,34 @@ MachoGetMachHeader64 (
   IN OUT OC_MACHO_CONTEXT  *Context
   );
 
+/**
+  Frees the lookup indices built for a Mach-O Context.  The Context stays
+  valid and the indices are rebuilt on demand.  This must be called before
+  the Context is discarded or reinitialised, and before the Mach-O
+  relocations are modified.
+
+  @param[in,out] Context  Context of the Mach-O.
+
+**/
+VOID
+MachoFreeContext (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  );
+
+/**
+  Enables symbol lookup by name and by value through an index, which is
+  built on first use.  This pays off for large symbol tables queried many
+  times, e.g. the kernel.  Contexts copied from Context must not build the
+  index, and Context must be released with MachoFreeContext.
+
+  @param[in,out] Context  Context of the Mach-O.
+
+**/
+VOID
+MachoEnableSymbolIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  );
+
 /**
   Returns the Mach-O's file size.
 
@@ -661,6 +706,22 @@ MachoGetLocalDefinedSymbolByName64 (
   IN     CONST CHAR8        *Name
   );
 
+/**
+  Retrieves the first symbol with the given name, defined or not.
+  The lookup stops at the first malformed symbol of the symbol table.
+
+  @param[in,out] Context  Context of the Mach-O.
+  @param[in]     Name     Name of the symbol to locate.
+
+  @retval NULL  NULL is returned on failure.
+
+**/
+MACH_NLIST_ANY *
+MachoGetSymbolByName (
+  IN OUT OC_MACHO_CONTEXT   *Context,
+  IN     CONST CHAR8        *Name
+  );
+
 /**
   Retrieves a symbol by its index.
 
@@ -933,6 +994,20 @@ MachoGetSymbolByExternRelocationOffset64 (
   OUT    MACH_NLIST_64      **Symbol
   );
 
+/**
+  Reports that the value of Symbol has been changed outside of OcMachoLib,
+  keeping symbol lookup by value consistent.
+
+  @param[in,out] Context  Context of the Mach-O.
+  @param[in]     Symbol   Symbol, which value was changed.
+
+**/
+VOID
+MachoSymbolValueChanged (
+  IN OUT OC_MACHO_CONTEXT      *Context,
+  IN     CONST MACH_NLIST_ANY  *Symbol
+  );
+
 /**
   Relocate Symbol to be against LinkAddress.
 
@@ -181,6 +181,37 @@ OcDeduplicateDescriptors (
   IN     UINTN                  DescriptorSize
   );
 
+/**
+  Normalise memory map in place: sort it, optionally split runtime
+  descriptors by memory attributes, then optionally drop duplicate
+  descriptors and join the adjacent ones in a single pass.
+  Equivalent to OcSortMemoryMap, OcSplitMemoryMapByAttributes,
+  OcDeduplicateDescriptors (when Deduplicate is set), and OcShrinkMemoryMap
+  called in sequence.
+
+  @param[in]     MaxMemoryMapSize   Upper memory map size bound for growth.
+  @param[in,out] MemoryMapSize      Current memory map size, updated on return.
+  @param[in,out] MemoryMap          Memory map to normalise.
+  @param[in]     DescriptorSize     Memory map descriptor size in bytes.
+  @param[in]     SplitByAttributes  Split runtime descriptors by memory attributes.
+  @param[in]     Deduplicate        Drop descriptors with the same range as the previous one.
+
+  Note, the function is guaranteed to return valid memory map, though not necessarily split.
+
+  @retval EFI_SUCCESS on success.
+  @retval EFI_UNSUPPORTED memory attributes are not supported by the platform.
+  @retval EFI_OUT_OF_RESOURCES split memory map did not fit.
+**/
+EFI_STATUS
+OcNormalizeMemoryMap (
+  IN     UINTN                  MaxMemoryMapSize,
+  IN OUT UINTN                  *MemoryMapSize,
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN     UINTN                  DescriptorSize,
+  IN     BOOLEAN                SplitByAttributes,
+  IN     BOOLEAN                Deduplicate
+  );
+
 /**
   Check range allocation compatibility callback.
 
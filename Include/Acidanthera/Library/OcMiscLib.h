@@ -59,6 +59,71 @@ ApplyPatch (
   IN UINT32        Skip
   );
 
+/**
+  Data patch description for multi-pattern patching.
+**/
+typedef struct {
+  //
+  // Find bytes.
+  //
+  CONST UINT8  *Pattern;
+  //
+  // Find mask or NULL.
+  //
+  CONST UINT8  *PatternMask;
+  //
+  // Replace bytes.
+  //
+  CONST UINT8  *Replace;
+  //
+  // Replace mask or NULL.
+  //
+  CONST UINT8  *ReplaceMask;
+  //
+  // Pattern size.
+  //
+  UINT32       PatternSize;
+  //
+  // Replace count or 0 for all.
+  //
+  UINT32       Count;
+  //
+  // Skip count or 0 to start from 1 match.
+  //
+  UINT32       Skip;
+  //
+  // Limit replacement size to this value or 0, which assumes data size.
+  //
+  UINT32       Limit;
+  //
+  // Amount of performed replacements, set by ApplyPatches.
+  //
+  UINT32       ReplaceCount;
+} OC_DATA_PATCH;
+
+/**
+  Apply multiple patches to data in as few passes as possible.
+
+  Count, Skip, and Limit are handled per patch exactly like in ApplyPatch.
+  Consecutive patches share a pass unless a match of one may overlap a match
+  of another before or after replacement, thus the result is identical to
+  separate ApplyPatch calls in the order of Patches.
+
+  @param[in,out]  Patches     Patches to apply, ReplaceCount is updated.
+  @param[in]      PatchCount  Number of patches.
+  @param[in,out]  Data        Data to patch.
+  @param[in]      DataSize    Data size.
+
+  @return  Total number of performed replacements.
+**/
+UINT32
+ApplyPatches (
+  IN OUT OC_DATA_PATCH  *Patches,
+  IN     UINT32         PatchCount,
+  IN OUT UINT8          *Data,
+  IN     UINT32         DataSize
+  );
+
 /**
   Obtain application arguments.
 
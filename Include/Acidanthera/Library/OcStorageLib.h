@@ -40,6 +40,11 @@
 **/
 #define OC_STORAGE_SAFE_PATH_MAX 128
 
+/**
+  Maximum total size of vault files kept in memory after preverification.
+**/
+#define OC_STORAGE_PREVERIFY_MAX_SIZE BASE_64MB
+
 /**
   Structure declaration for valult file.
 **/
@@ -56,6 +61,20 @@
   _(OC_STORAGE_VAULT_FILES      , Files    ,     , OC_CONSTR (OC_STORAGE_VAULT_FILES, _, __) , OC_DESTR (OC_STORAGE_VAULT_FILES))
   OC_DECLARE (OC_STORAGE_VAULT)
 
+/**
+  Vault file contents verified ahead of time.
+**/
+typedef struct {
+  ///
+  /// File contents with double null termination, NULL when not preverified.
+  ///
+  UINT8                            *Buffer;
+  ///
+  /// File size without null termination.
+  ///
+  UINT32                           Size;
+} OC_STORAGE_VAULT_DATA;
+
 /**
   Storage abstraction context
 **/
@@ -100,6 +119,10 @@ typedef struct {
   /// Vault status.
   ///
   BOOLEAN                          HasVault;
+  ///
+  /// Preverified vault file contents in Vault.Files order, optional.
+  ///
+  OC_STORAGE_VAULT_DATA            *VaultData;
 } OC_STORAGE_CONTEXT;
 
 /**
@@ -168,6 +191,34 @@ OcStorageReadFileUnicode (
   OUT UINT32                           *FileSize OPTIONAL
   );
 
+/**
+  Read and verify all files listed in storage vault in one pass.
+  Reads of the next file portion are overlapped with hashing of the current
+  one when the file protocol supports asynchronous I/O. Verified contents are
+  kept in memory up to OC_STORAGE_PREVERIFY_MAX_SIZE bytes and handed over
+  by the first OcStorageReadFileUnicode call for each file.
+
+  @param[in,out]  Context     Storage context with vault.
+
+  @retval EFI_SUCCESS when all vault files were verified.
+  @retval EFI_SECURITY_VIOLATION when some vault files are corrupted.
+**/
+EFI_STATUS
+OcStoragePreverifyVault (
+  IN OUT OC_STORAGE_CONTEXT            *Context
+  );
+
+/**
+  Free preverified vault file contents not yet consumed.
+  Later reads of these files are verified as usual.
+
+  @param[in,out]  Context     Storage context.
+**/
+VOID
+OcStorageFreePreverified (
+  IN OUT OC_STORAGE_CONTEXT            *Context
+  );
+
 /**
   Get information about the storage file when possible.
 
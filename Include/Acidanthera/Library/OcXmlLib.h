@@ -133,6 +133,69 @@ XmlDocumentParse (
   IN      BOOLEAN  WithRefs
   );
 
+/**
+  Allocate nodes and child lists, including the ones appended after parsing,
+  from a document arena released by XmlDocumentFree without visiting nodes.
+  Plist tag names are also interned in this mode.
+**/
+#define XML_PARSE_ARENA            BIT0
+
+/**
+  Count children in a separate pass, so that child lists are sized exactly.
+**/
+#define XML_PARSE_COUNT_CHILDREN   BIT1
+
+/**
+  Record the characters overwritten in the buffer while parsing, so that
+  XmlDocumentExport copies unchanged nodes from the buffer instead of
+  serialising them again.
+**/
+#define XML_PARSE_KEEP_SOURCE      BIT2
+
+/**
+  Document parsing statistics.
+**/
+typedef struct {
+  //
+  // Number of parsed nodes.
+  //
+  UINT32  NodeCount;
+  //
+  // Number of child lists created, including reallocations.
+  //
+  UINT32  ListCount;
+  //
+  // Number of pool allocations for nodes and child lists, or arena blocks.
+  //
+  UINT32  AllocationCount;
+  //
+  // Bytes used by nodes and child lists.
+  //
+  UINT32  BytesUsed;
+} XML_PARSE_STATS;
+
+/**
+  Parse the XML fragment in buffer with extended options.
+
+  @param[in,out]  Buffer  Chunk to be parsed.
+  @param[in]      Length  Size of the buffer.
+  @param[in]      WithRef TRUE to enable reference lookup support.
+  @param[in]      Flags   XML_PARSE_* flags, normally 0.
+  @param[out]     Stats   Parsing statistics. Optional.
+
+  @warning Same requirements as for XmlDocumentParse apply.
+
+  @return The parsed xml fragment or NULL.
+**/
+XML_DOCUMENT *
+XmlDocumentParseEx (
+  IN OUT  CHAR8            *Buffer,
+  IN      UINT32           Length,
+  IN      BOOLEAN          WithRefs,
+  IN      UINT32           Flags,
+     OUT  XML_PARSE_STATS  *Stats  OPTIONAL
+  );
+
 /**
   Export parsed document into the buffer.
 
@@ -151,6 +214,27 @@ XmlDocumentExport (
   IN   BOOLEAN             PrependPlistInfo
   );
 
+/**
+  Export parsed document into the caller provided buffer.
+
+  @param[in]      Document          XML_DOCUMENT to export.
+  @param[out]     Buffer            Destination buffer, NULL to query size.
+  @param[in,out]  Size              Buffer size on input, exported size with trailing '\0'
+                                    on output. Set to 0 when the document cannot be exported.
+  @param[in]      Skip              Number of root levels to be skipped before exporting, normally 0.
+  @param[in]      PrependPlistInfo  TRUE to prepend XML plist doc info to exported document.
+
+  @return TRUE if the document was exported into Buffer.
+**/
+BOOLEAN
+XmlDocumentExportTo (
+  IN      CONST XML_DOCUMENT  *Document,
+     OUT  CHAR8               *Buffer  OPTIONAL,
+  IN OUT  UINT32              *Size,
+  IN      UINT32              Skip,
+  IN      BOOLEAN             PrependPlistInfo
+  );
+
 /**
   Free all resources associated with the document. All XML_NODE
   references obtained through the document will be invalidated.
@@ -360,6 +444,24 @@ PlistDictChild (
   OUT  XML_NODE        **Value OPTIONAL
   );
 
+/**
+  Find the specific child node under a plist dictionary by key.
+  A key index is built on first lookup in large dictionaries and is
+  dropped when children are added. Keys must not be changed afterwards.
+
+  @param[in,out]  Node   A pointer to the XML node.
+  @param[in]      Key    Key name to look up.
+  @param[out]     Value  Value of the returned Node. Optional.
+
+  @return The first dictionary key matching Key or NULL.
+**/
+XML_NODE *
+PlistDictLookup (
+  IN OUT  XML_NODE     *Node,
+  IN      CONST CHAR8  *Key,
+     OUT  XML_NODE     **Value OPTIONAL
+  );
+
 /**
   Get the value of a plist key.
 
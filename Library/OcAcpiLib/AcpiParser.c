@@ -17,6 +17,288 @@
 
 #include "AcpiParser.h"
 
+/**
+  Records new node in namespace index and updates its frame depth.
+
+  @param[in, out] Context    Structure containing the parser context.
+  @param[in]      Type       Node type.
+  @param[in]      Start      Pointer after object opcode or NULL.
+  @param[in]      Length     Object package length or frame depth.
+  @param[in]      Name       Pointer to object name segments or NULL.
+  @param[in]      NameLength Quantity of name segments.
+  @param[in]      Name2      Pointer to second field name or NULL.
+  @param[in]      Flags      Node flags.
+
+  @retval EFI_SUCCESS          Node was recorded successfully.
+  @retval EFI_OUT_OF_RESOURCES Memory allocation failure.
+**/
+STATIC
+EFI_STATUS
+IndexAddNode (
+  IN OUT ACPI_PARSER_CONTEXT *Context,
+  IN     UINT8               Type,
+  IN     UINT8               *Start       OPTIONAL,
+  IN     UINT32              Length,
+  IN     UINT8               *Name        OPTIONAL,
+  IN     UINT8               NameLength,
+  IN     UINT8               *Name2       OPTIONAL,
+  IN     UINT8               Flags
+  )
+{
+  OC_ACPI_NAMESPACE_INDEX *Index;
+  OC_ACPI_NAMESPACE_NODE  *NewNodes;
+  OC_ACPI_NAMESPACE_NODE  *Node;
+
+  Index = Context->Index;
+
+  if (Index->NumberOfNodes == Index->AllocatedNodes) {
+    NewNodes = AllocatePool (Index->AllocatedNodes * 2 * sizeof (Index->Nodes[0]));
+    if (NewNodes == NULL) {
+      Context->IndexFailed = TRUE;
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CopyMem (NewNodes, Index->Nodes, Index->NumberOfNodes * sizeof (Index->Nodes[0]));
+    FreePool (Index->Nodes);
+
+    Index->Nodes          = NewNodes;
+    Index->AllocatedNodes *= 2;
+  }
+
+  Node = &Index->Nodes[Index->NumberOfNodes];
+  ++Index->NumberOfNodes;
+
+  Node->Type       = Type;
+  Node->Flags      = Flags;
+  Node->NameLength = NameLength;
+  Node->Opcode     = Start != NULL ? Start[-1] : 0;
+  Node->Offset     = Start != NULL ? (UINT32) (Start - 1 - Context->TableStart) : 0;
+  Node->Length     = Length;
+  Node->Name       = Name != NULL ? (UINT32) (Name - Context->TableStart) : 0;
+  Node->Name2      = Name2 != NULL ? (UINT32) (Name2 - Context->TableStart) : 0;
+
+  switch (Type) {
+    case OC_ACPI_NODE_SCOPE:
+    case OC_ACPI_NODE_IF:
+      ++Context->IndexDepth;
+      Index->MaxDepth = MAX (Index->MaxDepth, Context->IndexDepth);
+      break;
+
+    case OC_ACPI_NODE_SCOPE_END:
+    case OC_ACPI_NODE_IF_END:
+      ASSERT (Context->IndexDepth > 0);
+      --Context->IndexDepth;
+      break;
+
+    case OC_ACPI_NODE_RECOVER:
+      Context->IndexDepth = Length;
+      break;
+
+    default:
+      break;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Marks table bytes, which values affect parsing, in namespace index
+  being recorded if any.
+
+  @param[in, out] Context Structure containing the parser context.
+  @param[in]      Start   Pointer to first byte.
+  @param[in]      Size    Quantity of bytes.
+**/
+STATIC
+VOID
+IndexMarkValue (
+  IN OUT ACPI_PARSER_CONTEXT *Context,
+  IN     CONST UINT8         *Start,
+  IN     UINT32              Size
+  )
+{
+  UINT32 Offset;
+
+  if (Context->Index == NULL) {
+    return;
+  }
+
+  Offset = (UINT32) (Start - Context->TableStart);
+
+  while (Size > 0) {
+    Context->Index->ValueMap[Offset / 8] |= (UINT8) (1U << (Offset % 8));
+    ++Offset;
+    --Size;
+  }
+}
+
+/**
+  Checks whether name segment in ACPI table matches path identifier.
+
+  @param[in] Name       Pointer to name segment.
+  @param[in] Identifier Pointer to path identifier.
+
+  @retval TRUE  Name matches.
+**/
+STATIC
+BOOLEAN
+IsNameMatch (
+  IN CONST UINT8  *Name,
+  IN CONST UINT32 *Identifier
+  )
+{
+  UINT8 Index;
+
+  for (Index = 0; Index < IDENT_LEN; ++Index) {
+    if (Name[Index] != ((CONST UINT8 *) Identifier)[IDENT_LEN - Index - 1]) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Matches scope or device name against the path. Advances current
+  identifier on partial match and resets it otherwise.
+
+  @param[in, out] Context         Structure containing the parser context.
+  @param[in]      ScopeName       Pointer to scope name segments.
+  @param[in]      ScopeNameLength Quantity of name segments.
+  @param[in]      IsRootPath      1 if scope name is a root path.
+
+  @retval TRUE  Required entry was found.
+**/
+STATIC
+BOOLEAN
+MatchScopeName (
+  IN OUT ACPI_PARSER_CONTEXT *Context,
+  IN     UINT8               *ScopeName,
+  IN     UINT8               ScopeNameLength,
+  IN     UINT8               IsRootPath
+  )
+{
+  UINT8 Index;
+
+  if (IsRootPath) {
+    Context->CurrentIdentifier = Context->PathStart;
+  }
+
+  //
+  // Both exit conditions in these loops are for cases when there can be
+  // root-relative scopes within the current scope that does not match ours at all.
+  //
+  for (Index = 0; Index < ScopeNameLength; ++Index) {
+    if (Context->CurrentIdentifier == Context->PathEnd) {
+      Context->CurrentIdentifier = Context->PathStart;
+      break;
+    }
+
+    if (!IsNameMatch (ScopeName, Context->CurrentIdentifier)) {
+      Context->CurrentIdentifier = Context->PathStart;
+      break;
+    }
+
+    Context->CurrentIdentifier += 1;
+    ScopeName += 4;
+  }
+
+  if (Context->CurrentIdentifier == Context->PathEnd) {
+    Context->EntriesFound += 1;
+    if (Context->EntriesFound == Context->RequiredEntry) {
+      return TRUE;
+    }
+    //
+    // Same issue with root-relative scopes. Retry search.
+    //
+    Context->CurrentIdentifier = Context->PathStart;
+  }
+
+  return FALSE;
+}
+
+/**
+  Matches method or field name against the rest of the path.
+  Current identifier is preserved unless the entry is found.
+
+  @param[in, out] Context    Structure containing the parser context.
+  @param[in]      Name       Pointer to object name segments.
+  @param[in]      NameLength Quantity of name segments.
+
+  @retval TRUE  Required entry was found.
+**/
+STATIC
+BOOLEAN
+MatchObjectName (
+  IN OUT ACPI_PARSER_CONTEXT *Context,
+  IN     UINT8               *Name,
+  IN     UINT8               NameLength
+  )
+{
+  UINT32 *CurrentPath;
+  UINT8  Index;
+
+  CurrentPath = Context->CurrentIdentifier;
+
+  for (Index = 0; Index < NameLength; ++Index) {
+    //
+    // If the object is within our lookup path but not at it, this is not a match.
+    //
+    if (Context->CurrentIdentifier == Context->PathEnd
+      || !IsNameMatch (Name, Context->CurrentIdentifier)) {
+      Context->CurrentIdentifier = CurrentPath;
+      return FALSE;
+    }
+
+    Context->CurrentIdentifier += 1;
+    Name += 4;
+  }
+
+  if (Context->CurrentIdentifier != Context->PathEnd) {
+    Context->CurrentIdentifier = CurrentPath;
+    return FALSE;
+  }
+
+  Context->EntriesFound += 1;
+
+  if (Context->EntriesFound != Context->RequiredEntry) {
+    Context->CurrentIdentifier = CurrentPath;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Matches pair of field names (source and field for created fields,
+  register and field for bank and index fields) against the last
+  two path identifiers.
+
+  @param[in, out] Context Structure containing the parser context.
+  @param[in]      Name    Pointer to first name segment.
+  @param[in]      Name2   Pointer to second name segment.
+
+  @retval TRUE  Required entry was found.
+**/
+STATIC
+BOOLEAN
+MatchFieldNames (
+  IN OUT ACPI_PARSER_CONTEXT *Context,
+  IN     UINT8               *Name,
+  IN     UINT8               *Name2
+  )
+{
+  if (!IsNameMatch (Name, Context->CurrentIdentifier)
+    || Context->CurrentIdentifier + 2 != Context->PathEnd
+    || !IsNameMatch (Name2, Context->CurrentIdentifier + 1)) {
+    return FALSE;
+  }
+
+  Context->EntriesFound += 1;
+
+  return Context->EntriesFound == Context->RequiredEntry;
+}
+
 /**
   Parses identifier or path (several identifiers). Returns info about
   the identifier / path if necessary.
@@ -79,6 +361,7 @@ ParseNameString (
 
     case AML_MULTI_NAME_PREFIX:
       CONTEXT_ADVANCE_OPCODE (Context);
+      IndexMarkValue (Context, Context->CurrentOpcode, 1);
       CONTEXT_PEEK_BYTES (Context, 1 + Context->CurrentOpcode[0] * IDENT_LEN);
 
       if (NamePathStart != NULL) {
@@ -138,10 +421,12 @@ ParsePkgLength (
   TotalSize = 0;
   ByteCount = (LeadByte & 0xC0) >> 6;
 
+  IndexMarkValue (Context, Context->CurrentOpcode, 1);
   CONTEXT_CONSUME_BYTES (Context, 1);
 
   if (ByteCount > 0) {
     CONTEXT_PEEK_BYTES (Context, ByteCount);
+    IndexMarkValue (Context, Context->CurrentOpcode, ByteCount);
 
     for (Index = 0; Index < ByteCount; Index++) {
       TotalSize |= (UINT32) Context->CurrentOpcode[Index] << (Index * 8U + 4);
@@ -226,13 +511,9 @@ ParseScopeOrDevice (
   UINT32     *CurrentPath;
   UINT8      *ScopeEnd;
   UINT8      *ScopeName;
-  UINT8      *ScopeNameStart;
   UINT8      ScopeNameLength;
   UINT8      IsRootPath;
   EFI_STATUS Status;
-  UINT8      Index;
-  UINT8      Index2;
-  BOOLEAN    Breakout;
 
   CONTEXT_ENTER (Context, "Scope / Device");
   CONTEXT_HAS_WORK (Context);
@@ -265,57 +546,30 @@ ParseScopeOrDevice (
     return EFI_DEVICE_ERROR;
   }
 
-  ScopeNameStart = ScopeName;
-
   if (Context->CurrentOpcode > ScopeEnd) {
     return EFI_DEVICE_ERROR;
   }
 
-  if (IsRootPath) {
-    Context->CurrentIdentifier = Context->PathStart;
-  }
-
-  //
-  // Both exit conditions in these loops are for cases when there can be
-  // root-relative scopes within the current scope that does not match ours at all.
-  //
-  Breakout = FALSE;
-
-  for (Index = 0; Index < ScopeNameLength; ++Index) {
-    if (Context->CurrentIdentifier == Context->PathEnd) {
-      Context->CurrentIdentifier = Context->PathStart;
-      break;
-    }
-
-    for (Index2 = 0; Index2 < IDENT_LEN; ++Index2) {
-      if (*(ScopeName + Index2) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index2 - 1))) {
-        Context->CurrentIdentifier = Context->PathStart;
-        Breakout = TRUE;
-        break;
-      }
-    }
-
-    if (Breakout) {
-      break;
-    }
-
-    Context->CurrentIdentifier += 1;
-    ScopeName += 4;
-  }
-
-  if (Context->CurrentIdentifier == Context->PathEnd) {
-    Context->EntriesFound += 1;
-    if (Context->EntriesFound == Context->RequiredEntry) {
-      *Result = ScopeStart - 1;
-      return EFI_SUCCESS;
+  if (Context->Index != NULL) {
+    Status = IndexAddNode (
+      Context,
+      OC_ACPI_NODE_SCOPE,
+      ScopeStart,
+      PkgLength,
+      ScopeName,
+      ScopeNameLength,
+      NULL,
+      IsRootPath ? OC_ACPI_NODE_ROOT_PATH : 0
+      );
+    if (Status != EFI_SUCCESS) {
+      return Status;
     }
-    //
-    // Same issue with root-relative scopes. Retry search.
-    //
-    Context->CurrentIdentifier = Context->PathStart;
+  } else if (MatchScopeName (Context, ScopeName, ScopeNameLength, IsRootPath)) {
+    *Result = ScopeStart - 1;
+    return EFI_SUCCESS;
   }
 
-  PRINT_ACPI_NAME ("Entered scope", ScopeNameStart, ScopeNameLength);
+  PRINT_ACPI_NAME ("Entered scope", ScopeName, ScopeNameLength);
 
   while (Context->CurrentOpcode < ScopeEnd) {
     Status = InternalAcpiParseTerm (
@@ -328,7 +582,14 @@ ParseScopeOrDevice (
     }
   }
 
-  PRINT_ACPI_NAME ("Left scope", ScopeNameStart, ScopeNameLength);
+  PRINT_ACPI_NAME ("Left scope", ScopeName, ScopeNameLength);
+
+  if (Context->Index != NULL) {
+    Status = IndexAddNode (Context, OC_ACPI_NODE_SCOPE_END, NULL, 0, NULL, 0, NULL, 0);
+    if (Status != EFI_SUCCESS) {
+      return Status;
+    }
+  }
 
   Context->CurrentIdentifier = CurrentPath;
   CONTEXT_DECREASE_NESTING (Context);
@@ -451,12 +712,16 @@ ParseBankField (
      OUT UINT8               **Result
   )
 {
-  UINT32 PkgLength;
-  UINT8  *BankStart;
-  UINT8  *BankEnd;
-  UINT8  *Name;
-  UINT8  NameLength;
-  UINT8  Index;
+  UINT32     PkgLength;
+  UINT8      *BankStart;
+  UINT8      *BankEnd;
+  UINT8      *Name;
+  UINT8      *Name2;
+  UINT8      NameLength;
+  UINT8      Index;
+  UINT8      Flags;
+  UINT32     Nesting;
+  EFI_STATUS Status;
 
   CONTEXT_ENTER (Context, "BankField");
   CONTEXT_HAS_WORK (Context);
@@ -496,6 +761,45 @@ ParseBankField (
     return EFI_DEVICE_ERROR;
   }
 
+  if (Context->Index != NULL) {
+    //
+    // Only a match parses the bank name, record whether it fails
+    // for the lookup to know that the parser diverges there.
+    //
+    Nesting = Context->Nesting;
+    Flags   = 0;
+    if (ParseNameString (
+      Context,
+      &Name2,
+      &NameLength,
+      NULL
+      ) != EFI_SUCCESS) {
+      Flags = OC_ACPI_NODE_ERROR_LAST | OC_ACPI_NODE_ERROR_NEXT;
+      Name2 = NULL;
+    } else if (Context->CurrentOpcode > BankEnd || NameLength != 1) {
+      Flags = OC_ACPI_NODE_ERROR_NEXT;
+    }
+    Context->Nesting = Nesting;
+
+    Status = IndexAddNode (
+      Context,
+      OC_ACPI_NODE_BANK_FIELD,
+      BankStart,
+      PkgLength,
+      Name,
+      1,
+      Name2,
+      Flags
+      );
+    if (Status != EFI_SUCCESS) {
+      return Status;
+    }
+
+    Context->CurrentOpcode = BankEnd;
+    CONTEXT_DECREASE_NESTING (Context);
+    return EFI_NOT_FOUND;
+  }
+
   for (Index = 0; Index < IDENT_LEN; ++Index) {
     if (*(Name + Index) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index - 1))) {
       Context->CurrentOpcode = BankEnd;
@@ -593,12 +897,12 @@ ParseCreateField (
      OUT UINT8               **Result
   )
 {
-  UINT8    *FieldStart;
-  UINT8    *FieldOpcode;
-  UINT8    *Name;
-  UINT8    NameLength;
-  UINT8    Index;
-  BOOLEAN  Matched;
+  UINT8      *FieldStart;
+  UINT8      *FieldOpcode;
+  UINT8      *Name;
+  UINT8      *Name2;
+  UINT8      NameLength;
+  EFI_STATUS Status;
 
   CONTEXT_ENTER (Context, "CreateField");
   CONTEXT_HAS_WORK (Context);
@@ -650,14 +954,6 @@ ParseCreateField (
         return EFI_DEVICE_ERROR;
       }
 
-      Matched = TRUE;
-      for (Index = 0; Index < IDENT_LEN; Index++) {
-        if (*(Name + Index) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index - 1))) {
-          Matched = FALSE;
-          break;
-        }
-      }
-
       CONTEXT_PEEK_BYTES (Context, 1);
 
       switch (Context->CurrentOpcode[0]) {
@@ -691,7 +987,7 @@ ParseCreateField (
 
       if (ParseNameString (
         Context,
-        &Name,
+        &Name2,
         &NameLength,
         NULL
         ) != EFI_SUCCESS) {
@@ -702,39 +998,27 @@ ParseCreateField (
         return EFI_DEVICE_ERROR;
       }
 
-      if (!Matched) {
-        CONTEXT_DECREASE_NESTING (Context);
-        return EFI_NOT_FOUND;
-      }
-
-      Context->CurrentIdentifier += 1;
-
-      for (Index = 0; Index < IDENT_LEN; Index++) {
-        if (*(Name + Index) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index - 1))) {
-          CONTEXT_DECREASE_NESTING (Context);
-          Context->CurrentIdentifier--;
-          return EFI_NOT_FOUND;
+      if (Context->Index != NULL) {
+        Status = IndexAddNode (
+          Context,
+          OC_ACPI_NODE_CREATE_FIELD,
+          FieldStart,
+          0,
+          Name,
+          1,
+          Name2,
+          0
+          );
+        if (Status != EFI_SUCCESS) {
+          return Status;
         }
+      } else if (MatchFieldNames (Context, Name, Name2)) {
+        *Result = FieldStart - 1;
+        return EFI_SUCCESS;
       }
 
-      Context->CurrentIdentifier += 1;
-
-      if (Context->CurrentIdentifier != Context->PathEnd) {
-        CONTEXT_DECREASE_NESTING (Context);
-        Context->CurrentIdentifier -= 2;
-        return EFI_NOT_FOUND;
-      }
-
-      Context->EntriesFound += 1;
-
-      if (Context->EntriesFound != Context->RequiredEntry) {
-        CONTEXT_DECREASE_NESTING (Context);
-        Context->CurrentIdentifier -= 2;
-        return EFI_NOT_FOUND;
-      }
-
-      *Result = FieldStart - 1;
-      return EFI_SUCCESS;
+      CONTEXT_DECREASE_NESTING (Context);
+      return EFI_NOT_FOUND;
   }
 }
 
@@ -1160,21 +1444,18 @@ ParseMethod (
      OUT UINT8               **Result
   )
 {
-  UINT8  *MethodStart;
-  UINT32 *CurrentPath;
-  UINT32 PkgLength;
-  UINT8  *MethodEnd;
-  UINT8  *MethodName;
-  UINT8  MethodNameLength;
-  UINT8  Index;
-  UINT8  Index2;
+  UINT8      *MethodStart;
+  UINT32     PkgLength;
+  UINT8      *MethodEnd;
+  UINT8      *MethodName;
+  UINT8      MethodNameLength;
+  EFI_STATUS Status;
 
   CONTEXT_ENTER (Context, "Method");
   CONTEXT_HAS_WORK (Context);
   CONTEXT_INCREASE_NESTING (Context);
 
   MethodStart = Context->CurrentOpcode;
-  CurrentPath = Context->CurrentIdentifier;
 
   if (ParsePkgLength (
     Context,
@@ -1206,48 +1487,28 @@ ParseMethod (
     return EFI_DEVICE_ERROR;
   }
 
-  for (Index = 0; Index < MethodNameLength; ++Index) {
-    //
-    // If the method is within our lookup path but not at it, this is not a match.
-    //
-    if (Context->CurrentIdentifier == Context->PathEnd) {
-      Context->CurrentOpcode = MethodEnd;
-      Context->CurrentIdentifier = CurrentPath;
-      CONTEXT_DECREASE_NESTING (Context);
-      return EFI_NOT_FOUND;
+  if (Context->Index != NULL) {
+    Status = IndexAddNode (
+      Context,
+      OC_ACPI_NODE_METHOD,
+      MethodStart,
+      PkgLength,
+      MethodName,
+      MethodNameLength,
+      NULL,
+      0
+      );
+    if (Status != EFI_SUCCESS) {
+      return Status;
     }
-
-    for (Index2 = 0; Index2 < IDENT_LEN; Index2++) {
-      if (*(MethodName + Index2) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index2 - 1))) {
-        Context->CurrentOpcode = MethodEnd;
-        Context->CurrentIdentifier = CurrentPath;
-        CONTEXT_DECREASE_NESTING (Context);
-        return EFI_NOT_FOUND;
-      }
-    }
-
-    Context->CurrentIdentifier += 1;
-    MethodName += 4;
-  }
-
-  if (Context->CurrentIdentifier != Context->PathEnd) {
-    Context->CurrentOpcode = MethodEnd;
-    Context->CurrentIdentifier = CurrentPath;
-    CONTEXT_DECREASE_NESTING (Context);
-    return EFI_NOT_FOUND;
-  }
-
-  Context->EntriesFound += 1;
-
-  if (Context->EntriesFound != Context->RequiredEntry) {
-    Context->CurrentOpcode = MethodEnd;
-    Context->CurrentIdentifier = CurrentPath;
-    CONTEXT_DECREASE_NESTING (Context);
-    return EFI_NOT_FOUND;
+  } else if (MatchObjectName (Context, MethodName, MethodNameLength)) {
+    *Result = MethodStart - 1;
+    return EFI_SUCCESS;
   }
 
-  *Result = MethodStart - 1;
-  return EFI_SUCCESS;
+  Context->CurrentOpcode = MethodEnd;
+  CONTEXT_DECREASE_NESTING (Context);
+  return EFI_NOT_FOUND;
 }
 
 /**
@@ -1272,6 +1533,7 @@ ParseIfElse (
   UINT8      *IfStart;
   UINT32     *CurrentPath;
   UINT8      *IfEnd;
+  UINT32     Depth;
   EFI_STATUS Status;
 
   CONTEXT_ENTER (Context, "IfElse");
@@ -1294,6 +1556,15 @@ ParseIfElse (
 
   IfEnd = IfStart + PkgLength;
 
+  Depth = 0;
+  if (Context->Index != NULL) {
+    Status = IndexAddNode (Context, OC_ACPI_NODE_IF, IfStart, PkgLength, NULL, 0, NULL, 0);
+    if (Status != EFI_SUCCESS) {
+      return Status;
+    }
+    Depth = Context->IndexDepth;
+  }
+
   //
   // FIXME: This is broken like hell.
   //
@@ -1303,6 +1574,12 @@ ParseIfElse (
     if (Status == EFI_DEVICE_ERROR) {
       Context->CurrentOpcode += 1;
     }
+    //
+    // Errors are ignored leaving the lookup position of the failed term.
+    //
+    if (Context->Index != NULL && Status != EFI_NOT_FOUND) {
+      IndexAddNode (Context, OC_ACPI_NODE_RECOVER, NULL, Depth, NULL, 0, NULL, 0);
+    }
   }
 
   if (Status == EFI_DEVICE_ERROR) {
@@ -1320,6 +1597,10 @@ ParseIfElse (
 
   Context->CurrentIdentifier = CurrentPath;
 
+  if (Context->Index != NULL) {
+    IndexAddNode (Context, OC_ACPI_NODE_ELSE, NULL, 0, NULL, 0, NULL, 0);
+  }
+
   CONTEXT_PEEK_BYTES (Context, 1);
 
   if (Context->CurrentOpcode[0] == AML_ELSE_OP) {
@@ -1348,6 +1629,9 @@ ParseIfElse (
       if (Status == EFI_DEVICE_ERROR) {
         Context->CurrentOpcode += 1;
       }
+      if (Context->Index != NULL && Status != EFI_NOT_FOUND) {
+        IndexAddNode (Context, OC_ACPI_NODE_RECOVER, NULL, Depth, NULL, 0, NULL, 0);
+      }
     }
 
     if (Context->CurrentOpcode > IfEnd || Status == EFI_DEVICE_ERROR) {
@@ -1362,6 +1646,10 @@ ParseIfElse (
     Context->CurrentIdentifier = CurrentPath;
   }
 
+  if (Context->Index != NULL) {
+    IndexAddNode (Context, OC_ACPI_NODE_IF_END, NULL, 0, NULL, 0, NULL, 0);
+  }
+
   CONTEXT_DECREASE_NESTING (Context);
   return EFI_NOT_FOUND;
 }
@@ -1418,14 +1706,12 @@ ParseField (
      OUT UINT8               **Result
   )
 {
-  UINT8  *FieldStart;
-  UINT32 PkgLength;
-  UINT8  *FieldEnd;
-  UINT8  *FieldName;
-  UINT8  FieldNameLength;
-  UINT32 *CurrentPath;
-  UINT8  Index;
-  UINT8  Index2;
+  UINT8      *FieldStart;
+  UINT32     PkgLength;
+  UINT8      *FieldEnd;
+  UINT8      *FieldName;
+  UINT8      FieldNameLength;
+  EFI_STATUS Status;
 
   CONTEXT_ENTER (Context, "Field");
   CONTEXT_HAS_WORK (Context);
@@ -1463,47 +1749,28 @@ ParseField (
     return EFI_DEVICE_ERROR;
   }
 
-  CurrentPath = Context->CurrentIdentifier;
-
-  for (Index = 0; Index < FieldNameLength; Index++) {
-    if (Context->CurrentIdentifier == Context->PathEnd) {
-      Context->CurrentOpcode = FieldEnd;
-      Context->CurrentIdentifier = CurrentPath;
-      CONTEXT_DECREASE_NESTING (Context);
-      return EFI_NOT_FOUND;
-    }
-
-    for (Index2 = 0; Index2 < IDENT_LEN; Index2++) {
-      if (*(FieldName + Index2) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index2 - 1))) {
-        Context->CurrentOpcode = FieldEnd;
-        Context->CurrentIdentifier = CurrentPath;
-        CONTEXT_DECREASE_NESTING (Context);
-        return EFI_NOT_FOUND;
-      }
+  if (Context->Index != NULL) {
+    Status = IndexAddNode (
+      Context,
+      OC_ACPI_NODE_FIELD,
+      FieldStart,
+      PkgLength,
+      FieldName,
+      FieldNameLength,
+      NULL,
+      0
+      );
+    if (Status != EFI_SUCCESS) {
+      return Status;
     }
-
-    Context->CurrentIdentifier += 1;
-    FieldName += 4;
-  }
-
-  if (Context->CurrentIdentifier != Context->PathEnd) {
-    Context->CurrentOpcode = FieldEnd;
-    Context->CurrentIdentifier = CurrentPath;
-    CONTEXT_DECREASE_NESTING (Context);
-    return EFI_NOT_FOUND;
-  }
-
-  Context->EntriesFound += 1;
-
-  if (Context->EntriesFound != Context->RequiredEntry) {
-    Context->CurrentOpcode = FieldEnd;
-    Context->CurrentIdentifier = CurrentPath;
-    CONTEXT_DECREASE_NESTING (Context);
-    return EFI_NOT_FOUND;
+  } else if (MatchObjectName (Context, FieldName, FieldNameLength)) {
+    *Result = FieldStart - 1;
+    return EFI_SUCCESS;
   }
 
-  *Result = FieldStart - 1;
-  return EFI_SUCCESS;
+  Context->CurrentOpcode = FieldEnd;
+  CONTEXT_DECREASE_NESTING (Context);
+  return EFI_NOT_FOUND;
 }
 
 /**
@@ -1559,12 +1826,15 @@ ParseIndexField (
      OUT UINT8               **Result
   )
 {
-  UINT8  *FieldStart;
-  UINT32 PkgLength;
-  UINT8  *FieldEnd;
-  UINT8  *FieldName;
-  UINT8  FieldNameLength;
-  UINT8  Index;
+  UINT8      *FieldStart;
+  UINT32     PkgLength;
+  UINT8      *FieldEnd;
+  UINT8      *FieldName;
+  UINT8      *FieldName2;
+  UINT8      FieldNameLength;
+  UINT8      Index;
+  UINT8      Flags;
+  EFI_STATUS Status;
 
   CONTEXT_ENTER (Context, "IndexField");
   CONTEXT_HAS_WORK (Context);
@@ -1606,6 +1876,47 @@ ParseIndexField (
     return EFI_DEVICE_ERROR;
   }
 
+  if (Context->Index != NULL) {
+    //
+    // A match with the last path identifier always fails, others fail
+    // on data register name issues ignored without a match.
+    //
+    Flags = OC_ACPI_NODE_ERROR_LAST;
+    Status = ParseNameString (
+      Context,
+      &FieldName2,
+      &FieldNameLength,
+      NULL
+      );
+    if (Status != EFI_SUCCESS) {
+      Flags |= OC_ACPI_NODE_ERROR_NEXT;
+      FieldName2 = NULL;
+    } else if (Context->CurrentOpcode >= FieldEnd || FieldNameLength != 1) {
+      Flags |= OC_ACPI_NODE_ERROR_NEXT;
+    }
+
+    if (IndexAddNode (
+      Context,
+      OC_ACPI_NODE_INDEX_FIELD,
+      FieldStart,
+      PkgLength,
+      FieldName,
+      1,
+      FieldName2,
+      Flags
+      ) != EFI_SUCCESS) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    if (Status != EFI_SUCCESS) {
+      return EFI_DEVICE_ERROR;
+    }
+
+    Context->CurrentOpcode = FieldEnd;
+    CONTEXT_DECREASE_NESTING (Context);
+    return EFI_NOT_FOUND;
+  }
+
   for (Index = 0; Index < IDENT_LEN; ++Index) {
     if (*(FieldName + Index) != *((UINT8 *)Context->CurrentIdentifier + (IDENT_LEN - Index - 1))) {
       if (ParseNameString (
@@ -2045,3 +2356,332 @@ AcpiFindEntryInMemory (
   ClearContext (&Context);
   return EFI_NOT_FOUND;
 }
+
+EFI_STATUS
+AcpiInitNamespaceIndex (
+     OUT OC_ACPI_NAMESPACE_INDEX  *Index,
+  IN     UINT8                    *Table,
+  IN     UINT32                   TableLength OPTIONAL
+  )
+{
+  EFI_STATUS           Status;
+  UINT8                *Result;
+  UINT32               Identifier;
+  ACPI_PARSER_CONTEXT  Context;
+
+  ASSERT (Index != NULL);
+  ASSERT (Table != NULL);
+
+  ZeroMem (Index, sizeof (*Index));
+
+  if (TableLength > 0) {
+    if (TableLength < sizeof (EFI_ACPI_COMMON_HEADER)) {
+      DEBUG ((DEBUG_VERBOSE, "OCA: Got bad table format which does not specify its length!\n"));
+      return EFI_LOAD_ERROR;
+    }
+  } else {
+    TableLength = ((EFI_ACPI_COMMON_HEADER *) Table)->Length;
+  }
+
+  if (TableLength <= sizeof (EFI_ACPI_DESCRIPTION_HEADER)) {
+    DEBUG ((DEBUG_VERBOSE, "OCA: Bad or unsupported table header!\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
+  Index->Table          = Table;
+  Index->TableLength    = TableLength;
+  Index->Shadow         = AllocateCopyPool (TableLength, Table);
+  Index->ValueMap       = AllocateZeroPool ((TableLength + 7) / 8);
+  Index->AllocatedNodes = TableLength / 64 + 16;
+  Index->Nodes          = AllocatePool (Index->AllocatedNodes * sizeof (Index->Nodes[0]));
+
+  if (Index->Shadow == NULL || Index->ValueMap == NULL || Index->Nodes == NULL) {
+    AcpiFreeNamespaceIndex (Index);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  InitContext (&Context);
+
+  //
+  // Recording does not look at the path, but the context must have one.
+  //
+  Identifier = 0;
+  Context.PathStart         = &Identifier;
+  Context.CurrentIdentifier = &Identifier;
+  Context.PathEnd           = &Identifier + 1;
+  Context.RequiredEntry     = 1;
+  Context.Index             = Index;
+  Context.TableStart        = Table;
+  Context.TableEnd          = Table + TableLength;
+  Context.CurrentOpcode     = Table + sizeof (EFI_ACPI_DESCRIPTION_HEADER);
+
+  Status = EFI_NOT_FOUND;
+  while (Context.CurrentOpcode < Context.TableEnd) {
+    Status = InternalAcpiParseTerm (&Context, &Result);
+    if (Status != EFI_NOT_FOUND) {
+      break;
+    }
+  }
+
+  ASSERT (Status != EFI_SUCCESS);
+
+  if (Context.IndexFailed) {
+    AcpiFreeNamespaceIndex (Index);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Index->Status = Status;
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "OCA: Indexed %u bytes table into %u nodes with depth %u - %r\n",
+    TableLength,
+    Index->NumberOfNodes,
+    Index->MaxDepth,
+    Status
+    ));
+
+  return EFI_SUCCESS;
+}
+
+VOID
+AcpiFreeNamespaceIndex (
+  IN OUT OC_ACPI_NAMESPACE_INDEX  *Index
+  )
+{
+  if (Index->Shadow != NULL) {
+    FreePool (Index->Shadow);
+  }
+
+  if (Index->ValueMap != NULL) {
+    FreePool (Index->ValueMap);
+  }
+
+  if (Index->Nodes != NULL) {
+    FreePool (Index->Nodes);
+  }
+
+  ZeroMem (Index, sizeof (*Index));
+}
+
+/**
+  Checks whether byte is a valid name segment character.
+  All of them are parsed the same way unless used as a value.
+
+  @param[in] Byte  Byte to check.
+
+  @retval TRUE  Byte is a name character.
+**/
+STATIC
+BOOLEAN
+IsNameChar (
+  IN UINT8 Byte
+  )
+{
+  return (Byte >= 'A' && Byte <= 'Z')
+    || (Byte >= '0' && Byte <= '9')
+    || Byte == '_';
+}
+
+/**
+  Validates namespace index against current table contents.
+  Renamed name segments are accepted as they do not affect parsing.
+
+  @param[in, out] Index       Namespace index.
+  @param[in]      Table       Pointer to start of ACPI table.
+  @param[in]      TableLength Length of ACPI table.
+
+  @retval TRUE  Index is valid for the table.
+**/
+STATIC
+BOOLEAN
+IndexRefresh (
+  IN OUT OC_ACPI_NAMESPACE_INDEX  *Index,
+  IN     UINT8                    *Table,
+  IN     UINT32                   TableLength OPTIONAL
+  )
+{
+  UINT32 Offset;
+  UINT32 Size;
+  UINT32 Walker;
+
+  if (Index->Nodes == NULL) {
+    return FALSE;
+  }
+
+  if (TableLength == 0) {
+    TableLength = ((EFI_ACPI_COMMON_HEADER *) Table)->Length;
+  }
+
+  if (TableLength != Index->TableLength) {
+    return FALSE;
+  }
+
+  for (Offset = 0; Offset < TableLength; Offset += Size) {
+    Size = MIN (TableLength - Offset, INDEX_COMPARE_CHUNK);
+
+    if (CompareMem (Table + Offset, Index->Shadow + Offset, Size) == 0) {
+      continue;
+    }
+
+    for (Walker = Offset; Walker < Offset + Size; ++Walker) {
+      if (Table[Walker] != Index->Shadow[Walker]) {
+        if (!IsNameChar (Table[Walker])
+          || !IsNameChar (Index->Shadow[Walker])
+          || (Index->ValueMap[Walker / 8] & (1U << (Walker % 8))) != 0) {
+          return FALSE;
+        }
+
+        Index->Shadow[Walker] = Table[Walker];
+      }
+    }
+  }
+
+  Index->Table = Table;
+  return TRUE;
+}
+
+EFI_STATUS
+AcpiFindEntryInIndex (
+  IN OUT OC_ACPI_NAMESPACE_INDEX  *Index,
+  IN     UINT8                    *Table,
+  IN     CONST CHAR8              *PathString,
+  IN     UINT8                    Entry,
+     OUT UINT32                   *Offset,
+  IN     UINT32                   TableLength OPTIONAL
+  )
+{
+  EFI_STATUS              Status;
+  ACPI_PARSER_CONTEXT     Context;
+  OC_ACPI_NAMESPACE_NODE  *Node;
+  UINT32                  **Frames;
+  UINT32                  Depth;
+  UINT32                  NodeIndex;
+  UINT8                   Error;
+  BOOLEAN                 Found;
+
+  ASSERT (Index != NULL);
+  ASSERT (Table != NULL);
+  ASSERT (PathString != NULL);
+  ASSERT (Offset != NULL);
+
+  if (!IndexRefresh (Index, Table, TableLength)) {
+    AcpiFreeNamespaceIndex (Index);
+    Status = AcpiInitNamespaceIndex (Index, Table, TableLength);
+    if (EFI_ERROR (Status)) {
+      return AcpiFindEntryInMemory (Table, PathString, Entry, Offset, TableLength);
+    }
+  }
+
+  InitContext (&Context);
+  Context.RequiredEntry = Entry;
+
+  Status = GetOpcodeArray (
+    &Context,
+    PathString
+    );
+
+  if (EFI_ERROR (Status)) {
+    ClearContext (&Context);
+    return Status;
+  }
+
+  Frames = NULL;
+  if (Index->MaxDepth > 0) {
+    Frames = AllocatePool (Index->MaxDepth * sizeof (Frames[0]));
+    if (Frames == NULL) {
+      ClearContext (&Context);
+      return AcpiFindEntryInMemory (Table, PathString, Entry, Offset, TableLength);
+    }
+  }
+
+  //
+  // Replay path matching over the recorded objects. Frames keep lookup
+  // positions to restore when leaving scopes and if-else sections.
+  //
+  Status = Index->Status;
+  Depth  = 0;
+  Node   = NULL;
+
+  for (NodeIndex = 0; NodeIndex < Index->NumberOfNodes; ++NodeIndex) {
+    Node  = &Index->Nodes[NodeIndex];
+    Found = FALSE;
+
+    switch (Node->Type) {
+      case OC_ACPI_NODE_SCOPE:
+        Frames[Depth++] = Context.CurrentIdentifier;
+        Found = MatchScopeName (
+          &Context,
+          Table + Node->Name,
+          Node->NameLength,
+          (Node->Flags & OC_ACPI_NODE_ROOT_PATH) != 0
+          );
+        break;
+
+      case OC_ACPI_NODE_IF:
+        Frames[Depth++] = Context.CurrentIdentifier;
+        break;
+
+      case OC_ACPI_NODE_ELSE:
+        Context.CurrentIdentifier = Frames[Depth - 1];
+        break;
+
+      case OC_ACPI_NODE_SCOPE_END:
+      case OC_ACPI_NODE_IF_END:
+        Context.CurrentIdentifier = Frames[--Depth];
+        break;
+
+      case OC_ACPI_NODE_RECOVER:
+        Depth = Node->Length;
+        break;
+
+      case OC_ACPI_NODE_METHOD:
+      case OC_ACPI_NODE_FIELD:
+        Found = MatchObjectName (&Context, Table + Node->Name, Node->NameLength);
+        break;
+
+      case OC_ACPI_NODE_BANK_FIELD:
+      case OC_ACPI_NODE_INDEX_FIELD:
+        Error = Context.CurrentIdentifier + 1 == Context.PathEnd ? OC_ACPI_NODE_ERROR_LAST : OC_ACPI_NODE_ERROR_NEXT;
+        if ((Node->Flags & Error) != 0
+          && IsNameMatch (Table + Node->Name, Context.CurrentIdentifier)) {
+          //
+          // Matching makes the parser fail differently from recorded.
+          //
+          Status = EFI_UNSUPPORTED;
+          break;
+        }
+        /* Fallthrough */
+      case OC_ACPI_NODE_CREATE_FIELD:
+        Found = MatchFieldNames (&Context, Table + Node->Name, Table + Node->Name2);
+        break;
+
+      default:
+        ASSERT (FALSE);
+        break;
+    }
+
+    if (Found) {
+      *Offset = Node->Offset;
+      Status  = EFI_SUCCESS;
+      break;
+    }
+
+    if (Status == EFI_UNSUPPORTED) {
+      break;
+    }
+  }
+
+  if (Frames != NULL) {
+    FreePool (Frames);
+  }
+
+  ClearContext (&Context);
+
+  if (Status == EFI_UNSUPPORTED) {
+    DEBUG ((DEBUG_VERBOSE, "OCA: Index lookup of %a diverged at %u, parsing\n", PathString, Node->Offset));
+    return AcpiFindEntryInMemory (Table, PathString, Entry, Offset, TableLength);
+  }
+
+  return Status;
+}
@@ -46,6 +46,18 @@ typedef struct {
   /// Number of entries already found.
   ///
   UINT32 EntriesFound;
+  ///
+  /// Namespace index to record objects to instead of matching the path.
+  ///
+  OC_ACPI_NAMESPACE_INDEX *Index;
+  ///
+  /// Number of open frames in the namespace index being recorded.
+  ///
+  UINT32 IndexDepth;
+  ///
+  /// Namespace index lost nodes due to memory allocation failure.
+  ///
+  BOOLEAN IndexFailed;
 } ACPI_PARSER_CONTEXT;
 
 
@@ -53,6 +65,11 @@ typedef struct {
 #define OPCODE_LEN  8
 #define MAX_NESTING 1024
 
+///
+/// Table bytes compared at once when validating namespace index.
+///
+#define INDEX_COMPARE_CHUNK 256
+
 /**
   Print new entry name.
 **/
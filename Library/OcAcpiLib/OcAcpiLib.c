@@ -21,6 +21,7 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/OcMemoryLib.h>
 #include <Library/OcMiscLib.h>
+#include <Library/TimerLib.h>
 
 #include <IndustryStandard/AcpiAml.h>
 #include <IndustryStandard/Acpi.h>
@@ -872,6 +873,8 @@ AcpiFreeContext (
   IN OUT OC_ACPI_CONTEXT  *Context
   )
 {
+  UINT32  Index;
+
   if (Context->Tables != NULL) {
     FreePool (Context->Tables);
     Context->Tables = NULL;
@@ -881,6 +884,17 @@ AcpiFreeContext (
     FreePool (Context->Regions);
     Context->Regions = NULL;
   }
+
+  if (Context->Indices != NULL) {
+    for (Index = 0; Index < Context->NumberOfIndices; ++Index) {
+      AcpiFreeNamespaceIndex (&Context->Indices[Index]);
+    }
+
+    FreePool (Context->Indices);
+    Context->Indices          = NULL;
+    Context->NumberOfIndices  = 0;
+    Context->AllocatedIndices = 0;
+  }
 }
 
 EFI_STATUS
@@ -1226,14 +1240,122 @@ AcpiNormalizeHeaders (
   }
 }
 
+/**
+  Find patch Base entry in ACPI table with its namespace index,
+  which is created on first lookup in the table.
+
+  @param[in,out] Context     ACPI library context.
+  @param[in]     Table       ACPI table.
+  @param[in]     Patch       ACPI patch with Base.
+  @param[out]    BaseOffset  Base entry offset.
+
+  @return EFI_SUCCESS when Base entry is found.
+**/
+STATIC
 EFI_STATUS
-AcpiApplyPatch (
+AcpiFindPatchBase (
+  IN OUT OC_ACPI_CONTEXT         *Context,
+  IN     EFI_ACPI_COMMON_HEADER  *Table,
+  IN     OC_ACPI_PATCH           *Patch,
+     OUT UINT32                  *BaseOffset
+  )
+{
+  EFI_STATUS               Status;
+  OC_ACPI_NAMESPACE_INDEX  *NewIndices;
+  UINT32                   Index;
+
+  for (Index = 0; Index < Context->NumberOfIndices; ++Index) {
+    if (Context->Indices[Index].Table == (UINT8 *) Table) {
+      break;
+    }
+  }
+
+  if (Index == Context->NumberOfIndices) {
+    if (Context->NumberOfIndices == Context->AllocatedIndices) {
+      NewIndices = AllocatePool ((Context->AllocatedIndices + 2) * sizeof (Context->Indices[0]));
+      if (NewIndices == NULL) {
+        return AcpiFindEntryInMemory (
+          (UINT8 *) Table,
+          Patch->Base,
+          (UINT8) (Patch->BaseSkip + 1),
+          BaseOffset,
+          Table->Length
+          );
+      }
+
+      if (Context->Indices != NULL) {
+        CopyMem (NewIndices, Context->Indices, Context->NumberOfIndices * sizeof (Context->Indices[0]));
+        FreePool (Context->Indices);
+      }
+
+      Context->Indices = NewIndices;
+      Context->AllocatedIndices += 2;
+    }
+
+    ZeroMem (&Context->Indices[Index], sizeof (Context->Indices[0]));
+    ++Context->NumberOfIndices;
+  }
+
+  Status = AcpiFindEntryInIndex (
+    &Context->Indices[Index],
+    (UINT8 *) Table,
+    Patch->Base,
+    (UINT8) (Patch->BaseSkip + 1),
+    BaseOffset,
+    Table->Length
+    );
+
+  //
+  // Keep the slot even if the index could not be built.
+  //
+  Context->Indices[Index].Table = (UINT8 *) Table;
+
+  return Status;
+}
+
+/**
+  Move namespace index of ACPI table to its copy.
+
+  @param[in,out] Context   ACPI library context.
+  @param[in]     Table     Original ACPI table.
+  @param[in]     NewTable  Copied ACPI table.
+**/
+STATIC
+VOID
+AcpiMoveNamespaceIndex (
+  IN OUT OC_ACPI_CONTEXT         *Context,
+  IN     EFI_ACPI_COMMON_HEADER  *Table,
+  IN     EFI_ACPI_COMMON_HEADER  *NewTable
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < Context->NumberOfIndices; ++Index) {
+    if (Context->Indices[Index].Table == (UINT8 *) Table) {
+      Context->Indices[Index].Table = (UINT8 *) NewTable;
+      break;
+    }
+  }
+}
+
+/**
+  Patch ACPI tables with one patch.
+
+  @param[in,out] Context       ACPI library context.
+  @param[in]     Patch         ACPI patch.
+  @param[out]    ReplaceTotal  Replacements performed in all tables.
+**/
+STATIC
+EFI_STATUS
+AcpiApplyPatchCounted (
   IN OUT OC_ACPI_CONTEXT  *Context,
-  IN     OC_ACPI_PATCH    *Patch
+  IN     OC_ACPI_PATCH    *Patch,
+     OUT UINT32           *ReplaceTotal
   )
 {
   EFI_STATUS              Status;
   EFI_ACPI_COMMON_HEADER  *NewTable;
+  EFI_ACPI_COMMON_HEADER  *OldTable;
   UINT32                  Index;
   UINT32                  BaseOffset;
   UINT64                  CurrOemTableId;
@@ -1243,6 +1365,8 @@ AcpiApplyPatch (
 
   DEBUG ((DEBUG_INFO, "OCA: Applying %u byte ACPI patch skip %u, count %u\n", Patch->Size, Patch->Skip, Patch->Count));
 
+  *ReplaceTotal = 0;
+
   if (Context->Dsdt != NULL
     && (Patch->TableSignature == 0 || Patch->TableSignature == EFI_ACPI_6_2_DIFFERENTIATED_SYSTEM_DESCRIPTION_TABLE_SIGNATURE)
     && (Patch->TableLength == 0 || Context->Dsdt->Length == Patch->TableLength)
@@ -1255,12 +1379,11 @@ AcpiApplyPatch (
     BaseOffset = 0;
 
     if (Patch->Base != NULL && Patch->Base[0] != '\0') {
-      Status = AcpiFindEntryInMemory (
-        (VOID *) Context->Dsdt,
-        Patch->Base,
-        (UINT8) (Patch->BaseSkip + 1),
-        &BaseOffset,
-        Context->Dsdt->Length
+      Status = AcpiFindPatchBase (
+        Context,
+        (EFI_ACPI_COMMON_HEADER *) Context->Dsdt,
+        Patch,
+        &BaseOffset
         );
       if (!EFI_ERROR (Status)) {
         ReplaceLimit = MIN (ReplaceLimit, Context->Dsdt->Length - BaseOffset);
@@ -1278,10 +1401,12 @@ AcpiApplyPatch (
 
     if (!EFI_ERROR (Status)) {
       if (!AcpiIsTableWritable ((EFI_ACPI_COMMON_HEADER *) Context->Dsdt)) {
+        OldTable = (EFI_ACPI_COMMON_HEADER *) Context->Dsdt;
         Status = AcpiAllocateCopyDsdt (Context, NULL);
         if (EFI_ERROR (Status)) {
           return Status;
         }
+        AcpiMoveNamespaceIndex (Context, OldTable, (EFI_ACPI_COMMON_HEADER *) Context->Dsdt);
       }
 
       ReplaceCount = ApplyPatch (
@@ -1308,6 +1433,8 @@ AcpiApplyPatch (
       if (ReplaceCount > 0) {
         AcpiRefreshTableChecksum (Context->Dsdt);
       }
+
+      *ReplaceTotal += ReplaceCount;
     }
   }
 
@@ -1334,12 +1461,11 @@ AcpiApplyPatch (
 
       BaseOffset = 0;
       if (Patch->Base != NULL && Patch->Base[0] != '\0') {
-        Status = AcpiFindEntryInMemory (
-          (VOID *) Context->Tables[Index],
-          Patch->Base,
-          (UINT8) (Patch->BaseSkip + 1),
-          &BaseOffset,
-          Context->Tables[Index]->Length
+        Status = AcpiFindPatchBase (
+          Context,
+          Context->Tables[Index],
+          Patch,
+          &BaseOffset
           );
         if (EFI_ERROR (Status)) {
           DEBUG ((
@@ -1363,6 +1489,7 @@ AcpiApplyPatch (
         if (EFI_ERROR (Status)) {
           return Status;
         }
+        AcpiMoveNamespaceIndex (Context, Context->Tables[Index], NewTable);
         Context->Tables[Index] = NewTable;
       }
 
@@ -1394,12 +1521,306 @@ AcpiApplyPatch (
       if (ReplaceCount > 0 && Context->Tables[Index]->Length >= sizeof (EFI_ACPI_DESCRIPTION_HEADER)) {
         AcpiRefreshTableChecksum ((EFI_ACPI_DESCRIPTION_HEADER *) Context->Tables[Index]);
       }
+
+      *ReplaceTotal += ReplaceCount;
     }
   }
 
   return EFI_SUCCESS;
 }
 
+EFI_STATUS
+AcpiApplyPatch (
+  IN OUT OC_ACPI_CONTEXT  *Context,
+  IN     OC_ACPI_PATCH    *Patch
+  )
+{
+  UINT32  ReplaceTotal;
+
+  return AcpiApplyPatchCounted (Context, Patch, &ReplaceTotal);
+}
+
+/**
+  Check whether ACPI patch targets the table.
+
+  @param[in] Patch  ACPI patch.
+  @param[in] Table  ACPI table.
+
+  @retval TRUE  Table signature, length, and OEM table id match the patch.
+**/
+STATIC
+BOOLEAN
+AcpiIsPatchTarget (
+  IN OC_ACPI_PATCH           *Patch,
+  IN EFI_ACPI_COMMON_HEADER  *Table
+  )
+{
+  UINT64  CurrOemTableId;
+
+  if ((Patch->TableSignature != 0 && Table->Signature != Patch->TableSignature)
+    || (Patch->TableLength != 0 && Table->Length != Patch->TableLength)) {
+    return FALSE;
+  }
+
+  if (Table->Length >= sizeof (EFI_ACPI_DESCRIPTION_HEADER)) {
+    CurrOemTableId = ((EFI_ACPI_DESCRIPTION_HEADER *) Table)->OemTableId;
+  } else {
+    CurrOemTableId = 0;
+  }
+
+  return Patch->OemTableId == 0 || CurrOemTableId == Patch->OemTableId;
+}
+
+/**
+  Check whether ACPI patch looks up its data relative to a Base path.
+
+  @param[in] Patch  ACPI patch.
+
+  @retval TRUE  Patch has non-empty Base.
+**/
+STATIC
+BOOLEAN
+AcpiIsBasePatch (
+  IN OC_ACPI_PATCH  *Patch
+  )
+{
+  return Patch->Base != NULL && Patch->Base[0] != '\0';
+}
+
+/**
+  Apply all patches without Base to one ACPI table in a single pass.
+
+  @param[in,out] Context        ACPI library context.
+  @param[in]     TableIndex     Table index in Context->Tables or MAX_UINT32 for DSDT.
+  @param[in]     Patches        ACPI patches.
+  @param[in]     PatchCount     Number of ACPI patches.
+  @param[in]     DataPatches    Scratch data patches, PatchCount entries.
+  @param[in]     DataPatchMap   Scratch data patch map, PatchCount entries.
+  @param[in,out] ReplaceCounts  Replacements performed for every patch.
+**/
+STATIC
+EFI_STATUS
+AcpiApplyTablePatches (
+  IN OUT OC_ACPI_CONTEXT  *Context,
+  IN     UINT32           TableIndex,
+  IN     OC_ACPI_PATCH    *Patches,
+  IN     UINT32           PatchCount,
+  IN     OC_DATA_PATCH    *DataPatches,
+  IN     UINT32           *DataPatchMap,
+  IN OUT UINT32           *ReplaceCounts
+  )
+{
+  EFI_STATUS              Status;
+  EFI_ACPI_COMMON_HEADER  *Table;
+  EFI_ACPI_COMMON_HEADER  *NewTable;
+  UINT32                  DataPatchCount;
+  UINT32                  ReplaceCount;
+  UINT32                  Index;
+  UINT32                  TablePrintSignature;
+  UINT64                  StartTime;
+
+  if (TableIndex == MAX_UINT32) {
+    Table = (EFI_ACPI_COMMON_HEADER *) Context->Dsdt;
+  } else {
+    Table = Context->Tables[TableIndex];
+  }
+
+  DataPatchCount = 0;
+  for (Index = 0; Index < PatchCount; ++Index) {
+    if (!AcpiIsBasePatch (&Patches[Index])
+      && AcpiIsPatchTarget (&Patches[Index], Table)) {
+      DataPatches[DataPatchCount].Pattern     = Patches[Index].Find;
+      DataPatches[DataPatchCount].PatternMask = Patches[Index].Mask;
+      DataPatches[DataPatchCount].Replace     = Patches[Index].Replace;
+      DataPatches[DataPatchCount].ReplaceMask = Patches[Index].ReplaceMask;
+      DataPatches[DataPatchCount].PatternSize = Patches[Index].Size;
+      DataPatches[DataPatchCount].Count       = Patches[Index].Count;
+      DataPatches[DataPatchCount].Skip        = Patches[Index].Skip;
+      DataPatches[DataPatchCount].Limit       = Patches[Index].Limit;
+      DataPatchMap[DataPatchCount]            = Index;
+      ++DataPatchCount;
+    }
+  }
+
+  if (DataPatchCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (!AcpiIsTableWritable (Table)) {
+    if (TableIndex == MAX_UINT32) {
+      Status = AcpiAllocateCopyDsdt (Context, NULL);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+      NewTable = (EFI_ACPI_COMMON_HEADER *) Context->Dsdt;
+    } else {
+      Status = AcpiAllocateCopyTable (Table, 0, &NewTable);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+      Context->Tables[TableIndex] = NewTable;
+    }
+
+    AcpiMoveNamespaceIndex (Context, Table, NewTable);
+    Table = NewTable;
+  }
+
+  TablePrintSignature = AcpiReadSignature (Table);
+
+  StartTime = GetPerformanceCounter ();
+
+  ReplaceCount = ApplyPatches (
+    DataPatches,
+    DataPatchCount,
+    (UINT8 *) Table,
+    Table->Length
+    );
+
+  DEBUG ((
+    ReplaceCount > 0 ? DEBUG_INFO : DEBUG_BULK_INFO,
+    "OCA: Patching %.4a (OEM %016Lx) of %u bytes with %u patches replaced %u in %Lu us\n",
+    (CHAR8 *) &TablePrintSignature,
+    AcpiReadOemTableId (Table),
+    Table->Length,
+    DataPatchCount,
+    ReplaceCount,
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000)
+    ));
+
+  for (Index = 0; Index < DataPatchCount; ++Index) {
+    ReplaceCounts[DataPatchMap[Index]] += DataPatches[Index].ReplaceCount;
+  }
+
+  if (ReplaceCount > 0 && Table->Length >= sizeof (EFI_ACPI_DESCRIPTION_HEADER)) {
+    AcpiRefreshTableChecksum ((EFI_ACPI_DESCRIPTION_HEADER *) Table);
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+AcpiApplyPatches (
+  IN OUT OC_ACPI_CONTEXT  *Context,
+  IN     OC_ACPI_PATCH    *Patches,
+  IN     UINT32           PatchCount,
+     OUT UINT32           *ReplaceCounts
+  )
+{
+  EFI_STATUS     Status;
+  EFI_STATUS     PatchStatus;
+  EFI_STATUS     Result;
+  OC_DATA_PATCH  *DataPatches;
+  UINT32         *DataPatchMap;
+  UINT32         Index;
+  UINT32         Start;
+  UINT32         End;
+  UINT64         StartTime;
+
+  ASSERT (Context != NULL);
+  ASSERT (Patches != NULL || PatchCount == 0);
+  ASSERT (ReplaceCounts != NULL || PatchCount == 0);
+
+  if (PatchCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  ZeroMem (ReplaceCounts, PatchCount * sizeof (*ReplaceCounts));
+
+  DataPatches  = AllocatePool (PatchCount * sizeof (*DataPatches));
+  DataPatchMap = AllocatePool (PatchCount * sizeof (*DataPatchMap));
+  if (DataPatches == NULL || DataPatchMap == NULL) {
+    DEBUG ((DEBUG_INFO, "OCA: Falling back to separate patching for %u patches\n", PatchCount));
+    if (DataPatches != NULL) {
+      FreePool (DataPatches);
+    }
+    if (DataPatchMap != NULL) {
+      FreePool (DataPatchMap);
+    }
+
+    Status = EFI_SUCCESS;
+    for (Index = 0; Index < PatchCount; ++Index) {
+      PatchStatus = AcpiApplyPatchCounted (Context, &Patches[Index], &ReplaceCounts[Index]);
+      if (EFI_ERROR (PatchStatus)) {
+        Status = PatchStatus;
+      }
+    }
+
+    return Status;
+  }
+
+  StartTime = GetPerformanceCounter ();
+  Result    = EFI_SUCCESS;
+  Start     = 0;
+
+  while (Start < PatchCount) {
+    //
+    // Consecutive patches looking up data within the whole table share one pass
+    // per table. Base-relative patches have their own lookup range and break the
+    // run to keep the configuration order. ApplyPatches keeps the order within
+    // the run itself. Failures are recorded, but do not stop patching other
+    // tables and later patches.
+    //
+    for (End = Start; End < PatchCount && !AcpiIsBasePatch (&Patches[End]); ++End) {
+    }
+
+    if (End > Start && Context->Dsdt != NULL) {
+      Status = AcpiApplyTablePatches (
+        Context,
+        MAX_UINT32,
+        &Patches[Start],
+        End - Start,
+        DataPatches,
+        DataPatchMap,
+        &ReplaceCounts[Start]
+        );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_WARN, "OCA: Failed to patch DSDT - %r\n", Status));
+        Result = Status;
+      }
+    }
+
+    for (Index = 0; End > Start && Index < Context->NumberOfTables; ++Index) {
+      Status = AcpiApplyTablePatches (
+        Context,
+        Index,
+        &Patches[Start],
+        End - Start,
+        DataPatches,
+        DataPatchMap,
+        &ReplaceCounts[Start]
+        );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_WARN, "OCA: Failed to patch table %u - %r\n", Index, Status));
+        Result = Status;
+      }
+    }
+
+    if (End < PatchCount) {
+      Status = AcpiApplyPatchCounted (Context, &Patches[End], &ReplaceCounts[End]);
+      if (EFI_ERROR (Status)) {
+        Result = Status;
+      }
+      ++End;
+    }
+
+    Start = End;
+  }
+
+  FreePool (DataPatches);
+  FreePool (DataPatchMap);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OCA: Applied %u patches to %u tables in %Lu us - %r\n",
+    PatchCount,
+    Context->NumberOfTables + (Context->Dsdt != NULL ? 1 : 0),
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000),
+    Result
+    ));
+
+  return Result;
+}
+
 EFI_STATUS
 AcpiLoadRegions (
   IN OUT OC_ACPI_CONTEXT  *Context
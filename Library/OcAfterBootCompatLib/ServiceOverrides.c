@@ -319,6 +319,38 @@ DevirtualiseMmio (
   }
 }
 
+/**
+  Report single booter patch result.
+
+  @param[in]      Patch          Applied booter patch.
+  @param[in]      ReplaceCount   Number of performed replacements.
+**/
+STATIC
+VOID
+ReportBooterPatch (
+  IN     OC_BOOTER_PATCH  *Patch,
+  IN     UINT32           ReplaceCount
+  )
+{
+  if (ReplaceCount > 0 && Patch->Count > 0 && ReplaceCount != Patch->Count) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCABC: Booter patch (%a) performed only %u replacements out of %u\n",
+      Patch->Comment,
+      ReplaceCount,
+      Patch->Count
+      ));
+  } else if (ReplaceCount == 0) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCABC: Failed to apply Booter patch (%a) - not found\n",
+      Patch->Comment
+      ));
+  } else {
+    DEBUG ((DEBUG_INFO, "OCABC: Booter patch (%a) replace count - %u\n", Patch->Comment, ReplaceCount));
+  }
+}
+
 /**
   Apply single booter patch.
 
@@ -357,23 +389,7 @@ ApplyBooterPatch (
     Patch->Skip
     );
 
-  if (ReplaceCount > 0 && Patch->Count > 0 && ReplaceCount != Patch->Count) {
-    DEBUG ((
-      DEBUG_INFO,
-      "OCABC: Booter patch (%a) performed only %u replacements out of %u\n",
-      Patch->Comment,
-      ReplaceCount,
-      Patch->Count
-      ));
-  } else if (ReplaceCount == 0) {
-    DEBUG ((
-      DEBUG_INFO,
-      "OCABC: Failed to apply Booter patch (%a) - not found\n",
-      Patch->Comment
-      ));
-  } else {
-    DEBUG ((DEBUG_INFO, "OCABC: Booter patch (%a) replace count - %u\n", Patch->Comment, ReplaceCount));
-  }
+  ReportBooterPatch (Patch, ReplaceCount);
 }
 
 /**
@@ -399,6 +415,13 @@ ApplyBooterPatches (
   BOOLEAN                     UsePatch;
   CONST CHAR8                 *UserIdentifier;
   CHAR16                      *UserIdentifierUnicode;
+  OC_DATA_PATCH               *DataPatches;
+  UINT32                      *DataPatchMap;
+  UINT32                      DataPatchCount;
+
+  if (PatchCount == 0) {
+    return;
+  }
 
   Status = gBS->HandleProtocol (
     ImageHandle,
@@ -410,6 +433,23 @@ ApplyBooterPatches (
     return;
   }
 
+  //
+  // All patches target the same image, so apply them in a single pass when possible.
+  //
+  DataPatches    = AllocatePool (PatchCount * sizeof (*DataPatches));
+  DataPatchMap   = AllocatePool (PatchCount * sizeof (*DataPatchMap));
+  DataPatchCount = 0;
+  if (DataPatches == NULL || DataPatchMap == NULL) {
+    if (DataPatches != NULL) {
+      FreePool (DataPatches);
+      DataPatches = NULL;
+    }
+    if (DataPatchMap != NULL) {
+      FreePool (DataPatchMap);
+      DataPatchMap = NULL;
+    }
+  }
+
   for (Index = 0; Index < PatchCount; ++Index) {
     UserIdentifier = Patches[Index].Identifier;
 
@@ -427,13 +467,50 @@ ApplyBooterPatches (
       FreePool (UserIdentifierUnicode);
     }
 
-    if (UsePatch) {
+    if (!UsePatch) {
+      continue;
+    }
+
+    if (DataPatches == NULL) {
       ApplyBooterPatch (
         (UINT8 *) LoadedImage->ImageBase,
         (UINTN)LoadedImage->ImageSize,
         &Patches[Index]
         );
+      continue;
     }
+
+    if ((UINTN) LoadedImage->ImageSize < Patches[Index].Size) {
+      DEBUG ((DEBUG_INFO, "OCABC: Image size is even smaller than patch size\n"));
+      continue;
+    }
+
+    DataPatches[DataPatchCount].Pattern     = Patches[Index].Find;
+    DataPatches[DataPatchCount].PatternMask = Patches[Index].Mask;
+    DataPatches[DataPatchCount].Replace     = Patches[Index].Replace;
+    DataPatches[DataPatchCount].ReplaceMask = Patches[Index].ReplaceMask;
+    DataPatches[DataPatchCount].PatternSize = Patches[Index].Size;
+    DataPatches[DataPatchCount].Count       = Patches[Index].Count;
+    DataPatches[DataPatchCount].Skip        = Patches[Index].Skip;
+    DataPatches[DataPatchCount].Limit       = Patches[Index].Limit;
+    DataPatchMap[DataPatchCount]            = Index;
+    ++DataPatchCount;
+  }
+
+  if (DataPatches != NULL) {
+    ApplyPatches (
+      DataPatches,
+      DataPatchCount,
+      (UINT8 *) LoadedImage->ImageBase,
+      (UINT32) LoadedImage->ImageSize
+      );
+
+    for (Index = 0; Index < DataPatchCount; ++Index) {
+      ReportBooterPatch (&Patches[DataPatchMap[Index]], DataPatches[Index].ReplaceCount);
+    }
+
+    FreePool (DataPatches);
+    FreePool (DataPatchMap);
   }
 }
 
@@ -650,23 +727,17 @@ OcGetMemoryMap (
     }
 
     if (BootCompat->Settings.RebuildAppleMemoryMap) {
-      OcSortMemoryMap (*MemoryMapSize, MemoryMap, *DescriptorSize);
-
-      Status2 = OcSplitMemoryMapByAttributes (
+      Status2 = OcNormalizeMemoryMap (
         OriginalSize,
         MemoryMapSize,
         MemoryMap,
-        *DescriptorSize
+        *DescriptorSize,
+        TRUE,
+        FALSE
         );
       if (EFI_ERROR (Status2) && Status2 != EFI_UNSUPPORTED) {
         DEBUG ((DEBUG_INFO, "OCABC: Cannot rebuild memory map - %r\n", Status));
       }
-
-      OcShrinkMemoryMap (
-        MemoryMapSize,
-        MemoryMap,
-        *DescriptorSize
-        );
     }
 
     //
@@ -14,7 +14,6 @@
 
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
-#include <Library/MemoryAllocationLib.h>
 #include <Library/OcAppleChunklistLib.h>
 #include <Library/OcAppleRamDiskLib.h>
 #include <Library/OcCryptoLib.h>
@@ -124,71 +123,128 @@ OcAppleChunklistVerifySignature (
   return Result;
 }
 
-BOOLEAN
-OcAppleChunklistVerifyData (
-  IN OUT OC_APPLE_CHUNKLIST_CONTEXT         *Context,
-  IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+VOID
+OcAppleChunklistVerifyDataStart (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
   )
 {
-  BOOLEAN                     Result;
-
-  UINTN                       Index;
-  UINT8                       ChunkHash[SHA256_DIGEST_SIZE];
-  CONST APPLE_CHUNKLIST_CHUNK *CurrentChunk;
-  UINTN                       CurrentOffset;
-
-  UINT32                      ChunkDataSize;
-  VOID                        *ChunkData;
-
   ASSERT (Context != NULL);
   ASSERT (Context->Chunks != NULL);
-  ASSERT (ExtentTable != NULL);
 
   DEBUG_CODE (
     ASSERT (Context->Signature == NULL);
     );
 
-  ChunkDataSize = 0;
-  for (Index = 0; Index < Context->ChunkCount; ++Index) {
-    CurrentChunk = &Context->Chunks[Index];
-    if (ChunkDataSize < CurrentChunk->Length) {
-      ChunkDataSize = CurrentChunk->Length;
-    }
-  }
+  Context->VerifiedChunkCount = 0;
+  Context->ChunkHashedSize    = 0;
+  Context->VerifyFailed       = FALSE;
+  Sha256Init (&Context->ChunkHashContext);
+}
+
+BOOLEAN
+OcAppleChunklistVerifyDataUpdate (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context,
+  IN     CONST VOID                  *Data,
+  IN     UINTN                       Size
+  )
+{
+  CONST UINT8                 *DataBytes;
+  CONST APPLE_CHUNKLIST_CHUNK *CurrentChunk;
+  UINT8                       ChunkHash[SHA256_DIGEST_SIZE];
+  UINTN                       HashSize;
+
+  ASSERT (Context != NULL);
+  ASSERT (Data != NULL || Size == 0);
 
-  ChunkData = AllocatePool (ChunkDataSize);
-  if (ChunkData == NULL) {
+  if (Context->VerifyFailed) {
     return FALSE;
   }
 
-  CurrentOffset = 0;
-  for (Index = 0; Index < Context->ChunkCount; Index++) {
-    CurrentChunk = &Context->Chunks[Index];
-
-    Result = OcAppleRamDiskRead (
-               ExtentTable,
-               CurrentOffset,
-               CurrentChunk->Length,
-               ChunkData
-               );
-    if (!Result) {
-      FreePool (ChunkData);
-      return FALSE;
+  DataBytes = Data;
+
+  while (Context->VerifiedChunkCount < Context->ChunkCount) {
+    CurrentChunk = &Context->Chunks[Context->VerifiedChunkCount];
+
+    HashSize = MIN (Size, CurrentChunk->Length - Context->ChunkHashedSize);
+    if (HashSize > 0) {
+      Sha256Update (&Context->ChunkHashContext, DataBytes, HashSize);
+      Context->ChunkHashedSize += (UINT32) HashSize;
+      DataBytes                += HashSize;
+      Size                     -= HashSize;
+    }
+
+    if (Context->ChunkHashedSize < CurrentChunk->Length) {
+      break;
     }
+
     //
     // Calculate checksum of data and ensure they match.
     //
     DEBUG ((DEBUG_VERBOSE, "OCCL: Validating chunk %lu of %lu\n",
-      (UINT64)Index + 1, (UINT64)Context->ChunkCount));
-    Sha256 (ChunkHash, ChunkData, CurrentChunk->Length);
+      (UINT64)Context->VerifiedChunkCount + 1, (UINT64)Context->ChunkCount));
+    Sha256Final (&Context->ChunkHashContext, ChunkHash);
     if (CompareMem (ChunkHash, CurrentChunk->Checksum, SHA256_DIGEST_SIZE) != 0) {
-      FreePool (ChunkData);
+      DEBUG ((DEBUG_WARN, "OCCL: Chunk %lu checksum mismatch\n",
+        (UINT64)Context->VerifiedChunkCount + 1));
+      Context->VerifyFailed = TRUE;
       return FALSE;
     }
 
-    CurrentOffset += CurrentChunk->Length;
+    ++Context->VerifiedChunkCount;
+    Context->ChunkHashedSize = 0;
+    Sha256Init (&Context->ChunkHashContext);
   }
 
-  FreePool (ChunkData);
   return TRUE;
 }
+
+BOOLEAN
+OcAppleChunklistVerifyDataFinal (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
+  )
+{
+  ASSERT (Context != NULL);
+
+  //
+  // Trailing empty chunks need no more data.
+  //
+  if (!OcAppleChunklistVerifyDataUpdate (Context, NULL, 0)) {
+    return FALSE;
+  }
+
+  return Context->VerifiedChunkCount == Context->ChunkCount;
+}
+
+BOOLEAN
+OcAppleChunklistVerifyData (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT         *Context,
+  IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+  )
+{
+  UINT32                      Index;
+  CONST APPLE_RAM_DISK_EXTENT *Extent;
+
+  ASSERT (Context != NULL);
+  ASSERT (ExtentTable != NULL);
+
+  OcAppleChunklistVerifyDataStart (Context);
+
+  //
+  // Hash the extents in place, they are contiguous in RAM disk order.
+  //
+  for (Index = 0; Index < ExtentTable->ExtentCount; ++Index) {
+    Extent = &ExtentTable->Extents[Index];
+    ASSERT (Extent->Start <= MAX_UINTN);
+    ASSERT (Extent->Length <= MAX_UINTN);
+
+    if (!OcAppleChunklistVerifyDataUpdate (
+           Context,
+           (CONST VOID *)(UINTN) Extent->Start,
+           (UINTN) Extent->Length
+           )) {
+      return FALSE;
+    }
+  }
+
+  return OcAppleChunklistVerifyDataFinal (Context);
+}
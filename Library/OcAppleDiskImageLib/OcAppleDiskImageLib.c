@@ -56,6 +56,8 @@ OcAppleDiskImageInitializeContext (
   ASSERT (ExtentTable != NULL);
   ASSERT (FileSize > 0);
 
+  ZeroMem (Context, sizeof (*Context));
+
   if (FileSize <= sizeof (Trailer)) {
     DEBUG ((
       DEBUG_INFO,
@@ -192,10 +194,22 @@ OcAppleDiskImageInitializeContext (
   return TRUE;
 }
 
+STATIC
+BOOLEAN
+InternalVerifyChunklistData (
+  IN OUT VOID        *Context,
+  IN     CONST VOID  *Data,
+  IN     UINTN       Size
+  )
+{
+  return OcAppleChunklistVerifyDataUpdate (Context, Data, Size);
+}
+
 BOOLEAN
 OcAppleDiskImageInitializeFromFile (
-  OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  EFI_FILE_PROTOCOL            *File
+  OUT    OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     EFI_FILE_PROTOCOL            *File,
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT   *ChunklistContext OPTIONAL
   )
 {
   EFI_STATUS                        Status;
@@ -219,7 +233,22 @@ OcAppleDiskImageInitializeFromFile (
     return FALSE;
   }
 
-  Result = OcAppleRamDiskLoadFile (ExtentTable, File, FileSize);
+  //
+  // Verify the chunklist as the file is loaded to avoid traversing it twice.
+  //
+  if (ChunklistContext != NULL) {
+    OcAppleChunklistVerifyDataStart (ChunklistContext);
+    Result = OcAppleRamDiskLoadFile (
+               ExtentTable,
+               File,
+               FileSize,
+               InternalVerifyChunklistData,
+               ChunklistContext
+               );
+  } else {
+    Result = OcAppleRamDiskLoadFile (ExtentTable, File, FileSize, NULL, NULL);
+  }
+
   if (!Result) {
     DEBUG ((DEBUG_INFO, "OCDI: Failed to load DMG file\n"));
 
@@ -227,6 +256,13 @@ OcAppleDiskImageInitializeFromFile (
     return FALSE;
   }
 
+  if (ChunklistContext != NULL && !OcAppleChunklistVerifyDataFinal (ChunklistContext)) {
+    DEBUG ((DEBUG_INFO, "OCDI: DMG file does not match chunklist\n"));
+
+    OcAppleRamDiskFree (ExtentTable);
+    return FALSE;
+  }
+
   Result = OcAppleDiskImageInitializeContext (Context, ExtentTable, FileSize);
   if (!Result) {
     DEBUG ((DEBUG_INFO, "OCDI: Failed to initialise DMG context\n"));
@@ -267,6 +303,24 @@ OcAppleDiskImageFreeContext (
   }
 
   FreePool (Context->Blocks);
+
+  for (Index = 0; Index < OC_APPLE_DISK_IMAGE_CACHE_SIZE; ++Index) {
+    if (Context->Cache[Index].Data != NULL) {
+      FreePool (Context->Cache[Index].Data);
+      Context->Cache[Index].Data = NULL;
+    }
+  }
+
+  if (Context->CompressedData != NULL) {
+    FreePool (Context->CompressedData);
+    Context->CompressedData     = NULL;
+    Context->CompressedDataSize = 0;
+  }
+
+  if (Context->ZlibState != NULL) {
+    FreeZLIBDecompressState (Context->ZlibState);
+    Context->ZlibState = NULL;
+  }
 }
 
 VOID
@@ -278,6 +332,166 @@ OcAppleDiskImageFreeFile (
   OcAppleDiskImageFreeContext (Context);
 }
 
+STATIC
+UINT8 *
+InternalCacheLookup (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT   *Context,
+  IN     CONST APPLE_DISK_IMAGE_CHUNK  *Chunk
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < OC_APPLE_DISK_IMAGE_CACHE_SIZE; ++Index) {
+    if (Context->Cache[Index].Chunk == Chunk) {
+      Context->Cache[Index].LastUse = ++Context->CacheTick;
+      return Context->Cache[Index].Data;
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+UINT8 *
+InternalCacheFill (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT   *Context,
+  IN     CONST APPLE_DISK_IMAGE_CHUNK  *Chunk
+  )
+{
+  BOOLEAN                          Result;
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY  *Entry;
+  UINT64                           ChunkTotalLength;
+  UINTN                            OutSize;
+  UINT32                           Index;
+
+  Result = OcOverflowMulU64 (
+             Chunk->SectorCount,
+             APPLE_DISK_IMAGE_SECTOR_SIZE,
+             &ChunkTotalLength
+             );
+  if (Result || ChunkTotalLength > MAX_UINTN) {
+    return NULL;
+  }
+
+  //
+  // Replace the least recently used entry, empty entries are never used.
+  //
+  Entry = &Context->Cache[0];
+  for (Index = 1; Index < OC_APPLE_DISK_IMAGE_CACHE_SIZE; ++Index) {
+    if (Context->Cache[Index].LastUse < Entry->LastUse) {
+      Entry = &Context->Cache[Index];
+    }
+  }
+
+  Entry->Chunk   = NULL;
+  Entry->LastUse = 0;
+
+  if (Entry->DataSize < ChunkTotalLength) {
+    if (Entry->Data != NULL) {
+      FreePool (Entry->Data);
+    }
+
+    Entry->DataSize = 0;
+    Entry->Data     = AllocatePool ((UINTN) ChunkTotalLength);
+    if (Entry->Data == NULL) {
+      return NULL;
+    }
+
+    Entry->DataSize = (UINTN) ChunkTotalLength;
+  }
+
+  if (Context->ZlibState == NULL) {
+    Context->ZlibState = CreateZLIBDecompressState ();
+    if (Context->ZlibState == NULL) {
+      return NULL;
+    }
+  }
+
+  if (Context->CompressedDataSize < Chunk->CompressedLength) {
+    if (Context->CompressedData != NULL) {
+      FreePool (Context->CompressedData);
+    }
+
+    Context->CompressedDataSize = 0;
+    Context->CompressedData     = AllocatePool ((UINTN) Chunk->CompressedLength);
+    if (Context->CompressedData == NULL) {
+      return NULL;
+    }
+
+    Context->CompressedDataSize = (UINTN) Chunk->CompressedLength;
+  }
+
+  Result = OcAppleRamDiskRead (
+             Context->ExtentTable,
+             (UINTN) Chunk->CompressedOffset,
+             (UINTN) Chunk->CompressedLength,
+             Context->CompressedData
+             );
+  if (!Result) {
+    return NULL;
+  }
+
+  OutSize = DecompressZLIBWithState (
+              Context->ZlibState,
+              Entry->Data,
+              (UINTN) ChunkTotalLength,
+              Context->CompressedData,
+              (UINTN) Chunk->CompressedLength
+              );
+  if (OutSize != (UINTN) ChunkTotalLength) {
+    return NULL;
+  }
+
+  Entry->Chunk   = Chunk;
+  Entry->LastUse = ++Context->CacheTick;
+
+  return Entry->Data;
+}
+
+STATIC
+UINT8 *
+InternalGetChunkData (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     APPLE_DISK_IMAGE_BLOCK_DATA  *BlockData,
+  IN     APPLE_DISK_IMAGE_CHUNK       *Chunk
+  )
+{
+  UINT8                   *ChunkData;
+  APPLE_DISK_IMAGE_CHUNK  *NextChunk;
+
+  ChunkData = InternalCacheLookup (Context, Chunk);
+  if (ChunkData != NULL) {
+    ++Context->CacheHits;
+    Context->LastChunk = Chunk;
+    return ChunkData;
+  }
+
+  ++Context->CacheMisses;
+
+  ChunkData = InternalCacheFill (Context, Chunk);
+  if (ChunkData == NULL) {
+    return NULL;
+  }
+
+  //
+  // Read the next chunk ahead when chunks are accessed sequentially.
+  // The just filled entry is the most recent one and cannot be replaced.
+  //
+  NextChunk = Chunk + 1;
+  if (Chunk > &BlockData->Chunks[0]
+    && Context->LastChunk == Chunk - 1
+    && NextChunk < &BlockData->Chunks[BlockData->ChunkCount]
+    && NextChunk->Type == APPLE_DISK_IMAGE_CHUNK_TYPE_ZLIB
+    && InternalCacheLookup (Context, NextChunk) == NULL
+    && InternalCacheFill (Context, NextChunk) != NULL) {
+    ++Context->CacheReadAheads;
+  }
+
+  Context->LastChunk = Chunk;
+
+  return ChunkData;
+}
+
 BOOLEAN
 OcAppleDiskImageRead (
   IN  OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
@@ -294,7 +508,6 @@ OcAppleDiskImageRead (
   UINT64                      ChunkLength;
   UINT64                      ChunkOffset;
   UINT8                       *ChunkData;
-  UINT8                       *ChunkDataCompressed;
 
   UINTN                       LbaCurrent;
   UINTN                       LbaOffset;
@@ -303,8 +516,6 @@ OcAppleDiskImageRead (
   UINTN                       BufferChunkSize;
   UINT8                       *BufferCurrent;
 
-  UINTN                       OutSize;
-
   ASSERT (Context != NULL);
   ASSERT (Buffer != NULL);
   ASSERT (Lba < Context->SectorCount);
@@ -369,36 +580,12 @@ OcAppleDiskImageRead (
 
       case APPLE_DISK_IMAGE_CHUNK_TYPE_ZLIB:
       {
-        ChunkData = AllocatePool ((UINTN)(ChunkTotalLength + Chunk->CompressedLength));
+        ChunkData = InternalGetChunkData (Context, BlockData, Chunk);
         if (ChunkData == NULL) {
           return FALSE;
         }
 
-        ChunkDataCompressed = (ChunkData + (UINTN)ChunkTotalLength);
-        Result = OcAppleRamDiskRead (
-                   Context->ExtentTable,
-                   (UINTN)Chunk->CompressedOffset,
-                   (UINTN)Chunk->CompressedLength,
-                   ChunkDataCompressed
-                   );
-        if (!Result) {
-          FreePool (ChunkData);
-          return FALSE;
-        }
-
-        OutSize = DecompressZLIB (
-                    ChunkData,
-                    (UINTN)ChunkTotalLength,
-                    ChunkDataCompressed,
-                    (UINTN)Chunk->CompressedLength
-                    );
-        if (OutSize != (UINTN)ChunkTotalLength) {
-          FreePool (ChunkData);
-          return FALSE;
-        }
-
         CopyMem (BufferCurrent, (ChunkData + ChunkOffset), BufferChunkSize);
-        FreePool (ChunkData);
         break;
       }
 
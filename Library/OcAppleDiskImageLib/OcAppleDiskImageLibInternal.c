@@ -30,37 +30,13 @@ InternalFindPlistDictChild (
   OUT XML_NODE  **Value
   )
 {
-  UINT32      ChildCount;
-  XML_NODE    *ChildValue;
-  XML_NODE    *ChildKey;
-  CONST CHAR8 *ChildKeyName;
-  UINT32      Index;
-
   ASSERT (Node != NULL);
   ASSERT (KeyName != NULL);
   ASSERT (Key != NULL);
   ASSERT (Value != NULL);
 
-  ChildCount = PlistDictChildren (Node);
-  for (Index = 0; Index < ChildCount; ++Index) {
-    ChildKey = PlistDictChild (Node, Index, &ChildValue);
-    if (ChildKey == NULL) {
-      break;
-    }
-
-    ChildKeyName = PlistKeyValue (ChildKey);
-    if (ChildKeyName == NULL) {
-      break;
-    }
-
-    if (AsciiStrCmp (ChildKeyName, KeyName) == 0) {
-      *Key   = ChildKey;
-      *Value = ChildValue;
-      return TRUE;
-    }
-  }
-
-  return FALSE;
+  *Key = PlistDictLookup (Node, KeyName, Value);
+  return *Key != NULL;
 }
 
 STATIC
@@ -417,6 +417,7 @@ ScanExtensions (
           }
 
           InsertTailList (&Context->BuiltInKexts, &BuiltinKext->Link);
+          InternalKextIndexInsert (&Context->BuiltInKextIndex, BuiltinKext->Identifier, BuiltinKext);
           DEBUG ((
             DEBUG_VERBOSE,
             "OCAK: Discovered bundle %a %s %s %u\n",
@@ -479,6 +480,10 @@ LookupPatchedKextForIdentifier (
   PATCHED_KEXT  *PatchedKext;
   LIST_ENTRY    *KextLink;
 
+  if (!Context->PatchedKextIndex.Failed) {
+    return InternalKextIndexLookup (&Context->PatchedKextIndex, Identifier);
+  }
+
   KextLink = GetFirstNode (&Context->PatchedKexts);
   while (!IsNull (&Context->PatchedKexts, KextLink)) {
     PatchedKext = GET_PATCHED_KEXT_FROM_LINK (KextLink);
@@ -503,6 +508,10 @@ LookupBuiltinKextForIdentifier (
   BUILTIN_KEXT  *BuiltinKext;
   LIST_ENTRY    *KextLink;
 
+  if (!Context->BuiltInKextIndex.Failed) {
+    return InternalKextIndexLookup (&Context->BuiltInKextIndex, Identifier);
+  }
+
   KextLink = GetFirstNode (&Context->BuiltInKexts);
   while (!IsNull (&Context->BuiltInKexts, KextLink)) {
     BuiltinKext = GET_BUILTIN_KEXT_FROM_LINK (KextLink);
@@ -635,6 +644,7 @@ InternalAddPatchedKext (
   InitializeListHead (&PatchedKext->Patches);
 
   InsertTailList (&Context->PatchedKexts, &PatchedKext->Link);
+  InternalKextIndexInsert (&Context->PatchedKextIndex, PatchedKext->Identifier, PatchedKext);
 
   *Kext = PatchedKext;
   return EFI_SUCCESS;
@@ -788,6 +798,9 @@ CachelessContextFree (
     }
     FreePool (BuiltinKext);
   }
+
+  InternalKextIndexFree (&Context->PatchedKextIndex);
+  InternalKextIndexFree (&Context->BuiltInKextIndex);
   
   ZeroMem (Context, sizeof (*Context));
 }
@@ -0,0 +1,147 @@
+/** @file
+  Patched kernel difference runs.
+
+  Copyright (C) 2026, agent. All rights reserved.
+
+  All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Base.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/OcAppleKernelLib.h>
+
+#pragma pack(push, 1)
+
+///
+/// Patched kernel bytes differing from the original kernel, followed by Size bytes of data.
+///
+typedef PACKED struct {
+  UINT32  Offset;
+  UINT32  Size;
+} KERNEL_PATCH_CACHE_RUN;
+
+#pragma pack(pop)
+
+//
+// Unchanged bytes between two changed ones, which are still merged into a single run.
+// This is less than the run header, so merging never makes the run data larger.
+//
+#define KERNEL_PATCH_CACHE_RUN_GAP  sizeof (KERNEL_PATCH_CACHE_RUN)
+
+UINT32
+KernelPatchCacheDiff (
+  IN  CONST UINT8  *Original,
+  IN  UINT32       OriginalSize,
+  IN  CONST UINT8  *Patched,
+  IN  UINT32       PatchedSize,
+  OUT UINT8        *Data      OPTIONAL,
+  OUT UINT32       *RunCount
+  )
+{
+  UINT32                  Offset;
+  UINT32                  CommonSize;
+  UINT32                  Start;
+  UINT32                  End;
+  UINT32                  DataSize;
+  KERNEL_PATCH_CACHE_RUN  Run;
+
+  CommonSize = MIN (OriginalSize, PatchedSize);
+  DataSize   = 0;
+  *RunCount  = 0;
+  Offset     = 0;
+
+  while (Offset < PatchedSize) {
+    //
+    // Skip identical bytes, most of the kernel is left unchanged.
+    //
+    while (Offset + sizeof (UINT64) <= CommonSize
+      && ReadUnaligned64 ((CONST UINT64 *) (Original + Offset)) == ReadUnaligned64 ((CONST UINT64 *) (Patched + Offset))) {
+      Offset += sizeof (UINT64);
+    }
+
+    while (Offset < CommonSize && Original[Offset] == Patched[Offset]) {
+      ++Offset;
+    }
+
+    if (Offset >= PatchedSize) {
+      break;
+    }
+
+    Start = Offset;
+    End   = ++Offset;
+    while (Offset < PatchedSize && Offset - End < KERNEL_PATCH_CACHE_RUN_GAP) {
+      if (Offset >= CommonSize || Original[Offset] != Patched[Offset]) {
+        End = Offset + 1;
+      }
+      ++Offset;
+    }
+
+    if (Data != NULL) {
+      Run.Offset = Start;
+      Run.Size   = End - Start;
+      CopyMem (Data + DataSize, &Run, sizeof (Run));
+      CopyMem (Data + DataSize + sizeof (Run), Patched + Start, End - Start);
+    }
+
+    DataSize += sizeof (Run) + End - Start;
+    ++(*RunCount);
+    Offset = End;
+  }
+
+  return DataSize;
+}
+
+BOOLEAN
+KernelPatchCacheApplyRuns (
+  IN OUT UINT8        *Kernel,
+  IN     UINT32       PatchedSize,
+  IN     CONST UINT8  *Data,
+  IN     UINT32       DataSize,
+  IN     UINT32       RunCount
+  )
+{
+  UINT32                  Pass;
+  UINT32                  Index;
+  UINT32                  Offset;
+  KERNEL_PATCH_CACHE_RUN  Run;
+
+  for (Pass = 0; Pass < 2; ++Pass) {
+    Offset = 0;
+    for (Index = 0; Index < RunCount; ++Index) {
+      if (DataSize - Offset < sizeof (Run)) {
+        return FALSE;
+      }
+
+      CopyMem (&Run, Data + Offset, sizeof (Run));
+      Offset += sizeof (Run);
+
+      if (Run.Size > DataSize - Offset
+        || Run.Offset > PatchedSize
+        || Run.Size > PatchedSize - Run.Offset) {
+        return FALSE;
+      }
+
+      if (Pass == 1) {
+        CopyMem (Kernel + Run.Offset, Data + Offset, Run.Size);
+      }
+
+      Offset += Run.Size;
+    }
+
+    if (Offset != DataSize) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
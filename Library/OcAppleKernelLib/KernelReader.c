@@ -35,6 +35,11 @@ STATIC SHA384_CONTEXT mKernelDigestContext;
 STATIC UINT32         mKernelDigestPosition;
 STATIC BOOLEAN        mNeedKernelDigest;
 
+typedef struct {
+  EFI_FILE_PROTOCOL  *File;
+  UINT32             Offset;
+} KERNEL_COMPRESSED_READ_CONTEXT;
+
 typedef enum {
   KernelArchUnknown,
   KernelArch32,
@@ -187,6 +192,21 @@ ParseFatArchitecture (
   return Status;
 }
 
+STATIC
+BOOLEAN
+ReadCompressedKernelData (
+  IN  VOID    *Context,
+  IN  UINT32  Offset,
+  IN  UINT32  Size,
+  OUT UINT8   *Buffer
+  )
+{
+  KERNEL_COMPRESSED_READ_CONTEXT  *ReadContext;
+
+  ReadContext = Context;
+  return !EFI_ERROR (KernelGetFileData (ReadContext->File, ReadContext->Offset + Offset, Size, Buffer));
+}
+
 STATIC
 UINT32
 ParseCompressedHeader (
@@ -197,15 +217,17 @@ ParseCompressedHeader (
   IN     UINT32             ReservedSize
   )
 {
-  EFI_STATUS        Status;
-
-  UINT32            KernelSize;
-  MACH_COMP_HEADER  *CompHeader;
-  UINT8             *CompressedBuffer;
-  UINT32            CompressionType;
-  UINT32            CompressedSize;
-  UINT32            DecompressedSize;
-  UINT32            DecompressedHash;
+  EFI_STATUS                      Status;
+
+  UINT32                          KernelSize;
+  MACH_COMP_HEADER                *CompHeader;
+  KERNEL_COMPRESSED_READ_CONTEXT  ReadContext;
+  UINT32                          CompressionType;
+  UINT32                          CompressedSize;
+  UINT32                          CompressedEnd;
+  UINT32                          DecompressedSize;
+  UINT32                          DecompressedHash;
+  UINT32                          KernelHash;
 
   CompHeader       = (MACH_COMP_HEADER *)*Buffer;
   CompressionType  = CompHeader->Compression;
@@ -218,7 +240,8 @@ ParseCompressedHeader (
   if (CompressedSize > OC_COMPRESSION_MAX_LENGTH
     || CompressedSize == 0
     || DecompressedSize > OC_COMPRESSION_MAX_LENGTH
-    || DecompressedSize < KERNEL_HEADER_SIZE) {
+    || DecompressedSize < KERNEL_HEADER_SIZE
+    || OcOverflowTriAddU32 (Offset, sizeof (MACH_COMP_HEADER), CompressedSize, &CompressedEnd)) {
     DEBUG ((DEBUG_INFO, "OCAK: Comp kernel invalid comp %u or decomp %u at %08X\n", CompressedSize, DecompressedSize, Offset));
     return KernelSize;
   }
@@ -229,35 +252,45 @@ ParseCompressedHeader (
     return KernelSize;
   }
 
-  CompressedBuffer = AllocatePool (CompressedSize);
-  if (CompressedBuffer == NULL) {
-    DEBUG ((DEBUG_INFO, "OCAK: Comp kernel (%u bytes) cannot be allocated at %08X\n", CompressedSize, Offset));
-    return KernelSize;
-  }
-
-  Status = KernelGetFileData (File, Offset + sizeof (MACH_COMP_HEADER), CompressedSize, CompressedBuffer);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_INFO, "OCAK: Comp kernel (%u bytes) cannot be read at %08X\n", CompressedSize, Offset));
-    FreePool (CompressedBuffer);
-    return KernelSize;
-  }
+  //
+  // Decompress straight into the kernel buffer, reading compressed data in blocks,
+  // so that the compressed image never needs to be held in memory as a whole.
+  //
+  ReadContext.File   = File;
+  ReadContext.Offset = Offset + sizeof (MACH_COMP_HEADER);
+  KernelHash         = 0;
 
   if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
-    KernelSize = (UINT32)DecompressLZVN (*Buffer, DecompressedSize, CompressedBuffer, CompressedSize);
+    KernelSize = DecompressLZVNStream (
+      *Buffer,
+      DecompressedSize,
+      CompressedSize,
+      OC_DECOMPRESS_STREAM_BLOCK_SIZE,
+      ReadCompressedKernelData,
+      &ReadContext,
+      &KernelHash
+      );
   } else if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZSS) {
-    KernelSize = (UINT32)DecompressLZSS (*Buffer, DecompressedSize, CompressedBuffer, CompressedSize);
+    KernelSize = DecompressLZSSStream (
+      *Buffer,
+      DecompressedSize,
+      CompressedSize,
+      OC_DECOMPRESS_STREAM_BLOCK_SIZE,
+      ReadCompressedKernelData,
+      &ReadContext,
+      &KernelHash
+      );
   }
 
   if (KernelSize != DecompressedSize) {
-    KernelSize = 0;
+    DEBUG ((DEBUG_INFO, "OCAK: Comp kernel (%u bytes) cannot be decompressed at %08X - %u\n", CompressedSize, Offset, KernelSize));
+    return 0;
   }
 
-  //
-  // TODO: implement adler32 hash verification.
-  //
-  (VOID) DecompressedHash;
-
-  FreePool (CompressedBuffer);
+  if (KernelHash != DecompressedHash) {
+    DEBUG ((DEBUG_INFO, "OCAK: Decomp kernel adler32 mismatch %08X vs %08X at %08X\n", KernelHash, DecompressedHash, Offset));
+    return 0;
+  }
 
   return KernelSize;
 }
@@ -0,0 +1,237 @@
+/** @file
+  Kext bundle identifier index.
+
+  Copyright (C) 2026, agent. All rights reserved.
+
+  All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Base.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcAppleKernelLib.h>
+#include <Library/OcXmlLib.h>
+
+#include "PrelinkedInternal.h"
+
+//
+// Initial hash table size, must be a power of two.
+//
+#define KEXT_ID_INDEX_MIN_SIZE  64U
+
+STATIC
+UINT32
+InternalHashKextIdentifier (
+  IN CONST CHAR8  *Identifier
+  )
+{
+  UINT32  Hash;
+
+  //
+  // FNV-1a, bundle identifiers share long prefixes like com.apple.
+  //
+  Hash = 0x811C9DC5U;
+  while (*Identifier != '\0') {
+    Hash ^= (UINT8) *Identifier;
+    Hash *= 0x01000193U;
+    ++Identifier;
+  }
+
+  return Hash;
+}
+
+STATIC
+VOID
+InternalKextIndexPut (
+  IN OUT KEXT_ID_INDEX_ENTRY  *Entries,
+  IN     UINT32               Mask,
+  IN     CONST CHAR8          *Identifier,
+  IN     VOID                 *Value
+  )
+{
+  UINT32  Slot;
+
+  Slot = InternalHashKextIdentifier (Identifier) & Mask;
+  while (Entries[Slot].Identifier != NULL) {
+    Slot = (Slot + 1) & Mask;
+  }
+
+  Entries[Slot].Identifier = Identifier;
+  Entries[Slot].Value      = Value;
+}
+
+STATIC
+BOOLEAN
+InternalKextIndexGrow (
+  IN OUT KEXT_ID_INDEX  *Index
+  )
+{
+  KEXT_ID_INDEX_ENTRY  *Entries;
+  UINT32               Size;
+  UINT32               Slot;
+
+  if (Index->Entries == NULL) {
+    Size = KEXT_ID_INDEX_MIN_SIZE;
+  } else if (Index->Mask < MAX_UINT32 / (2 * sizeof (KEXT_ID_INDEX_ENTRY))) {
+    Size = (Index->Mask + 1) * 2;
+  } else {
+    return FALSE;
+  }
+
+  Entries = AllocateZeroPool (Size * sizeof (KEXT_ID_INDEX_ENTRY));
+  if (Entries == NULL) {
+    return FALSE;
+  }
+
+  if (Index->Entries != NULL) {
+    for (Slot = 0; Slot <= Index->Mask; ++Slot) {
+      if (Index->Entries[Slot].Identifier != NULL) {
+        InternalKextIndexPut (
+          Entries,
+          Size - 1,
+          Index->Entries[Slot].Identifier,
+          Index->Entries[Slot].Value
+          );
+      }
+    }
+
+    FreePool (Index->Entries);
+  }
+
+  Index->Entries = Entries;
+  Index->Mask    = Size - 1;
+  return TRUE;
+}
+
+VOID
+InternalKextIndexInsert (
+  IN OUT KEXT_ID_INDEX  *Index,
+  IN     CONST CHAR8    *Identifier,
+  IN     VOID           *Value
+  )
+{
+  ASSERT (Index != NULL);
+  ASSERT (Identifier != NULL);
+
+  if (Index->Failed) {
+    return;
+  }
+
+  if (InternalKextIndexLookup (Index, Identifier) != NULL) {
+    return;
+  }
+
+  //
+  // Keep load factor at most 1/2.
+  //
+  if (Index->Entries == NULL || Index->Count >= (Index->Mask + 1) / 2) {
+    if (!InternalKextIndexGrow (Index)) {
+      DEBUG ((DEBUG_INFO, "OCAK: Kext index failed, falling back to linear lookup\n"));
+      InternalKextIndexFree (Index);
+      Index->Failed = TRUE;
+      return;
+    }
+  }
+
+  InternalKextIndexPut (Index->Entries, Index->Mask, Identifier, Value);
+  ++Index->Count;
+}
+
+VOID *
+InternalKextIndexLookup (
+  IN CONST KEXT_ID_INDEX  *Index,
+  IN CONST CHAR8          *Identifier
+  )
+{
+  UINT32  Slot;
+
+  ASSERT (Index != NULL);
+  ASSERT (!Index->Failed);
+  ASSERT (Identifier != NULL);
+
+  if (Index->Entries == NULL) {
+    return NULL;
+  }
+
+  Slot = InternalHashKextIdentifier (Identifier) & Index->Mask;
+  while (Index->Entries[Slot].Identifier != NULL) {
+    if (AsciiStrCmp (Index->Entries[Slot].Identifier, Identifier) == 0) {
+      return Index->Entries[Slot].Value;
+    }
+
+    Slot = (Slot + 1) & Index->Mask;
+  }
+
+  return NULL;
+}
+
+VOID
+InternalKextIndexPlistArray (
+  IN OUT KEXT_ID_INDEX  *Index,
+  IN     XML_NODE       *KextList
+  )
+{
+  XML_NODE     *KextPlist;
+  XML_NODE     *KextPlistValue;
+  CONST CHAR8  *KextPlistKey;
+  CONST CHAR8  *KextIdentifier;
+  UINT32       KextCount;
+  UINT32       KextIndex;
+  UINT32       FieldCount;
+  UINT32       FieldIndex;
+
+  ASSERT (Index != NULL);
+  ASSERT (KextList != NULL);
+
+  KextCount = XmlNodeChildren (KextList);
+  for (KextIndex = 0; KextIndex < KextCount && !Index->Failed; ++KextIndex) {
+    KextPlist = PlistNodeCast (XmlNodeChild (KextList, KextIndex), PLIST_NODE_TYPE_DICT);
+    if (KextPlist == NULL) {
+      continue;
+    }
+
+    //
+    // Match InternalCreatePrelinkedKext, which only considers the first identifier key.
+    //
+    FieldCount = PlistDictChildren (KextPlist);
+    for (FieldIndex = 0; FieldIndex < FieldCount; ++FieldIndex) {
+      KextPlistKey = PlistKeyValue (PlistDictChild (KextPlist, FieldIndex, &KextPlistValue));
+      if (KextPlistKey == NULL || AsciiStrCmp (KextPlistKey, INFO_BUNDLE_IDENTIFIER_KEY) != 0) {
+        continue;
+      }
+
+      KextIdentifier = XmlNodeContent (KextPlistValue);
+      if (PlistNodeCast (KextPlistValue, PLIST_NODE_TYPE_STRING) != NULL && KextIdentifier != NULL) {
+        InternalKextIndexInsert (Index, KextIdentifier, KextPlist);
+      }
+      break;
+    }
+  }
+}
+
+VOID
+InternalKextIndexFree (
+  IN OUT KEXT_ID_INDEX  *Index
+  )
+{
+  ASSERT (Index != NULL);
+
+  if (Index->Entries != NULL) {
+    FreePool (Index->Entries);
+    Index->Entries = NULL;
+  }
+
+  Index->Count = 0;
+  Index->Mask  = 0;
+}
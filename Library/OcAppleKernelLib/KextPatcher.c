@@ -19,6 +19,7 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/OcAppleKernelLib.h>
 #include <Library/OcMachoLib.h>
 #include <Library/OcMiscLib.h>
@@ -112,6 +113,14 @@ PatcherInitContextFromPrelinked (
   }
 
   CopyMem (Context, &Kext->Context, sizeof (*Context));
+
+  //
+  // Lookup indices stay owned by the kext, the copy is never freed.
+  //
+  Context->MachContext.RelocationIndex   = NULL;
+  Context->MachContext.NoRelocationIndex = TRUE;
+  Context->MachContext.SymbolIndex       = NULL;
+  Context->MachContext.UseSymbolIndex    = FALSE;
   return EFI_SUCCESS;
 }
 
@@ -220,65 +229,86 @@ PatcherGetSymbolAddress (
   )
 {
   MACH_NLIST_ANY  *Symbol;
-  CONST CHAR8     *SymbolName;
   UINT64          SymbolAddress;
   UINT32          Offset;
-  UINT32          Index;
 
-  Index  = 0;
   Offset = 0;
-  while (TRUE) {
-    //
-    // Try the usual way first via SYMTAB.
-    //
-    Symbol = MachoGetSymbolByIndex (&Context->MachContext, Index);
-    if (Symbol == NULL) {
-      //
-      // If we have KxldState, use it.
-      //
-      if (Index == 0 && Context->KxldState != NULL) {
-        SymbolAddress = InternalKxldSolveSymbol (
-          Context->Is32Bit,
-          Context->KxldState,
-          Context->KxldStateSize,
-          Name
-          );
-        //
-        // If we have a symbol, get its ondisk offset.
-        //
-        if (SymbolAddress != 0 && MachoSymbolGetDirectFileOffset (&Context->MachContext, SymbolAddress, &Offset, NULL)) {
-          //
-          // Proceed to success.
-          //
-          break;
-        }
-      }
 
+  //
+  // Try the usual way first via SYMTAB.
+  //
+  if (MachoGetSymbolByIndex (&Context->MachContext, 0) != NULL) {
+    Symbol = MachoGetSymbolByName (&Context->MachContext, Name);
+    if (Symbol == NULL) {
       return EFI_NOT_FOUND;
     }
 
-    SymbolName = MachoGetSymbolName (&Context->MachContext, Symbol);
-    if (SymbolName != NULL && AsciiStrCmp (Name, SymbolName) == 0) {
-      //
-      // Once we have a symbol, get its ondisk offset.
-      //
-      if (MachoSymbolGetFileOffset (&Context->MachContext, Symbol, &Offset, NULL)) {
-        //
-        // Proceed to success.
-        //
-        break;
-      }
-
+    //
+    // Once we have a symbol, get its ondisk offset.
+    //
+    if (!MachoSymbolGetFileOffset (&Context->MachContext, Symbol, &Offset, NULL)) {
       return EFI_INVALID_PARAMETER;
     }
+  } else {
+    //
+    // If we have KxldState, use it.
+    //
+    if (Context->KxldState == NULL) {
+      return EFI_NOT_FOUND;
+    }
 
-    Index++;
+    SymbolAddress = InternalKxldSolveSymbol (
+      Context->Is32Bit,
+      Context->KxldState,
+      Context->KxldStateSize,
+      Name
+      );
+    //
+    // If we have a symbol, get its ondisk offset.
+    //
+    if (SymbolAddress == 0 || !MachoSymbolGetDirectFileOffset (&Context->MachContext, SymbolAddress, &Offset, NULL)) {
+      return EFI_NOT_FOUND;
+    }
   }
 
   *Address = (UINT8 *) MachoGetMachHeader (&Context->MachContext) + Offset;
   return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+InternalReportGenericPatch (
+  IN PATCHER_CONTEXT        *Context,
+  IN PATCHER_GENERIC_PATCH  *Patch,
+  IN UINT32                 ReplaceCount
+  )
+{
+  DEBUG ((
+    DEBUG_INFO,
+    "OCAK: %a-bit %a replace count - %u\n",
+    Context->Is32Bit ? "32" : "64",
+    Patch->Comment != NULL ? Patch->Comment : "Patch",
+    ReplaceCount
+    ));
+
+  if (ReplaceCount > 0 && Patch->Count > 0 && ReplaceCount != Patch->Count) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCAK: %a-bit %a performed only %u replacements out of %u\n",
+      Context->Is32Bit ? "32" : "64",
+      Patch->Comment != NULL ? Patch->Comment : "Patch",
+      ReplaceCount,
+      Patch->Count
+      ));
+  }
+
+  if (ReplaceCount > 0) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
 EFI_STATUS
 PatcherApplyGenericPatch (
   IN OUT PATCHER_CONTEXT        *Context,
@@ -338,30 +368,125 @@ PatcherApplyGenericPatch (
     Patch->Skip
     );
 
-  DEBUG ((
-    DEBUG_INFO,
-    "OCAK: %a-bit %a replace count - %u\n",
-    Context->Is32Bit ? "32" : "64",
-    Patch->Comment != NULL ? Patch->Comment : "Patch",
-    ReplaceCount
-    ));
+  return InternalReportGenericPatch (Context, Patch, ReplaceCount);
+}
 
-  if (ReplaceCount > 0 && Patch->Count > 0 && ReplaceCount != Patch->Count) {
-    DEBUG ((
-      DEBUG_INFO,
-      "OCAK: %a-bit %a performed only %u replacements out of %u\n",
-      Context->Is32Bit ? "32" : "64",
-      Patch->Comment != NULL ? Patch->Comment : "Patch",
-      ReplaceCount,
-      Patch->Count
-      ));
+/**
+  Apply pending patches looking up data within the whole binary in a single pass.
+**/
+STATIC
+VOID
+InternalFlushGenericPatches (
+  IN OUT PATCHER_CONTEXT        *Context,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN OUT OC_DATA_PATCH          *DataPatches,
+  IN     UINT32                 *DataPatchMap,
+  IN     UINT32                 DataPatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  UINT32  Index;
+
+  if (DataPatchCount == 0) {
+    return;
   }
 
-  if (ReplaceCount > 0) {
-    return EFI_SUCCESS;
+  ApplyPatches (
+    DataPatches,
+    DataPatchCount,
+    (UINT8 *) MachoGetMachHeader (&Context->MachContext),
+    MachoGetFileSize (&Context->MachContext)
+    );
+
+  for (Index = 0; Index < DataPatchCount; ++Index) {
+    Results[DataPatchMap[Index]] = InternalReportGenericPatch (
+      Context,
+      &Patches[DataPatchMap[Index]],
+      DataPatches[Index].ReplaceCount
+      );
   }
+}
 
-  return EFI_NOT_FOUND;
+EFI_STATUS
+PatcherApplyGenericPatches (
+  IN OUT PATCHER_CONTEXT        *Context,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  EFI_STATUS     Status;
+  OC_DATA_PATCH  *DataPatches;
+  UINT32         *DataPatchMap;
+  UINT32         DataPatchCount;
+  UINT32         Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Patches != NULL || PatchCount == 0);
+  ASSERT (Results != NULL || PatchCount == 0);
+
+  DataPatches  = NULL;
+  DataPatchMap = NULL;
+
+  if (PatchCount > 1) {
+    DataPatches  = AllocatePool (PatchCount * sizeof (*DataPatches));
+    DataPatchMap = AllocatePool (PatchCount * sizeof (*DataPatchMap));
+    if (DataPatches == NULL || DataPatchMap == NULL) {
+      DEBUG ((DEBUG_INFO, "OCAK: Falling back to separate patching for %u patches\n", PatchCount));
+      if (DataPatches != NULL) {
+        FreePool (DataPatches);
+        DataPatches = NULL;
+      }
+      if (DataPatchMap != NULL) {
+        FreePool (DataPatchMap);
+        DataPatchMap = NULL;
+      }
+    }
+  }
+
+  //
+  // Only consecutive patches looking up data within the whole binary can share
+  // a pass, pending ones are flushed before others to preserve patch order.
+  //
+  DataPatchCount = 0;
+
+  for (Index = 0; Index < PatchCount; ++Index) {
+    if (DataPatches != NULL && Patches[Index].Base == NULL && Patches[Index].Find != NULL) {
+      DataPatches[DataPatchCount].Pattern     = Patches[Index].Find;
+      DataPatches[DataPatchCount].PatternMask = Patches[Index].Mask;
+      DataPatches[DataPatchCount].Replace     = Patches[Index].Replace;
+      DataPatches[DataPatchCount].ReplaceMask = Patches[Index].ReplaceMask;
+      DataPatches[DataPatchCount].PatternSize = Patches[Index].Size;
+      DataPatches[DataPatchCount].Count       = Patches[Index].Count;
+      DataPatches[DataPatchCount].Skip        = Patches[Index].Skip;
+      DataPatches[DataPatchCount].Limit       = Patches[Index].Limit;
+      DataPatchMap[DataPatchCount]            = Index;
+      ++DataPatchCount;
+      continue;
+    }
+
+    InternalFlushGenericPatches (Context, Patches, DataPatches, DataPatchMap, DataPatchCount, Results);
+    DataPatchCount = 0;
+
+    Results[Index] = PatcherApplyGenericPatch (Context, &Patches[Index]);
+  }
+
+  InternalFlushGenericPatches (Context, Patches, DataPatches, DataPatchMap, DataPatchCount, Results);
+
+  Status = EFI_SUCCESS;
+
+  for (Index = 0; Index < PatchCount; ++Index) {
+    if (EFI_ERROR (Results[Index])) {
+      Status = Results[Index];
+    }
+  }
+
+  if (DataPatches != NULL) {
+    FreePool (DataPatches);
+    FreePool (DataPatchMap);
+  }
+
+  return Status;
 }
 
 EFI_STATUS
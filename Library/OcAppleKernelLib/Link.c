@@ -20,6 +20,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/OcAppleKernelLib.h>
 #include <Library/OcGuardLib.h>
 #include <Library/OcMachoLib.h>
@@ -35,6 +36,191 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 // Symbols
 //
 
+STATIC
+UINT32
+InternalHashSymbolName (
+  IN CONST CHAR8  *Name,
+  IN UINT32       Length
+  )
+{
+  UINT32  Hash;
+  UINT32  Index;
+
+  //
+  // FNV-1a.
+  //
+  Hash = 0x811C9DC5U;
+  for (Index = 0; Index < Length; ++Index) {
+    Hash = (Hash ^ (UINT8) Name[Index]) * 0x01000193U;
+  }
+
+  return Hash;
+}
+
+STATIC
+UINT32
+InternalHashSymbolValue (
+  IN UINT64  Value
+  )
+{
+  UINT32  Hash;
+
+  //
+  // Symbol values are aligned addresses, mix the bits to avoid clustering.
+  //
+  Hash  = (UINT32) Value ^ (UINT32) RShiftU64 (Value, 32);
+  Hash ^= Hash >> 16;
+  Hash *= 0x85EBCA6BU;
+  Hash ^= Hash >> 13;
+  Hash *= 0xC2B2AE35U;
+  Hash ^= Hash >> 16;
+
+  return Hash;
+}
+
+VOID
+InternalFreeLinkedSymbolIndex (
+  IN OUT PRELINKED_KEXT     *Kext
+  )
+{
+  if (Kext->SymbolNameIndex != NULL) {
+    FreePool (Kext->SymbolNameIndex);
+    Kext->SymbolNameIndex = NULL;
+  }
+
+  if (Kext->SymbolValueIndex != NULL) {
+    FreePool (Kext->SymbolValueIndex);
+    Kext->SymbolValueIndex = NULL;
+  }
+
+  Kext->SymbolIndexMask = 0;
+}
+
+VOID
+InternalBuildLinkedSymbolIndex (
+  IN OUT PRELINKED_KEXT     *Kext,
+  IN     PRELINKED_CONTEXT  *Context
+  )
+{
+  CONST PRELINKED_KEXT_SYMBOL *Symbol;
+  UINT32                      IndexSize;
+  UINT32                      Index;
+  UINT32                      Slot;
+
+  ASSERT (Kext->LinkedSymbolTable != NULL);
+
+  if (Context->DisableSymbolIndex
+    || Kext->SymbolNameIndex != NULL
+    || Kext->NumberOfSymbols < PRELINKED_KEXT_SYMBOL_INDEX_MIN
+    || Kext->NumberOfSymbols > MAX_UINT32 / 8) {
+    return;
+  }
+
+  //
+  // Keep load factor at most 50% for short probe sequences.
+  //
+  IndexSize = GetPowerOfTwo32 (Kext->NumberOfSymbols) * 4;
+
+  Kext->SymbolNameIndex  = AllocateZeroPool (IndexSize * sizeof (*Kext->SymbolNameIndex));
+  Kext->SymbolValueIndex = AllocateZeroPool (IndexSize * sizeof (*Kext->SymbolValueIndex));
+  if (Kext->SymbolNameIndex == NULL || Kext->SymbolValueIndex == NULL) {
+    InternalFreeLinkedSymbolIndex (Kext);
+    return;
+  }
+
+  Kext->SymbolIndexMask = IndexSize - 1;
+
+  //
+  // Symbols are inserted in table order with linear probing, so symbols
+  // sharing a key are met in table order during lookup, just like when
+  // walking the table linearly.
+  //
+  for (Index = 0; Index < Kext->NumberOfSymbols; ++Index) {
+    Symbol = &Kext->LinkedSymbolTable[Index];
+
+    Slot = InternalHashSymbolName (Symbol->Name, Symbol->Length) & Kext->SymbolIndexMask;
+    while (Kext->SymbolNameIndex[Slot] != 0) {
+      Slot = (Slot + 1) & Kext->SymbolIndexMask;
+    }
+    Kext->SymbolNameIndex[Slot] = Index + 1;
+
+    Slot = InternalHashSymbolValue (Symbol->Value) & Kext->SymbolIndexMask;
+    while (Kext->SymbolValueIndex[Slot] != 0) {
+      Slot = (Slot + 1) & Kext->SymbolIndexMask;
+    }
+    Kext->SymbolValueIndex[Slot] = Index + 1;
+  }
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "OCAK: Built symbol index for %a with %u symbols in %u slots\n",
+    Kext->Identifier,
+    Kext->NumberOfSymbols,
+    IndexSize
+    ));
+}
+
+/**
+  Lookup symbol by name in the hash index within [First, Last) table range.
+**/
+STATIC
+CONST PRELINKED_KEXT_SYMBOL *
+InternalLookupIndexedSymbolName (
+  IN PRELINKED_KEXT                   *Kext,
+  IN CONST CHAR8                      *LookupValue,
+  IN UINT32                           LookupValueLength,
+  IN UINT32                           First,
+  IN UINT32                           Last
+  )
+{
+  CONST PRELINKED_KEXT_SYMBOL *Symbol;
+  UINT32                      Slot;
+  UINT32                      Index;
+
+  Slot = InternalHashSymbolName (LookupValue, LookupValueLength) & Kext->SymbolIndexMask;
+  while (Kext->SymbolNameIndex[Slot] != 0) {
+    Index  = Kext->SymbolNameIndex[Slot] - 1;
+    Symbol = &Kext->LinkedSymbolTable[Index];
+    if (Index >= First && Index < Last
+      && Symbol->Length == LookupValueLength
+      && CompareMem (Symbol->Name, LookupValue, LookupValueLength) == 0) {
+      return Symbol;
+    }
+    Slot = (Slot + 1) & Kext->SymbolIndexMask;
+  }
+
+  return NULL;
+}
+
+/**
+  Lookup symbol by value in the hash index within [First, Last) table range.
+**/
+STATIC
+CONST PRELINKED_KEXT_SYMBOL *
+InternalLookupIndexedSymbolValue (
+  IN PRELINKED_KEXT                   *Kext,
+  IN UINT64                           LookupValue,
+  IN UINT32                           First,
+  IN UINT32                           Last
+  )
+{
+  CONST PRELINKED_KEXT_SYMBOL *Symbol;
+  UINT32                      Slot;
+  UINT32                      Index;
+
+  Slot = InternalHashSymbolValue (LookupValue) & Kext->SymbolIndexMask;
+  while (Kext->SymbolValueIndex[Slot] != 0) {
+    Index  = Kext->SymbolValueIndex[Slot] - 1;
+    Symbol = &Kext->LinkedSymbolTable[Index];
+    if (Index >= First && Index < Last && Symbol->Value == LookupValue) {
+      return Symbol;
+    }
+    Slot = (Slot + 1) & Kext->SymbolIndexMask;
+  }
+
+  return NULL;
+}
+
 STATIC
 CONST PRELINKED_KEXT_SYMBOL *
 InternalOcGetSymbolWorkerName (
@@ -55,7 +241,18 @@ InternalOcGetSymbolWorkerName (
   //
   Kext->Processed = TRUE;
 
-  if (Kext->LinkedSymbolTable != NULL) {
+  if (Kext->SymbolNameIndex != NULL) {
+    Symbols = InternalLookupIndexedSymbolName (
+      Kext,
+      LookupValue,
+      LookupValueLength,
+      SymbolLevel == OcGetSymbolOnlyCxx ? Kext->NumberOfSymbols - Kext->NumberOfCxxSymbols : 0,
+      Kext->NumberOfSymbols
+      );
+    if (Symbols != NULL) {
+      return Symbols;
+    }
+  } else if (Kext->LinkedSymbolTable != NULL) {
     NumSymbols = Kext->NumberOfSymbols;
     Symbols    = Kext->LinkedSymbolTable;
 
@@ -133,7 +330,17 @@ InternalOcGetSymbolWorkerValue (
   //
   Kext->Processed = TRUE;
 
-  if (Kext->LinkedSymbolTable != NULL) {
+  if (Kext->SymbolValueIndex != NULL) {
+    Symbols = InternalLookupIndexedSymbolValue (
+      Kext,
+      LookupValue,
+      SymbolLevel == OcGetSymbolOnlyCxx ? Kext->NumberOfSymbols - Kext->NumberOfCxxSymbols : 0,
+      Kext->NumberOfSymbols
+      );
+    if (Symbols != NULL) {
+      return Symbols;
+    }
+  } else if (Kext->LinkedSymbolTable != NULL) {
     NumSymbols = Kext->NumberOfSymbols;
     Symbols    = Kext->LinkedSymbolTable;
 
@@ -199,6 +406,7 @@ InternalOcGetSymbolName (
 
   Symbol = NULL;
   LookupValueLength = (UINT32)AsciiStrLen (LookupValue);
+  ++Context->SymbolNameLookups;
 
   //
   // Such symbols are illegit, but InternalOcGetSymbolWorkerName assumes Length > 0.
@@ -252,6 +460,7 @@ InternalOcGetSymbolValue (
   UINT32                      Index;
 
   Symbol = NULL;
+  ++Context->SymbolValueLookups;
 
   if ((SymbolLevel == OcGetSymbolOnlyCxx) && (Kext->LinkedSymbolTable != NULL)) {
     Symbol = InternalOcGetSymbolWorkerValue (Kext, LookupValue, SymbolLevel);
@@ -281,19 +490,19 @@ InternalOcGetSymbolValue (
 /**
   Patches Symbol with Value and marks it as solved.
 
-  @param[in]  Is32Bit Symbol is 32-bit.
-  @param[in]  Value   The value to solve Symbol with.
-  @param[out] Symbol  The symbol to solve.
+  @param[in,out] MachoContext  Context of the Mach-O owning Symbol.
+  @param[in]     Value         The value to solve Symbol with.
+  @param[out]    Symbol        The symbol to solve.
 
 **/
 VOID
 InternalSolveSymbolValue (
-  IN  BOOLEAN             Is32Bit,
-  IN  UINT64              Value,
-  OUT MACH_NLIST_ANY      *Symbol
+  IN OUT OC_MACHO_CONTEXT   *MachoContext,
+  IN     UINT64             Value,
+  OUT    MACH_NLIST_ANY     *Symbol
   )
 {
-  if (Is32Bit) {
+  if (MachoContext->Is32Bit) {
     Symbol->Symbol32.Value   = (UINT32) Value;
     Symbol->Symbol32.Type    = (MACH_N_TYPE_ABS | MACH_N_TYPE_EXT);
     Symbol->Symbol32.Section = NO_SECT;
@@ -302,6 +511,8 @@ InternalSolveSymbolValue (
     Symbol->Symbol64.Type    = (MACH_N_TYPE_ABS | MACH_N_TYPE_EXT);
     Symbol->Symbol64.Section = NO_SECT;
   }
+
+  MachoSymbolValueChanged (MachoContext, Symbol);
 }
 
 /**
@@ -369,7 +580,7 @@ InternalSolveSymbolNonWeak (
                     OcGetSymbolFirstLevel
                     );
   if (ResolveSymbol != NULL) {
-    InternalSolveSymbolValue (Context->Is32Bit, ResolveSymbol->Value, Symbol);
+    InternalSolveSymbolValue (&Kext->Context.MachContext, ResolveSymbol->Value, Symbol);
   }
 
   return TRUE;
@@ -515,7 +726,7 @@ InternalSolveSymbol (
     }
 
     if (Value != 0) {
-      InternalSolveSymbolValue (Context->Is32Bit, Value, Symbol);
+      InternalSolveSymbolValue (&Kext->Context.MachContext, Value, Symbol);
       return TRUE;
     }
   }
@@ -1736,6 +1947,10 @@ InternalPrelinkKext (
     DEBUG ((DEBUG_INFO, "OCAK: Vtable patching failed for kext %a\n", Kext->Identifier));
     return EFI_LOAD_ERROR;
   }
+  //
+  // Relocations are rewritten below, drop the lookup indices referring to them.
+  //
+  MachoFreeContext (MachoContext);
 
   //
   // Relocate local and external symbols.
@@ -2099,8 +2314,9 @@ InternalPrelinkKext (
 
   //
   // Reinitialize the Mach-O context to account for the changed __LINKEDIT
-  // segment and file size.
+  // segment and file size. Drop the lookup indices rebuilt since relocation.
   //
+  MachoFreeContext (MachoContext);
   if (!MachoInitializeContext (MachoContext, MachHeader, MachSize, MachoContext->ContainerOffset, Context->Is32Bit)) { 
     //
     // This should never failed under normal and abnormal conditions.
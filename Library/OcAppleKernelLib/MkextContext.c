@@ -140,7 +140,13 @@ ParseMkextV2Plist (
     CopyMem (PlistBuffer, &MkextBuffer[PlistOffset], PlistFullSize);
   }
 
-  PlistXml = XmlDocumentParse (PlistBuffer, PlistFullSize, FALSE);
+  PlistXml = XmlDocumentParseEx (
+    PlistBuffer,
+    PlistFullSize,
+    FALSE,
+    XML_PARSE_ARENA | XML_PARSE_COUNT_CHILDREN | XML_PARSE_KEEP_SOURCE,
+    NULL
+    );
   if (PlistXml == NULL) {
     FreePool (PlistBuffer);
     return FALSE;
@@ -194,29 +200,21 @@ UpdateMkextV2Plist (
   )
 {
   UINT8       *MkextBuffer;
-  CHAR8       *ExportedInfo;
   UINT32      ExportedInfoSize;
-  UINT32      TmpSize;
 
-  //
-  // Export plist and include \0 terminator in size.
-  //
-  ExportedInfo = XmlDocumentExport (PlistDoc, &ExportedInfoSize, 0, FALSE);
-  if (ExportedInfo == NULL) {
+  if (Offset >= AllocatedSize) {
     return 0;
   }
-  ExportedInfoSize++;
 
-  if (OcOverflowAddU32 (Offset, ExportedInfoSize, &TmpSize)
-    || TmpSize > AllocatedSize) {
-    FreePool (ExportedInfo);
+  //
+  // Export plist with \0 terminator right into the mkext.
+  //
+  MkextBuffer      = (UINT8 *) Mkext;
+  ExportedInfoSize = AllocatedSize - Offset;
+  if (!XmlDocumentExportTo (PlistDoc, (CHAR8 *) &MkextBuffer[Offset], &ExportedInfoSize, 0, FALSE)) {
     return 0;
   }
 
-  MkextBuffer = (UINT8 *) Mkext;
-  CopyMem (&MkextBuffer[Offset], ExportedInfo, ExportedInfoSize);
-  FreePool (ExportedInfo);
-
   Mkext->PlistOffset          = SwapBytes32 (Offset);
   Mkext->PlistFullSize        = SwapBytes32 (ExportedInfoSize);
   Mkext->PlistCompressedSize  = 0;
@@ -249,12 +247,84 @@ InsertCachedMkextKext (
   }
 
   InsertTailList (&Context->CachedKexts, &MkextKext->Link);
+  InternalKextIndexInsert (&Context->CachedKextIndex, MkextKext->Identifier, MkextKext);
 
   DEBUG ((DEBUG_VERBOSE, "OCAK: Inserted %a into mkext cache\n", Identifier));
 
   return MkextKext;
 }
 
+STATIC
+BOOLEAN
+InternalMkextV2ParseBundle (
+  IN     XML_NODE           *PlistBundle,
+     OUT CONST CHAR8        **KextIdentifier,
+     OUT UINT32             *KextBinOffset
+  )
+{
+  UINT32              PlistBundleIndex;
+  UINT32              PlistBundleCount;
+  CONST CHAR8         *PlistBundleKey;
+  XML_NODE            *PlistBundleKeyValue;
+
+  *KextIdentifier = NULL;
+  *KextBinOffset  = 0;
+
+  PlistBundleCount = PlistDictChildren (PlistBundle);
+  for (PlistBundleIndex = 0; PlistBundleIndex < PlistBundleCount; PlistBundleIndex++) {
+    PlistBundleKey = PlistKeyValue (PlistDictChild (PlistBundle, PlistBundleIndex, &PlistBundleKeyValue));
+    if (PlistBundleKey == NULL || PlistBundleKeyValue == NULL) {
+      continue;
+    }
+    
+    if (AsciiStrCmp (PlistBundleKey, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
+      *KextIdentifier = XmlNodeContent (PlistBundleKeyValue);
+    }
+
+    if (AsciiStrCmp (PlistBundleKey, MKEXT_EXECUTABLE_KEY) == 0) {
+      //
+      // Ensure binary offset is before plist offset.
+      //
+      if (!PlistIntegerValue (PlistBundleKeyValue, KextBinOffset, sizeof (*KextBinOffset), TRUE)) {
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+VOID
+InternalMkextV2IndexKexts (
+  IN OUT MKEXT_CONTEXT      *Context
+  )
+{
+  UINT32              Index;
+  UINT32              PlistBundlesCount;
+  XML_NODE            *PlistBundle;
+  CONST CHAR8         *KextIdentifier;
+  UINT32              KextBinOffset;
+
+  PlistBundlesCount = XmlNodeChildren (Context->MkextKexts);
+  for (Index = 0; Index < PlistBundlesCount && !Context->MkextKextIndex.Failed; Index++) {
+    PlistBundle = PlistNodeCast (XmlNodeChild (Context->MkextKexts, Index), PLIST_NODE_TYPE_DICT);
+    //
+    // Malformed entries abort linear lookup, leave them to it.
+    //
+    if (PlistBundle == NULL
+      || !InternalMkextV2ParseBundle (PlistBundle, &KextIdentifier, &KextBinOffset)) {
+      InternalKextIndexFree (&Context->MkextKextIndex);
+      Context->MkextKextIndex.Failed = TRUE;
+      return;
+    }
+
+    if (KextIdentifier != NULL) {
+      InternalKextIndexInsert (&Context->MkextKextIndex, KextIdentifier, PlistBundle);
+    }
+  }
+}
+
 MKEXT_KEXT *
 InternalCachedMkextKext (
   IN OUT MKEXT_CONTEXT      *Context,
@@ -293,15 +363,22 @@ InternalCachedMkextKext (
   //
   // Try to get cached kext.
   //
-  KextLink = GetFirstNode (&Context->CachedKexts);
-  while (!IsNull (&Context->CachedKexts, KextLink)) {
-    MkextKext = GET_MKEXT_KEXT_FROM_LINK (KextLink);
-
-    if (AsciiStrCmp (Identifier, MkextKext->Identifier) == 0) {
+  if (!Context->CachedKextIndex.Failed) {
+    MkextKext = InternalKextIndexLookup (&Context->CachedKextIndex, Identifier);
+    if (MkextKext != NULL) {
       return MkextKext;
     }
+  } else {
+    KextLink = GetFirstNode (&Context->CachedKexts);
+    while (!IsNull (&Context->CachedKexts, KextLink)) {
+      MkextKext = GET_MKEXT_KEXT_FROM_LINK (KextLink);
 
-    KextLink = GetNextNode (&Context->CachedKexts, KextLink);
+      if (AsciiStrCmp (Identifier, MkextKext->Identifier) == 0) {
+        return MkextKext;
+      }
+
+      KextLink = GetNextNode (&Context->CachedKexts, KextLink);
+    }
   }
 
   //
@@ -390,38 +467,40 @@ InternalCachedMkextKext (
   // Mkext v2.
   //
   } else if (Context->MkextVersion == MKEXT_VERSION_V2) {
-    KextIdentifier  = NULL;
-    KextBinOffset   = 0;
+    //
+    // Index bundle dicts once, as a linear walk per kext is quadratic.
+    //
+    if (!Context->MkextKextIndexValid) {
+      InternalMkextV2IndexKexts (Context);
+      Context->MkextKextIndexValid = TRUE;
+    }
+
+    if (!Context->MkextKextIndex.Failed) {
+      PlistBundle = InternalKextIndexLookup (&Context->MkextKextIndex, Identifier);
+      if (PlistBundle == NULL) {
+        return NULL;
+      }
+
+      //
+      // Index is only built when all bundles parse successfully.
+      //
+      InternalMkextV2ParseBundle (PlistBundle, &KextIdentifier, &KextBinOffset);
+      IsKextMatch = KextBinOffset > 0
+        && KextBinOffset < Context->MkextSize - sizeof (MKEXT_V2_FILE_ENTRY);
+    }
 
     //
-    // Enumerate bundle dicts.
+    // Enumerate bundle dicts, e.g. for duplicate identifiers with an invalid first entry.
     //
-    PlistBundlesCount = XmlNodeChildren (Context->MkextKexts);
+    PlistBundlesCount = IsKextMatch ? 0 : XmlNodeChildren (Context->MkextKexts);
     for (Index = 0; Index < PlistBundlesCount; Index++) {
       PlistBundle = PlistNodeCast (XmlNodeChild (Context->MkextKexts, Index), PLIST_NODE_TYPE_DICT);
       if (PlistBundle == NULL) {
         return NULL;
       }
 
-      PlistBundleCount = PlistDictChildren (PlistBundle);
-      for (PlistBundleIndex = 0; PlistBundleIndex < PlistBundleCount; PlistBundleIndex++) {
-        PlistBundleKey = PlistKeyValue (PlistDictChild (PlistBundle, PlistBundleIndex, &PlistBundleKeyValue));
-        if (PlistBundleKey == NULL || PlistBundleKeyValue == NULL) {
-          continue;
-        }
-        
-        if (AsciiStrCmp (PlistBundleKey, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
-          KextIdentifier = XmlNodeContent (PlistBundleKeyValue);
-        }
-
-        if (AsciiStrCmp (PlistBundleKey, MKEXT_EXECUTABLE_KEY) == 0) {
-          //
-          // Ensure binary offset is before plist offset.
-          //
-          if (!PlistIntegerValue (PlistBundleKeyValue, &KextBinOffset, sizeof (KextBinOffset), TRUE)) {
-            return NULL;
-          }
-        }
+      if (!InternalMkextV2ParseBundle (PlistBundle, &KextIdentifier, &KextBinOffset)) {
+        return NULL;
       }
 
       if (KextIdentifier != NULL
@@ -431,9 +510,6 @@ InternalCachedMkextKext (
         IsKextMatch = TRUE;
         break;
       }
-
-      KextIdentifier  = NULL;
-      KextBinOffset   = 0;
     }
 
     //
@@ -1090,6 +1166,9 @@ MkextContextFree (
     FreePool (MkextKext);
   }
 
+  InternalKextIndexFree (&Context->CachedKextIndex);
+  InternalKextIndexFree (&Context->MkextKextIndex);
+
   if (Context->MkextInfoDocument != NULL) {
     XmlDocumentFree (Context->MkextInfoDocument);
   }
@@ -1430,6 +1509,36 @@ MkextContextApplyPatch (
   return PatcherApplyGenericPatch (&Patcher, Patch);
 }
 
+EFI_STATUS
+MkextContextApplyPatches (
+  IN OUT MKEXT_CONTEXT          *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  EFI_STATUS            Status;
+  PATCHER_CONTEXT       Patcher;
+  UINT32                Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Identifier != NULL);
+  ASSERT (Patches != NULL);
+  ASSERT (Results != NULL);
+
+  Status = PatcherInitContextFromMkext (&Patcher, Context, Identifier);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCAK: Failed to mkext find %a - %r\n", Identifier, Status));
+    for (Index = 0; Index < PatchCount; ++Index) {
+      Results[Index] = Status;
+    }
+    return Status;
+  }
+
+  return PatcherApplyGenericPatches (&Patcher, Patches, PatchCount, Results);
+}
+
 EFI_STATUS
 MkextContextApplyQuirk (
   IN OUT MKEXT_CONTEXT        *Context,
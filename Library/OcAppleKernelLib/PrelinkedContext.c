@@ -344,11 +344,16 @@ PrelinkedContextInit (
     return EFI_OUT_OF_RESOURCES;
   }
 
-  Context->PrelinkedInfoDocument = XmlDocumentParse (
+  //
+  // Prelinked plist has tens of thousands of nodes, avoid allocating each.
+  //
+  Context->PrelinkedInfoDocument = XmlDocumentParseEx (
     Context->PrelinkedInfo,
     (UINT32) (Context->Is32Bit ?
       Context->PrelinkedInfoSection->Section32.Size : Context->PrelinkedInfoSection->Section64.Size),
-    TRUE
+    TRUE,
+    XML_PARSE_ARENA | XML_PARSE_COUNT_CHILDREN | XML_PARSE_KEEP_SOURCE,
+    NULL
     );
   if (Context->PrelinkedInfoDocument == NULL) {
     PrelinkedContextFree (Context);
@@ -469,6 +474,9 @@ PrelinkedContextFree (
 
   ZeroMem (&Context->PrelinkedKexts, sizeof (Context->PrelinkedKexts));
 
+  InternalKextIndexFree (&Context->PrelinkedKextIndex);
+  InternalKextIndexFree (&Context->KextListIndex);
+
   //
   // We do not need to iterate InjectedKexts here, as its memory was freed above.
   //
@@ -739,7 +747,6 @@ PrelinkedInjectComplete (
   )
 {
   EFI_STATUS  Status;
-  CHAR8       *ExportedInfo;
   UINT32      ExportedInfoSize;
   UINT32      NewSize;
   UINT32      KextsSize;
@@ -772,19 +779,24 @@ PrelinkedInjectComplete (
     }
   }
 
-  ExportedInfo = XmlDocumentExport (Context->PrelinkedInfoDocument, &ExportedInfoSize, 0, FALSE);
-  if (ExportedInfo == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
   //
-  // Include \0 terminator.
+  // Export right into the reserved space without an intermediate buffer.
+  // Untouched kext dictionaries are copied from the original plist, and
+  // the size including \0 terminator is obtained in the same pass.
   //
-  ExportedInfoSize++;
+  ExportedInfoSize = Context->PrelinkedAllocSize - Context->PrelinkedSize;
+  if (!XmlDocumentExportTo (
+    Context->PrelinkedInfoDocument,
+    (CHAR8 *) &Context->Prelinked[Context->PrelinkedSize],
+    &ExportedInfoSize,
+    0,
+    FALSE
+    )) {
+    return ExportedInfoSize == 0 ? EFI_OUT_OF_RESOURCES : EFI_BUFFER_TOO_SMALL;
+  }
 
   if (OcOverflowAddU32 (Context->PrelinkedSize, MACHO_ALIGN (ExportedInfoSize), &NewSize)
     || NewSize > Context->PrelinkedAllocSize) {
-    FreePool (ExportedInfo);
     return EFI_BUFFER_TOO_SMALL;
   }
 
@@ -796,7 +808,7 @@ PrelinkedInjectComplete (
   if (Context->IsKernelCollection && MACHO_ALIGN (ExportedInfoSize) <= Context->PrelinkedInfoSegment->Size) {
     CopyMem (
       &Context->Prelinked[Context->PrelinkedInfoSegment->FileOffset],
-      ExportedInfo,
+      &Context->Prelinked[Context->PrelinkedSize],
       ExportedInfoSize
       );
 
@@ -805,8 +817,6 @@ PrelinkedInjectComplete (
       Context->PrelinkedInfoSegment->FileSize - ExportedInfoSize
       );
 
-    FreePool (ExportedInfo);
-
     return EFI_SUCCESS;
   }
 #endif
@@ -843,12 +853,6 @@ PrelinkedInjectComplete (
     Context->InnerInfoSection->Offset         = Context->PrelinkedSize;
   }
 
-  CopyMem (
-    &Context->Prelinked[Context->PrelinkedSize],
-    ExportedInfo,
-    ExportedInfoSize
-    );
-
   ZeroMem (
     &Context->Prelinked[Context->PrelinkedSize + ExportedInfoSize],
     MACHO_ALIGN (ExportedInfoSize) - ExportedInfoSize
@@ -1188,7 +1192,7 @@ PrelinkedInjectKext (
   // Let other kexts depend on this one.
   //
   if (PrelinkedKext != NULL) {
-    InsertTailList (&Context->PrelinkedKexts, &PrelinkedKext->Link);
+    InternalInsertPrelinkedKext (Context, PrelinkedKext);
     //
     // Additionally register this kext in the injected list, as this is required
     // for KernelCollection support.
@@ -1222,6 +1226,36 @@ PrelinkedContextApplyPatch (
   return PatcherApplyGenericPatch (&Patcher, Patch);
 }
 
+EFI_STATUS
+PrelinkedContextApplyPatches (
+  IN OUT PRELINKED_CONTEXT      *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  EFI_STATUS            Status;
+  PATCHER_CONTEXT       Patcher;
+  UINT32                Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Identifier != NULL);
+  ASSERT (Patches != NULL);
+  ASSERT (Results != NULL);
+
+  Status = PatcherInitContextFromPrelinked (&Patcher, Context, Identifier);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCAK: Failed to pk find %a - %r\n", Identifier, Status));
+    for (Index = 0; Index < PatchCount; ++Index) {
+      Results[Index] = Status;
+    }
+    return Status;
+  }
+
+  return PatcherApplyGenericPatches (&Patcher, Patches, PatchCount, Results);
+}
+
 EFI_STATUS
 PrelinkedContextApplyQuirk (
   IN OUT PRELINKED_CONTEXT    *Context,
@@ -27,6 +27,12 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 //
 #define MAX_KEXT_DEPEDENCIES 16
 
+//
+// Minimal number of symbols to build linked symbol hash indices for.
+// Smaller tables are faster to walk linearly.
+//
+#define PRELINKED_KEXT_SYMBOL_INDEX_MIN  64
+
 //
 // Aligned maximum virtual address size with 0x prefix and \0 terminator.
 //
@@ -127,6 +133,16 @@ struct PRELINKED_KEXT_ {
   //
   PRELINKED_KEXT_SYMBOL    *LinkedSymbolTable;
   //
+  // Hash indices of LinkedSymbolTable by symbol name and value, or NULL.
+  // Entries contain LinkedSymbolTable index plus one, 0 marks a free slot.
+  //
+  UINT32                   *SymbolNameIndex;
+  UINT32                   *SymbolValueIndex;
+  //
+  // Number of hash index slots minus one, slot count is a power of two.
+  //
+  UINT32                   SymbolIndexMask;
+  //
   // A flag set during dependency walk BFS to avoid going through the same path.
   //
   BOOLEAN                  Processed;
@@ -189,6 +205,15 @@ InternalFreePrelinkedKext (
   IN PRELINKED_KEXT  *Kext
   );
 
+/**
+  Inserts PRELINKED_KEXT into PRELINKED_CONTEXT cache.
+**/
+VOID
+InternalInsertPrelinkedKext (
+  IN OUT PRELINKED_CONTEXT  *Prelinked,
+  IN OUT PRELINKED_KEXT     *Kext
+  );
+
 /**
   Gets cached PRELINKED_KEXT from PRELINKED_CONTEXT.
 **/
@@ -414,11 +439,34 @@ InternalOcGetSymbolValue (
   IN OC_GET_SYMBOL_LEVEL  SymbolLevel
   );
 
+/**
+  Build hash indices for linked symbol table lookup by name and value.
+  Failure to build the indices is not fatal, linear lookup is used then.
+
+  @param[in,out] Kext        Kext dependency with LinkedSymbolTable.
+  @param[in]     Context     Prelinking context.
+**/
+VOID
+InternalBuildLinkedSymbolIndex (
+  IN OUT PRELINKED_KEXT     *Kext,
+  IN     PRELINKED_CONTEXT  *Context
+  );
+
+/**
+  Free hash indices for linked symbol table lookup.
+
+  @param[in,out] Kext        Kext dependency.
+**/
+VOID
+InternalFreeLinkedSymbolIndex (
+  IN OUT PRELINKED_KEXT     *Kext
+  );
+
 VOID
 InternalSolveSymbolValue (
-  IN  BOOLEAN             Is32Bit,
-  IN  UINT64              Value,
-  OUT MACH_NLIST_ANY      *Symbol
+  IN OUT OC_MACHO_CONTEXT   *MachoContext,
+  IN     UINT64             Value,
+  OUT    MACH_NLIST_ANY     *Symbol
   );
 
 /**
@@ -501,4 +549,57 @@ InternalKxldSolveSymbol (
   IN CONST CHAR8   *Name
   );
 
+/**
+  Insert value into kext identifier index. Existing identifiers are kept,
+  so that lookup matches the first list entry like a linear walk does.
+  On allocation failure the index is freed and marked as failed.
+
+  @param[in,out] Index       Kext identifier index.
+  @param[in]     Identifier  Bundle identifier, must outlive the index.
+  @param[in]     Value       Value to index.
+**/
+VOID
+InternalKextIndexInsert (
+  IN OUT KEXT_ID_INDEX  *Index,
+  IN     CONST CHAR8    *Identifier,
+  IN     VOID           *Value
+  );
+
+/**
+  Lookup value in kext identifier index.
+
+  @param[in] Index       Kext identifier index, must not be failed.
+  @param[in] Identifier  Bundle identifier.
+
+  @retval Indexed value or NULL.
+**/
+VOID *
+InternalKextIndexLookup (
+  IN CONST KEXT_ID_INDEX  *Index,
+  IN CONST CHAR8          *Identifier
+  );
+
+/**
+  Index plist dictionaries from kext array by CFBundleIdentifier.
+  Dictionaries without string identifier are skipped.
+
+  @param[in,out] Index       Empty kext identifier index.
+  @param[in]     KextList    Plist array of kext dictionaries.
+**/
+VOID
+InternalKextIndexPlistArray (
+  IN OUT KEXT_ID_INDEX  *Index,
+  IN     XML_NODE       *KextList
+  );
+
+/**
+  Free kext identifier index.
+
+  @param[in,out] Index       Kext identifier index.
+**/
+VOID
+InternalKextIndexFree (
+  IN OUT KEXT_ID_INDEX  *Index
+  );
+
 #endif // PRELINKED_INTERNAL_H
@@ -229,6 +229,11 @@ InternalCreatePrelinkedKext (
     return NULL;
   }
 
+  //
+  // Vtable processing looks up symbols of dependencies by name and value.
+  //
+  MachoEnableSymbolIndex (&NewKext->Context.MachContext);
+
   NewKext->Signature                  = PRELINKED_KEXT_SIGNATURE;
   NewKext->Identifier                 = KextIdentifier;
   NewKext->BundleLibraries            = BundleLibraries;
@@ -449,6 +454,8 @@ InternalScanBuildLinkedSymbolTable (
   Kext->NumberOfCxxSymbols = NumCxxSymbols;
   Kext->LinkedSymbolTable  = SymbolTable;
 
+  InternalBuildLinkedSymbolIndex (Kext, Context);
+
   return EFI_SUCCESS;
 }
 
@@ -647,6 +654,7 @@ InternalNewPrelinkedKext (
   }
 
   CopyMem (&NewKext->Context.MachContext, Context, sizeof (NewKext->Context.MachContext));
+  MachoEnableSymbolIndex (&NewKext->Context.MachContext);
   return NewKext;
 }
 
@@ -660,6 +668,10 @@ InternalFreePrelinkedKext (
     Kext->LinkedSymbolTable = NULL;
   }
 
+  InternalFreeLinkedSymbolIndex (Kext);
+
+  MachoFreeContext (&Kext->Context.MachContext);
+
   if (Kext->LinkedVtables != NULL) {
     FreePool (Kext->LinkedVtables);
     Kext->LinkedVtables = NULL;
@@ -668,6 +680,16 @@ InternalFreePrelinkedKext (
   FreePool (Kext);
 }
 
+VOID
+InternalInsertPrelinkedKext (
+  IN OUT PRELINKED_CONTEXT  *Prelinked,
+  IN OUT PRELINKED_KEXT     *Kext
+  )
+{
+  InsertTailList (&Prelinked->PrelinkedKexts, &Kext->Link);
+  InternalKextIndexInsert (&Prelinked->PrelinkedKextIndex, Kext->Identifier, Kext);
+}
+
 PRELINKED_KEXT *
 InternalCachedPrelinkedKext (
   IN OUT PRELINKED_CONTEXT  *Prelinked,
@@ -683,30 +705,59 @@ InternalCachedPrelinkedKext (
   //
   // Find cached entry if any.
   //
-  Kext = GetFirstNode (&Prelinked->PrelinkedKexts);
-  while (!IsNull (&Prelinked->PrelinkedKexts, Kext)) {
-    if (AsciiStrCmp (Identifier, GET_PRELINKED_KEXT_FROM_LINK (Kext)->Identifier) == 0) {
-      return GET_PRELINKED_KEXT_FROM_LINK (Kext);
+  if (!Prelinked->PrelinkedKextIndex.Failed) {
+    NewKext = InternalKextIndexLookup (&Prelinked->PrelinkedKextIndex, Identifier);
+    if (NewKext != NULL) {
+      return NewKext;
     }
+  } else {
+    Kext = GetFirstNode (&Prelinked->PrelinkedKexts);
+    while (!IsNull (&Prelinked->PrelinkedKexts, Kext)) {
+      if (AsciiStrCmp (Identifier, GET_PRELINKED_KEXT_FROM_LINK (Kext)->Identifier) == 0) {
+        return GET_PRELINKED_KEXT_FROM_LINK (Kext);
+      }
 
-    Kext = GetNextNode (&Prelinked->PrelinkedKexts, Kext);
+      Kext = GetNextNode (&Prelinked->PrelinkedKexts, Kext);
+    }
   }
 
   //
-  // Try with real entry.
+  // Index real entries once, as a linear walk per dependency is quadratic.
   //
-  NewKext   = NULL;
-  KextCount = XmlNodeChildren (Prelinked->KextList);
-  for (Index = 0; Index < KextCount; ++Index) {
-    KextPlist = PlistNodeCast (XmlNodeChild (Prelinked->KextList, Index), PLIST_NODE_TYPE_DICT);
+  if (!Prelinked->KextListIndexValid) {
+    InternalKextIndexPlistArray (&Prelinked->KextListIndex, Prelinked->KextList);
+    Prelinked->KextListIndexValid = TRUE;
+  }
 
+  //
+  // Try with real entry.
+  //
+  NewKext = NULL;
+  if (!Prelinked->KextListIndex.Failed) {
+    KextPlist = InternalKextIndexLookup (&Prelinked->KextListIndex, Identifier);
     if (KextPlist == NULL) {
-      continue;
+      return NULL;
     }
 
     NewKext = InternalCreatePrelinkedKext (Prelinked, KextPlist, Identifier, Prelinked->Is32Bit);
-    if (NewKext != NULL) {
-      break;
+  }
+
+  //
+  // Fallback to slow lookup, e.g. for duplicate identifiers with an invalid first entry.
+  //
+  if (NewKext == NULL) {
+    KextCount = XmlNodeChildren (Prelinked->KextList);
+    for (Index = 0; Index < KextCount; ++Index) {
+      KextPlist = PlistNodeCast (XmlNodeChild (Prelinked->KextList, Index), PLIST_NODE_TYPE_DICT);
+
+      if (KextPlist == NULL) {
+        continue;
+      }
+
+      NewKext = InternalCreatePrelinkedKext (Prelinked, KextPlist, Identifier, Prelinked->Is32Bit);
+      if (NewKext != NULL) {
+        break;
+      }
     }
   }
 
@@ -714,7 +765,7 @@ InternalCachedPrelinkedKext (
     return NULL;
   }
 
-  InsertTailList (&Prelinked->PrelinkedKexts, &NewKext->Link);
+  InternalInsertPrelinkedKext (Prelinked, NewKext);
 
   return NewKext;
 }
@@ -756,6 +807,7 @@ InternalCachedPrelinkedKernel (
     &Prelinked->PrelinkedMachContext,
     sizeof (NewKext->Context.MachContext)
     );
+  MachoEnableSymbolIndex (&NewKext->Context.MachContext);
 
   Segment = MachoGetSegmentByName (
     &NewKext->Context.MachContext,
@@ -859,7 +911,7 @@ InternalCachedPrelinkedKernel (
     }
   }
 
-  InsertTailList (&Prelinked->PrelinkedKexts, &NewKext->Link);
+  InternalInsertPrelinkedKext (Prelinked, NewKext);
 
   return NewKext;
 }
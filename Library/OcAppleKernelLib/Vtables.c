@@ -363,7 +363,7 @@ InternalPatchVtableSymbol (
   //       changed for the symbol value is already resolved and nothing but a
   //       VTable Relocation should reference it.
   //
-  InternalSolveSymbolValue (MachoContext->Is32Bit, ParentEntry->Address, Symbol);
+  InternalSolveSymbolValue (MachoContext, ParentEntry->Address, Symbol);
   //
   // The C++ ABI requires that functions be aligned on a 2-byte boundary:
   // http://www.codesourcery.com/public/cxx-abi/abi.html#member-pointers
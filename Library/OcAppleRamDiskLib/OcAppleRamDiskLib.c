@@ -469,7 +469,9 @@ BOOLEAN
 OcAppleRamDiskLoadFile (
   IN CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
   IN EFI_FILE_PROTOCOL                  *File,
-  IN UINTN                              FileSize
+  IN UINTN                              FileSize,
+  IN OC_APPLE_RAM_DISK_LOAD_VERIFY      Verify         OPTIONAL,
+  IN OUT VOID                           *VerifyContext OPTIONAL
   )
 {
   EFI_STATUS      Status;
@@ -535,6 +537,16 @@ OcAppleRamDiskLoadFile (
       Sha256Update (&Ctx, TmpBuffer, ReadSize);
       DEBUG_CODE_END ();
 
+      //
+      // Verify while the data is still hot in the bounce buffer,
+      // and stop loading at the first mismatch.
+      //
+      if (Verify != NULL && !Verify (VerifyContext, TmpBuffer, ReadSize)) {
+        DEBUG ((DEBUG_INFO, "OCRAM: File verification failed at 0x%Lx\n", FilePosition));
+        FreePool (TmpBuffer);
+        return FALSE;
+      }
+
       CopyMem (ExtentBuffer, TmpBuffer, ReadSize);
 
       FilePosition += ReadSize;
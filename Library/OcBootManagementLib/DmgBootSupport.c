@@ -108,76 +108,74 @@ InternalGetFirstDeviceBootFilePath (
 }
 
 STATIC
-EFI_DEVICE_PATH_PROTOCOL *
-InternalGetDiskImageBootFile (
-  OUT INTERNAL_DMG_LOAD_CONTEXT   *Context,
-  IN  OC_DMG_LOADING_SUPPORT      DmgLoading,
-  IN  UINTN                       DmgFileSize,
+BOOLEAN
+InternalVerifyDmgChunklist (
+  OUT OC_APPLE_CHUNKLIST_CONTEXT  *ChunklistContext,
   IN  VOID                        *ChunklistBuffer OPTIONAL,
   IN  UINT32                      ChunklistBufferSize OPTIONAL
   )
 {
-  EFI_DEVICE_PATH_PROTOCOL       *DevPath;
+  BOOLEAN  Result;
 
-  BOOLEAN                        Result;
-  OC_APPLE_CHUNKLIST_CONTEXT     ChunklistContext;
+  ASSERT (ChunklistContext != NULL);
 
-  CONST EFI_DEVICE_PATH_PROTOCOL *DmgDevicePath;
-  UINTN                          DmgDevicePathSize;
-
-  ASSERT (Context != NULL);
-  ASSERT (DmgFileSize > 0);
+  if (ChunklistBuffer == NULL) {
+    DEBUG ((DEBUG_WARN, "OCB: Missing DMG signature, aborting\n"));
+    return FALSE;
+  }
 
-  if (DmgLoading == OcDmgLoadingAppleSigned) {
-    if (ChunklistBuffer == NULL) {
-      DEBUG ((DEBUG_WARN, "OCB: Missing DMG signature, aborting\n"));
-      return NULL;
-    }
+  ASSERT (ChunklistBufferSize > 0);
 
-    ASSERT (ChunklistBufferSize > 0);
+  Result = OcAppleChunklistInitializeContext (
+    ChunklistContext,
+    ChunklistBuffer,
+    ChunklistBufferSize
+    );
+  if (!Result) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCB: Failed to initialise DMG Chunklist context\n"
+      ));
+    return FALSE;
+  }
 
-    Result = OcAppleChunklistInitializeContext (
-      &ChunklistContext,
-      ChunklistBuffer,
-      ChunklistBufferSize
-      );
-    if (!Result) {
-      DEBUG ((
-        DEBUG_INFO,
-        "OCB: Failed to initialise DMG Chunklist context\n"
-        ));
-      return NULL;
-    }
+  //
+  // FIXME: Properly abstract OcAppleKeysLib.
+  //
+  Result = OcAppleChunklistVerifySignature (
+    ChunklistContext,
+    PkDataBase[0].PublicKey
+    );
 
-    //
-    // FIXME: Properly abstract OcAppleKeysLib.
-    //
+  if (!Result) {
     Result = OcAppleChunklistVerifySignature (
-      &ChunklistContext,
-      PkDataBase[0].PublicKey
+      ChunklistContext,
+      PkDataBase[1].PublicKey
       );
+  }
 
-    if (!Result) {
-      Result = OcAppleChunklistVerifySignature (
-        &ChunklistContext,
-        PkDataBase[1].PublicKey
-        );
-    }
+  if (!Result) {
+    DEBUG ((DEBUG_WARN, "OCB: DMG is not trusted, aborting\n"));
+    return FALSE;
+  }
 
-    if (!Result) {
-      DEBUG ((DEBUG_WARN, "OCB: DMG is not trusted, aborting\n"));
-      return NULL;
-    }
+  return TRUE;
+}
 
-    Result = OcAppleDiskImageVerifyData (
-               Context->DmgContext,
-               &ChunklistContext
-               );
-    if (!Result) {
-      DEBUG ((DEBUG_WARN, "OCB: DMG has been altered\n"));
-      return NULL;
-    }
-  }
+STATIC
+EFI_DEVICE_PATH_PROTOCOL *
+InternalGetDiskImageBootFile (
+  OUT INTERNAL_DMG_LOAD_CONTEXT   *Context,
+  IN  UINTN                       DmgFileSize
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL       *DevPath;
+
+  CONST EFI_DEVICE_PATH_PROTOCOL *DmgDevicePath;
+  UINTN                          DmgDevicePathSize;
+
+  ASSERT (Context != NULL);
+  ASSERT (DmgFileSize > 0);
 
   Context->BlockIoHandle = OcAppleDiskImageInstallBlockIo (
                              Context->DmgContext,
@@ -335,6 +333,7 @@ InternalLoadDmg (
   EFI_FILE_PROTOCOL        *ChunklistFile;
   UINT32                   ChunklistFileSize;
   VOID                     *ChunklistBuffer;
+  OC_APPLE_CHUNKLIST_CONTEXT ChunklistContext;
 
   CHAR16 *DevPathText;
 
@@ -403,25 +402,6 @@ InternalLoadDmg (
     return NULL;
   }
 
-  Context->DmgContext = AllocatePool (sizeof (*Context->DmgContext));
-  if (Context->DmgContext == NULL) {
-    DEBUG ((DEBUG_INFO, "OCB: Failed to allocate DMG context\n"));
-    return NULL;
-  }
-
-  Result = OcAppleDiskImageInitializeFromFile (Context->DmgContext, DmgFile);
-
-  DmgFile->Close (DmgFile);
-
-  if (!Result) {
-    DEBUG ((DEBUG_INFO, "OCB: Failed to initialise DMG from file\n"));
-
-    FreePool (DmgFileInfo);
-    FreePool (Context->DmgContext);
-    DmgDir->Close (DmgDir);
-    return NULL;
-  }
-
   ChunklistBuffer   = NULL;
   ChunklistFileSize = 0;
 
@@ -461,16 +441,70 @@ InternalLoadDmg (
     FreePool (ChunklistFileInfo);
   }
 
-  FreePool (DmgFileInfo);
+  //
+  // Check the chunklist signature before loading the DMG, so that its data
+  // can be verified while it is read.
+  //
+  if (DmgLoading == OcDmgLoadingAppleSigned) {
+    Result = InternalVerifyDmgChunklist (
+               &ChunklistContext,
+               ChunklistBuffer,
+               ChunklistFileSize
+               );
+    if (!Result) {
+      if (ChunklistBuffer != NULL) {
+        FreePool (ChunklistBuffer);
+      }
 
+      FreePool (DmgFileInfo);
+      DmgFile->Close (DmgFile);
+      DmgDir->Close (DmgDir);
+      return NULL;
+    }
+  }
+
+  Context->DmgContext = AllocatePool (sizeof (*Context->DmgContext));
+  if (Context->DmgContext == NULL) {
+    DEBUG ((DEBUG_INFO, "OCB: Failed to allocate DMG context\n"));
+
+    if (ChunklistBuffer != NULL) {
+      FreePool (ChunklistBuffer);
+    }
+
+    FreePool (DmgFileInfo);
+    DmgFile->Close (DmgFile);
+    DmgDir->Close (DmgDir);
+    return NULL;
+  }
+
+  Result = OcAppleDiskImageInitializeFromFile (
+             Context->DmgContext,
+             DmgFile,
+             DmgLoading == OcDmgLoadingAppleSigned ? &ChunklistContext : NULL
+             );
+
+  DmgFile->Close (DmgFile);
+  FreePool (DmgFileInfo);
   DmgDir->Close (DmgDir);
 
+  if (ChunklistBuffer != NULL) {
+    FreePool (ChunklistBuffer);
+  }
+
+  if (!Result) {
+    if (DmgLoading == OcDmgLoadingAppleSigned) {
+      DEBUG ((DEBUG_WARN, "OCB: DMG has been altered or failed to load\n"));
+    } else {
+      DEBUG ((DEBUG_INFO, "OCB: Failed to initialise DMG from file\n"));
+    }
+
+    FreePool (Context->DmgContext);
+    return NULL;
+  }
+
   DevPath = InternalGetDiskImageBootFile (
               Context,
-              DmgLoading,
-              DmgFileSize,
-              ChunklistBuffer,
-              ChunklistFileSize
+              DmgFileSize
               );
   Context->DevicePath = DevPath;
 
@@ -487,10 +521,6 @@ InternalLoadDmg (
     FreePool (Context->DmgContext);
   }
 
-  if (ChunklistBuffer != NULL) {
-    FreePool (ChunklistBuffer);
-  }
-
   return DevPath;
 }
 
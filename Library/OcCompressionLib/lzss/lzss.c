@@ -66,208 +66,379 @@ u_int32_t local_adler32(u_int8_t * buffer, int32_t length)
 #define F         18    /* upper limit for match_length */
 #define THRESHOLD 2     /* encode string into position and length
                            if match_length is greater than this */
-#define NIL       N     /* index for root of binary search trees */
+#define NIL       (-1)  /* end of hash chain */
+
+#define HASH_BITS 12    /* hash chain heads for three byte strings */
+#define HASH_SIZE (1 << HASH_BITS)
+
+/*
+ * Room for a group of eight matches, the last of which may be copied
+ * in 8 byte steps and overrun its end by up to 7 bytes.
+ */
+#define GROUP_DST_MARGIN (8 * F + 8)
 
 struct encode_state {
-    /*
-     * left & right children & parent. These constitute binary search trees.
-     */
-    int lchild[N + 1], rchild[N + 257], parent[N + 1];
+    /* most recent position of each hashed string, or NIL */
+    int32_t head[HASH_SIZE];
 
-    /* ring buffer of size N, with extra F-1 bytes to aid string comparison */
-    u_int8_t text_buf[N + F - 1];
+    /* previous position with the same hash, indexed by position modulo N */
+    int32_t prev[N];
+};
 
-    /*
-     * match_length of longest match.
-     * These are set by the insert_node() procedure.
-     */
-    int match_position, match_length;
+struct decode_state {
+    /* flags of the current eight units, with the higher byte counting them */
+    unsigned int flags;
 };
 
+/*
+ * Number of source bytes taken by the eight units following each flag byte:
+ * one for a literal (flag bit set) and two for a position and length pair.
+ */
+static const u_int8_t group_length[256] = {
+    16, 15, 15, 14, 15, 14, 14, 13, 15, 14, 14, 13, 14, 13, 13, 12,
+    15, 14, 14, 13, 14, 13, 13, 12, 14, 13, 13, 12, 13, 12, 12, 11,
+    15, 14, 14, 13, 14, 13, 13, 12, 14, 13, 13, 12, 13, 12, 12, 11,
+    14, 13, 13, 12, 13, 12, 12, 11, 13, 12, 12, 11, 12, 11, 11, 10,
+    15, 14, 14, 13, 14, 13, 13, 12, 14, 13, 13, 12, 13, 12, 12, 11,
+    14, 13, 13, 12, 13, 12, 12, 11, 13, 12, 12, 11, 12, 11, 11, 10,
+    14, 13, 13, 12, 13, 12, 12, 11, 13, 12, 12, 11, 12, 11, 11, 10,
+    13, 12, 12, 11, 12, 11, 11, 10, 12, 11, 11, 10, 11, 10, 10,  9,
+    15, 14, 14, 13, 14, 13, 13, 12, 14, 13, 13, 12, 13, 12, 12, 11,
+    14, 13, 13, 12, 13, 12, 12, 11, 13, 12, 12, 11, 12, 11, 11, 10,
+    14, 13, 13, 12, 13, 12, 12, 11, 13, 12, 12, 11, 12, 11, 11, 10,
+    13, 12, 12, 11, 12, 11, 11, 10, 12, 11, 11, 10, 11, 10, 10,  9,
+    14, 13, 13, 12, 13, 12, 12, 11, 13, 12, 12, 11, 12, 11, 11, 10,
+    13, 12, 12, 11, 12, 11, 11, 10, 12, 11, 11, 10, 11, 10, 10,  9,
+    13, 12, 12, 11, 12, 11, 11, 10, 12, 11, 11, 10, 11, 10, 10,  9,
+    12, 11, 11, 10, 11, 10, 10,  9, 11, 10, 10,  9, 10,  9,  9,  8
+};
 
-/*******************************************************************************
-*******************************************************************************/
-u_int32_t decompress_lzss(
-    u_int8_t       * dst,
-    u_int32_t        dstlen,
-    u_int8_t       * src,
-    u_int32_t        srclen)
+#if defined(__GNUC__) || defined(__clang__)
+/*
+ * memcpy maps to an out of line CopyMem call in firmware, so use unaligned
+ * types to let the compiler emit plain loads and stores.
+ */
+typedef u_int64_t __attribute__((__aligned__(1), __may_alias__)) unaligned_u64;
+
+static inline void copy8(u_int8_t *dst, const u_int8_t *src)
 {
-    /* ring buffer of size N, with extra F-1 bytes to aid string comparison */
-    u_int8_t text_buf[N + F - 1];
-    u_int8_t * dststart = dst;
-    const u_int8_t * dstend = dst + dstlen;
-    const u_int8_t * srcend = src + srclen;
-    int  i, j, k, r;
+    *(unaligned_u64 *) dst = *(const unaligned_u64 *) src;
+}
+#else
+static inline void copy8(u_int8_t *dst, const u_int8_t *src)
+{
+    u_int64_t data;
+    memcpy(&data, src, sizeof(data));
+    memcpy(dst, &data, sizeof(data));
+}
+#endif
+
+static void init_decode_state(struct decode_state *sp)
+{
+    sp->flags = 0;
+}
+
+/*
+ * The decoder needs no ring buffer, as everything decoded so far is at hand
+ * in dst. Output byte pos goes to ring position (N - F + pos) & (N - 1),
+ * so the distance back to ring position i is ((N - F + pos - i - 1) mod N) + 1.
+ * A distance past the start of the output refers to the initial ring
+ * contents, which are N - F spaces followed by F bytes the encoder never
+ * reads before writing them and that are taken as zeroes.
+ */
+static u_int8_t *copy_initial(
+    u_int8_t        * dst,
+    const u_int8_t  * dstend,
+    u_int32_t         pos,
+    u_int32_t         dist,
+    int               len)
+{
+    for (; len > 0 && dst < dstend; len--, pos++, dst++) {
+        if (dist > pos)
+            *dst = dist - pos <= N - F ? ' ' : 0;
+        else
+            *dst = dst[-(int32_t) dist];
+    }
+
+    return dst;
+}
+
+/*
+ * Decodes units from src to dst until either of them ends. Only complete
+ * units are consumed from src, so decoding may resume with more data
+ * appended after *srcp. dstbegin is the start of the whole output.
+ */
+static u_int8_t *decode_lzss(
+    struct decode_state *sp,
+    const u_int8_t  * dstbegin,
+    u_int8_t        * dst,
+    const u_int8_t  * dstend,
+    const u_int8_t ** srcp,
+    const u_int8_t  * srcend)
+{
+    const u_int8_t * src = *srcp;
+    u_int32_t  i, j, k, pos, dist;
     u_int8_t c;
     unsigned int flags;
 
-    if (dstlen > OC_COMPRESSION_MAX_LENGTH || srclen > OC_COMPRESSION_MAX_LENGTH) {
-        return 0;
-    }
+    flags = sp->flags;
+    while (dst < dstend) {
+        if ((flags & 0x100) == 0) {
+            /* decode eight units per flag byte while both buffers have room */
+            while (src < srcend && srcend - src > group_length[*src]
+                && dstend - dst >= GROUP_DST_MARGIN) {
+                c = *src++;
+                if (c == 0xFF) {
+                    copy8(dst, src);
+                    src += 8;
+                    dst += 8;
+                    continue;
+                }
+                for (k = 0; k < 8; k++, c >>= 1) {
+                    if (c & 1) {
+                        *dst++ = *src++;
+                        continue;
+                    }
+                    i = src[0] | ((src[1] & 0xF0) << 4);
+                    j = (src[1] & 0x0F) + THRESHOLD + 1;
+                    src += 2;
+                    pos = (u_int32_t)(dst - dstbegin);
+                    dist = ((N - F + pos - i - 1) & (N - 1)) + 1;
+                    if (dist > pos) {
+                        dst = copy_initial(dst, dstend, pos, dist, j);
+                    } else if (dist >= 8) {
+                        /* source stays behind dst, overrun is under 8 bytes */
+                        copy8(dst, dst - dist);
+                        if (j > 8)
+                            copy8(dst + 8, dst + 8 - dist);
+                        if (j > 16)
+                            copy8(dst + 16, dst + 16 - dist);
+                        dst += j;
+                    } else {
+                        for (; j > 0; j--, dst++)
+                            *dst = dst[-(int32_t) dist];
+                    }
+                }
+            }
 
-    dst = dststart;
-    memset(text_buf, ' ', N - F);
-    r = N - F;
-    flags = 0;
-    for ( ; ; ) {
-        if (((flags >>= 1) & 0x100) == 0) {
             if (src < srcend) c = *src++; else break;
             flags = c | 0xFF00;  /* uses higher byte cleverly */
         }   /* to count eight */
         if (flags & 1) {
             if (src < srcend) c = *src++; else break;
-            if (dst < dstend) *dst++ = c; else break;
-            text_buf[r++] = c;
-            r &= (N - 1);
+            *dst++ = c;
         } else {
-            if (src < srcend) i = *src++; else break;
-            if (src < srcend) j = *src++; else break;
+            if (srcend - src >= 2) { i = src[0]; j = src[1]; src += 2; } else break;
             i |= ((j & 0xF0) << 4);
-            j  =  (j & 0x0F) + THRESHOLD;
-            for (k = 0; k <= j; k++) {
-                c = text_buf[(i + k) & (N - 1)];
-                if (dst < dstend) *dst++ = c; else break;
-                text_buf[r++] = c;
-                r &= (N - 1);
-            }
+            j  =  (j & 0x0F) + THRESHOLD + 1;
+            pos = (u_int32_t)(dst - dstbegin);
+            dist = ((N - F + pos - i - 1) & (N - 1)) + 1;
+            dst = copy_initial(dst, dstend, pos, dist, j);
         }
+        flags >>= 1;
     }
 
-    return (u_int32_t)(dst - dststart);
+    sp->flags = flags;
+    *srcp = src;
+    return dst;
 }
 
-/*
- * initialize state, mostly the trees
- *
- * For i = 0 to N - 1, rchild[i] and lchild[i] will be the right and left
- * children of node i.  These nodes need not be initialized.  Also, parent[i]
- * is the parent of node i.  These are initialized to NIL (= N), which stands
- * for 'not used.'  For i = 0 to 255, rchild[N + i + 1] is the root of the
- * tree for strings that begin with character i.  These are initialized to NIL.
- * Note there are 256 trees. */
+/*******************************************************************************
+*******************************************************************************/
+u_int32_t decompress_lzss(
+    u_int8_t       * dst,
+    u_int32_t        dstlen,
+    u_int8_t       * src,
+    u_int32_t        srclen)
+{
+    struct decode_state state;
+    const u_int8_t * srcptr = src;
+    u_int8_t * dstptr;
+
+    if (dstlen > OC_COMPRESSION_MAX_LENGTH || srclen > OC_COMPRESSION_MAX_LENGTH) {
+        return 0;
+    }
+
+    init_decode_state(&state);
+    dstptr = decode_lzss(&state, dst, dst, dst + dstlen, &srcptr, src + srclen);
+
+    return (u_int32_t)(dstptr - dst);
+}
+
+/*******************************************************************************
+*******************************************************************************/
+u_int32_t decompress_lzss_stream(
+    u_int8_t           * dst,
+    u_int32_t            dstlen,
+    u_int32_t            srclen,
+    u_int32_t            blocksize,
+    OC_DECOMPRESS_READ   read,
+    void               * context,
+    u_int32_t          * adler)
+{
+    struct decode_state *sp;
+    u_int8_t * buffer;
+    const u_int8_t * srcptr;
+    u_int8_t * dstptr;
+    u_int8_t * decoded;
+    const u_int8_t * dstend = dst + dstlen;
+    u_int32_t offset, chunk, pending, checksum;
+
+    if (dstlen > OC_COMPRESSION_MAX_LENGTH || srclen > OC_COMPRESSION_MAX_LENGTH
+        || blocksize == 0 || blocksize > OC_COMPRESSION_MAX_LENGTH) {
+        return 0;
+    }
+
+    /* one extra byte for an incomplete position and length pair */
+    sp = (struct decode_state *) malloc(sizeof(*sp) + blocksize + 1);
+    if (!sp)
+        return 0;
+
+    buffer = (u_int8_t *) (sp + 1);
+    init_decode_state(sp);
+    dstptr = dst;
+    checksum = 1;
+    pending = 0;
+
+    for (offset = 0; offset < srclen && dstptr < dstend; offset += chunk) {
+        chunk = srclen - offset;
+        if (chunk > blocksize)
+            chunk = blocksize;
+        if (!read(context, offset, chunk, buffer + pending))
+            break;
+
+        srcptr = buffer;
+        decoded = dstptr;
+        dstptr = decode_lzss(sp, dst, dstptr, dstend, &srcptr, buffer + pending + chunk);
+
+        /* checksum freshly decoded data while it is still in cache */
+        if (adler)
+            checksum = Adler32Update(checksum, decoded, (u_int32_t)(dstptr - decoded));
+
+        pending = (u_int32_t)(buffer + pending + chunk - srcptr);
+        if (pending > 0)
+            buffer[0] = *srcptr;
+    }
+
+    free(sp);
+
+    if (adler)
+        *adler = checksum;
+
+    return (u_int32_t)(dstptr - dst);
+}
+
+static u_int32_t hash_string(const u_int8_t *p)
+{
+    return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761U) >> (32 - HASH_BITS);
+}
+
+/* initialize state, all hash chains are empty */
 static void init_state(struct encode_state *sp)
 {
-    bzero(sp, sizeof(*sp));
-    memset(&sp->text_buf[0], ' ', N - F);
-    bzero(&sp->rchild[N + 1], 256 * sizeof(sp->rchild[0]));
-    bzero(&sp->parent[0], N * sizeof(sp->parent[0]));
+    memset(sp->head, 0xFF, sizeof(sp->head));
 }
 
 /*
- * Inserts string of length F, text_buf[r..r+F-1], into one of the trees
- * (text_buf[r]'th tree) and returns the longest-match position and length
- * via the global variables match_position and match_length.
- * If match_length = F, then removes the old node in favor of the new one,
- * because the old one will be deleted sooner. Note r plays double role,
- * as tree node and position in buffer.
+ * Registers the string at src[pos], which must have at least three bytes.
+ * Chain links older than N positions get overwritten, but they are never
+ * followed, as find_match() stops at the window start.
  */
-static void insert_node(struct encode_state *sp, int r)
+static void insert_string(struct encode_state *sp, const u_int8_t *src, int32_t pos)
 {
-    int  i, p, cmp;
-    u_int8_t  *key;
-
-    cmp = 1;
-    key = &sp->text_buf[r];
-    p = N + 1 + key[0];
-    sp->rchild[r] = sp->lchild[r] = NIL;
-    sp->match_length = 0;
-    for ( ; ; ) {
-        if (cmp >= 0) {
-            if (sp->rchild[p] != NIL)
-                p = sp->rchild[p];
-            else {
-                sp->rchild[p] = r;
-                sp->parent[r] = p;
-                return;
-            }
-        } else {
-            if (sp->lchild[p] != NIL)
-                p = sp->lchild[p];
-            else {
-                sp->lchild[p] = r;
-                sp->parent[r] = p;
-                return;
-            }
-        }
-        for (i = 1; i < F; i++) {
-            if ((cmp = key[i] - sp->text_buf[p + i]) != 0)
-                break;
-        }
-        if (i > sp->match_length) {
-            sp->match_position = p;
-            if ((sp->match_length = i) >= F)
-                break;
-        }
-    }
-    sp->parent[r] = sp->parent[p];
-    sp->lchild[r] = sp->lchild[p];
-    sp->rchild[r] = sp->rchild[p];
-    sp->parent[sp->lchild[p]] = r;
-    sp->parent[sp->rchild[p]] = r;
-    if (sp->rchild[sp->parent[p]] == p)
-        sp->rchild[sp->parent[p]] = r;
-    else
-        sp->lchild[sp->parent[p]] = r;
-    sp->parent[p] = NIL;  /* remove p */
+    u_int32_t h;
+
+    h = hash_string(&src[pos]);
+    sp->prev[pos & (N - 1)] = sp->head[h];
+    sp->head[h] = pos;
 }
 
-/* deletes node p from tree */
-static void delete_node(struct encode_state *sp, int p)
+/*
+ * Returns the length of the longest match for src[pos..] among the
+ * last max_chain strings with the same hash, setting *match_position.
+ * Matches are kept within N - F bytes behind pos, like the ring buffer of
+ * the reference encoder, and shorter than THRESHOLD + 1 are not reported.
+ */
+static int find_match(
+    struct encode_state *sp,
+    const u_int8_t  * src,
+    int32_t           pos,
+    int32_t           srclen,
+    int               max_chain,
+    int32_t         * match_position)
 {
-    int  q;
-
-    if (sp->parent[p] == NIL)
-        return;  /* not in tree */
-    if (sp->rchild[p] == NIL)
-        q = sp->lchild[p];
-    else if (sp->lchild[p] == NIL)
-        q = sp->rchild[p];
-    else {
-        q = sp->lchild[p];
-        if (sp->rchild[q] != NIL) {
-            do {
-                q = sp->rchild[q];
-            } while (sp->rchild[q] != NIL);
-            sp->rchild[sp->parent[q]] = sp->lchild[q];
-            sp->parent[sp->lchild[q]] = sp->parent[q];
-            sp->lchild[q] = sp->lchild[p];
-            sp->parent[sp->lchild[p]] = q;
+    const u_int8_t * key = &src[pos];
+    const u_int8_t * cur;
+    int32_t  cand, limit;
+    int  i, best, max_length;
+
+    max_length = srclen - pos;
+    if (max_length > F)
+        max_length = F;
+    if (max_length <= THRESHOLD)
+        return 0;
+
+    limit = pos - (N - F);
+    best = THRESHOLD;
+    cand = sp->head[hash_string(key)];
+    while (cand != NIL && cand >= limit && max_chain-- > 0) {
+        cur = &src[cand];
+        /* a longer match must also differ from best at its last byte */
+        if (cur[best] == key[best] && cur[0] == key[0]) {
+            for (i = 1; i < max_length && cur[i] == key[i]; i++)
+                ;
+            if (i > best) {
+                best = i;
+                *match_position = cand;
+                if (i >= max_length)
+                    break;
+            }
         }
-        sp->rchild[q] = sp->rchild[p];
-        sp->parent[sp->rchild[p]] = q;
+        cand = sp->prev[cand & (N - 1)];
     }
-    sp->parent[q] = sp->parent[p];
-    if (sp->rchild[sp->parent[p]] == p)
-        sp->rchild[sp->parent[p]] = q;
-    else
-        sp->lchild[sp->parent[p]] = q;
-    sp->parent[p] = NIL;
+
+    return best > THRESHOLD ? best : 0;
 }
 
 /*******************************************************************************
 *******************************************************************************/
-u_int8_t * compress_lzss(
+u_int8_t * compress_lzss_ex(
     u_int8_t       * dst,
     u_int32_t        dstlen,
     u_int8_t       * src,
-    u_int32_t        srclen)
+    u_int32_t        srclen,
+    u_int32_t        effort)
 {
     u_int8_t * result = NULL;
-    /* Encoding state, mostly tree but some current match stuff */
-    struct encode_state *sp;
+    /* Encoding state, hash chains of recent strings */
+    struct encode_state *sp = NULL;
 
-    int  i, len, r, s, last_match_length, code_buf_ptr;
-    u_int8_t c;
+    int  i, len, next_len, code_buf_ptr, max_chain, lazy, have_match;
+    int32_t  pos, position, next_position, ring_position;
     u_int8_t code_buf[17], mask;
-    u_int8_t * srcend = src + srclen;
     u_int8_t *dstend = dst + dstlen;
 
     if (dstlen > OC_COMPRESSION_MAX_LENGTH || srclen > OC_COMPRESSION_MAX_LENGTH) {
         return NULL;
     }
 
-    /* initialize trees */
+    if (!srclen)
+        goto finish;
+
+    if (effort < OC_LZSS_EFFORT_MIN)
+        effort = OC_LZSS_EFFORT_MIN;
+    else if (effort > OC_LZSS_EFFORT_MAX)
+        effort = OC_LZSS_EFFORT_MAX;
+
+    /*
+     * Each effort level doubles the number of chain entries examined,
+     * and from the default level on a match is deferred by one byte
+     * if a longer one starts there.
+     */
+    max_chain = 1 << effort;
+    lazy = effort >= OC_LZSS_EFFORT_DEFAULT;
+
+    /* state is per call, so independent buffers may be compressed in parallel */
     sp = (struct encode_state *) malloc(sizeof(*sp));
     if (!sp) goto finish;
 
@@ -282,91 +453,66 @@ u_int8_t * compress_lzss(
     code_buf[0] = 0;
     code_buf_ptr = mask = 1;
 
-    /* Clear the buffer with any character that will appear often. */
-    s = 0;  r = N - F;
-
-    /* Read F bytes into the last F bytes of the buffer */
-    for (len = 0; len < F && src < srcend; len++)
-        sp->text_buf[r + len] = *src++;
-    if (!len)
-        goto finish;
-
-    /*
-     * Insert the F strings, each of which begins with one or more
-     * 'space' characters.  Note the order in which these strings are
-     * inserted.  This way, degenerate trees will be less likely to occur.
-     */
-    for (i = 1; i <= F; i++)
-        insert_node(sp, r - i);
+    len = 0;
+    position = 0;
+    have_match = 0;
+    pos = 0;
+    while (pos < (int32_t) srclen) {
+        if (!have_match)
+            len = find_match(sp, src, pos, (int32_t) srclen, max_chain, &position);
+        have_match = 0;
+
+        if (pos + THRESHOLD < (int32_t) srclen)
+            insert_string(sp, src, pos);
+
+        if (len && lazy && len < F) {
+            next_len = find_match(sp, src, pos + 1, (int32_t) srclen, max_chain, &next_position);
+            if (next_len > len) {
+                /* Send one byte now and the longer match right after it. */
+                len = 0;
+                have_match = 1;
+            }
+        }
 
-    /*
-     * Finally, insert the whole string just read.
-     * The global variables match_length and match_position are set.
-     */
-    insert_node(sp, r);
-    do {
-        /* match_length may be spuriously long near the end of text. */
-        if (sp->match_length > len)
-            sp->match_length = len;
-        if (sp->match_length <= THRESHOLD) {
-            sp->match_length = 1;  /* Not long enough match.  Send one byte. */
+        if (!len) {
             code_buf[0] |= mask;  /* 'send one byte' flag */
-            code_buf[code_buf_ptr++] = sp->text_buf[r];  /* Send uncoded. */
+            code_buf[code_buf_ptr++] = src[pos];  /* Send uncoded. */
+            pos++;
         } else {
-            /* Send position and length pair. Note match_length > THRESHOLD. */
-            code_buf[code_buf_ptr++] = (u_int8_t) sp->match_position;
+            /* Send position and length pair. Note len > THRESHOLD. */
+            ring_position = (N - F + position) & (N - 1);
+            code_buf[code_buf_ptr++] = (u_int8_t) ring_position;
             code_buf[code_buf_ptr++] = (u_int8_t)
-                ( ((sp->match_position >> 4) & 0xF0)
-                |  (sp->match_length - (THRESHOLD + 1)) );
+                ( ((ring_position >> 4) & 0xF0)
+                |  (len - (THRESHOLD + 1)) );
+            for (i = 1; i < len; i++) {
+                if (pos + i + THRESHOLD < (int32_t) srclen)
+                    insert_string(sp, src, pos + i);
+            }
+            pos += len;
+        }
+
+        if (have_match) {
+            len = next_len;
+            position = next_position;
         }
+
         if ((mask <<= 1) == 0) {  /* Shift mask left one bit. */
                 /* Send at most 8 units of code together */
+            if (dstend - dst < code_buf_ptr)
+                goto finish;
             for (i = 0; i < code_buf_ptr; i++)
-                if (dst < dstend)
-                    *dst++ = code_buf[i];
-                else
-                    goto finish;
+                *dst++ = code_buf[i];
             code_buf[0] = 0;
             code_buf_ptr = mask = 1;
         }
-        last_match_length = sp->match_length;
-        for (i = 0; i < last_match_length && src < srcend; i++) {
-            delete_node(sp, s);    /* Delete old strings and */
-            c = *src++;
-            sp->text_buf[s] = c;    /* read new bytes */
-
-            /*
-             * If the position is near the end of buffer, extend the buffer
-             * to make string comparison easier.
-             */
-            if (s < F - 1)
-                sp->text_buf[s + N] = c;
-
-            /* Since this is a ring buffer, increment the position modulo N. */
-            s = (s + 1) & (N - 1);
-            r = (r + 1) & (N - 1);
-
-            /* Register the string in text_buf[r..r+F-1] */
-            insert_node(sp, r);
-        }
-        while (i++ < last_match_length) {
-        delete_node(sp, s);
-
-            /* After the end of text, no need to read, */
-            s = (s + 1) & (N - 1);
-            r = (r + 1) & (N - 1);
-            /* but buffer may not be empty. */
-            if (--len)
-                insert_node(sp, r);
-        }
-    } while (len > 0);   /* until length of string to be processed is zero */
+    }
 
     if (code_buf_ptr > 1) {    /* Send remaining code. */
+        if (dstend - dst < code_buf_ptr)
+            goto finish;
         for (i = 0; i < code_buf_ptr; i++)
-            if (dst < dstend)
-                *dst++ = code_buf[i];
-            else
-                goto finish;
+            *dst++ = code_buf[i];
     }
 
     result = dst;
@@ -376,3 +522,14 @@ finish:
 
     return result;
 }
+
+/*******************************************************************************
+*******************************************************************************/
+u_int8_t * compress_lzss(
+    u_int8_t       * dst,
+    u_int32_t        dstlen,
+    u_int8_t       * src,
+    u_int32_t        srclen)
+{
+    return compress_lzss_ex(dst, dstlen, src, srclen, OC_LZSS_EFFORT_DEFAULT);
+}
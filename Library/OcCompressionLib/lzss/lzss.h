@@ -20,7 +20,9 @@
 #include <Library/OcCompressionLib.h>
 
 #define compress_lzss CompressLZSS
+#define compress_lzss_ex CompressLZSSEx
 #define decompress_lzss DecompressLZSS
+#define decompress_lzss_stream DecompressLZSSStream
 
 #ifdef EFIUSER
 #include <stdint.h>
@@ -45,6 +47,11 @@ typedef INT32 int32_t;
 #undef free
 #endif
 
+#ifdef memcpy
+#undef memcpy
+#endif
+
+#define memcpy(Dst, Src, Size) CopyMem ((Dst), (Src), (Size))
 #define memset(Dst, Val, Size) SetMem ((Dst), (Size), (Val))
 #define malloc(Size) AllocatePool (Size)
 #define free(Ptr) FreePool (Ptr)
@@ -53,6 +60,7 @@ typedef INT32 int32_t;
 typedef UINT8  u_int8_t;
 typedef UINT16 u_int16_t;
 typedef UINT32 u_int32_t;
+typedef UINT64 u_int64_t;
 
 #ifdef bzero
 #undef bzero
@@ -76,6 +76,35 @@ typedef struct {
 
 } lzvn_decoder_state;
 
+#if defined(__GNUC__) || defined(__clang__)
+//  memcpy maps to an out of line CopyMem call in firmware, so use unaligned
+//  types to let the compiler emit plain loads and stores.
+typedef uint16_t __attribute__((__aligned__(1), __may_alias__)) lzvn_unaligned_u16;
+typedef uint32_t __attribute__((__aligned__(1), __may_alias__)) lzvn_unaligned_u32;
+typedef uint64_t __attribute__((__aligned__(1), __may_alias__)) lzvn_unaligned_u64;
+
+/*! @abstract Load bytes from memory location SRC. */
+LZFSE_INLINE uint16_t load2(const void *ptr) {
+  return *(const lzvn_unaligned_u16 *)ptr;
+}
+
+LZFSE_INLINE uint32_t load4(const void *ptr) {
+  return *(const lzvn_unaligned_u32 *)ptr;
+}
+
+LZFSE_INLINE uint64_t load8(const void *ptr) {
+  return *(const lzvn_unaligned_u64 *)ptr;
+}
+
+/*! @abstract Store bytes to memory location DST. */
+LZFSE_INLINE void store4(void *ptr, uint32_t data) {
+  *(lzvn_unaligned_u32 *)ptr = data;
+}
+
+LZFSE_INLINE void store8(void *ptr, uint64_t data) {
+  *(lzvn_unaligned_u64 *)ptr = data;
+}
+#else
 /*! @abstract Load bytes from memory location SRC. */
 LZFSE_INLINE uint16_t load2(const void *ptr) {
   uint16_t data;
@@ -103,6 +132,15 @@ LZFSE_INLINE void store4(void *ptr, uint32_t data) {
 LZFSE_INLINE void store8(void *ptr, uint64_t data) {
   memcpy(ptr, &data, sizeof data);
 }
+#endif
+
+/*! @abstract Copy 16 bytes from SRC to DST, which must not overlap. */
+LZFSE_INLINE void copy16(void *dst, const void *src) {
+  uint64_t lo = load8(src);
+  uint64_t hi = load8((const unsigned char *)src + 8);
+  store8(dst, lo);
+  store8((unsigned char *)dst + 8, hi);
+}
 
 /*! @abstract Extracts \p width bits from \p container, starting with \p lsb; if
  * we view \p container as a bit array, we extract \c container[lsb:lsb+width]. */
@@ -817,6 +855,191 @@ invalid_match_distance:
 #endif
 }
 
+//  Safety margins of the fast path. Every instruction is at most 3 opcode
+//  bytes followed by 271 literal bytes, and produces at most 271 literal or
+//  3 literal and 271 match bytes. Wildcopies may write up to 15 bytes past
+//  the end of a literal or a match, and read up to 15 bytes past a literal.
+#define LZVN_FAST_SRC_MARGIN (3 + 271 + 16)
+#define LZVN_FAST_DST_MARGIN (3 + 271 + 16)
+
+/*! @abstract Opcode classes for the fast path. */
+enum {
+  LZVN_SML_D,
+  LZVN_MED_D,
+  LZVN_LRG_D,
+  LZVN_PRE_D,
+  LZVN_SML_L,
+  LZVN_LRG_L,
+  LZVN_SML_M,
+  LZVN_LRG_M,
+  LZVN_NOP,
+  LZVN_OTHER
+};
+
+/*! @abstract Opcode classes, LZVN_OTHER is end-of-stream or undefined. */
+static const unsigned char lzvn_opc_class[256] = {
+#define D LZVN_SML_D
+#define E LZVN_MED_D
+#define G LZVN_LRG_D
+#define P LZVN_PRE_D
+#define O LZVN_OTHER
+#define N LZVN_NOP
+  D, D, D, D, D, D, O, G, D, D, D, D, D, D, N, G,
+  D, D, D, D, D, D, N, G, D, D, D, D, D, D, O, G,
+  D, D, D, D, D, D, O, G, D, D, D, D, D, D, O, G,
+  D, D, D, D, D, D, O, G, D, D, D, D, D, D, O, G,
+  D, D, D, D, D, D, P, G, D, D, D, D, D, D, P, G,
+  D, D, D, D, D, D, P, G, D, D, D, D, D, D, P, G,
+  D, D, D, D, D, D, P, G, D, D, D, D, D, D, P, G,
+  O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+  D, D, D, D, D, D, P, G, D, D, D, D, D, D, P, G,
+  D, D, D, D, D, D, P, G, D, D, D, D, D, D, P, G,
+  E, E, E, E, E, E, E, E, E, E, E, E, E, E, E, E,
+  E, E, E, E, E, E, E, E, E, E, E, E, E, E, E, E,
+  D, D, D, D, D, D, P, G, D, D, D, D, D, D, P, G,
+  O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+#undef D
+#undef E
+#undef G
+#undef P
+#undef O
+#undef N
+  LZVN_LRG_L, LZVN_SML_L, LZVN_SML_L, LZVN_SML_L,
+  LZVN_SML_L, LZVN_SML_L, LZVN_SML_L, LZVN_SML_L,
+  LZVN_SML_L, LZVN_SML_L, LZVN_SML_L, LZVN_SML_L,
+  LZVN_SML_L, LZVN_SML_L, LZVN_SML_L, LZVN_SML_L,
+  LZVN_LRG_M, LZVN_SML_M, LZVN_SML_M, LZVN_SML_M,
+  LZVN_SML_M, LZVN_SML_M, LZVN_SML_M, LZVN_SML_M,
+  LZVN_SML_M, LZVN_SML_M, LZVN_SML_M, LZVN_SML_M,
+  LZVN_SML_M, LZVN_SML_M, LZVN_SML_M, LZVN_SML_M
+};
+
+/*! @abstract Decode source to destination while both are far from their
+ *  end, using wide copies that may overrun literals and matches.
+ *  Stops at the first instruction it cannot handle (end-of-stream, invalid
+ *  data, or the end of either buffer being near), leaving \p state at the
+ *  beginning of that instruction for lzvn_decode to continue. */
+static void lzvn_decode_fast(lzvn_decoder_state *state) {
+  const unsigned char *src_ptr = state->src;
+  const unsigned char *src_limit;
+  const unsigned char *src_prev = src_ptr;
+  unsigned char *dst_ptr = state->dst;
+  unsigned char *dst_limit;
+  unsigned char *dst_prev = dst_ptr;
+  size_t D = state->d_prev;
+  size_t D_prev = D;
+  size_t L, M, N, opc_len, i;
+  unsigned char opc;
+  uint16_t opc23;
+
+  if ((size_t)(state->src_end - src_ptr) <= LZVN_FAST_SRC_MARGIN ||
+      (size_t)(state->dst_end - dst_ptr) <= LZVN_FAST_DST_MARGIN)
+    return;
+
+  src_limit = state->src_end - LZVN_FAST_SRC_MARGIN;
+  dst_limit = state->dst_end - LZVN_FAST_DST_MARGIN;
+
+  while (src_ptr < src_limit && dst_ptr < dst_limit) {
+    opc = src_ptr[0];
+    if (lzvn_opc_class[opc] == LZVN_OTHER) {
+      //  End-of-stream and undefined opcodes are left to lzvn_decode.
+      //  It reports undefined opcodes at the beginning of the preceding
+      //  instruction, so restart from there to return the same result.
+      src_ptr = src_prev;
+      dst_ptr = dst_prev;
+      D = D_prev;
+      break;
+    }
+    src_prev = src_ptr;
+    dst_prev = dst_ptr;
+    D_prev = D;
+    switch (lzvn_opc_class[opc]) {
+    case LZVN_SML_D:
+      opc_len = 2;
+      L = (size_t)extract(opc, 6, 2);
+      M = (size_t)extract(opc, 3, 3) + 3;
+      N = (size_t)extract(opc, 0, 3) << 8 | src_ptr[1];
+      break;
+    case LZVN_MED_D:
+      opc_len = 3;
+      L = (size_t)extract(opc, 3, 2);
+      opc23 = load2(&src_ptr[1]);
+      M = (size_t)((extract(opc, 0, 3) << 2 | extract(opc23, 0, 2)) + 3);
+      N = (size_t)extract(opc23, 2, 14);
+      break;
+    case LZVN_LRG_D:
+      opc_len = 3;
+      L = (size_t)extract(opc, 6, 2);
+      M = (size_t)extract(opc, 3, 3) + 3;
+      N = load2(&src_ptr[1]);
+      break;
+    case LZVN_PRE_D:
+      opc_len = 1;
+      L = (size_t)extract(opc, 6, 2);
+      M = (size_t)extract(opc, 3, 3) + 3;
+      N = D;
+      break;
+    case LZVN_SML_L:
+    case LZVN_LRG_L:
+      if (opc == 0xE0) {
+        opc_len = 2;
+        L = src_ptr[1] + 16;
+      } else {
+        opc_len = 1;
+        L = (size_t)extract(opc, 0, 4);
+      }
+      src_ptr += opc_len;
+      for (i = 0; i < L; i += 16)
+        copy16(&dst_ptr[i], &src_ptr[i]);
+      src_ptr += L;
+      dst_ptr += L;
+      continue;
+    case LZVN_SML_M:
+      opc_len = 1;
+      L = 0;
+      M = (size_t)extract(opc, 0, 4);
+      N = D;
+      break;
+    case LZVN_LRG_M:
+      opc_len = 2;
+      L = 0;
+      M = src_ptr[1] + 16;
+      N = D;
+      break;
+    case LZVN_NOP:
+    default:
+      src_ptr += 1;
+      continue;
+    }
+
+    //  Literal of at most 3 bytes, and match with distance N. Leave
+    //  instructions referencing data before the output to lzvn_decode.
+    if (N > (size_t)(dst_ptr + L - state->dst_begin) || N == 0)
+      break;
+    D = N;
+
+    store4(dst_ptr, load4(src_ptr + opc_len));
+    src_ptr += opc_len + L;
+    dst_ptr += L;
+
+    if (D >= 16) {
+      for (i = 0; i < M; i += 16)
+        copy16(&dst_ptr[i], dst_ptr + i - D);
+    } else if (D >= 8) {
+      for (i = 0; i < M; i += 8)
+        store8(&dst_ptr[i], load8(dst_ptr + i - D));
+    } else {
+      for (i = 0; i < M; ++i)
+        dst_ptr[i] = *(dst_ptr + i - D);
+    }
+    dst_ptr += M;
+  }
+
+  state->src = src_ptr;
+  state->dst = dst_ptr;
+  state->d_prev = D;
+}
+
 size_t lzvn_decode_buffer(unsigned char *dst, size_t dst_size,
                           const unsigned char *src, size_t src_size) {
   // Init LZVN decoder state
@@ -837,9 +1060,95 @@ size_t lzvn_decode_buffer(unsigned char *dst, size_t dst_size,
   dstate.d_prev = 0;
   dstate.end_of_stream = 0;
 
-  // Run LZVN decoder
+  // Run the fast path over the bulk of the data, and finish the
+  // remaining instructions with the full LZVN decoder
+  lzvn_decode_fast(&dstate);
   lzvn_decode(&dstate);
 
   // This is how much we decompressed
   return dstate.dst - dst;
 }
+
+//  Largest amount of unconsumed source bytes lzvn_decode may leave behind on
+//  a valid stream: the longest literal opcode with its literal, and the first
+//  byte of the next opcode. Anything longer means the stream is invalid.
+#define LZVN_STREAM_MAX_PENDING 512
+
+UINT32 lzvn_decode_stream(unsigned char *dst, UINT32 dst_size,
+                          UINT32 src_size, UINT32 block_size,
+                          OC_DECOMPRESS_READ read, void *context,
+                          UINT32 *adler) {
+  lzvn_decoder_state dstate;
+  unsigned char *buffer;
+  unsigned char *hashed;
+  size_t pending;
+  UINT32 offset;
+  UINT32 chunk;
+  UINT32 checksum;
+
+  if (dst_size > OC_COMPRESSION_MAX_LENGTH || src_size > OC_COMPRESSION_MAX_LENGTH
+    || block_size == 0 || block_size > OC_COMPRESSION_MAX_LENGTH) {
+    return 0;
+  }
+
+  buffer = AllocatePool(block_size + LZVN_STREAM_MAX_PENDING);
+  if (buffer == NULL) {
+    return 0;
+  }
+
+  memset(&dstate, 0x00, sizeof(dstate));
+  dstate.src = buffer;
+  dstate.src_end = buffer;
+
+  dstate.dst_begin = dst;
+  dstate.dst = dst;
+  dstate.dst_end = dst + dst_size;
+
+  offset = 0;
+  hashed = dst;
+  checksum = 1;
+
+  while (offset < src_size) {
+    //  Move the unconsumed tail of the previous block to the front
+    //  and append the next block of compressed data after it.
+    pending = dstate.src_end - dstate.src;
+    if (pending > LZVN_STREAM_MAX_PENDING)
+      break; // invalid stream
+    memmove(buffer, dstate.src, pending);
+
+    chunk = src_size - offset;
+    if (chunk > block_size)
+      chunk = block_size;
+    if (!read(context, offset, chunk, buffer + pending))
+      break; // read failure
+    offset += chunk;
+
+    dstate.src = buffer;
+    dstate.src_end = buffer + pending + chunk;
+
+    //  Run the fast path while the block and the output are far from their
+    //  end, and finish the block with the full LZVN decoder, which keeps
+    //  the truncated instruction at the block end for the next round.
+    if (dstate.L == 0 && dstate.M == 0)
+      lzvn_decode_fast(&dstate);
+    lzvn_decode(&dstate);
+
+    //  Checksum freshly decoded data while it is still in cache.
+    if (adler != NULL) {
+      checksum = Adler32Update(checksum, hashed, (UINT32)(dstate.dst - hashed));
+      hashed = dstate.dst;
+    }
+
+    if (dstate.end_of_stream || dstate.dst == dstate.dst_end)
+      break;
+  }
+
+  FreePool(buffer);
+
+  if (adler != NULL) {
+    *adler = checksum;
+  }
+
+  // This is how much we decompressed
+  return (UINT32)(dstate.dst - dst);
+}
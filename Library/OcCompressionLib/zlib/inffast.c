@@ -12,6 +12,31 @@
 #  pragma message("Assembler code may have bugs -- use at your own risk")
 #else
 
+/*
+   The bit buffer is refilled a word at a time and matches at least a word
+   behind are copied a word at a time. Both rely on little endian unaligned
+   loads, which all supported targets provide.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+/*
+   zmemcpy maps to an out of line CopyMem call, so use unaligned types
+   to let the compiler emit plain loads and stores.
+ */
+typedef UINT64 __attribute__((__aligned__(1), __may_alias__)) unaligned_u64;
+
+#define load64(src) (*(const unaligned_u64 *)(src))
+#define copy8(dst, src) (*(unaligned_u64 *)(dst) = *(const unaligned_u64 *)(src))
+#else
+local UINT64 load64(const unsigned char FAR *src)
+{
+    UINT64 data;
+    zmemcpy(&data, src, sizeof(data));
+    return data;
+}
+
+#define copy8(dst, src) zmemcpy((dst), (src), 8)
+#endif
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -23,7 +48,7 @@
    Entry assumptions:
 
         state->mode == LEN
-        strm->avail_in >= 6
+        strm->avail_in >= 8
         strm->avail_out >= 258
         start >= strm->avail_out
         state->bits < 8
@@ -40,7 +65,9 @@
       length code, 5 bits for the length extra, 15 bits for the distance code,
       and 13 bits for the distance extra.  This totals 48 bits, or six bytes.
       Therefore if strm->avail_in >= 6, then there is enough input to avoid
-      checking for available input while decoding.
+      checking for available input while decoding.  The bit buffer is refilled
+      with eight byte loads to at least 56 bits once per code, which requires
+      strm->avail_in >= 8 instead.
 
     - The maximum bytes that a single length/distance pair can output is 258
       bytes, which is the maximum length that can be coded.  inflate_fast()
@@ -64,7 +91,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     unsigned whave;             /* valid bytes in the window */
     unsigned wnext;             /* window write index */
     unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
-    unsigned long hold;         /* local strm->hold */
+    UINT64 hold;                /* local strm->hold, 64 bits for refills */
     unsigned bits;              /* local strm->bits */
     code const FAR *lcode;      /* local strm->lencode */
     code const FAR *dcode;      /* local strm->distcode */
@@ -80,7 +107,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     /* copy state to local variables */
     state = (struct inflate_state FAR *)strm->state;
     in = strm->next_in;
-    last = in + (strm->avail_in - 5);
+    last = in + (strm->avail_in - 7);
     out = strm->next_out;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
@@ -101,12 +128,10 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
-        if (bits < 15) {
-            hold += (unsigned long)(*in++) << bits;
-            bits += 8;
-            hold += (unsigned long)(*in++) << bits;
-            bits += 8;
-        }
+        /* Bits above bits are the next input bits, so ORing them is safe. */
+        hold |= load64(in) << bits;
+        in += (63 - bits) >> 3;
+        bits |= 56;
         here = lcode + (hold & lmask);
       dolen:
         op = (unsigned)(here->bits);
@@ -123,21 +148,11 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
             len = (unsigned)(here->val);
             op &= 15;                           /* number of extra bits */
             if (op) {
-                if (bits < op) {
-                    hold += (unsigned long)(*in++) << bits;
-                    bits += 8;
-                }
                 len += (unsigned)hold & ((1U << op) - 1);
                 hold >>= op;
                 bits -= op;
             }
             Tracevv((stderr, "inflate:         length %u\n", len));
-            if (bits < 15) {
-                hold += (unsigned long)(*in++) << bits;
-                bits += 8;
-                hold += (unsigned long)(*in++) << bits;
-                bits += 8;
-            }
             here = dcode + (hold & dmask);
           dodist:
             op = (unsigned)(here->bits);
@@ -147,14 +162,6 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
             if (op & 16) {                      /* distance base */
                 dist = (unsigned)(here->val);
                 op &= 15;                       /* number of extra bits */
-                if (bits < op) {
-                    hold += (unsigned long)(*in++) << bits;
-                    bits += 8;
-                    if (bits < op) {
-                        hold += (unsigned long)(*in++) << bits;
-                        bits += 8;
-                    }
-                }
                 dist += (unsigned)hold & ((1U << op) - 1);
 #ifdef INFLATE_STRICT
                 if (dist > dmax) {
@@ -248,6 +255,19 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                             *out++ = *from++;
                     }
                 }
+                else if (dist >= 8 && len >= 8) {
+                    /* source stays a word behind, the last word overlaps */
+                    from = out - dist;          /* copy direct from output */
+                    op = len;
+                    while (op > 8) {
+                        copy8(out, from);
+                        out += 8;
+                        from += 8;
+                        op -= 8;
+                    }
+                    copy8(out + op - 8, from + op - 8);
+                    out += op;
+                }
                 else {
                     from = out - dist;          /* copy direct from output */
                     do {                        /* minimum length is three */
@@ -293,15 +313,15 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     len = bits >> 3;
     in -= len;
     bits -= len << 3;
-    hold &= (1U << bits) - 1;
+    hold &= ((UINT64)1 << bits) - 1;
 
     /* update state and return */
     strm->next_in = in;
     strm->next_out = out;
-    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
+    strm->avail_in = (unsigned)(in < last ? 7 + (last - in) : 7 - (in - last));
     strm->avail_out = (unsigned)(out < end ?
                                  257 + (end - out) : 257 - (out - end));
-    state->hold = hold;
+    state->hold = (unsigned long)hold;
     state->bits = bits;
     return;
 }
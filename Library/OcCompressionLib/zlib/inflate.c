@@ -1071,7 +1071,7 @@ int flush;
         case LEN_:
             state->mode = LEN;
         case LEN:
-            if (have >= 6 && left >= 258) {
+            if (have >= 8 && left >= 258) {
                 RESTORE();
                 inflate_fast(strm, out);
                 LOAD();
@@ -17,6 +17,10 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/OcCompressionLib.h>
 
+struct OC_ZLIB_DECOMPRESS_STATE_ {
+  z_stream  Stream;
+};
+
 voidpf ZLIB_INTERNAL zcalloc (opaque, items, size)
     voidpf opaque;
     unsigned items;
@@ -76,6 +80,70 @@ DecompressZLIB (
   return 0;
 }
 
+OC_ZLIB_DECOMPRESS_STATE *
+CreateZLIBDecompressState (
+  VOID
+  )
+{
+  OC_ZLIB_DECOMPRESS_STATE  *State;
+
+  State = AllocateZeroPool (sizeof (*State));
+  if (State == NULL) {
+    return NULL;
+  }
+
+  if (inflateInit (&State->Stream) != Z_OK) {
+    FreePool (State);
+    return NULL;
+  }
+
+  return State;
+}
+
+VOID
+FreeZLIBDecompressState (
+  IN OC_ZLIB_DECOMPRESS_STATE  *State
+  )
+{
+  inflateEnd (&State->Stream);
+  FreePool (State);
+}
+
+UINTN
+DecompressZLIBWithState (
+  IN OUT OC_ZLIB_DECOMPRESS_STATE  *State,
+  OUT    UINT8                     *Dst,
+  IN     UINTN                     DstLen,
+  IN     CONST UINT8               *Src,
+  IN     UINTN                     SrcLen
+  )
+{
+  z_stream  *Stream;
+
+  if (SrcLen > OC_COMPRESSION_MAX_LENGTH || DstLen > OC_COMPRESSION_MAX_LENGTH) {
+    return 0;
+  }
+
+  //
+  // Reset keeps the allocated state and window, unlike uncompress.
+  //
+  Stream = &State->Stream;
+  if (inflateReset (Stream) != Z_OK) {
+    return 0;
+  }
+
+  Stream->next_in   = (z_const Bytef *) Src;
+  Stream->avail_in  = (uInt) SrcLen;
+  Stream->next_out  = Dst;
+  Stream->avail_out = (uInt) DstLen;
+
+  if (inflate (Stream, Z_FINISH) == Z_STREAM_END) {
+    return Stream->total_out;
+  }
+
+  return 0;
+}
+
 UINT32
 Adler32 (
   IN CONST UINT8  *Buffer,
@@ -84,3 +152,13 @@ Adler32 (
 {
   return adler32 (1, Buffer, BufferLen);
 }
+
+UINT32
+Adler32Update (
+  IN UINT32       Adler,
+  IN CONST UINT8  *Buffer,
+  IN UINT32       BufferLen
+  )
+{
+  return adler32 (Adler, Buffer, BufferLen);
+}
@@ -375,6 +375,7 @@ mKernelQuirksSchema[] = {
 STATIC
 OC_SCHEMA
 mKernelSchemeSchema[] = {
+  OC_SCHEMA_BOOLEAN_IN ("CachePatchedKernel", OC_GLOBAL_CONFIG, Kernel.Scheme.CachePatchedKernel),
   OC_SCHEMA_BOOLEAN_IN ("CustomKernel",       OC_GLOBAL_CONFIG, Kernel.Scheme.CustomKernel),
   OC_SCHEMA_BOOLEAN_IN ("FuzzyMatch",         OC_GLOBAL_CONFIG, Kernel.Scheme.FuzzyMatch),
   OC_SCHEMA_STRING_IN  ("KernelArch",         OC_GLOBAL_CONFIG, Kernel.Scheme.KernelArch),
@@ -448,6 +449,7 @@ mMiscConfigurationSecuritySchema[] = {
   OC_SCHEMA_INTEGER_IN ("HaltLevel",            OC_GLOBAL_CONFIG, Misc.Security.HaltLevel),
   OC_SCHEMA_DATAF_IN   ("PasswordHash",         OC_GLOBAL_CONFIG, Misc.Security.PasswordHash),
   OC_SCHEMA_DATA_IN    ("PasswordSalt",         OC_GLOBAL_CONFIG, Misc.Security.PasswordSalt),
+  OC_SCHEMA_BOOLEAN_IN ("PreverifyVault",       OC_GLOBAL_CONFIG, Misc.Security.PreverifyVault),
   OC_SCHEMA_INTEGER_IN ("ScanPolicy",           OC_GLOBAL_CONFIG, Misc.Security.ScanPolicy),
   OC_SCHEMA_STRING_IN  ("SecureBootModel",      OC_GLOBAL_CONFIG, Misc.Security.SecureBootModel),
   OC_SCHEMA_STRING_IN  ("Vault",                OC_GLOBAL_CONFIG, Misc.Security.Vault),
@@ -50,6 +50,45 @@ BigNumWordMul (
   IN  OC_BN_WORD  B
   );
 
+/**
+  Calculates a row of the Montgomery product of A and B mod N with the BMI2
+  and ADX instruction set extensions. Must only be called when
+  BigNumIsAdxSupported returned TRUE.
+
+  @param[in,out] Result    The result buffer.
+  @param[in]     NumWords  The number of Words of Result, B and N.
+  @param[in]     AWord     The current row's Word of the multiplicant.
+  @param[in]     B         The multiplier.
+  @param[in]     N         The modulus.
+  @param[in]     N0Inv     The Montgomery Inverse of N.
+
+  @returns  Whether Result has wrapped around and must be reduced by N.
+
+**/
+BOOLEAN
+EFIAPI
+BigNumMontMulRowAdx (
+  IN OUT OC_BN_WORD        *Result,
+  IN     OC_BN_NUM_WORDS   NumWords,
+  IN     OC_BN_WORD        AWord,
+  IN     CONST OC_BN_WORD  *B,
+  IN     CONST OC_BN_WORD  *N,
+  IN     OC_BN_WORD        N0Inv
+  );
+
+/**
+  Returns whether the BMI2 and ADX instruction set extensions can be used by
+  BigNumMontMulRowAdx.
+
+  @returns  Whether BigNumMontMulRowAdx is supported.
+
+**/
+BOOLEAN
+EFIAPI
+BigNumIsAdxSupported (
+  VOID
+  );
+
 /**
   Calulates the difference of A and B.
   A must have the same precision as B. Result must have a precision at most as
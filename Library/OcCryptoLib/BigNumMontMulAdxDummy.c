@@ -0,0 +1,41 @@
+/** @file
+  Copyright (C) 2026, agent. All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Base.h>
+
+#include <Library/DebugLib.h>
+
+#include "BigNumLibInternal.h"
+
+BOOLEAN
+EFIAPI
+BigNumMontMulRowAdx (
+  IN OUT OC_BN_WORD        *Result,
+  IN     OC_BN_NUM_WORDS   NumWords,
+  IN     OC_BN_WORD        AWord,
+  IN     CONST OC_BN_WORD  *B,
+  IN     CONST OC_BN_WORD  *N,
+  IN     OC_BN_WORD        N0Inv
+  )
+{
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+BOOLEAN
+EFIAPI
+BigNumIsAdxSupported (
+  VOID
+  )
+{
+  return FALSE;
+}
@@ -31,6 +31,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Base.h>
 
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -39,6 +40,20 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include "BigNumLibInternal.h"
 
+//
+// Exponents with at least this many significant bits use a sliding window of
+// OC_BN_POW_WINDOW_BITS bits, shorter ones plain square-and-multiply.
+//
+#define OC_BN_POW_WINDOW_MIN_EXP_BITS  24U
+#define OC_BN_POW_WINDOW_BITS          3U
+
+//
+// BMI2 and ADX only use general purpose registers, so unlike AVX they are
+// detected on first use without waiting for EnableVectorAcceleration.
+//
+STATIC BOOLEAN mBigNumAdxChecked;
+STATIC BOOLEAN mBigNumAdxSupported;
+
 /**
   Calculates the Montgomery Inverse -1 / A mod 2^#Bits(Word).
   This algorithm is based on the Extended Euclidean Algorithm, which returns
@@ -331,6 +346,16 @@ BigNumMontMulRow (
   ASSERT (N != NULL);
   ASSERT (N0Inv != 0);
   //
+  // The same row computed with two independent carry chains.
+  //
+  if (mBigNumAdxSupported) {
+    if (BigNumMontMulRowAdx (Result, NumWords, AWord, B, N, N0Inv)) {
+      BigNumSub (Result, NumWords, Result, N);
+    }
+
+    return;
+  }
+  //
   // Standard multiplication
   // C = C + A*B
   //
@@ -566,6 +591,220 @@ BigNumMontMul1 (
   //
 }
 
+/**
+  Calculates the exponentiation of A with B = 2^NumSquares + 1 mod N, which
+  covers the common RSA exponents 3 and 65537. No precomputation is required,
+  as the only set bits are the most and the least significant one.
+
+  @param[in,out] Result      The buffer to return the result into.
+  @param[in]     NumWords    The number of Words of Result, A, N, RSqrMod and
+                             Scratch.
+  @param[in]     A           The base.
+  @param[in]     NumSquares  The index of the most significant bit of B.
+  @param[in]     N           The modulus.
+  @param[in]     N0Inv       The Montgomery Inverse of N.
+  @param[in]     RSqrMod     Montgomery's R^2 mod N.
+  @param[in,out] Scratch     The buffer for the intermediate results.
+
+**/
+STATIC
+VOID
+BigNumPowModFermat (
+  IN OUT OC_BN_WORD        *Result,
+  IN     OC_BN_NUM_WORDS   NumWords,
+  IN     CONST OC_BN_WORD  *A,
+  IN     UINTN             NumSquares,
+  IN     CONST OC_BN_WORD  *N,
+  IN     OC_BN_WORD        N0Inv,
+  IN     CONST OC_BN_WORD  *RSqrMod,
+  IN OUT OC_BN_WORD        *Scratch
+  )
+{
+  OC_BN_WORD *Cur;
+  OC_BN_WORD *Next;
+  OC_BN_WORD *Swap;
+
+  UINTN      Index;
+
+  ASSERT (NumSquares > 0);
+  //
+  // The intermediate results alternate between Result and Scratch. Start with
+  // the buffer which makes the final multiplication store into Result.
+  //
+  if (NumSquares % 2 == 0) {
+    Cur  = Scratch;
+    Next = Result;
+  } else {
+    Cur  = Result;
+    Next = Scratch;
+  }
+  //
+  // Convert A into the Montgomery Domain.
+  // Cur = MM (A, R^2 mod N)
+  //
+  BigNumMontMul (Cur, NumWords, A, RSqrMod, N, N0Inv);
+  //
+  // Squaring the intermediate results NumSquares times yields
+  // A'^(2^NumSquares).
+  //
+  for (Index = 0; Index < NumSquares; ++Index) {
+    //
+    // Next = MM (Cur, Cur)
+    //
+    BigNumMontMul (Next, NumWords, Cur, Cur, N, N0Inv);
+
+    Swap = Cur;
+    Cur  = Next;
+    Next = Swap;
+  }
+
+  ASSERT (Next == Result);
+  //
+  // Because A is not within the Montgomery Domain, this implies another
+  // division by R, which takes the result out of the Montgomery Domain.
+  // C = MM (Cur, A)
+  //
+  BigNumMontMul (Result, NumWords, Cur, A, N, N0Inv);
+}
+
+/**
+  Calculates the exponentiation of A with B mod N with a left-to-right
+  sliding window. The odd powers of A up to 2^WindowBits - 1 are precomputed,
+  so that every window of up to WindowBits bits takes a single Montgomery
+  Multiplication in addition to the squarings.
+
+  @param[in,out] Result      The buffer to return the result into.
+  @param[in]     NumWords    The number of Words of Result, A, N and RSqrMod.
+  @param[in]     A           The base.
+  @param[in]     B           The exponent.
+  @param[in]     WindowBits  The maximum window size, in bits.
+  @param[in]     N           The modulus.
+  @param[in]     N0Inv       The Montgomery Inverse of N.
+  @param[in]     RSqrMod     Montgomery's R^2 mod N.
+  @param[in,out] Scratch     The buffer for the table of odd powers followed
+                             by the intermediate results, it must be
+                             2^(WindowBits - 1) + 1 times the size of Result.
+
+**/
+STATIC
+VOID
+BigNumPowModWindow (
+  IN OUT OC_BN_WORD        *Result,
+  IN     OC_BN_NUM_WORDS   NumWords,
+  IN     CONST OC_BN_WORD  *A,
+  IN     UINT32            B,
+  IN     UINTN             WindowBits,
+  IN     CONST OC_BN_WORD  *N,
+  IN     OC_BN_WORD        N0Inv,
+  IN     CONST OC_BN_WORD  *RSqrMod,
+  IN OUT OC_BN_WORD        *Scratch
+  )
+{
+  UINTN      NumTable;
+  OC_BN_WORD *Cur;
+  OC_BN_WORD *Next;
+  OC_BN_WORD *Swap;
+  OC_BN_WORD *Power;
+
+  INTN       BitIndex;
+  INTN       WindowEnd;
+  UINTN      WindowSize;
+  UINT32     Window;
+  BOOLEAN    IsFirst;
+  UINTN      Index;
+
+  ASSERT (B != 0);
+  ASSERT (WindowBits > 0 && WindowBits <= OC_BN_POW_WINDOW_BITS);
+
+  NumTable = (UINTN)1U << (WindowBits - 1);
+  Cur      = Result;
+  Next     = &Scratch[NumTable * NumWords];
+  //
+  // Precompute A'^1, A'^3, ..., A'^(2^WindowBits - 1) within the Montgomery
+  // Domain.
+  // Scratch[0] = MM (A, R^2 mod N)
+  //
+  BigNumMontMul (Scratch, NumWords, A, RSqrMod, N, N0Inv);
+  if (NumTable > 1) {
+    //
+    // Next = MM (A', A')
+    //
+    BigNumMontMul (Next, NumWords, Scratch, Scratch, N, N0Inv);
+    for (Index = 1; Index < NumTable; ++Index) {
+      BigNumMontMul (
+        &Scratch[Index * NumWords],
+        NumWords,
+        &Scratch[(Index - 1) * NumWords],
+        Next,
+        N,
+        N0Inv
+        );
+    }
+  }
+  //
+  // Scan B from its most significant bit. Every window starts and ends with a
+  // set bit, the zero bits between windows are squared individually.
+  //
+  IsFirst  = TRUE;
+  BitIndex = HighBitSet32 (B);
+  while (BitIndex >= 0) {
+    if ((B & (1U << BitIndex)) == 0) {
+      //
+      // Next = MM (Cur, Cur)
+      //
+      BigNumMontMul (Next, NumWords, Cur, Cur, N, N0Inv);
+
+      Swap = Cur;
+      Cur  = Next;
+      Next = Swap;
+
+      --BitIndex;
+      continue;
+    }
+
+    WindowEnd = MAX (BitIndex - (INTN)WindowBits + 1, 0);
+    while ((B & (1U << WindowEnd)) == 0) {
+      ++WindowEnd;
+    }
+
+    WindowSize = (UINTN)(BitIndex - WindowEnd + 1);
+    Window     = (B >> WindowEnd) & ((1U << WindowSize) - 1);
+    Power      = &Scratch[(Window / 2) * NumWords];
+
+    if (IsFirst) {
+      CopyMem (Cur, Power, (UINTN)NumWords * OC_BN_WORD_SIZE);
+      IsFirst = FALSE;
+    } else {
+      for (Index = 0; Index < WindowSize; ++Index) {
+        BigNumMontMul (Next, NumWords, Cur, Cur, N, N0Inv);
+
+        Swap = Cur;
+        Cur  = Next;
+        Next = Swap;
+      }
+      //
+      // Next = MM (Cur, A'^Window)
+      //
+      BigNumMontMul (Next, NumWords, Cur, Power, N, N0Inv);
+
+      Swap = Cur;
+      Cur  = Next;
+      Next = Swap;
+    }
+
+    BitIndex = WindowEnd - 1;
+  }
+  //
+  // Perform a Montgomery Multiplication with 1, which effectively is a
+  // division by R, taking the result out of the Montgomery Domain.
+  // C = MM (Cur, 1)
+  //
+  BigNumMontMul1 (Next, NumWords, Cur, N, N0Inv);
+  if (Next != Result) {
+    CopyMem (Result, Next, (UINTN)NumWords * OC_BN_WORD_SIZE);
+  }
+}
+
 BOOLEAN
 BigNumPowMod (
   IN OUT OC_BN_WORD        *Result,
@@ -577,9 +816,11 @@ BigNumPowMod (
   IN     CONST OC_BN_WORD  *RSqrMod
   )
 {
-  OC_BN_WORD *ATmp;
-
-  UINTN      Index;
+  OC_BN_WORD *Scratch;
+  INTN       TopBit;
+  BOOLEAN    IsFermat;
+  UINTN      WindowBits;
+  UINTN      NumScratch;
 
   ASSERT (Result != NULL);
   ASSERT (NumWords > 0);
@@ -588,60 +829,65 @@ BigNumPowMod (
   ASSERT (N0Inv != 0);
   ASSERT (RSqrMod != NULL);
   //
-  // Currently, only the most frequent exponents are supported.
+  // No sensible RSA key uses the exponent 0.
   //
-  if (B != 0x10001 && B != 3) {
+  if (B == 0) {
     DEBUG ((DEBUG_INFO, "OCCR: Unsupported exponent: %x\n", B));
     return FALSE;
   }
 
-  ATmp = AllocatePool ((UINTN)NumWords * OC_BN_WORD_SIZE);
-  if (ATmp == NULL) {
-    DEBUG ((DEBUG_INFO, "OCCR: Memory allocation failure in ModPow\n"));
-    return FALSE;
+  if (!mBigNumAdxChecked) {
+    mBigNumAdxSupported = BigNumIsAdxSupported ();
+    mBigNumAdxChecked   = TRUE;
   }
+
+  TopBit = HighBitSet32 (B);
   //
-  // Convert A into the Montgomery Domain.
-  // ATmp = MM (A, R^2 mod N)
+  // Exponents of the form 2^k + 1, like 65537 and 3, avoid the window table.
   //
-  BigNumMontMul (ATmp, NumWords, A, RSqrMod, N, N0Inv);
-
-  if (B == 0x10001) {
-    //
-    // Squaring the intermediate results 16 times yields A'^ (2^16).
-    //
-    for (Index = 0; Index < 16; Index += 2) {
-      //
-      // Result = MM (ATmp, ATmp)
-      //
-      BigNumMontMul (Result, NumWords, ATmp, ATmp, N, N0Inv);
-      //
-      // ATmp = MM (Result, Result)
-      //
-      BigNumMontMul (ATmp, NumWords, Result, Result, N, N0Inv);
+  IsFermat   = B > 2 && ((B - 1) & (B - 2)) == 0;
+  WindowBits = 0;
+  if (IsFermat) {
+    NumScratch = 1;
+  } else {
+    if ((UINTN)TopBit + 1 >= OC_BN_POW_WINDOW_MIN_EXP_BITS) {
+      WindowBits = OC_BN_POW_WINDOW_BITS;
+    } else {
+      WindowBits = 1;
     }
-    //
-    // Because A is not within the Montgomery Domain, this implies another
-    // division by R, which takes the result out of the Montgomery Domain.
-    // C = MM (ATmp, A)
-    //
-    BigNumMontMul (Result, NumWords, ATmp, A, N, N0Inv);
+
+    NumScratch = ((UINTN)1U << (WindowBits - 1)) + 1;
+  }
+
+  Scratch = AllocatePool (NumScratch * NumWords * OC_BN_WORD_SIZE);
+  if (Scratch == NULL) {
+    DEBUG ((DEBUG_INFO, "OCCR: Memory allocation failure in ModPow\n"));
+    return FALSE;
+  }
+
+  if (IsFermat) {
+    BigNumPowModFermat (
+      Result,
+      NumWords,
+      A,
+      (UINTN)TopBit,
+      N,
+      N0Inv,
+      RSqrMod,
+      Scratch
+      );
   } else {
-    //
-    // Result = MM (ATmp, ATmp)
-    //
-    BigNumMontMul (Result, NumWords, ATmp, ATmp, N, N0Inv);
-    //
-    // ATmp = MM (Result, ATmp)
-    //
-    BigNumMontMul (ATmp, NumWords, Result, ATmp, N, N0Inv);
-    //
-    // Perform a Montgomery Multiplication with 1, which effectively is a
-    // division by R, taking the result out of the Montgomery Domain.
-    // C = MM (ATmp, 1)
-    // TODO: Is this needed or can we just multiply with A above?
-    //
-    BigNumMontMul1 (Result, NumWords, ATmp, N, N0Inv);
+    BigNumPowModWindow (
+      Result,
+      NumWords,
+      A,
+      B,
+      WindowBits,
+      N,
+      N0Inv,
+      RSqrMod,
+      Scratch
+      );
   }
   //
   // The Montgomery Multiplications above only ensure the result is mod N when
@@ -654,6 +900,6 @@ BigNumPowMod (
     BigNumSub (Result, NumWords, Result, N);
   }
 
-  FreePool (ATmp);
+  FreePool (Scratch);
   return TRUE;
 }
@@ -92,8 +92,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
   } while(0)
 
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN mIsAvxEnabled;
+GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN mIsAvx2Enabled;
+GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN mIsShaNiEnabled;
 
-STATIC CONST UINT32 SHA256_K[64] = {
+//
+// Maximum number of messages hashed at once by Sha256Multi.
+//
+#define SHA256_MULTI_MAX_LANES  8
+
+CONST UINT32 SHA256_K[64] = {
   0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
   0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
   0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
@@ -166,57 +173,89 @@ STATIC CONST UINT64 SHA512_H0[8] = {
 //
 // Sha 256 functions
 //
+VOID
+EFIAPI
+Sha256TransformShaNi (
+  IN OUT UINT32      *State,
+  IN     CONST UINT8 *Data,
+  IN     UINTN       BlockNb
+  );
+
+VOID
+EFIAPI
+Sha256TransformMultiAvx (
+  IN OUT UINT32      *State,
+  IN     CONST UINT8 **Data,
+  IN     UINTN       BlockNb
+  );
+
+VOID
+EFIAPI
+Sha256TransformMultiAvx2 (
+  IN OUT UINT32      *State,
+  IN     CONST UINT8 **Data,
+  IN     UINTN       BlockNb
+  );
+
 VOID
 Sha256Transform (
-  SHA256_CONTEXT  *Context,
-  CONST UINT8     *Data
+  IN OUT UINT32      *State,
+  IN     CONST UINT8 *Data,
+  IN     UINTN       BlockNb
   )
 {
   UINT32 A, B, C, D, E, F, G, H, Index1, Index2, T1, T2;
   UINT32 M[64];
 
-  for (Index1 = 0, Index2 = 0; Index1 < 16; Index1++, Index2 += 4) {
-    M[Index1] = ((UINT32)Data[Index2] << 24)
-                | ((UINT32)Data[Index2 + 1] << 16)
-                | ((UINT32)Data[Index2 + 2] << 8)
-                | ((UINT32)Data[Index2 + 3]);
+  if (mIsShaNiEnabled) {
+    Sha256TransformShaNi (State, Data, BlockNb);
+    return;
   }
 
-  for ( ; Index1 < 64; ++Index1) {
-    M[Index1] = SHA256_SIG1 (M[Index1 - 2]) + M[Index1 - 7]
-      + SHA256_SIG0 (M[Index1 - 15]) + M[Index1 - 16];
-  }
+  for (; BlockNb > 0; --BlockNb, Data += SHA256_BLOCK_SIZE) {
+    for (Index1 = 0, Index2 = 0; Index1 < 16; Index1++, Index2 += 4) {
+      M[Index1] = ((UINT32)Data[Index2] << 24)
+                  | ((UINT32)Data[Index2 + 1] << 16)
+                  | ((UINT32)Data[Index2 + 2] << 8)
+                  | ((UINT32)Data[Index2 + 3]);
+    }
 
-  A = Context->State[0];
-  B = Context->State[1];
-  C = Context->State[2];
-  D = Context->State[3];
-  E = Context->State[4];
-  F = Context->State[5];
-  G = Context->State[6];
-  H = Context->State[7];
-
-  for (Index1 = 0; Index1 < 64; ++Index1) {
-    T1 = H + SHA256_EP1 (E) + CH (E, F, G) + SHA256_K[Index1] + M[Index1];
-    T2 = SHA256_EP0 (A) + MAJ (A, B, C);
-    H = G;
-    G = F;
-    F = E;
-    E = D + T1;
-    D = C;
-    C = B;
-    B = A;
-    A = T1 + T2;
-  }
+    for ( ; Index1 < 64; ++Index1) {
+      M[Index1] = SHA256_SIG1 (M[Index1 - 2]) + M[Index1 - 7]
+        + SHA256_SIG0 (M[Index1 - 15]) + M[Index1 - 16];
+    }
 
-  Context->State[0] += A;
-  Context->State[1] += B;
-  Context->State[2] += C;
-  Context->State[3] += D;
-  Context->State[4] += E;
-  Context->State[5] += F;
-  Context->State[6] += G;
-  Context->State[7] += H;
+    A = State[0];
+    B = State[1];
+    C = State[2];
+    D = State[3];
+    E = State[4];
+    F = State[5];
+    G = State[6];
+    H = State[7];
+
+    for (Index1 = 0; Index1 < 64; ++Index1) {
+      T1 = H + SHA256_EP1 (E) + CH (E, F, G) + SHA256_K[Index1] + M[Index1];
+      T2 = SHA256_EP0 (A) + MAJ (A, B, C);
+      H = G;
+      G = F;
+      F = E;
+      E = D + T1;
+      D = C;
+      C = B;
+      B = A;
+      A = T1 + T2;
+    }
+
+    State[0] += A;
+    State[1] += B;
+    State[2] += C;
+    State[3] += D;
+    State[4] += E;
+    State[5] += F;
+    State[6] += G;
+    State[7] += H;
+  }
 }
 
 VOID
@@ -239,17 +278,41 @@ Sha256Update (
   UINTN          Len
   )
 {
-  UINT32 Index;
-
-  for (Index = 0; Index < Len; ++Index) {
-    Context->Data[Context->DataLen] = Data[Index];
-    Context->DataLen++;
-    if (Context->DataLen == 64) {
-      Sha256Transform (Context, Context->Data);
-      Context->BitLen += 512;
-      Context->DataLen = 0;
+  UINTN  CopyLen;
+  UINTN  BlockNb;
+
+  //
+  // Complete the buffered block first.
+  //
+  if (Context->DataLen > 0) {
+    CopyLen = MIN (Len, SHA256_BLOCK_SIZE - Context->DataLen);
+    CopyMem (&Context->Data[Context->DataLen], Data, CopyLen);
+    Context->DataLen += (UINT32) CopyLen;
+    Data             += CopyLen;
+    Len              -= CopyLen;
+
+    if (Context->DataLen < SHA256_BLOCK_SIZE) {
+      return;
     }
+
+    Sha256Transform (Context->State, Context->Data, 1);
+    Context->BitLen += 512;
+    Context->DataLen = 0;
+  }
+
+  //
+  // Hash whole blocks in place.
+  //
+  BlockNb = Len / SHA256_BLOCK_SIZE;
+  if (BlockNb > 0) {
+    Sha256Transform (Context->State, Data, BlockNb);
+    Context->BitLen += LShiftU64 (BlockNb, 9);
+    Data            += BlockNb * SHA256_BLOCK_SIZE;
+    Len             -= BlockNb * SHA256_BLOCK_SIZE;
   }
+
+  CopyMem (Context->Data, Data, Len);
+  Context->DataLen = (UINT32) Len;
 }
 
 VOID
@@ -271,7 +334,7 @@ Sha256Final (
   } else {
     Context->Data[Index++] = 0x80;
     ZeroMem (Context->Data + Index, 64-Index);
-    Sha256Transform (Context, Context->Data);
+    Sha256Transform (Context->State, Context->Data, 1);
     ZeroMem (Context->Data, 56);
   }
 
@@ -287,7 +350,7 @@ Sha256Final (
   Context->Data[58] = (UINT8) (Context->BitLen >> 40);
   Context->Data[57] = (UINT8) (Context->BitLen >> 48);
   Context->Data[56] = (UINT8) (Context->BitLen >> 56);
-  Sha256Transform (Context, Context->Data);
+  Sha256Transform (Context->State, Context->Data, 1);
 
   //
   // Since this implementation uses little endian byte ordering and SHA uses big endian,
@@ -320,6 +383,177 @@ Sha256 (
   ZeroMem (&Ctx, sizeof (Ctx));
 }
 
+/**
+  Finish hashing a message of Sha256Multi with a single buffer transform.
+
+  @param[in]  States     Transposed states of all lanes.
+  @param[in]  Lanes      Number of lanes.
+  @param[in]  Lane       Lane the message was hashed in.
+  @param[in]  Data       Remaining message data.
+  @param[in]  Remaining  Remaining message data size in bytes.
+  @param[in]  Length     Total message size in bytes.
+  @param[out] Hash       Resulting digest.
+**/
+STATIC
+VOID
+Sha256MultiFinish (
+  IN  CONST UINT32  *States,
+  IN  UINTN         Lanes,
+  IN  UINTN         Lane,
+  IN  CONST UINT8   *Data,
+  IN  UINTN         Remaining,
+  IN  UINTN         Length,
+  OUT UINT8         *Hash
+  )
+{
+  SHA256_CONTEXT  Ctx;
+  UINTN           Index;
+
+  for (Index = 0; Index < 8; ++Index) {
+    Ctx.State[Index] = States[Index * Lanes + Lane];
+  }
+
+  Ctx.DataLen = 0;
+  Ctx.BitLen  = LShiftU64 (Length - Remaining, 3);
+  Sha256Update (&Ctx, Data, Remaining);
+  Sha256Final (&Ctx, Hash);
+  ZeroMem (&Ctx, sizeof (Ctx));
+}
+
+VOID
+Sha256Multi (
+  OUT UINT8        *Hashes,
+  IN  CONST UINT8  **Data,
+  IN  CONST UINTN  *Lengths,
+  IN  UINTN        Count
+  )
+{
+  UINT32       States[8 * SHA256_MULTI_MAX_LANES];
+  CONST UINT8  *LaneData[SHA256_MULTI_MAX_LANES];
+  UINTN        LaneBlocks[SHA256_MULTI_MAX_LANES];
+  UINTN        LaneMessage[SHA256_MULTI_MAX_LANES];
+  CONST UINT8  *SpareData;
+  UINTN        Lanes;
+  UINTN        Lane;
+  UINTN        Index;
+  UINTN        Next;
+  UINTN        Active;
+  UINTN        BlockNb;
+
+  //
+  // SHA extensions are as fast for a single message as vector lanes are
+  // for several, and there is nothing to interleave with one message.
+  //
+  if (mIsShaNiEnabled || !mIsAvxEnabled || Count < 2) {
+    for (Index = 0; Index < Count; ++Index) {
+      Sha256 (&Hashes[Index * SHA256_DIGEST_SIZE], Data[Index], Lengths[Index]);
+    }
+    return;
+  }
+
+  Lanes  = mIsAvx2Enabled ? 8 : 4;
+  Next   = 0;
+  Active = 0;
+
+  for (Lane = 0; Lane < Lanes; ++Lane) {
+    LaneData[Lane]    = NULL;
+    LaneBlocks[Lane]  = 0;
+    LaneMessage[Lane] = MAX_UINTN;
+  }
+
+  while (TRUE) {
+    //
+    // Feed idle lanes with the next messages, ones shorter than a block
+    // are finished right away.
+    //
+    for (Lane = 0; Lane < Lanes; ++Lane) {
+      while (LaneMessage[Lane] == MAX_UINTN && Next < Count) {
+        for (Index = 0; Index < 8; ++Index) {
+          States[Index * Lanes + Lane] = SHA256_H0[Index];
+        }
+
+        if (Lengths[Next] < SHA256_BLOCK_SIZE) {
+          Sha256MultiFinish (
+            States,
+            Lanes,
+            Lane,
+            Data[Next],
+            Lengths[Next],
+            Lengths[Next],
+            &Hashes[Next * SHA256_DIGEST_SIZE]
+            );
+        } else {
+          LaneData[Lane]    = Data[Next];
+          LaneBlocks[Lane]  = Lengths[Next] / SHA256_BLOCK_SIZE;
+          LaneMessage[Lane] = Next;
+          ++Active;
+        }
+
+        ++Next;
+      }
+    }
+
+    if (Active == 0) {
+      break;
+    }
+
+    //
+    // Run the lanes until the shortest message runs out of whole blocks.
+    // Idle lanes rehash the data of a busy one, their state is discarded.
+    //
+    BlockNb   = MAX_UINTN;
+    SpareData = NULL;
+    for (Lane = 0; Lane < Lanes; ++Lane) {
+      if (LaneMessage[Lane] != MAX_UINTN) {
+        BlockNb   = MIN (BlockNb, LaneBlocks[Lane]);
+        SpareData = LaneData[Lane];
+      }
+    }
+
+    for (Lane = 0; Lane < Lanes; ++Lane) {
+      if (LaneMessage[Lane] == MAX_UINTN) {
+        LaneData[Lane] = SpareData;
+      }
+    }
+
+    if (Lanes == 8) {
+      Sha256TransformMultiAvx2 (States, LaneData, BlockNb);
+    } else {
+      Sha256TransformMultiAvx (States, LaneData, BlockNb);
+    }
+
+    for (Lane = 0; Lane < Lanes; ++Lane) {
+      if (LaneMessage[Lane] == MAX_UINTN) {
+        continue;
+      }
+
+      LaneData[Lane]   += BlockNb * SHA256_BLOCK_SIZE;
+      LaneBlocks[Lane] -= BlockNb;
+
+      //
+      // Finished messages get their tail hashed separately, and so does
+      // the last message, as a single lane is slower than a single buffer.
+      //
+      if (LaneBlocks[Lane] == 0 || (Active == 1 && Next == Count)) {
+        Index = LaneMessage[Lane];
+        Sha256MultiFinish (
+          States,
+          Lanes,
+          Lane,
+          LaneData[Lane],
+          Lengths[Index] - (UINTN) (LaneData[Lane] - Data[Index]),
+          Lengths[Index],
+          &Hashes[Index * SHA256_DIGEST_SIZE]
+          );
+        LaneMessage[Lane] = MAX_UINTN;
+        --Active;
+      }
+    }
+  }
+
+  ZeroMem (States, sizeof (States));
+}
+
 
 //
 // Sha 512 functions
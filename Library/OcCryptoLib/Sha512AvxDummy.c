@@ -13,6 +13,8 @@
 #include <Library/DebugLib.h>
 
 extern BOOLEAN mIsAvxEnabled;
+extern BOOLEAN mIsAvx2Enabled;
+extern BOOLEAN mIsShaNiEnabled;
 
 VOID
 EFIAPI
@@ -31,6 +33,8 @@ TryEnableAvx (
   VOID
   )
 {
-  mIsAvxEnabled = FALSE;
+  mIsAvxEnabled   = FALSE;
+  mIsAvx2Enabled  = FALSE;
+  mIsShaNiEnabled = FALSE;
   return FALSE;
 }
@@ -140,6 +140,128 @@ GetLogPath (
   return LogPath;
 }
 
+STATIC
+EFI_STATUS
+AppendLogBuffer (
+  IN OC_LOG_PRIVATE_DATA  *Private,
+  IN CONST CHAR8          *Timing,
+  IN UINTN                TimingLength,
+  IN CONST CHAR8          *Line,
+  IN UINTN                LineLength
+  )
+{
+  //
+  // Keep the buffer null terminated, it is zeroed on allocation.
+  //
+  if (Private->AsciiBufferSize - Private->AsciiBufferLength <= TimingLength + LineLength) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  CopyMem (&Private->AsciiBuffer[Private->AsciiBufferLength], Timing, TimingLength);
+  Private->AsciiBufferLength += TimingLength;
+  CopyMem (&Private->AsciiBuffer[Private->AsciiBufferLength], Line, LineLength);
+  Private->AsciiBufferLength += LineLength;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+FlushLogFile (
+  IN OC_LOG_PROTOCOL  *OcLog
+  )
+{
+  EFI_STATUS           Status;
+  OC_LOG_PRIVATE_DATA  *Private;
+  EFI_FILE_PROTOCOL    *File;
+  UINTN                Start;
+  UINTN                Size;
+  UINTN                WrittenSize;
+
+  Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
+
+  if ((OcLog->Options & OC_LOG_FILE) == 0
+    || OcLog->FileSystem == NULL
+    || Private->AsciiBufferFlushed == Private->AsciiBufferLength
+    || EfiGetCurrentTpl () > TPL_CALLBACK) {
+    return;
+  }
+
+  //
+  // The file is preallocated to full buffer size, so rewriting whole blocks
+  // with new entries never changes its size and it stays consistent.
+  //
+  Start = Private->AsciiBufferFlushed & ~((UINTN) OC_LOG_FILE_BLOCK_SIZE - 1);
+  Size  = MIN (ALIGN_VALUE (Private->AsciiBufferLength, OC_LOG_FILE_BLOCK_SIZE), Private->AsciiBufferSize) - Start;
+
+  Status = OcSafeFileOpen (
+    OcLog->FileSystem,
+    &File,
+    OcLog->FilePath,
+    EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+    0
+    );
+  if (!EFI_ERROR (Status)) {
+    Status = File->SetPosition (File, Start);
+    if (!EFI_ERROR (Status)) {
+      WrittenSize = Size;
+      Status = File->Write (File, &WrittenSize, &Private->AsciiBuffer[Start]);
+      if (!EFI_ERROR (Status) && WrittenSize != Size) {
+        Status = EFI_BAD_BUFFER_SIZE;
+      }
+    }
+
+    File->Close (File);
+  } else {
+    //
+    // Recreate the file if it is gone.
+    //
+    Status = OcSetFileData (
+      OcLog->FileSystem,
+      OcLog->FilePath,
+      Private->AsciiBuffer,
+      (UINT32) Private->AsciiBufferSize
+      );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Private->AsciiBufferFlushed = Private->AsciiBufferLength;
+  }
+
+  Private->PendingLines = 0;
+  Private->TscLastFlush = Private->TscLast;
+}
+
+STATIC
+BOOLEAN
+IsLogFlushNeeded (
+  IN OC_LOG_PROTOCOL  *OcLog,
+  IN UINTN            ErrorLevel
+  )
+{
+  OC_LOG_PRIVATE_DATA  *Private;
+
+  Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
+
+  if (Private->PendingLines >= OC_LOG_FLUSH_LINES) {
+    return TRUE;
+  }
+
+  //
+  // Errors may be followed by a hang, write them out immediately.
+  //
+  if ((ErrorLevel & (DEBUG_ERROR | OcLog->HaltLevel)) != 0) {
+    return TRUE;
+  }
+
+  //
+  // TscLast is updated by GetTiming for every entry.
+  //
+  return Private->TscFrequency != 0
+    && Private->TscLast - Private->TscLastFlush
+      >= DivU64x32 (MultU64x32 (Private->TscFrequency, OC_LOG_FLUSH_INTERVAL_MS), 1000);
+}
+
 EFI_STATUS
 EFIAPI
 OcLogAddEntry  (
@@ -278,24 +400,23 @@ OcLogAddEntry  (
     // Write to internal buffer.
     //
 
-    Status = AsciiStrCatS (Private->AsciiBuffer, Private->AsciiBufferSize, Private->TimingTxt);
-    if (!EFI_ERROR (Status)) {
-      Status = AsciiStrCatS (Private->AsciiBuffer, Private->AsciiBufferSize, Private->LineBuffer);
-    }
+    Status = AppendLogBuffer (
+      Private,
+      Private->TimingTxt,
+      TimingLength,
+      Private->LineBuffer,
+      LineLength
+      );
 
     //
     // Write to a file.
-    // Always overwriting file completely is most reliable.
-    // I know it is slow, but fixed size write is more reliable with broken FAT32 driver.
+    // Writes are batched and only rewrite the fixed size blocks with new entries.
+    // Fixed size write is more reliable with broken FAT32 driver.
     //
     if ((OcLog->Options & OC_LOG_FILE) != 0 && OcLog->FileSystem != NULL) {
-      if (EfiGetCurrentTpl () <= TPL_CALLBACK) {
-        OcSetFileData (
-          OcLog->FileSystem,
-          OcLog->FilePath,
-          Private->AsciiBuffer,
-          (UINT32) Private->AsciiBufferSize
-          );
+      ++Private->PendingLines;
+      if (IsLogFlushNeeded (OcLog, ErrorLevel)) {
+        FlushLogFile (OcLog);
       }
     }
 
@@ -307,8 +428,10 @@ OcLogAddEntry  (
       // Do not log timing information to NVRAM, it is already large.
       // This check is here, because Microsoft is retarded and asserts.
       //
-      if (Private->NvramBufferSize - AsciiStrSize (Private->NvramBuffer) >= AsciiStrLen (Private->LineBuffer)) {
-        Status = AsciiStrCatS (Private->NvramBuffer, Private->NvramBufferSize, Private->LineBuffer);
+      if (Private->NvramBufferSize - Private->NvramBufferLength > LineLength) {
+        CopyMem (&Private->NvramBuffer[Private->NvramBufferLength], Private->LineBuffer, LineLength + 1);
+        Private->NvramBufferLength += LineLength;
+        Status = EFI_SUCCESS;
       } else {
         Status = EFI_BUFFER_TOO_SMALL;
       }
@@ -325,7 +448,7 @@ OcLogAddEntry  (
           OC_LOG_VARIABLE_NAME,
           &gOcVendorVariableGuid,
           Attributes,
-          AsciiStrLen (Private->NvramBuffer),
+          Private->NvramBufferLength,
           Private->NvramBuffer
           );
 
@@ -350,6 +473,7 @@ OcLogAddEntry  (
   if ((ErrorLevel & OcLog->HaltLevel) != 0
     && AsciiStrnCmp (FormatString, "\nASSERT_RETURN_ERROR", L_STR_LEN ("\nASSERT_RETURN_ERROR")) != 0
     && AsciiStrnCmp (FormatString, "\nASSERT_EFI_ERROR", L_STR_LEN ("\nASSERT_EFI_ERROR")) != 0) {
+    FlushLogFile (OcLog);
     gST->ConOut->OutputString (gST->ConOut, L"Halting on critical error\r\n");
     gBS->Stall (SECONDS_TO_MICROSECONDS (1));
     CpuDeadLoop ();
@@ -487,6 +611,8 @@ OcConfigureLogProtocol (
     // Set desired options in existing protocol.
     //
 
+    FlushLogFile (OcLog);
+
     if (OcLog->FileSystem != NULL) {
       OcLog->FileSystem->Close (OcLog->FileSystem);
     }
@@ -540,13 +666,18 @@ OcConfigureLogProtocol (
 
   if (LogRoot != NULL) {
     if (!EFI_ERROR (Status)) {
-      if (OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog)->AsciiBufferSize > 0) {
-        OcSetFileData (
+      //
+      // Preallocate the file to full buffer size, later flushes only rewrite blocks.
+      //
+      Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
+      if (Private->AsciiBufferSize > 0 && !EFI_ERROR (OcSetFileData (
           LogRoot,
           LogPath,
-          OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog)->AsciiBuffer,
-          (UINT32) OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog)->AsciiBufferSize
-          );
+          Private->AsciiBuffer,
+          (UINT32) Private->AsciiBufferSize
+          ))) {
+        Private->AsciiBufferFlushed = Private->AsciiBufferLength;
+        Private->PendingLines       = 0;
       }
     } else {
       LogRoot->Close (LogRoot);
@@ -556,3 +687,16 @@ OcConfigureLogProtocol (
 
   return Status;
 }
+
+VOID
+OcFlushLogProtocol (
+  VOID
+  )
+{
+  OC_LOG_PROTOCOL  *OcLog;
+
+  OcLog = InternalGetOcLog ();
+  if (OcLog != NULL) {
+    FlushLogFile (OcLog);
+  }
+}
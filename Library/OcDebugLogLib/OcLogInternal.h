@@ -24,6 +24,14 @@
 #define OC_LOG_FILE_PATH_BUFFER_SIZE  256
 #define OC_LOG_TIMING_BUFFER_SIZE     64
 
+//
+// Log file is preallocated to OC_LOG_BUFFER_SIZE and only the blocks
+// containing new entries are rewritten on flush.
+//
+#define OC_LOG_FILE_BLOCK_SIZE        BASE_4KB
+#define OC_LOG_FLUSH_LINES            32
+#define OC_LOG_FLUSH_INTERVAL_MS      500
+
 #define OC_LOG_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('O', 'C', 'L', 'G')
 
 #define OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS(a) \
@@ -39,9 +47,14 @@ typedef struct {
   CHAR16                 UnicodeLineBuffer[OC_LOG_LINE_BUFFER_SIZE];
   CHAR8                  AsciiBuffer[OC_LOG_BUFFER_SIZE];
   UINTN                  AsciiBufferSize;
+  UINTN                  AsciiBufferLength;
+  UINTN                  AsciiBufferFlushed;
   CHAR8                  NvramBuffer[OC_LOG_NVRAM_BUFFER_SIZE];
   UINTN                  NvramBufferSize;
+  UINTN                  NvramBufferLength;
   UINT32                 LogCounter;
+  UINT32                 PendingLines;
+  UINT64                 TscLastFlush;
   CHAR16                 *LogFilePathName;
   EFI_DATA_HUB_PROTOCOL  *DataHub;
   OC_LOG_PROTOCOL        OcLog;
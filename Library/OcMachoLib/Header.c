@@ -39,6 +39,17 @@ MachoInitializeContext (
     MachoInitializeContext64 (Context, FileData, FileSize, ContainerOffset);
 }
 
+VOID
+MachoFreeContext (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  )
+{
+  ASSERT (Context != NULL);
+
+  InternalFreeRelocationIndex (Context);
+  InternalFreeSymbolIndex (Context);
+}
+
 MACH_HEADER_ANY *
 MachoGetMachHeader (
   IN OUT OC_MACHO_CONTEXT   *Context
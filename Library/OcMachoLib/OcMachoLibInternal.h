@@ -21,6 +21,64 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #define SYM_MAX_NAME_LEN  256U
 
+//
+// Minimum number of relocations to build an index for.
+//
+#define MACHO_RELOCATION_INDEX_MIN_ENTRIES  16U
+
+//
+// Address-sorted lookup index entry.
+//
+typedef struct {
+  UINT64  Address;
+  VOID    *Item;
+} OC_MACHO_ADDRESS_INDEX_ENTRY;
+
+//
+// External relocations followed by local relocations, each sorted by
+// target address and then by position in the relocation table.
+//
+struct OC_MACHO_RELOCATION_INDEX_ {
+  UINT32                        NumExtern;
+  UINT32                        NumLocal;
+  OC_MACHO_ADDRESS_INDEX_ENTRY  Entries[];
+};
+
+//
+// Minimum number of symbols to build an index for.
+//
+#define MACHO_SYMBOL_INDEX_MIN_SYMBOLS  64U
+
+//
+// Maximum number of changed symbol values before the value index is rebuilt.
+//
+#define MACHO_SYMBOL_INDEX_MAX_CHANGED  32U
+
+typedef struct {
+  UINT32  Hash;
+  //
+  // Symbol table index plus one, zero marks a free slot.
+  //
+  UINT32  Symbol;
+} OC_MACHO_SYMBOL_NAME_ENTRY;
+
+//
+// Symbols are inserted into the open addressing name table in symbol table
+// order, so probing meets symbols of the same name in that order too.
+// Values are sorted once, symbols changing their value afterwards are
+// checked separately.
+//
+struct OC_MACHO_SYMBOL_INDEX_ {
+  OC_MACHO_SYMBOL_NAME_ENTRY    *Names;
+  UINT32                        NameMask;
+  BOOLEAN                       NoNames;
+  OC_MACHO_ADDRESS_INDEX_ENTRY  *Values;
+  UINT32                        NumValues;
+  BOOLEAN                       NoValues;
+  UINT32                        NumChanged;
+  CONST MACH_NLIST_ANY          *Changed[MACHO_SYMBOL_INDEX_MAX_CHANGED];
+};
+
 /**
   Retrieves the SYMTAB command.
 
@@ -62,6 +120,94 @@ InternalGetLocalRelocationByOffset (
   IN     UINT64            Address
   );
 
+/**
+  Sorts address index entries by address and then by item.
+
+  @param[in,out] Entries     Entries to sort.
+  @param[in]     NumEntries  Number of entries.
+**/
+VOID
+InternalSortAddressIndex (
+  IN OUT OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries,
+  IN     UINT32                        NumEntries
+  );
+
+/**
+  Finds the first sorted address index entry not below Address.
+
+  @param[in] Entries     Sorted entries.
+  @param[in] NumEntries  Number of entries.
+  @param[in] Address     Address to search for.
+
+  @returns  Entry index, NumEntries when all entries are below Address.
+**/
+UINT32
+InternalFindAddressIndex (
+  IN CONST OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries,
+  IN UINT32                              NumEntries,
+  IN UINT64                              Address
+  );
+
+/**
+  Frees the relocation index of a Mach-O Context.
+
+  @param[in,out] Context  Context of the Mach-O.
+**/
+VOID
+InternalFreeRelocationIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  );
+
+/**
+  Retrieves the first symbol in a symbol table range by its name
+  through the symbol index.
+
+  @param[in,out] Context      Context of the Mach-O.
+  @param[in]     Name         Name of the symbol to locate.
+  @param[in]     Start        Index of the first symbol to consider.
+  @param[in]     NumSymbols   Number of symbols to consider.
+  @param[in]     OnlyDefined  Whether to skip symbols, which are not defined.
+  @param[out]    Symbol       Symbol found, NULL if there is none.
+
+  @retval FALSE  There is no symbol index, the lookup must be linear.
+**/
+BOOLEAN
+InternalSymbolIndexGetByName (
+  IN OUT OC_MACHO_CONTEXT  *Context,
+  IN     CONST CHAR8       *Name,
+  IN     UINT32            Start,
+  IN     UINT32            NumSymbols,
+  IN     BOOLEAN           OnlyDefined,
+  OUT    MACH_NLIST_ANY    **Symbol
+  );
+
+/**
+  Retrieves the first symbol in the symbol table by its value
+  through the symbol index.
+
+  @param[in,out] Context  Context of the Mach-O.
+  @param[in]     Value    Value of the symbol to locate.
+  @param[out]    Symbol   Symbol found, NULL if there is none.
+
+  @retval FALSE  There is no symbol index, the lookup must be linear.
+**/
+BOOLEAN
+InternalSymbolIndexGetByValue (
+  IN OUT OC_MACHO_CONTEXT  *Context,
+  IN     UINT64            Value,
+  OUT    MACH_NLIST_ANY    **Symbol
+  );
+
+/**
+  Frees the symbol index of a Mach-O Context.
+
+  @param[in,out] Context  Context of the Mach-O.
+**/
+VOID
+InternalFreeSymbolIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  );
+
 /**
   Check 32-bit symbol validity.
 
@@ -17,6 +17,8 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <IndustryStandard/AppleMachoImage.h>
 
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcGuardLib.h>
 #include <Library/OcMachoLib.h>
 
 #include "OcMachoLibInternal.h"
@@ -194,6 +196,318 @@ InternalLookupSectionRelocationByOffset (
   return NULL;
 }
 
+/**
+  Collects the relocations of one kind in the order they are looked up.
+
+  @param[in,out] Context   Context of the Mach-O.
+  @param[in]     External  Whether to collect external or local relocations.
+  @param[out]    Entries   Index entries to fill, NULL to only count them.
+
+  @returns  Number of collected relocations.
+
+**/
+STATIC
+UINT32
+InternalCollectRelocations (
+  IN OUT OC_MACHO_CONTEXT              *Context,
+  IN     BOOLEAN                       External,
+  OUT    OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries OPTIONAL
+  )
+{
+  MACH_SECTION_ANY      *Section;
+  UINT32                SectionIndex;
+  UINT32                Index;
+  UINT32                Count;
+
+  MACH_RELOCATION_INFO  *Relocations;
+  MACH_RELOCATION_INFO  *Relocation;
+  UINT32                RelocationCount;
+  UINT64                Address;
+
+  Count = 0;
+
+  //
+  // Mirror InternalLookupRelocationByOffset and
+  // InternalLookupSectionRelocationByOffset, which the index replaces.
+  //
+  if (Context->DySymtab != NULL) {
+    if (External) {
+      Relocations     = Context->ExternRelocations;
+      RelocationCount = Context->DySymtab->NumExternalRelocations;
+    } else {
+      Relocations     = Context->LocalRelocations;
+      RelocationCount = Context->DySymtab->NumOfLocalRelocations;
+    }
+
+    for (Index = 0; Index < RelocationCount; ++Index) {
+      Relocation = &Relocations[Index];
+      if ((Relocation->Extern == 0)
+       && (Relocation->SymbolNumber == MACH_RELOC_ABSOLUTE)) {
+        continue;
+      }
+
+      if (Entries != NULL) {
+        Entries[Count].Address    = (UINT64)Relocation->Address;
+        Entries[Count].Item       = Relocation;
+      }
+
+      ++Count;
+
+      if (MachoRelocationIsPairIntel64 ((UINT8)Relocation->Type)) {
+        if (Index == (MAX_UINT32 - 1)) {
+          break;
+        }
+        ++Index;
+      }
+    }
+
+    return Count;
+  }
+
+  for (SectionIndex = 0; ; ++SectionIndex) {
+    Section = MachoGetSectionByIndex (Context, SectionIndex);
+    if (Section == NULL) {
+      break;
+    }
+
+    RelocationCount = Context->Is32Bit ? Section->Section32.NumRelocations : Section->Section64.NumRelocations;
+    if (RelocationCount == 0) {
+      continue;
+    }
+
+    Relocations = (MACH_RELOCATION_INFO*) (((UINTN)(Context->MachHeader))
+      + (Context->Is32Bit ? Section->Section32.RelocationsOffset : Section->Section64.RelocationsOffset));
+
+    for (Index = 0; Index < RelocationCount; ++Index) {
+      Relocation = &Relocations[Index];
+      if ((Relocation->Extern == 0)
+       && (Relocation->SymbolNumber == MACH_RELOC_ABSOLUTE)) {
+        continue;
+      }
+
+      if (Relocation->Extern != (UINT32)(External ? 1 : 0)) {
+        continue;
+      }
+
+      if (Context->Is32Bit) {
+        Address = (UINT32)((UINT32)Relocation->Address + Section->Section32.Address);
+      } else {
+        Address = (UINT64)Relocation->Address + Section->Section64.Address;
+      }
+
+      if (Entries != NULL) {
+        Entries[Count].Address    = Address;
+        Entries[Count].Item       = Relocation;
+      }
+
+      ++Count;
+    }
+  }
+
+  return Count;
+}
+
+STATIC
+BOOLEAN
+InternalAddressIndexEntryLess (
+  IN CONST OC_MACHO_ADDRESS_INDEX_ENTRY  *First,
+  IN CONST OC_MACHO_ADDRESS_INDEX_ENTRY  *Second
+  )
+{
+  if (First->Address != Second->Address) {
+    return First->Address < Second->Address;
+  }
+
+  //
+  // Keep table order for items at the same address,
+  // so the first one is found like with the linear lookup.
+  //
+  return (UINTN)First->Item < (UINTN)Second->Item;
+}
+
+STATIC
+VOID
+InternalSiftAddressIndex (
+  IN OUT OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries,
+  IN     UINT32                        Root,
+  IN     UINT32                        NumEntries
+  )
+{
+  UINT32                        Child;
+  OC_MACHO_ADDRESS_INDEX_ENTRY  Entry;
+
+  while (Root < NumEntries / 2) {
+    Child = 2 * Root + 1;
+    if (Child + 1 < NumEntries
+      && InternalAddressIndexEntryLess (&Entries[Child], &Entries[Child + 1])) {
+      ++Child;
+    }
+
+    if (!InternalAddressIndexEntryLess (&Entries[Root], &Entries[Child])) {
+      break;
+    }
+
+    Entry          = Entries[Root];
+    Entries[Root]  = Entries[Child];
+    Entries[Child] = Entry;
+    Root           = Child;
+  }
+}
+
+VOID
+InternalSortAddressIndex (
+  IN OUT OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries,
+  IN     UINT32                        NumEntries
+  )
+{
+  UINT32                        Index;
+  OC_MACHO_ADDRESS_INDEX_ENTRY  Entry;
+
+  //
+  // Heap sort, no extra memory and no quadratic worst case.
+  //
+  for (Index = NumEntries / 2; Index > 0; --Index) {
+    InternalSiftAddressIndex (Entries, Index - 1, NumEntries);
+  }
+
+  for (Index = NumEntries; Index > 1; --Index) {
+    Entry              = Entries[0];
+    Entries[0]         = Entries[Index - 1];
+    Entries[Index - 1] = Entry;
+    InternalSiftAddressIndex (Entries, 0, Index - 1);
+  }
+}
+
+UINT32
+InternalFindAddressIndex (
+  IN CONST OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries,
+  IN UINT32                              NumEntries,
+  IN UINT64                              Address
+  )
+{
+  UINT32  Start;
+  UINT32  End;
+  UINT32  Middle;
+
+  Start = 0;
+  End   = NumEntries;
+  while (Start < End) {
+    Middle = Start + (End - Start) / 2;
+    if (Entries[Middle].Address < Address) {
+      Start = Middle + 1;
+    } else {
+      End = Middle;
+    }
+  }
+
+  return Start;
+}
+
+/**
+  Retrieves the relocation index of a Mach-O, building it on first use.
+
+  @param[in,out] Context  Context of the Mach-O.
+
+  @retval NULL  Relocations are to be looked up linearly.
+
+**/
+STATIC
+OC_MACHO_RELOCATION_INDEX *
+InternalGetRelocationIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  )
+{
+  OC_MACHO_RELOCATION_INDEX  *RelocationIndex;
+  UINT32                     NumExtern;
+  UINT32                     NumLocal;
+  UINT32                     NumEntries;
+  UINTN                      IndexSize;
+
+  if (Context->RelocationIndex != NULL || Context->NoRelocationIndex) {
+    return Context->RelocationIndex;
+  }
+
+  //
+  // Relocation tables are only known once symtabs are initialised.
+  //
+  if (Context->SymbolTable == NULL) {
+    return NULL;
+  }
+
+  //
+  // Do not try again regardless of the outcome.
+  //
+  Context->NoRelocationIndex = TRUE;
+
+  NumExtern = InternalCollectRelocations (Context, TRUE, NULL);
+  NumLocal  = InternalCollectRelocations (Context, FALSE, NULL);
+  if (NumExtern < MACHO_RELOCATION_INDEX_MIN_ENTRIES
+    && NumLocal < MACHO_RELOCATION_INDEX_MIN_ENTRIES) {
+    return NULL;
+  }
+
+  if (OcOverflowAddU32 (NumExtern, NumLocal, &NumEntries)
+    || OcOverflowMulAddUN (NumEntries, sizeof (OC_MACHO_ADDRESS_INDEX_ENTRY), sizeof (*RelocationIndex), &IndexSize)) {
+    return NULL;
+  }
+
+  RelocationIndex = AllocatePool (IndexSize);
+  if (RelocationIndex == NULL) {
+    DEBUG ((DEBUG_INFO, "OCMCO: Failed to allocate relocation index, falling back to linear lookup\n"));
+    return NULL;
+  }
+
+  RelocationIndex->NumExtern = InternalCollectRelocations (Context, TRUE, RelocationIndex->Entries);
+  RelocationIndex->NumLocal  = InternalCollectRelocations (
+                                 Context,
+                                 FALSE,
+                                 &RelocationIndex->Entries[RelocationIndex->NumExtern]
+                                 );
+  ASSERT (RelocationIndex->NumExtern == NumExtern);
+  ASSERT (RelocationIndex->NumLocal == NumLocal);
+
+  InternalSortAddressIndex (RelocationIndex->Entries, RelocationIndex->NumExtern);
+  InternalSortAddressIndex (
+    &RelocationIndex->Entries[RelocationIndex->NumExtern],
+    RelocationIndex->NumLocal
+    );
+
+  Context->RelocationIndex   = RelocationIndex;
+  Context->NoRelocationIndex = FALSE;
+  return RelocationIndex;
+}
+
+STATIC
+MACH_RELOCATION_INFO *
+InternalLookupRelocationIndex (
+  IN CONST OC_MACHO_ADDRESS_INDEX_ENTRY  *Entries,
+  IN UINT32                              NumEntries,
+  IN UINT64                              Address
+  )
+{
+  UINT32  Index;
+
+  Index = InternalFindAddressIndex (Entries, NumEntries, Address);
+  if (Index < NumEntries && Entries[Index].Address == Address) {
+    return Entries[Index].Item;
+  }
+
+  return NULL;
+}
+
+VOID
+InternalFreeRelocationIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  )
+{
+  if (Context->RelocationIndex != NULL) {
+    FreePool (Context->RelocationIndex);
+    Context->RelocationIndex = NULL;
+  }
+
+  Context->NoRelocationIndex = FALSE;
+}
+
 /**
   Retrieves an extern Relocation by the address it targets.
 
@@ -209,6 +523,17 @@ InternalGetExternRelocationByOffset (
   IN     UINT64            Address
   )
 {
+  OC_MACHO_RELOCATION_INDEX  *RelocationIndex;
+
+  RelocationIndex = InternalGetRelocationIndex (Context);
+  if (RelocationIndex != NULL) {
+    return InternalLookupRelocationIndex (
+             RelocationIndex->Entries,
+             RelocationIndex->NumExtern,
+             Address
+             );
+  }
+
   //
   // MH_OBJECT does not have a DYSYMTAB.
   //
@@ -242,6 +567,17 @@ InternalGetLocalRelocationByOffset (
   IN     UINT64            Address
   )
 {
+  OC_MACHO_RELOCATION_INDEX  *RelocationIndex;
+
+  RelocationIndex = InternalGetRelocationIndex (Context);
+  if (RelocationIndex != NULL) {
+    return InternalLookupRelocationIndex (
+             &RelocationIndex->Entries[RelocationIndex->NumExtern],
+             RelocationIndex->NumLocal,
+             Address
+             );
+  }
+
   //
   // MH_OBJECT does not have a DYSYMTAB.
   //
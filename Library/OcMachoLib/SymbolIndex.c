@@ -0,0 +1,383 @@
+/** @file
+  Provides symbol lookup indices.
+
+Copyright (c) 2026, agent.  All rights reserved.<BR>
+This program and the accompanying materials are licensed and made available
+under the terms and conditions of the BSD License which accompanies this
+distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php.
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <Uefi.h>
+
+#include <IndustryStandard/AppleMachoImage.h>
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcGuardLib.h>
+#include <Library/OcMachoLib.h>
+
+#include "OcMachoLibInternal.h"
+
+STATIC
+UINT32
+InternalHashSymbolName (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32  Hash;
+
+  //
+  // FNV-1a, mangled C++ names share long prefixes.
+  //
+  Hash = 0x811C9DC5U;
+  while (*Name != '\0') {
+    Hash ^= (UINT8) *Name;
+    Hash *= 0x01000193U;
+    ++Name;
+  }
+
+  return Hash;
+}
+
+STATIC
+MACH_NLIST_ANY *
+InternalSymbolIndexGetSymbol (
+  IN OUT OC_MACHO_CONTEXT  *Context,
+  IN     UINT32            Index
+  )
+{
+  return Context->Is32Bit ?
+    (MACH_NLIST_ANY *) &(&Context->SymbolTable->Symbol32)[Index] :
+    (MACH_NLIST_ANY *) &(&Context->SymbolTable->Symbol64)[Index];
+}
+
+STATIC
+UINT64
+InternalSymbolIndexGetValue (
+  IN OUT OC_MACHO_CONTEXT      *Context,
+  IN     CONST MACH_NLIST_ANY  *Symbol
+  )
+{
+  return Context->Is32Bit ? Symbol->Symbol32.Value : Symbol->Symbol64.Value;
+}
+
+/**
+  Retrieves the symbol index of a Mach-O, allocating it on first use.
+
+  @param[in,out] Context  Context of the Mach-O.
+
+  @retval NULL  Symbols are to be looked up linearly.
+
+**/
+STATIC
+OC_MACHO_SYMBOL_INDEX *
+InternalGetSymbolIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  )
+{
+  if (Context->SymbolIndex != NULL || !Context->UseSymbolIndex) {
+    return Context->SymbolIndex;
+  }
+
+  //
+  // Symbols are only known once symtabs are initialised.
+  //
+  if (Context->SymbolTable == NULL
+    || Context->Symtab->NumSymbols < MACHO_SYMBOL_INDEX_MIN_SYMBOLS) {
+    return NULL;
+  }
+
+  Context->SymbolIndex = AllocateZeroPool (sizeof (*Context->SymbolIndex));
+  if (Context->SymbolIndex == NULL) {
+    DEBUG ((DEBUG_INFO, "OCMCO: Failed to allocate symbol index, falling back to linear lookup\n"));
+    Context->UseSymbolIndex = FALSE;
+  }
+
+  return Context->SymbolIndex;
+}
+
+STATIC
+BOOLEAN
+InternalBuildSymbolNameIndex (
+  IN OUT OC_MACHO_CONTEXT       *Context,
+  IN OUT OC_MACHO_SYMBOL_INDEX  *SymbolIndex
+  )
+{
+  MACH_NLIST_ANY  *Symbol;
+  UINT32          NumSymbols;
+  UINT32          Index;
+  UINT32          Size;
+  UINT32          Hash;
+  UINT32          Slot;
+
+  NumSymbols = Context->Symtab->NumSymbols;
+
+  //
+  // Linear lookup stops at the first malformed symbol, only index sane tables.
+  //
+  for (Index = 0; Index < NumSymbols; ++Index) {
+    Symbol = InternalSymbolIndexGetSymbol (Context, Index);
+    if (Symbol->Symbol32.UnifiedName.StringIndex >= Context->Symtab->StringsSize) {
+      return FALSE;
+    }
+  }
+
+  //
+  // Keep load factor at most 1/2.
+  //
+  if (NumSymbols > MAX_UINT32 / (4 * sizeof (OC_MACHO_SYMBOL_NAME_ENTRY))) {
+    return FALSE;
+  }
+
+  Size = GetPowerOfTwo32 (NumSymbols) * 4;
+
+  SymbolIndex->Names = AllocateZeroPool (Size * sizeof (OC_MACHO_SYMBOL_NAME_ENTRY));
+  if (SymbolIndex->Names == NULL) {
+    return FALSE;
+  }
+
+  SymbolIndex->NameMask = Size - 1;
+
+  for (Index = 0; Index < NumSymbols; ++Index) {
+    Symbol = InternalSymbolIndexGetSymbol (Context, Index);
+    Hash   = InternalHashSymbolName (MachoGetSymbolName (Context, Symbol));
+    Slot   = Hash & SymbolIndex->NameMask;
+    while (SymbolIndex->Names[Slot].Symbol != 0) {
+      Slot = (Slot + 1) & SymbolIndex->NameMask;
+    }
+
+    SymbolIndex->Names[Slot].Hash   = Hash;
+    SymbolIndex->Names[Slot].Symbol = Index + 1;
+  }
+
+  return TRUE;
+}
+
+BOOLEAN
+InternalSymbolIndexGetByName (
+  IN OUT OC_MACHO_CONTEXT  *Context,
+  IN     CONST CHAR8       *Name,
+  IN     UINT32            Start,
+  IN     UINT32            NumSymbols,
+  IN     BOOLEAN           OnlyDefined,
+  OUT    MACH_NLIST_ANY    **Symbol
+  )
+{
+  OC_MACHO_SYMBOL_INDEX  *SymbolIndex;
+  MACH_NLIST_ANY         *Candidate;
+  UINT32                 Hash;
+  UINT32                 Slot;
+  UINT32                 Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Name != NULL);
+  ASSERT (Symbol != NULL);
+
+  SymbolIndex = InternalGetSymbolIndex (Context);
+  if (SymbolIndex == NULL || SymbolIndex->NoNames) {
+    return FALSE;
+  }
+
+  if (SymbolIndex->Names == NULL
+    && !InternalBuildSymbolNameIndex (Context, SymbolIndex)) {
+    SymbolIndex->NoNames = TRUE;
+    return FALSE;
+  }
+
+  *Symbol = NULL;
+
+  Hash = InternalHashSymbolName (Name);
+  Slot = Hash & SymbolIndex->NameMask;
+  while (SymbolIndex->Names[Slot].Symbol != 0) {
+    Index = SymbolIndex->Names[Slot].Symbol - 1;
+    if (SymbolIndex->Names[Slot].Hash == Hash
+      && Index >= Start
+      && Index - Start < NumSymbols) {
+      Candidate = InternalSymbolIndexGetSymbol (Context, Index);
+      //
+      // Symbols may become defined during linking, check on every lookup.
+      //
+      if ((!OnlyDefined || MachoSymbolIsDefined (Context, Candidate))
+        && AsciiStrCmp (Name, MachoGetSymbolName (Context, Candidate)) == 0) {
+        *Symbol = Candidate;
+        break;
+      }
+    }
+
+    Slot = (Slot + 1) & SymbolIndex->NameMask;
+  }
+
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+InternalBuildSymbolValueIndex (
+  IN OUT OC_MACHO_CONTEXT       *Context,
+  IN OUT OC_MACHO_SYMBOL_INDEX  *SymbolIndex
+  )
+{
+  MACH_NLIST_ANY  *Symbol;
+  UINT32          NumSymbols;
+  UINT32          Index;
+  UINTN           Size;
+
+  NumSymbols = Context->Symtab->NumSymbols;
+  if (OcOverflowMulUN (NumSymbols, sizeof (OC_MACHO_ADDRESS_INDEX_ENTRY), &Size)) {
+    return FALSE;
+  }
+
+  SymbolIndex->Values = AllocatePool (Size);
+  if (SymbolIndex->Values == NULL) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < NumSymbols; ++Index) {
+    Symbol = InternalSymbolIndexGetSymbol (Context, Index);
+    SymbolIndex->Values[Index].Address = InternalSymbolIndexGetValue (Context, Symbol);
+    SymbolIndex->Values[Index].Item    = Symbol;
+  }
+
+  InternalSortAddressIndex (SymbolIndex->Values, NumSymbols);
+
+  SymbolIndex->NumValues  = NumSymbols;
+  SymbolIndex->NumChanged = 0;
+  return TRUE;
+}
+
+BOOLEAN
+InternalSymbolIndexGetByValue (
+  IN OUT OC_MACHO_CONTEXT  *Context,
+  IN     UINT64            Value,
+  OUT    MACH_NLIST_ANY    **Symbol
+  )
+{
+  OC_MACHO_SYMBOL_INDEX  *SymbolIndex;
+  MACH_NLIST_ANY         *Candidate;
+  MACH_NLIST_ANY         *Result;
+  UINT32                 Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Symbol != NULL);
+
+  SymbolIndex = InternalGetSymbolIndex (Context);
+  if (SymbolIndex == NULL || SymbolIndex->NoValues) {
+    return FALSE;
+  }
+
+  if (SymbolIndex->Values == NULL
+    && !InternalBuildSymbolValueIndex (Context, SymbolIndex)) {
+    SymbolIndex->NoValues = TRUE;
+    return FALSE;
+  }
+
+  Result = NULL;
+
+  //
+  // Entries with the same value are in symbol table order, skip the ones
+  // which value changed since sorting.
+  //
+  for (
+    Index = InternalFindAddressIndex (SymbolIndex->Values, SymbolIndex->NumValues, Value);
+    Index < SymbolIndex->NumValues && SymbolIndex->Values[Index].Address == Value;
+    ++Index
+    ) {
+    Candidate = SymbolIndex->Values[Index].Item;
+    if (InternalSymbolIndexGetValue (Context, Candidate) == Value) {
+      Result = Candidate;
+      break;
+    }
+  }
+
+  for (Index = 0; Index < SymbolIndex->NumChanged; ++Index) {
+    Candidate = (MACH_NLIST_ANY *) SymbolIndex->Changed[Index];
+    if (InternalSymbolIndexGetValue (Context, Candidate) == Value
+      && (Result == NULL || (UINTN) Candidate < (UINTN) Result)) {
+      Result = Candidate;
+    }
+  }
+
+  *Symbol = Result;
+  return TRUE;
+}
+
+VOID
+MachoSymbolValueChanged (
+  IN OUT OC_MACHO_CONTEXT      *Context,
+  IN     CONST MACH_NLIST_ANY  *Symbol
+  )
+{
+  OC_MACHO_SYMBOL_INDEX  *SymbolIndex;
+  UINT32                 Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Symbol != NULL);
+
+  SymbolIndex = Context->SymbolIndex;
+  if (SymbolIndex == NULL || SymbolIndex->Values == NULL) {
+    return;
+  }
+
+  //
+  // Only symbol table entries are looked up by value, not indirect ones.
+  //
+  if ((UINTN) Symbol < (UINTN) InternalSymbolIndexGetSymbol (Context, 0)
+    || (UINTN) Symbol >= (UINTN) InternalSymbolIndexGetSymbol (Context, SymbolIndex->NumValues)) {
+    return;
+  }
+
+  for (Index = 0; Index < SymbolIndex->NumChanged; ++Index) {
+    if (SymbolIndex->Changed[Index] == Symbol) {
+      return;
+    }
+  }
+
+  if (SymbolIndex->NumChanged == MACHO_SYMBOL_INDEX_MAX_CHANGED) {
+    //
+    // Sort again on next lookup.
+    //
+    FreePool (SymbolIndex->Values);
+    SymbolIndex->Values     = NULL;
+    SymbolIndex->NumValues  = 0;
+    SymbolIndex->NumChanged = 0;
+    return;
+  }
+
+  SymbolIndex->Changed[SymbolIndex->NumChanged] = Symbol;
+  ++SymbolIndex->NumChanged;
+}
+
+VOID
+InternalFreeSymbolIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  )
+{
+  if (Context->SymbolIndex != NULL) {
+    if (Context->SymbolIndex->Names != NULL) {
+      FreePool (Context->SymbolIndex->Names);
+    }
+
+    if (Context->SymbolIndex->Values != NULL) {
+      FreePool (Context->SymbolIndex->Values);
+    }
+
+    FreePool (Context->SymbolIndex);
+    Context->SymbolIndex = NULL;
+  }
+}
+
+VOID
+MachoEnableSymbolIndex (
+  IN OUT OC_MACHO_CONTEXT  *Context
+  )
+{
+  ASSERT (Context != NULL);
+
+  Context->UseSymbolIndex = TRUE;
+}
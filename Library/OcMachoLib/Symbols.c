@@ -63,6 +63,45 @@ MachoGetLocalDefinedSymbolByName (
     (MACH_NLIST_ANY *) MachoGetLocalDefinedSymbolByName64 (Context, Name);
 }
 
+MACH_NLIST_ANY *
+MachoGetSymbolByName (
+  IN OUT OC_MACHO_CONTEXT   *Context,
+  IN     CONST CHAR8        *Name
+  )
+{
+  MACH_NLIST_ANY  *Symbol;
+  UINT32          Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Name != NULL);
+
+  if (!InternalRetrieveSymtabs (Context)) {
+    return NULL;
+  }
+
+  if (InternalSymbolIndexGetByName (
+        Context,
+        Name,
+        0,
+        Context->Symtab->NumSymbols,
+        FALSE,
+        &Symbol
+        )) {
+    return Symbol;
+  }
+
+  for (Index = 0; ; ++Index) {
+    Symbol = MachoGetSymbolByIndex (Context, Index);
+    if (Symbol == NULL) {
+      return NULL;
+    }
+
+    if (AsciiStrCmp (Name, MachoGetSymbolName (Context, Symbol)) == 0) {
+      return Symbol;
+    }
+  }
+}
+
 MACH_NLIST_ANY *
 MachoGetSymbolByIndex (
   IN OUT OC_MACHO_CONTEXT  *Context,
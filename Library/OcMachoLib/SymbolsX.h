@@ -83,11 +83,16 @@ MACH_X (InternalGetSymbolByValue) (
   IN     MACH_UINT_X        Value
   )
 {
-  UINT32 Index;
+  UINT32          Index;
+  MACH_NLIST_ANY  *Symbol;
 
   ASSERT (Context->SymbolTable != NULL);
   ASSERT (Context->Symtab != NULL);
 
+  if (InternalSymbolIndexGetByValue (Context, Value, &Symbol)) {
+    return (MACH_NLIST_X *) Symbol;
+  }
+
   for (Index = 0; Index < Context->Symtab->NumSymbols; ++Index) {
     if ((MACH_X (&Context->SymbolTable->Symbol))[Index].Value == Value) {
       return &(MACH_X (&Context->SymbolTable->Symbol))[Index];
@@ -485,6 +490,7 @@ MACH_X (MachoGetLocalDefinedSymbolByName) (
   MACH_NLIST_X                *SymbolTable;
   CONST MACH_DYSYMTAB_COMMAND *DySymtab;
   MACH_NLIST_X                *Symbol;
+  MACH_NLIST_ANY              *IndexedSymbol;
 
   ASSERT (Context != NULL);
   ASSERT (Name != NULL);
@@ -500,6 +506,28 @@ MACH_X (MachoGetLocalDefinedSymbolByName) (
   DySymtab = Context->DySymtab;
 
   if (DySymtab != NULL) {
+    if (InternalSymbolIndexGetByName (
+          Context,
+          Name,
+          DySymtab->LocalSymbolsIndex,
+          DySymtab->NumLocalSymbols,
+          TRUE,
+          &IndexedSymbol
+          )) {
+      if (IndexedSymbol == NULL) {
+        InternalSymbolIndexGetByName (
+          Context,
+          Name,
+          DySymtab->ExternalSymbolsIndex,
+          DySymtab->NumExternalSymbols,
+          TRUE,
+          &IndexedSymbol
+          );
+      }
+
+      return (MACH_NLIST_X *) IndexedSymbol;
+    }
+
     Symbol = InternalGetLocalDefinedSymbolByNameWorker (
                Context,
                &SymbolTable[DySymtab->LocalSymbolsIndex],
@@ -516,6 +544,17 @@ MACH_X (MachoGetLocalDefinedSymbolByName) (
     }
   } else {
     ASSERT (Context->Symtab != NULL);
+    if (InternalSymbolIndexGetByName (
+          Context,
+          Name,
+          0,
+          Context->Symtab->NumSymbols,
+          TRUE,
+          &IndexedSymbol
+          )) {
+      return (MACH_NLIST_X *) IndexedSymbol;
+    }
+
     Symbol = InternalGetLocalDefinedSymbolByNameWorker (
                Context,
                SymbolTable,
@@ -573,6 +612,7 @@ MACH_X (MachoRelocateSymbol) (
     }
 
     Symbol->Value = Value;
+    MachoSymbolValueChanged (Context, (MACH_NLIST_ANY *) Symbol);
   }
 
   return TRUE;
@@ -141,6 +141,40 @@ OcAcpiPatchTables (
   UINT32               Index;
   OC_ACPI_PATCH_ENTRY  *UserPatch;
   OC_ACPI_PATCH        Patch;
+  OC_ACPI_PATCH        *Patches;
+  UINT32               *PatchIndices;
+  UINT32               *ReplaceCounts;
+  UINT32               PatchCount;
+
+  //
+  // Patches are collected first and then applied together, so that each
+  // table is scanned once for all of its patches.
+  //
+  Patches       = NULL;
+  PatchIndices  = NULL;
+  ReplaceCounts = NULL;
+  PatchCount    = 0;
+
+  if (Config->Acpi.Patch.Count > 0) {
+    Patches       = AllocatePool (Config->Acpi.Patch.Count * sizeof (*Patches));
+    PatchIndices  = AllocatePool (Config->Acpi.Patch.Count * sizeof (*PatchIndices));
+    ReplaceCounts = AllocatePool (Config->Acpi.Patch.Count * sizeof (*ReplaceCounts));
+    if (Patches == NULL || PatchIndices == NULL || ReplaceCounts == NULL) {
+      DEBUG ((DEBUG_WARN, "OC: ACPI patches will be applied separately due to allocation failure\n"));
+      if (Patches != NULL) {
+        FreePool (Patches);
+        Patches = NULL;
+      }
+      if (PatchIndices != NULL) {
+        FreePool (PatchIndices);
+        PatchIndices = NULL;
+      }
+      if (ReplaceCounts != NULL) {
+        FreePool (ReplaceCounts);
+        ReplaceCounts = NULL;
+      }
+    }
+  }
 
   for (Index = 0; Index < Config->Acpi.Patch.Count; ++Index) {
     UserPatch = Config->Acpi.Patch.Values[Index];
@@ -187,11 +221,40 @@ OcAcpiPatchTables (
     Patch.TableLength = UserPatch->TableLength;
     CopyMem (&Patch.OemTableId, UserPatch->OemTableId, sizeof (UserPatch->OemTableId));
 
+    if (Patches != NULL) {
+      CopyMem (&Patches[PatchCount], &Patch, sizeof (Patch));
+      PatchIndices[PatchCount] = Index;
+      ++PatchCount;
+      continue;
+    }
+
     Status = AcpiApplyPatch (Context, &Patch);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_WARN, "OC: ACPI patcher failed %u - %r\n", Index, Status));
     }
   }
+
+  if (Patches != NULL) {
+    Status = AcpiApplyPatches (Context, Patches, PatchCount, ReplaceCounts);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "OC: ACPI patcher failed - %r\n", Status));
+    }
+
+    for (Index = 0; Index < PatchCount; ++Index) {
+      UserPatch = Config->Acpi.Patch.Values[PatchIndices[Index]];
+      DEBUG ((
+        DEBUG_INFO,
+        "OC: ACPI patch %u (%a) replaced %u\n",
+        PatchIndices[Index],
+        OC_BLOB_GET (&UserPatch->Comment),
+        ReplaceCounts[Index]
+        ));
+    }
+
+    FreePool (Patches);
+    FreePool (PatchIndices);
+    FreePool (ReplaceCounts);
+  }
 }
 
 VOID
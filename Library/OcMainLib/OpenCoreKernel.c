@@ -21,6 +21,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/MemoryAllocationLib.h>
 #include <Library/OcAfterBootCompatLib.h>
 #include <Library/OcAppleKernelLib.h>
+#include <Library/OcDebugLogLib.h>
 #include <Library/OcMiscLib.h>
 #include <Library/OcAppleImg4Lib.h>
 #include <Library/OcStringLib.h>
@@ -43,6 +44,36 @@ STATIC BOOLEAN             mOcCachelessInProgress;
 STATIC EFI_FILE_PROTOCOL   *mCustomKernelDirectory;
 STATIC BOOLEAN             mCustomKernelDirectoryInProgress;
 
+//
+// Patched kernel cache, stored at the root of OpenCore volume.
+//
+#define OC_KERNEL_PATCH_CACHE_PATH       L"OcKernelPatchCache.bin"
+#define OC_KERNEL_PATCH_CACHE_SIGNATURE  SIGNATURE_32 ('O', 'C', 'K', 'P')
+#define OC_KERNEL_PATCH_CACHE_VERSION    1U
+
+#pragma pack(push, 1)
+
+///
+/// Kernel patch cache file header, followed by DataSize bytes of runs.
+///
+typedef PACKED struct {
+  UINT32  Signature;
+  UINT32  Version;
+  UINT8   KernelDigest[SHA256_DIGEST_SIZE];
+  UINT8   ContextDigest[SHA256_DIGEST_SIZE];
+  UINT8   DataDigest[SHA256_DIGEST_SIZE];
+  UINT32  KernelSize;
+  UINT32  AllocatedSize;
+  UINT32  PatchedSize;
+  UINT32  RunCount;
+  UINT32  DataSize;
+} OC_KERNEL_PATCH_CACHE_HEADER;
+
+#pragma pack(pop)
+
+STATIC UINT8               mKernelPatchCacheConfigDigest[SHA256_DIGEST_SIZE];
+STATIC BOOLEAN             mKernelPatchCacheInProgress;
+
 STATIC
 VOID
 OcKernelConfigureCapabilities (
@@ -1053,6 +1084,268 @@ OcKernelFuzzyMatch (
   return Status;
 }
 
+STATIC
+VOID
+OcKernelPatchCacheDigestKexts (
+  IN OUT SHA256_CONTEXT       *Context,
+  IN     OC_KERNEL_ADD_ENTRY  **Kexts,
+  IN     UINT32               KextCount
+  )
+{
+  UINT32               Index;
+  OC_KERNEL_ADD_ENTRY  *Kext;
+
+  for (Index = 0; Index < KextCount; ++Index) {
+    Kext = Kexts[Index];
+
+    Sha256Update (Context, (UINT8 *) &Kext->Enabled, sizeof (Kext->Enabled));
+    Sha256Update (Context, (UINT8 *) &Kext->PlistDataSize, sizeof (Kext->PlistDataSize));
+    if (Kext->PlistData != NULL) {
+      Sha256Update (Context, (UINT8 *) Kext->PlistData, Kext->PlistDataSize);
+    }
+
+    Sha256Update (Context, (UINT8 *) &Kext->ImageDataSize, sizeof (Kext->ImageDataSize));
+    if (Kext->ImageData != NULL) {
+      Sha256Update (Context, Kext->ImageData, Kext->ImageDataSize);
+    }
+  }
+}
+
+/**
+  Compute patch cache key. Patching result depends on the original kernel,
+  configuration, loaded kexts, and for some quirks on CPUID information.
+  OpenCore version and build date are included as patching code changes
+  between builds.
+**/
+STATIC
+VOID
+OcKernelPatchCacheKey (
+  IN  CONST UINT8  *Kernel,
+  IN  UINT32       KernelSize,
+  IN  UINT32       AllocatedSize,
+  IN  UINT32       ReservedExeSize,
+  IN  UINT32       LinkedExpansion,
+  OUT UINT8        *KernelDigest,
+  OUT UINT8        *ContextDigest
+  )
+{
+  SHA256_CONTEXT  Context;
+  CONST CHAR8     *Version;
+  UINT32          Sizes[3];
+
+  Sha256 (KernelDigest, Kernel, KernelSize);
+
+  Version  = OcMiscGetVersionString ();
+  Sizes[0] = AllocatedSize;
+  Sizes[1] = ReservedExeSize;
+  Sizes[2] = LinkedExpansion;
+
+  Sha256Init (&Context);
+  Sha256Update (&Context, (CONST UINT8 *) Version, AsciiStrLen (Version));
+  Sha256Update (&Context, mKernelPatchCacheConfigDigest, sizeof (mKernelPatchCacheConfigDigest));
+  Sha256Update (&Context, (UINT8 *) &mOcDarwinVersion, sizeof (mOcDarwinVersion));
+  Sha256Update (&Context, (UINT8 *) &mUse32BitKernel, sizeof (mUse32BitKernel));
+  Sha256Update (&Context, (UINT8 *) Sizes, sizeof (Sizes));
+
+  if (mOcConfiguration->Kernel.Quirks.ProvideCurrentCpuInfo
+    || mOcConfiguration->Kernel.Emulate.Cpuid1Data[0] != 0
+    || mOcConfiguration->Kernel.Emulate.Cpuid1Data[1] != 0
+    || mOcConfiguration->Kernel.Emulate.Cpuid1Data[2] != 0
+    || mOcConfiguration->Kernel.Emulate.Cpuid1Data[3] != 0) {
+    //
+    // Only hash CPUID information used by the patches. Measured frequencies
+    // differ between boots and would invalidate the cache every time.
+    //
+    Sha256Update (&Context, (UINT8 *) mOcCpuInfo->Vendor, sizeof (mOcCpuInfo->Vendor));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->CpuidVerEax, sizeof (mOcCpuInfo->CpuidVerEax));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->CpuidVerEbx, sizeof (mOcCpuInfo->CpuidVerEbx));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->CpuidVerEcx, sizeof (mOcCpuInfo->CpuidVerEcx));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->CpuidVerEdx, sizeof (mOcCpuInfo->CpuidVerEdx));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->MicrocodeRevision, sizeof (mOcCpuInfo->MicrocodeRevision));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->Hypervisor, sizeof (mOcCpuInfo->Hypervisor));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->CoreCount, sizeof (mOcCpuInfo->CoreCount));
+    Sha256Update (&Context, (UINT8 *) &mOcCpuInfo->ThreadCount, sizeof (mOcCpuInfo->ThreadCount));
+  }
+
+  OcKernelPatchCacheDigestKexts (
+    &Context,
+    mOcConfiguration->Kernel.Force.Values,
+    mOcConfiguration->Kernel.Force.Count
+    );
+  OcKernelPatchCacheDigestKexts (
+    &Context,
+    mOcConfiguration->Kernel.Add.Values,
+    mOcConfiguration->Kernel.Add.Count
+    );
+
+  Sha256Final (&Context, ContextDigest);
+}
+
+/**
+  Patch original kernel from the cache.
+  Any mismatch leaves the kernel untouched.
+
+  @return  TRUE if the kernel got patched.
+**/
+STATIC
+BOOLEAN
+OcKernelPatchCacheLoad (
+  IN OUT UINT8        *Kernel,
+  IN OUT UINT32       *KernelSize,
+  IN     UINT32       AllocatedSize,
+  IN     CONST UINT8  *KernelDigest,
+  IN     CONST UINT8  *ContextDigest
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_FILE_PROTOCOL             *Root;
+  EFI_FILE_PROTOCOL             *File;
+  UINT32                        FileSize;
+  OC_KERNEL_PATCH_CACHE_HEADER  Header;
+  UINT8                         *Data;
+  UINT8                         DataDigest[SHA256_DIGEST_SIZE];
+  BOOLEAN                       Result;
+
+  Status = OcFindWritableOcFileSystem (&Root);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  mKernelPatchCacheInProgress = TRUE;
+  Status = OcSafeFileOpen (Root, &File, OC_KERNEL_PATCH_CACHE_PATH, EFI_FILE_MODE_READ, 0);
+  mKernelPatchCacheInProgress = FALSE;
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OC: Kernel patch cache is missing - %r\n", Status));
+    Root->Close (Root);
+    return FALSE;
+  }
+
+  Data   = NULL;
+  Result = FALSE;
+
+  Status = OcGetFileSize (File, &FileSize);
+  if (!EFI_ERROR (Status) && FileSize >= sizeof (Header)) {
+    Status = OcGetFileData (File, 0, sizeof (Header), (UINT8 *) &Header);
+  } else {
+    Status = EFI_VOLUME_CORRUPTED;
+  }
+
+  if (!EFI_ERROR (Status)
+    && Header.Signature == OC_KERNEL_PATCH_CACHE_SIGNATURE
+    && Header.Version == OC_KERNEL_PATCH_CACHE_VERSION
+    && CompareMem (Header.KernelDigest, KernelDigest, SHA256_DIGEST_SIZE) == 0
+    && CompareMem (Header.ContextDigest, ContextDigest, SHA256_DIGEST_SIZE) == 0
+    && Header.KernelSize == *KernelSize
+    && Header.AllocatedSize == AllocatedSize
+    && Header.PatchedSize <= AllocatedSize
+    && Header.DataSize <= FileSize - sizeof (Header)) {
+    Data = AllocatePool (Header.DataSize + 1);
+    if (Data != NULL) {
+      Status = OcGetFileData (File, sizeof (Header), Header.DataSize, Data);
+      if (!EFI_ERROR (Status)) {
+        Sha256 (DataDigest, Data, Header.DataSize);
+        Result = CompareMem (DataDigest, Header.DataDigest, SHA256_DIGEST_SIZE) == 0
+          && KernelPatchCacheApplyRuns (Kernel, Header.PatchedSize, Data, Header.DataSize, Header.RunCount);
+      }
+
+      FreePool (Data);
+    }
+  }
+
+  File->Close (File);
+  Root->Close (Root);
+
+  if (Result) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OC: Kernel patch cache hit, %u runs of %u bytes, size %u -> %u\n",
+      Header.RunCount,
+      Header.DataSize,
+      *KernelSize,
+      Header.PatchedSize
+      ));
+    *KernelSize = Header.PatchedSize;
+  } else {
+    DEBUG ((DEBUG_INFO, "OC: Kernel patch cache miss\n"));
+  }
+
+  return Result;
+}
+
+/**
+  Store patched kernel difference from the original kernel to the cache.
+**/
+STATIC
+VOID
+OcKernelPatchCacheStore (
+  IN CONST UINT8  *Original,
+  IN UINT32       OriginalSize,
+  IN CONST UINT8  *Patched,
+  IN UINT32       PatchedSize,
+  IN UINT32       AllocatedSize,
+  IN CONST UINT8  *KernelDigest,
+  IN CONST UINT8  *ContextDigest
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_FILE_PROTOCOL             *Root;
+  EFI_FILE_PROTOCOL             *File;
+  OC_KERNEL_PATCH_CACHE_HEADER  *Header;
+  UINT32                        DataSize;
+  UINT32                        RunCount;
+  UINT32                        CacheSize;
+
+  DataSize = KernelPatchCacheDiff (Original, OriginalSize, Patched, PatchedSize, NULL, &RunCount);
+  if (OcOverflowAddU32 (DataSize, sizeof (*Header), &CacheSize)) {
+    return;
+  }
+
+  Header = AllocatePool (CacheSize);
+  if (Header == NULL) {
+    DEBUG ((DEBUG_INFO, "OC: Cannot allocate %u bytes for kernel patch cache\n", CacheSize));
+    return;
+  }
+
+  Header->Signature     = OC_KERNEL_PATCH_CACHE_SIGNATURE;
+  Header->Version       = OC_KERNEL_PATCH_CACHE_VERSION;
+  Header->KernelSize    = OriginalSize;
+  Header->AllocatedSize = AllocatedSize;
+  Header->PatchedSize   = PatchedSize;
+  Header->RunCount      = RunCount;
+  Header->DataSize      = DataSize;
+  KernelPatchCacheDiff (Original, OriginalSize, Patched, PatchedSize, (UINT8 *) (Header + 1), &RunCount);
+  CopyMem (Header->KernelDigest, KernelDigest, SHA256_DIGEST_SIZE);
+  CopyMem (Header->ContextDigest, ContextDigest, SHA256_DIGEST_SIZE);
+  Sha256 (Header->DataDigest, (UINT8 *) (Header + 1), DataSize);
+
+  Status = OcFindWritableOcFileSystem (&Root);
+  if (!EFI_ERROR (Status)) {
+    mKernelPatchCacheInProgress = TRUE;
+
+    //
+    // Existing file is not truncated on write, so remove it first.
+    //
+    Status = OcSafeFileOpen (Root, &File, OC_KERNEL_PATCH_CACHE_PATH, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+    if (!EFI_ERROR (Status)) {
+      File->Delete (File);
+    }
+
+    Status = OcSetFileData (Root, OC_KERNEL_PATCH_CACHE_PATH, Header, CacheSize);
+    mKernelPatchCacheInProgress = FALSE;
+    Root->Close (Root);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OC: Kernel patch cache store %u runs of %u bytes - %r\n",
+    RunCount,
+    DataSize,
+    Status
+    ));
+
+  FreePool (Header);
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -1084,12 +1377,21 @@ OcKernelFileOpen (
   UINT32             ReservedFullSize;
   CHAR16             *NewFileName;
   EFI_FILE_PROTOCOL  *EspNewHandle;
+  BOOLEAN            CacheHit;
+  UINT8              *OriginalKernel;
+  UINT32             OriginalSize;
+  UINT8              CacheKernelDigest[SHA256_DIGEST_SIZE];
+  UINT8              CacheContextDigest[SHA256_DIGEST_SIZE];
 
   if (mCustomKernelDirectoryInProgress) {
     DEBUG ((DEBUG_INFO, "OC: Skipping OpenFile hooking on ESP Kernels directory\n"));
     return OcSafeFileOpen (This, NewHandle, FileName, OpenMode, Attributes);
   }
 
+  if (mKernelPatchCacheInProgress) {
+    return OcSafeFileOpen (This, NewHandle, FileName, OpenMode, Attributes);
+  }
+
   //
   // Prevent access to cache files depending on maximum cache type allowed.
   //
@@ -1265,31 +1567,84 @@ OcKernelFileOpen (
       }
 
       //
-      // Apply patches to kernel itself, and then process prelinked.
+      // Reuse patching results from previous boot with the same kernel and configuration.
       //
-      OcKernelApplyPatches (
-        mOcConfiguration,
-        mOcCpuInfo,
-        mOcDarwinVersion,
-        mUse32BitKernel,
-        CacheTypeNone,
-        NULL,
-        Kernel,
-        KernelSize
-        );
+      CacheHit       = FALSE;
+      OriginalKernel = NULL;
+      OriginalSize   = KernelSize;
+      if (mOcConfiguration->Kernel.Scheme.CachePatchedKernel) {
+        OcKernelPatchCacheKey (
+          Kernel,
+          KernelSize,
+          AllocatedSize,
+          ReservedExeSize,
+          LinkedExpansion,
+          CacheKernelDigest,
+          CacheContextDigest
+          );
 
-      PrelinkedStatus = OcKernelProcessPrelinked (
-        mOcConfiguration,
-        mOcDarwinVersion,
-        mUse32BitKernel,
-        Kernel,
-        &KernelSize,
-        AllocatedSize,
-        LinkedExpansion,
-        ReservedExeSize
-        );
+        CacheHit = OcKernelPatchCacheLoad (
+          Kernel,
+          &KernelSize,
+          AllocatedSize,
+          CacheKernelDigest,
+          CacheContextDigest
+          );
 
-      DEBUG ((DEBUG_INFO, "OC: Prelinked status - %r\n", PrelinkedStatus));
+        if (!CacheHit) {
+          OriginalKernel = AllocateCopyPool (KernelSize, Kernel);
+        }
+      }
+
+      if (!CacheHit) {
+        //
+        // Apply patches to kernel itself, and then process prelinked.
+        //
+        OcKernelApplyPatches (
+          mOcConfiguration,
+          mOcCpuInfo,
+          mOcDarwinVersion,
+          mUse32BitKernel,
+          CacheTypeNone,
+          NULL,
+          Kernel,
+          KernelSize
+          );
+
+        PrelinkedStatus = OcKernelProcessPrelinked (
+          mOcConfiguration,
+          mOcDarwinVersion,
+          mUse32BitKernel,
+          Kernel,
+          &KernelSize,
+          AllocatedSize,
+          LinkedExpansion,
+          ReservedExeSize
+          );
+
+        DEBUG ((DEBUG_INFO, "OC: Prelinked status - %r\n", PrelinkedStatus));
+
+        if (OriginalKernel != NULL) {
+          if (!EFI_ERROR (PrelinkedStatus)) {
+            OcKernelPatchCacheStore (
+              OriginalKernel,
+              OriginalSize,
+              Kernel,
+              KernelSize,
+              AllocatedSize,
+              CacheKernelDigest,
+              CacheContextDigest
+              );
+          }
+
+          FreePool (OriginalKernel);
+        }
+
+        //
+        // The booter exits boot services soon after loading the kernel.
+        //
+        OcFlushLogProtocol ();
+      }
 
       Status = OcGetFileModificationTime (*NewHandle, &ModificationTime);
       if (EFI_ERROR (Status)) {
@@ -1491,6 +1846,8 @@ OcLoadKernelSupport (
 {
   EFI_STATUS         Status;
   EFI_FILE_PROTOCOL  *Root;
+  UINT8              *ConfigData;
+  UINT32             ConfigDataSize;
 
   Status = EnableVirtualFs (gBS, OcKernelFileOpen);
 
@@ -1501,6 +1858,7 @@ OcLoadKernelSupport (
     mOcDarwinVersion                  = 0;
     mOcCachelessInProgress            = FALSE;
     mCustomKernelDirectoryInProgress  = FALSE;
+    mKernelPatchCacheInProgress       = FALSE;
     //
     // Open customised Kernels if needed.
     //
@@ -1527,6 +1885,45 @@ OcLoadKernelSupport (
       }
     }
 
+    //
+    // Patch cache is read bypassing the vault, and its digest can be recomputed
+    // by anyone with ESP access. Only trust it when the vault is not used.
+    //
+    if (mOcConfiguration->Kernel.Scheme.CachePatchedKernel
+      && AsciiStrCmp (OC_BLOB_GET (&mOcConfiguration->Misc.Security.Vault), "Optional") != 0) {
+      DEBUG ((DEBUG_WARN, "OC: Kernel patch cache requires Optional vault mode, disabling\n"));
+      mOcConfiguration->Kernel.Scheme.CachePatchedKernel = FALSE;
+    }
+
+    //
+    // ProvideCurrentCpuInfo embeds measured CPU frequencies outside of Intel
+    // bare metal, which differ between boots.
+    //
+    if (mOcConfiguration->Kernel.Scheme.CachePatchedKernel
+      && mOcConfiguration->Kernel.Quirks.ProvideCurrentCpuInfo
+      && (mOcCpuInfo->Hypervisor || mOcCpuInfo->Vendor[0] != CPUID_VENDOR_INTEL)) {
+      DEBUG ((DEBUG_INFO, "OC: Kernel patch cache is incompatible with measured CPU frequencies, disabling\n"));
+      mOcConfiguration->Kernel.Scheme.CachePatchedKernel = FALSE;
+    }
+
+    //
+    // Configuration is a part of patch cache key.
+    //
+    if (mOcConfiguration->Kernel.Scheme.CachePatchedKernel) {
+      ConfigData = OcStorageReadFileUnicode (
+        Storage,
+        OPEN_CORE_CONFIG_PATH,
+        &ConfigDataSize
+        );
+      if (ConfigData != NULL) {
+        Sha256 (mKernelPatchCacheConfigDigest, ConfigData, ConfigDataSize);
+        FreePool (ConfigData);
+      } else {
+        DEBUG ((DEBUG_INFO, "OC: Unable to read configuration for kernel patch cache, disabling\n"));
+        mOcConfiguration->Kernel.Scheme.CachePatchedKernel = FALSE;
+      }
+    }
+
     OcImageLoaderRegisterConfigure (OcKernelConfigureCapabilities);
   } else {
     DEBUG ((DEBUG_ERROR, "OC: Failed to enable vfs - %r\n", Status));
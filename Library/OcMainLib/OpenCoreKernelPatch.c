@@ -60,6 +60,70 @@ OcKernelApplyQuirk (
   return EFI_UNSUPPORTED;
 }
 
+//
+// Kernel patch collected for application.
+//
+typedef struct {
+  CONST CHAR8  *Target;
+  CONST CHAR8  *Comment;
+  UINT32       Index;
+  EFI_STATUS   Status;
+  BOOLEAN      Applied;
+} OC_KERNEL_PATCH_STATE;
+
+STATIC
+VOID
+OcKernelApplyPatchGroup (
+  IN     KERNEL_CACHE_TYPE      CacheType,
+  IN     VOID                   *Context,
+  IN OUT PATCHER_CONTEXT        *KernelPatcher,
+  IN     CONST CHAR8            *Target,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  UINT32  Index;
+
+  if (Context == NULL) {
+    ASSERT (KernelPatcher != NULL);
+    PatcherApplyGenericPatches (KernelPatcher, Patches, PatchCount, Results);
+  } else if (CacheType == CacheTypeMkext) {
+    MkextContextApplyPatches (Context, Target, Patches, PatchCount, Results);
+  } else if (CacheType == CacheTypePrelinked) {
+    PrelinkedContextApplyPatches (Context, Target, Patches, PatchCount, Results);
+  } else {
+    for (Index = 0; Index < PatchCount; ++Index) {
+      if (CacheType == CacheTypeCacheless) {
+        Results[Index] = CachelessContextAddPatch (Context, Target, &Patches[Index]);
+      } else {
+        Results[Index] = EFI_UNSUPPORTED;
+      }
+    }
+  }
+}
+
+STATIC
+VOID
+OcKernelReportPatch (
+  IN KERNEL_CACHE_TYPE  CacheType,
+  IN UINT32             Index,
+  IN CONST CHAR8        *Target,
+  IN CONST CHAR8        *Comment,
+  IN EFI_STATUS         Status
+  )
+{
+  DEBUG ((
+    EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
+    "OC: %a patcher result %u for %a (%a) - %r\n",
+    PRINT_KERNEL_CACHE_TYPE (CacheType),
+    Index,
+    Target,
+    Comment,
+    Status
+    ));
+}
+
 VOID
 OcKernelApplyPatches (
   IN     OC_GLOBAL_CONFIG  *Config,
@@ -83,6 +147,13 @@ OcKernelApplyPatches (
   UINT32                 MaxKernel;
   UINT32                 MinKernel;
   BOOLEAN                IsKernelPatch;
+  PATCHER_GENERIC_PATCH  *Patches;
+  OC_KERNEL_PATCH_STATE  *PatchStates;
+  UINT32                 *GroupMap;
+  EFI_STATUS             *GroupResults;
+  UINT32                 PatchCount;
+  UINT32                 GroupCount;
+  UINT32                 GroupIndex;
 
   IsKernelPatch = Context == NULL;
 
@@ -100,6 +171,47 @@ OcKernelApplyPatches (
       DEBUG ((DEBUG_ERROR, "OC: Kernel patcher kernel init failure - %r\n", Status));
       return;
     }
+
+    //
+    // Symbolic patches and quirks look up dozens of kernel symbols.
+    //
+    MachoEnableSymbolIndex (&KernelPatcher.MachContext);
+  }
+
+  //
+  // Patches are collected first and then applied per target, so that each
+  // binary is scanned once for all of its patches.
+  //
+  Patches      = NULL;
+  PatchStates  = NULL;
+  GroupMap     = NULL;
+  GroupResults = NULL;
+  PatchCount   = 0;
+
+  if (Config->Kernel.Patch.Count > 0) {
+    Patches      = AllocatePool (Config->Kernel.Patch.Count * 2 * sizeof (*Patches));
+    PatchStates  = AllocatePool (Config->Kernel.Patch.Count * sizeof (*PatchStates));
+    GroupMap     = AllocatePool (Config->Kernel.Patch.Count * sizeof (*GroupMap));
+    GroupResults = AllocatePool (Config->Kernel.Patch.Count * sizeof (*GroupResults));
+    if (Patches == NULL || PatchStates == NULL || GroupMap == NULL || GroupResults == NULL) {
+      DEBUG ((DEBUG_WARN, "OC: Kernel patches will be applied separately due to allocation failure\n"));
+      if (Patches != NULL) {
+        FreePool (Patches);
+        Patches = NULL;
+      }
+      if (PatchStates != NULL) {
+        FreePool (PatchStates);
+        PatchStates = NULL;
+      }
+      if (GroupMap != NULL) {
+        FreePool (GroupMap);
+        GroupMap = NULL;
+      }
+      if (GroupResults != NULL) {
+        FreePool (GroupResults);
+        GroupResults = NULL;
+      }
+    }
   }
 
   for (Index = 0; Index < Config->Kernel.Patch.Count; ++Index) {
@@ -188,29 +300,80 @@ OcKernelApplyPatches (
     Patch.Skip    = UserPatch->Skip;
     Patch.Limit   = UserPatch->Limit;
 
-    if (IsKernelPatch) {
-      Status = PatcherApplyGenericPatch (&KernelPatcher, &Patch);
-    } else {
-      if (CacheType == CacheTypeCacheless) {
-        Status = CachelessContextAddPatch (Context, Target, &Patch);
-      } else if (CacheType == CacheTypeMkext) {
-        Status = MkextContextApplyPatch (Context, Target, &Patch);
-      } else if (CacheType == CacheTypePrelinked) {
-        Status = PrelinkedContextApplyPatch (Context, Target, &Patch);
-      } else {
-        Status = EFI_UNSUPPORTED;
-      }
+    if (Patches != NULL) {
+      CopyMem (&Patches[PatchCount], &Patch, sizeof (Patch));
+      PatchStates[PatchCount].Target  = Target;
+      PatchStates[PatchCount].Comment = Comment;
+      PatchStates[PatchCount].Index   = Index;
+      PatchStates[PatchCount].Applied = FALSE;
+      ++PatchCount;
+      continue;
     }
 
-    DEBUG ((
-      EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
-      "OC: %a patcher result %u for %a (%a) - %r\n",
-      PRINT_KERNEL_CACHE_TYPE (CacheType),
-      Index,
+    OcKernelApplyPatchGroup (
+      CacheType,
+      Context,
+      IsKernelPatch ? &KernelPatcher : NULL,
       Target,
-      Comment,
-      Status
-      ));
+      &Patch,
+      1,
+      &Status
+      );
+
+    OcKernelReportPatch (CacheType, Index, Target, Comment, Status);
+  }
+
+  if (Patches != NULL) {
+    //
+    // Second half of Patches is used for contiguous per-target groups.
+    // Different targets never share data, while patches for the same
+    // target keep their configuration order within the group.
+    //
+    for (Index = 0; Index < PatchCount; ++Index) {
+      if (PatchStates[Index].Applied) {
+        continue;
+      }
+
+      GroupCount = 0;
+      for (GroupIndex = Index; GroupIndex < PatchCount; ++GroupIndex) {
+        if (!PatchStates[GroupIndex].Applied
+          && AsciiStrCmp (PatchStates[GroupIndex].Target, PatchStates[Index].Target) == 0) {
+          CopyMem (&Patches[PatchCount + GroupCount], &Patches[GroupIndex], sizeof (*Patches));
+          GroupMap[GroupCount]            = GroupIndex;
+          PatchStates[GroupIndex].Applied = TRUE;
+          ++GroupCount;
+        }
+      }
+
+      OcKernelApplyPatchGroup (
+        CacheType,
+        Context,
+        IsKernelPatch ? &KernelPatcher : NULL,
+        PatchStates[Index].Target,
+        &Patches[PatchCount],
+        GroupCount,
+        GroupResults
+        );
+
+      for (GroupIndex = 0; GroupIndex < GroupCount; ++GroupIndex) {
+        PatchStates[GroupMap[GroupIndex]].Status = GroupResults[GroupIndex];
+      }
+    }
+
+    for (Index = 0; Index < PatchCount; ++Index) {
+      OcKernelReportPatch (
+        CacheType,
+        PatchStates[Index].Index,
+        PatchStates[Index].Target,
+        PatchStates[Index].Comment,
+        PatchStates[Index].Status
+        );
+    }
+
+    FreePool (Patches);
+    FreePool (PatchStates);
+    FreePool (GroupMap);
+    FreePool (GroupResults);
   }
 
   //
@@ -345,6 +508,8 @@ OcKernelApplyPatches (
     if (Config->Kernel.Quirks.ProvideCurrentCpuInfo) {
       PatchProvideCurrentCpuInfo (&KernelPatcher, CpuInfo, DarwinVersion);  
     }
+
+    MachoFreeContext (&KernelPatcher.MachContext);
   }
 }
 
@@ -511,6 +511,14 @@ OcMiscEarlyInit (
       ));
   }
 
+  if (Config->Misc.Security.PreverifyVault && Vault >= OcsVaultBasic) {
+    //
+    // Corrupted files are not kept, and any later access to them fails as usual.
+    //
+    Status = OcStoragePreverifyVault (Storage);
+    DEBUG ((DEBUG_INFO, "OC: Vault preverification - %r\n", Status));
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -956,6 +964,11 @@ OcMiscBoot (
     }
   }
 
+  //
+  // Files loaded past this point are not worth keeping preverified contents in memory.
+  //
+  OcStorageFreePreverified (Storage);
+
   Status = OcRunBootPicker (Context);
 
   if (EFI_ERROR (Status)) {
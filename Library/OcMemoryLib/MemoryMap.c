@@ -15,6 +15,7 @@
 #include <Uefi.h>
 
 #include <Guid/MemoryAttributesTable.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -297,138 +298,276 @@ OcGetCurrentMemoryMapAlloc (
   return Status;
 }
 
+/**
+  Swap two memory descriptors of arbitrary size.
+
+  @param[in,out]  First           First memory descriptor.
+  @param[in,out]  Second          Second memory descriptor.
+  @param[in]      DescriptorSize  Memory map descriptor size in bytes.
+**/
+STATIC
 VOID
-OcSortMemoryMap (
-  IN UINTN                      MemoryMapSize,
-  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
-  IN UINTN                      DescriptorSize
+InternalSwapDescriptors (
+  IN OUT UINT8  *First,
+  IN OUT UINT8  *Second,
+  IN     UINTN  DescriptorSize
   )
 {
-  EFI_MEMORY_DESCRIPTOR       *MemoryMapEntry;
-  EFI_MEMORY_DESCRIPTOR       *NextMemoryMapEntry;
-  EFI_MEMORY_DESCRIPTOR       *MemoryMapEnd;
-  EFI_MEMORY_DESCRIPTOR       TempMemoryMap;
+  UINT64  Temp64;
+  UINT8   Temp8;
+  UINTN   Index;
+
+  for (Index = 0; Index + sizeof (Temp64) <= DescriptorSize; Index += sizeof (Temp64)) {
+    Temp64 = ReadUnaligned64 ((UINT64 *) (First + Index));
+    WriteUnaligned64 ((UINT64 *) (First + Index), ReadUnaligned64 ((UINT64 *) (Second + Index)));
+    WriteUnaligned64 ((UINT64 *) (Second + Index), Temp64);
+  }
 
-  MemoryMapEntry = MemoryMap;
-  NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-  MemoryMapEnd = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + MemoryMapSize);
-  while (MemoryMapEntry < MemoryMapEnd) {
-    while (NextMemoryMapEntry < MemoryMapEnd) {
-      if (MemoryMapEntry->PhysicalStart > NextMemoryMapEntry->PhysicalStart) {
-        CopyMem (&TempMemoryMap, MemoryMapEntry, sizeof(EFI_MEMORY_DESCRIPTOR));
-        CopyMem (MemoryMapEntry, NextMemoryMapEntry, sizeof(EFI_MEMORY_DESCRIPTOR));
-        CopyMem (NextMemoryMapEntry, &TempMemoryMap, sizeof(EFI_MEMORY_DESCRIPTOR));
+  for (; Index < DescriptorSize; ++Index) {
+    Temp8         = First[Index];
+    First[Index]  = Second[Index];
+    Second[Index] = Temp8;
+  }
+}
+
+/**
+  Restore max-heap property by PhysicalStart for the subtree at Root.
+
+  @param[in,out]  MemoryMap       Memory map.
+  @param[in]      Root            Subtree root descriptor index.
+  @param[in]      EntryCount      Number of descriptors in the heap.
+  @param[in]      DescriptorSize  Memory map descriptor size in bytes.
+**/
+STATIC
+VOID
+InternalSiftDownDescriptor (
+  IN OUT UINT8  *MemoryMap,
+  IN     UINTN  Root,
+  IN     UINTN  EntryCount,
+  IN     UINTN  DescriptorSize
+  )
+{
+  UINTN                  Child;
+  EFI_MEMORY_DESCRIPTOR  *RootDesc;
+  EFI_MEMORY_DESCRIPTOR  *ChildDesc;
+  EFI_MEMORY_DESCRIPTOR  *NextChildDesc;
+
+  while (Root < EntryCount / 2) {
+    Child     = 2 * Root + 1;
+    ChildDesc = (EFI_MEMORY_DESCRIPTOR *) (MemoryMap + Child * DescriptorSize);
+
+    if (Child + 1 < EntryCount) {
+      NextChildDesc = NEXT_MEMORY_DESCRIPTOR (ChildDesc, DescriptorSize);
+      if (NextChildDesc->PhysicalStart > ChildDesc->PhysicalStart) {
+        ++Child;
+        ChildDesc = NextChildDesc;
       }
+    }
 
-      NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (NextMemoryMapEntry, DescriptorSize);
+    RootDesc = (EFI_MEMORY_DESCRIPTOR *) (MemoryMap + Root * DescriptorSize);
+    if (RootDesc->PhysicalStart >= ChildDesc->PhysicalStart) {
+      break;
     }
 
-    MemoryMapEntry      = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-    NextMemoryMapEntry  = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
+    InternalSwapDescriptors ((UINT8 *) RootDesc, (UINT8 *) ChildDesc, DescriptorSize);
+    Root = Child;
   }
 }
 
+/**
+  Compact sorted memory map in a single pass.
+
+  @param[in,out]  EntryCount      Memory map size in entries, updated on shrink.
+  @param[in,out]  MemoryMap       Memory map to compact.
+  @param[in]      DescriptorSize  Memory map descriptor size in bytes.
+  @param[in]      Join            Join adjacent non-runtime and same type runtime descriptors.
+  @param[in]      Deduplicate     Drop descriptors with the same range as the previous one
+                                  before it was joined with anything.
+
+  @retval EFI_SUCCESS on success.
+  @retval EFI_NOT_FOUND when cannot join or drop anything.
+**/
+STATIC
 EFI_STATUS
-OcShrinkMemoryMap (
-  IN OUT UINTN                  *MemoryMapSize,
+InternalCompactMemoryMap (
+  IN OUT UINTN                  *EntryCount,
   IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
-  IN     UINTN                  DescriptorSize
+  IN     UINTN                  DescriptorSize,
+  IN     BOOLEAN                Join,
+  IN     BOOLEAN                Deduplicate
   )
 {
   EFI_STATUS              Status;
-  UINTN                   SizeFromDescToEnd;
+  UINTN                   EntriesToGo;
   UINT64                  Bytes;
+  UINT64                  LastStart;
+  UINT64                  LastPages;
   EFI_MEMORY_DESCRIPTOR   *PrevDesc;
   EFI_MEMORY_DESCRIPTOR   *Desc;
   BOOLEAN                 CanBeJoinedFree;
   BOOLEAN                 CanBeJoinedRt;
-  BOOLEAN                 HasEntriesToRemove;
 
   Status = EFI_NOT_FOUND;
 
-  if (*MemoryMapSize <= DescriptorSize) {
+  if (*EntryCount <= 1) {
     return Status;
   }
 
-  PrevDesc           = MemoryMap;
-  Desc               = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
-  SizeFromDescToEnd  = *MemoryMapSize - DescriptorSize;
-  *MemoryMapSize     = DescriptorSize;
-  HasEntriesToRemove = FALSE;
-
-  while (SizeFromDescToEnd > 0) {
-    Bytes = EFI_PAGES_TO_SIZE (PrevDesc->NumberOfPages);
-    CanBeJoinedFree = FALSE;
-    CanBeJoinedRt   = FALSE;
-    if (Desc->Attribute == PrevDesc->Attribute
-      && PrevDesc->PhysicalStart + Bytes == Desc->PhysicalStart) {
-      //
-      // It *should* be safe to join this with conventional memory, because the firmware should not use
-      // GetMemoryMap for allocation, and for the kernel it does not matter, since it joins them.
-      //
-      CanBeJoinedFree = (
-          Desc->Type == EfiBootServicesCode
-          || Desc->Type == EfiBootServicesData
-          || Desc->Type == EfiConventionalMemory
-          || Desc->Type == EfiLoaderCode
-          || Desc->Type == EfiLoaderData
-        ) && (
-          PrevDesc->Type == EfiBootServicesCode
-          || PrevDesc->Type == EfiBootServicesData
-          || PrevDesc->Type == EfiConventionalMemory
-          || PrevDesc->Type == EfiLoaderCode
-          || PrevDesc->Type == EfiLoaderData
-        );
-
-      CanBeJoinedRt = (
-          Desc->Type == EfiRuntimeServicesCode
-          && PrevDesc->Type == EfiRuntimeServicesCode
-        ) || (
-          Desc->Type == EfiRuntimeServicesData
-          && PrevDesc->Type == EfiRuntimeServicesData
-        );
-    }
+  //
+  // PrevDesc is the last kept descriptor, every next one is either
+  // folded into it or moved right after it. Duplicates are checked against
+  // the range of the last non-duplicate descriptor as it was in the input,
+  // since PrevDesc may have already grown by joining.
+  //
+  PrevDesc    = MemoryMap;
+  LastStart   = PrevDesc->PhysicalStart;
+  LastPages   = PrevDesc->NumberOfPages;
+  Desc        = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
+  EntriesToGo = *EntryCount - 1;
+  *EntryCount = 1;
 
-    if (CanBeJoinedFree) {
+  while (EntriesToGo > 0) {
+    if (Deduplicate
+      && Desc->PhysicalStart == LastStart
+      && Desc->NumberOfPages == LastPages) {
       //
-      // Two entries are the same/similar - join them
+      // Two entries are duplicate, remove the latter.
       //
-      PrevDesc->Type           = EfiConventionalMemory;
-      PrevDesc->NumberOfPages += Desc->NumberOfPages;
-      HasEntriesToRemove       = TRUE;
-      Status                   = EFI_SUCCESS;
-    } else if (CanBeJoinedRt) {
-      PrevDesc->NumberOfPages += Desc->NumberOfPages;
-      HasEntriesToRemove       = TRUE;
-      Status                   = EFI_SUCCESS;
+      Status = EFI_SUCCESS;
     } else {
-      //
-      // Cannot be joined - we need to move to next
-      //
-      *MemoryMapSize += DescriptorSize;
-      PrevDesc        = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
-      if (HasEntriesToRemove) {
+      LastStart       = Desc->PhysicalStart;
+      LastPages       = Desc->NumberOfPages;
+      Bytes           = EFI_PAGES_TO_SIZE (PrevDesc->NumberOfPages);
+      CanBeJoinedFree = FALSE;
+      CanBeJoinedRt   = FALSE;
+      if (Join
+        && Desc->Attribute == PrevDesc->Attribute
+        && PrevDesc->PhysicalStart + Bytes == Desc->PhysicalStart) {
+        //
+        // It *should* be safe to join this with conventional memory, because the firmware should not use
+        // GetMemoryMap for allocation, and for the kernel it does not matter, since it joins them.
+        //
+        CanBeJoinedFree = (
+            Desc->Type == EfiBootServicesCode
+            || Desc->Type == EfiBootServicesData
+            || Desc->Type == EfiConventionalMemory
+            || Desc->Type == EfiLoaderCode
+            || Desc->Type == EfiLoaderData
+          ) && (
+            PrevDesc->Type == EfiBootServicesCode
+            || PrevDesc->Type == EfiBootServicesData
+            || PrevDesc->Type == EfiConventionalMemory
+            || PrevDesc->Type == EfiLoaderCode
+            || PrevDesc->Type == EfiLoaderData
+          );
+
+        CanBeJoinedRt = (
+            Desc->Type == EfiRuntimeServicesCode
+            && PrevDesc->Type == EfiRuntimeServicesCode
+          ) || (
+            Desc->Type == EfiRuntimeServicesData
+            && PrevDesc->Type == EfiRuntimeServicesData
+          );
+      }
+
+      if (CanBeJoinedFree) {
+        //
+        // Two entries are the same/similar - join them
+        //
+        PrevDesc->Type           = EfiConventionalMemory;
+        PrevDesc->NumberOfPages += Desc->NumberOfPages;
+        Status                   = EFI_SUCCESS;
+      } else if (CanBeJoinedRt) {
+        PrevDesc->NumberOfPages += Desc->NumberOfPages;
+        Status                   = EFI_SUCCESS;
+      } else {
         //
-        // Have entries between PrevDesc and Desc which are joined to PrevDesc,
-        // we need to copy [Desc, end of list] to PrevDesc + 1
+        // Cannot be joined - we need to move to next
         //
-        CopyMem (PrevDesc, Desc, SizeFromDescToEnd);
-        Desc = PrevDesc;
-        HasEntriesToRemove = FALSE;
+        ++(*EntryCount);
+        PrevDesc = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
+        if (PrevDesc != Desc) {
+          CopyMem (PrevDesc, Desc, DescriptorSize);
+        }
       }
     }
 
     Desc = NEXT_MEMORY_DESCRIPTOR (Desc, DescriptorSize);
-    SizeFromDescToEnd -= DescriptorSize;
+    --EntriesToGo;
+  }
+
+  return Status;
+}
+
+VOID
+OcSortMemoryMap (
+  IN UINTN                      MemoryMapSize,
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN UINTN                      DescriptorSize
+  )
+{
+  EFI_MEMORY_DESCRIPTOR       *MemoryMapEntry;
+  EFI_MEMORY_DESCRIPTOR       *NextMemoryMapEntry;
+  EFI_MEMORY_DESCRIPTOR       *MemoryMapEnd;
+  UINTN                       EntryCount;
+  UINTN                       Index;
+
+  if (MemoryMapSize < 2 * DescriptorSize) {
+    return;
   }
 
   //
-  // Handle last entries if they were merged.
+  // Firmware memory maps are mostly sorted already, check it first.
   //
-  if (HasEntriesToRemove) {
-    *MemoryMapSize += DescriptorSize;
+  MemoryMapEntry     = MemoryMap;
+  NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
+  MemoryMapEnd       = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + MemoryMapSize);
+  while (NextMemoryMapEntry < MemoryMapEnd
+    && MemoryMapEntry->PhysicalStart <= NextMemoryMapEntry->PhysicalStart) {
+    MemoryMapEntry     = NextMemoryMapEntry;
+    NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (NextMemoryMapEntry, DescriptorSize);
+  }
+
+  if (NextMemoryMapEntry >= MemoryMapEnd) {
+    return;
   }
 
+  //
+  // Heap sort in place, it needs no allocations and moves whole descriptors.
+  //
+  EntryCount = MemoryMapSize / DescriptorSize;
+
+  for (Index = EntryCount / 2; Index > 0; --Index) {
+    InternalSiftDownDescriptor ((UINT8 *) MemoryMap, Index - 1, EntryCount, DescriptorSize);
+  }
+
+  for (Index = EntryCount - 1; Index > 0; --Index) {
+    InternalSwapDescriptors (
+      (UINT8 *) MemoryMap,
+      (UINT8 *) MemoryMap + Index * DescriptorSize,
+      DescriptorSize
+      );
+    InternalSiftDownDescriptor ((UINT8 *) MemoryMap, 0, Index, DescriptorSize);
+  }
+}
+
+EFI_STATUS
+OcShrinkMemoryMap (
+  IN OUT UINTN                  *MemoryMapSize,
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN     UINTN                  DescriptorSize
+  )
+{
+  UINTN  EntryCount;
+
+  if (*MemoryMapSize <= DescriptorSize) {
+    return EFI_NOT_FOUND;
+  }
+
+  EntryCount = *MemoryMapSize / DescriptorSize;
+  InternalCompactMemoryMap (&EntryCount, MemoryMap, DescriptorSize, TRUE, FALSE);
+  *MemoryMapSize = EntryCount * DescriptorSize;
+
   return EFI_SUCCESS;
 }
 
@@ -439,62 +578,45 @@ OcDeduplicateDescriptors (
   IN     UINTN                  DescriptorSize
   )
 {
-  EFI_STATUS              Status;
-  UINTN                   EntriesToGo;
-  EFI_MEMORY_DESCRIPTOR   *PrevDesc;
-  EFI_MEMORY_DESCRIPTOR   *Desc;
-  BOOLEAN                 IsDuplicate;
-  BOOLEAN                 HasEntriesToRemove;
+  EFI_STATUS  Status;
+  UINTN       Count;
 
-  Status = EFI_NOT_FOUND;
-
-  if (*EntryCount <= 1) {
-    return Status;
-  }
+  Count  = *EntryCount;
+  Status = InternalCompactMemoryMap (&Count, MemoryMap, DescriptorSize, FALSE, TRUE);
+  *EntryCount = (UINT32) Count;
 
-  PrevDesc           = MemoryMap;
-  Desc               = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
-  EntriesToGo        = *EntryCount - 1;
-  *EntryCount        = 1;
-  HasEntriesToRemove = FALSE;
+  return Status;
+}
 
-  while (EntriesToGo > 0) {
-    IsDuplicate = Desc->PhysicalStart == PrevDesc->PhysicalStart
-      && Desc->NumberOfPages == PrevDesc->NumberOfPages;
+EFI_STATUS
+OcNormalizeMemoryMap (
+  IN     UINTN                  MaxMemoryMapSize,
+  IN OUT UINTN                  *MemoryMapSize,
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN     UINTN                  DescriptorSize,
+  IN     BOOLEAN                SplitByAttributes,
+  IN     BOOLEAN                Deduplicate
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       EntryCount;
 
-    if (IsDuplicate) {
-      //
-      // Two entries are duplicate, remove them.
-      //
-      Status               = EFI_SUCCESS;
-      HasEntriesToRemove   = TRUE;
-    } else {
-      //
-      // Not duplicates - we need to move to next
-      //
-      ++(*EntryCount);
-      PrevDesc = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
-      if (HasEntriesToRemove) {
-        //
-        // Have same entries between PrevDesc and Desc which are replaced by PrevDesc,
-        // we need to copy [Desc, end of list] to PrevDesc + 1.
-        //
-        CopyMem (PrevDesc, Desc, EntriesToGo * DescriptorSize);
-        Desc = PrevDesc;
-        HasEntriesToRemove = FALSE;
-      }
-    }
+  OcSortMemoryMap (*MemoryMapSize, MemoryMap, DescriptorSize);
 
-    Desc = NEXT_MEMORY_DESCRIPTOR (Desc, DescriptorSize);
-    --EntriesToGo;
+  if (SplitByAttributes) {
+    Status = OcSplitMemoryMapByAttributes (
+      MaxMemoryMapSize,
+      MemoryMapSize,
+      MemoryMap,
+      DescriptorSize
+      );
+  } else {
+    Status = EFI_SUCCESS;
   }
 
-  //
-  // Handle last entries if they were deduplicated.
-  //
-  if (HasEntriesToRemove) {
-    ++(*EntryCount);
-  }
+  EntryCount = *MemoryMapSize / DescriptorSize;
+  InternalCompactMemoryMap (&EntryCount, MemoryMap, DescriptorSize, TRUE, Deduplicate);
+  *MemoryMapSize = EntryCount * DescriptorSize;
 
   return Status;
 }
@@ -18,6 +18,11 @@
 #include <Library/OcGuardLib.h>
 #include <Library/OcMiscLib.h>
 
+//
+// Maximum amount of patches handled in a single pass, one bit per patch.
+//
+#define OC_PATCH_GROUP_SIZE  64
+
 STATIC
 BOOLEAN
 InternalFindPattern (
@@ -75,6 +80,262 @@ InternalFindPattern (
   return FALSE;
 }
 
+STATIC
+BOOLEAN
+InternalMatchPattern (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Data
+  )
+{
+  UINT32   Index;
+
+  if (PatternMask == NULL) {
+    for (Index = 0; Index < PatternSize; ++Index) {
+      if (Data[Index] != Pattern[Index]) {
+        return FALSE;
+      }
+    }
+  } else {
+    for (Index = 0; Index < PatternSize; ++Index) {
+      if ((Data[Index] & PatternMask[Index]) != Pattern[Index]) {
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+VOID
+InternalReplacePattern (
+  IN CONST UINT8   *Replace,
+  IN CONST UINT8   *ReplaceMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN OUT   UINT8   *Data
+  )
+{
+  UINT32   Index;
+
+  if (ReplaceMask == NULL) {
+    CopyMem (Data, Replace, PatternSize);
+  } else {
+    for (Index = 0; Index < PatternSize; ++Index) {
+      Data[Index] = (Data[Index] & ~ReplaceMask[Index]) | (Replace[Index] & ReplaceMask[Index]);
+    }
+  }
+}
+
+/**
+  Apply up to OC_PATCH_GROUP_SIZE patches in a single pass over Data.
+
+  Each data byte is looked up in a first byte table containing a bitmask
+  of patches, which may start with this byte, and only these patches are
+  verified at the current offset.
+**/
+STATIC
+UINT32
+InternalApplyPatchGroup (
+  IN OUT OC_DATA_PATCH  *Patches,
+  IN     UINT32         PatchCount,
+  IN OUT UINT8          *Data,
+  IN     UINT32         DataSize
+  )
+{
+  UINT64         FirstByteTable[256];
+  UINT32         LastOffset[OC_PATCH_GROUP_SIZE];
+  UINT32         NextOffset[OC_PATCH_GROUP_SIZE];
+  UINT32         Count[OC_PATCH_GROUP_SIZE];
+  UINT32         Skip[OC_PATCH_GROUP_SIZE];
+  UINT64         Active;
+  UINT64         Candidates;
+  UINT32         MaxOffset;
+  UINT32         Offset;
+  UINT32         Index;
+  UINT32         Byte;
+  UINT32         Size;
+  UINT32         ReplaceCount;
+  OC_DATA_PATCH  *Patch;
+
+  ASSERT (PatchCount <= OC_PATCH_GROUP_SIZE);
+
+  ZeroMem (FirstByteTable, sizeof (FirstByteTable));
+  Active    = 0;
+  MaxOffset = 0;
+
+  for (Index = 0; Index < PatchCount; ++Index) {
+    Patch = &Patches[Index];
+    Patch->ReplaceCount = 0;
+
+    Size = DataSize;
+    if (Patch->Limit > 0 && Patch->Limit < Size) {
+      Size = Patch->Limit;
+    }
+
+    if (Patch->PatternSize == 0 || Size < Patch->PatternSize) {
+      continue;
+    }
+
+    LastOffset[Index] = Size - Patch->PatternSize;
+    NextOffset[Index] = 0;
+    Count[Index]      = Patch->Count;
+    Skip[Index]       = Patch->Skip;
+    MaxOffset         = MAX (MaxOffset, LastOffset[Index]);
+    Active           |= LShiftU64 (1, Index);
+
+    if (Patch->PatternMask == NULL) {
+      FirstByteTable[Patch->Pattern[0]] |= LShiftU64 (1, Index);
+    } else {
+      for (Byte = 0; Byte <= MAX_UINT8; ++Byte) {
+        if ((Byte & Patch->PatternMask[0]) == Patch->Pattern[0]) {
+          FirstByteTable[Byte] |= LShiftU64 (1, Index);
+        }
+      }
+    }
+  }
+
+  ReplaceCount = 0;
+
+  for (Offset = 0; Active != 0 && Offset <= MaxOffset; ++Offset) {
+    Candidates = FirstByteTable[Data[Offset]] & Active;
+
+    while (Candidates != 0) {
+      Index       = (UINT32) LowBitSet64 (Candidates);
+      Candidates &= Candidates - 1;
+      Patch       = &Patches[Index];
+
+      if (Offset > LastOffset[Index]) {
+        Active &= ~LShiftU64 (1, Index);
+        continue;
+      }
+
+      //
+      // Matches of the same patch never overlap, just like in ApplyPatch.
+      //
+      if (Offset < NextOffset[Index]
+        || !InternalMatchPattern (Patch->Pattern, Patch->PatternMask, Patch->PatternSize, &Data[Offset])) {
+        continue;
+      }
+
+      NextOffset[Index] = Offset + Patch->PatternSize;
+
+      if (Skip[Index] > 0) {
+        --Skip[Index];
+        continue;
+      }
+
+      InternalReplacePattern (Patch->Replace, Patch->ReplaceMask, Patch->PatternSize, &Data[Offset]);
+      ++Patch->ReplaceCount;
+      ++ReplaceCount;
+
+      if (Count[Index] > 0) {
+        --Count[Index];
+        if (Count[Index] == 0) {
+          Active &= ~LShiftU64 (1, Index);
+        }
+      }
+    }
+  }
+
+  return ReplaceCount;
+}
+
+/**
+  Get patch byte value and the mask of its known bits before or after
+  the replacement.
+**/
+STATIC
+VOID
+InternalGetPatchByte (
+  IN  CONST OC_DATA_PATCH  *Patch,
+  IN        UINT32         Index,
+  IN        BOOLEAN        Replaced,
+  OUT       UINT8          *Value,
+  OUT       UINT8          *Mask
+  )
+{
+  UINT8  PatternMask;
+  UINT8  ReplaceMask;
+
+  PatternMask = Patch->PatternMask != NULL ? Patch->PatternMask[Index] : MAX_UINT8;
+
+  if (!Replaced) {
+    *Value = Patch->Pattern[Index] & PatternMask;
+    *Mask  = PatternMask;
+    return;
+  }
+
+  ReplaceMask = Patch->ReplaceMask != NULL ? Patch->ReplaceMask[Index] : MAX_UINT8;
+  *Value = (Patch->Replace[Index] & ReplaceMask) | (Patch->Pattern[Index] & PatternMask & ~ReplaceMask);
+  *Mask  = ReplaceMask | PatternMask;
+}
+
+/**
+  Check whether the bytes of two patches may overlap in any data,
+  i.e. there is a relative offset with no conflicting known bits.
+**/
+STATIC
+BOOLEAN
+InternalPatchesOverlap (
+  IN CONST OC_DATA_PATCH  *First,
+  IN       BOOLEAN        FirstReplaced,
+  IN CONST OC_DATA_PATCH  *Second,
+  IN       BOOLEAN        SecondReplaced
+  )
+{
+  INT32    Shift;
+  INT32    Index;
+  INT32    End;
+  UINT8    FirstValue;
+  UINT8    FirstMask;
+  UINT8    SecondValue;
+  UINT8    SecondMask;
+  BOOLEAN  Compatible;
+
+  //
+  // Second patch starts at Shift bytes from the start of the first patch.
+  //
+  for (Shift = 1 - (INT32) Second->PatternSize; Shift < (INT32) First->PatternSize; ++Shift) {
+    Index      = MAX (Shift, 0);
+    End        = MIN ((INT32) First->PatternSize, Shift + (INT32) Second->PatternSize);
+    Compatible = TRUE;
+
+    for (; Index < End; ++Index) {
+      InternalGetPatchByte (First, (UINT32) Index, FirstReplaced, &FirstValue, &FirstMask);
+      InternalGetPatchByte (Second, (UINT32) (Index - Shift), SecondReplaced, &SecondValue, &SecondMask);
+      if (((FirstValue ^ SecondValue) & FirstMask & SecondMask) != 0) {
+        Compatible = FALSE;
+        break;
+      }
+    }
+
+    if (Compatible) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Check whether applying two patches in a single pass may give a different
+  result from applying them one after another. This happens when a match of
+  one patch may overlap a match of another before or after its replacement.
+**/
+STATIC
+BOOLEAN
+InternalPatchesInteract (
+  IN CONST OC_DATA_PATCH  *Earlier,
+  IN CONST OC_DATA_PATCH  *Later
+  )
+{
+  return InternalPatchesOverlap (Earlier, FALSE, Later, FALSE)
+    || InternalPatchesOverlap (Earlier, TRUE, Later, FALSE)
+    || InternalPatchesOverlap (Earlier, FALSE, Later, TRUE);
+}
+
 BOOLEAN
 FindPattern (
   IN CONST UINT8   *Pattern,
@@ -155,13 +416,7 @@ ApplyPatch (
     //
     // Perform replacement.
     //
-    if (ReplaceMask == NULL) {
-      CopyMem (&Data[DataOff], Replace, PatternSize);
-    } else {
-      for (UINTN Index = 0; Index < PatternSize; ++Index) {
-        Data[DataOff + Index] = (Data[DataOff + Index] & ~ReplaceMask[Index]) | (Replace[Index] & ReplaceMask[Index]);
-      }
-    }
+    InternalReplacePattern (Replace, ReplaceMask, PatternSize, &Data[DataOff]);
     ++ReplaceCount;
     DataOff += PatternSize;
 
@@ -178,3 +433,51 @@ ApplyPatch (
 
   return ReplaceCount;
 }
+
+UINT32
+ApplyPatches (
+  IN OUT OC_DATA_PATCH  *Patches,
+  IN     UINT32         PatchCount,
+  IN OUT UINT8          *Data,
+  IN     UINT32         DataSize
+  )
+{
+  UINT32   ReplaceCount;
+  UINT32   GroupCount;
+  UINT32   Index;
+  BOOLEAN  Interacts;
+
+  ReplaceCount = 0;
+
+  while (PatchCount > 0) {
+    //
+    // Extend the group with consecutive patches, which cannot interact
+    // with the ones already in it, to preserve the order of replacements.
+    //
+    Interacts = FALSE;
+    for (GroupCount = 1; GroupCount < MIN (PatchCount, OC_PATCH_GROUP_SIZE); ++GroupCount) {
+      for (Index = 0; Index < GroupCount; ++Index) {
+        Interacts = InternalPatchesInteract (&Patches[Index], &Patches[GroupCount]);
+        if (Interacts) {
+          break;
+        }
+      }
+
+      if (Interacts) {
+        break;
+      }
+    }
+
+    ReplaceCount += InternalApplyPatchGroup (
+      Patches,
+      GroupCount,
+      Data,
+      DataSize
+      );
+
+    Patches    += GroupCount;
+    PatchCount -= GroupCount;
+  }
+
+  return ReplaceCount;
+}
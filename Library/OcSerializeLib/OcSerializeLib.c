@@ -100,7 +100,6 @@ ParseSerializedDict (
 {
   UINT32         DictSize;
   UINT32         Index;
-  UINT32         Index2;
   CONST CHAR8    *CurrentKey;
   XML_NODE       *CurrentValue;
   XML_NODE       *OldValue;
@@ -169,19 +168,7 @@ ParseSerializedDict (
       continue;
     }
 
-    for (Index2 = 0; Index2 < DictSize; ++Index2) {
-      CurrentKey = PlistKeyValue (PlistDictChild (Node, Index2, NULL));
-
-      if (CurrentKey == NULL) {
-        continue;
-      }
-
-      if (AsciiStrCmp (CurrentKey, Info->Dict.Schema[Index].Name) == 0) {
-        break;
-      }
-    }
-
-    if (Index2 == DictSize) {
+    if (PlistDictLookup (Node, Info->Dict.Schema[Index].Name, NULL) == NULL) {
       DEBUG ((
         DEBUG_WARN,
         "警告: 缺少 %a 键值, 位置: <%a>!\n",
@@ -24,6 +24,7 @@
 #include <Library/OcDevicePathLib.h>
 #include <Library/OcStringLib.h>
 #include <Library/OcStorageLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
 OC_STRUCTORS (OC_STORAGE_VAULT_HASH, ())
@@ -45,6 +46,34 @@ typedef PACKED struct {
 
 #pragma pack(pop)
 
+//
+// Files are read in 1 MB portions like in OcGetFileData, which lets us
+// hash every portion right after reading while it is still in cache.
+//
+#define OC_STORAGE_READ_CHUNK_SIZE BASE_1MB
+
+//
+// Time in nanoseconds to wait for a single non-blocking read, 1 MB takes
+// well under a second even on slow USB drives.
+//
+#define OC_STORAGE_READ_TIMEOUT  5000000000ULL
+
+//
+// Vault file state during preverification.
+//
+typedef struct {
+  EFI_FILE_PROTOCOL  *File;
+  UINT8              *Buffer;
+  UINT32             Index;
+  UINT32             Size;
+  UINT32             Offset;
+  UINT32             ChunkSize;
+  BOOLEAN            Pending;
+  EFI_STATUS         Status;
+  SHA256_CONTEXT     Hash;
+  UINT64             StartTime;
+} OC_STORAGE_PREVERIFY_FILE;
+
 //
 // We do not want to expose these for the time being!.
 //
@@ -177,7 +206,8 @@ STATIC
 UINT8 *
 OcStorageGetDigest (
   IN OUT OC_STORAGE_CONTEXT  *Context,
-  IN     CONST CHAR16        *Filename
+  IN     CONST CHAR16        *Filename,
+  OUT    UINT32              *VaultIndex  OPTIONAL
   )
 {
   UINT32             Index;
@@ -205,6 +235,9 @@ OcStorageGetDigest (
     }
 
     if (StrIndex == FilenameSize) {
+      if (VaultIndex != NULL) {
+        *VaultIndex = Index;
+      }
       return &Context->Vault.Files.Values[Index]->Hash[0];
     }
   }
@@ -212,6 +245,299 @@ OcStorageGetDigest (
   return NULL;
 }
 
+/**
+  Read file data from the beginning of the file and optionally hash it.
+
+  @param[in]  File      File to read from.
+  @param[in]  Size      Amount of bytes to read.
+  @param[out] Buffer    Destination buffer of at least Size bytes.
+  @param[out] Digest    SHA-256 digest of the data, optional.
+
+  @retval EFI_SUCCESS on success.
+**/
+STATIC
+EFI_STATUS
+OcStorageReadAndHash (
+  IN  EFI_FILE_PROTOCOL  *File,
+  IN  UINT32             Size,
+  OUT UINT8              *Buffer,
+  OUT UINT8              *Digest  OPTIONAL
+  )
+{
+  EFI_STATUS      Status;
+  SHA256_CONTEXT  HashContext;
+  UINT32          Offset;
+  UINT32          ChunkSize;
+
+  if (Digest != NULL) {
+    Sha256Init (&HashContext);
+  }
+
+  for (Offset = 0; Offset < Size; Offset += ChunkSize) {
+    ChunkSize = MIN (Size - Offset, OC_STORAGE_READ_CHUNK_SIZE);
+
+    Status = OcGetFileData (File, Offset, ChunkSize, &Buffer[Offset]);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (Digest != NULL) {
+      Sha256Update (&HashContext, &Buffer[Offset], ChunkSize);
+    }
+  }
+
+  if (Digest != NULL) {
+    Sha256Final (&HashContext, Digest);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Open the next vault file fitting the preverification memory budget.
+
+  @param[in]      Context   Storage context.
+  @param[in,out]  Index     Vault file index to start from, updated.
+  @param[in,out]  Budget    Remaining memory budget, updated.
+  @param[out]     Entry     Preverification state of the opened file.
+
+  @retval TRUE when a file was opened.
+**/
+STATIC
+BOOLEAN
+OcStoragePreverifyOpen (
+  IN     OC_STORAGE_CONTEXT         *Context,
+  IN OUT UINT32                     *Index,
+  IN OUT UINT32                     *Budget,
+  OUT    OC_STORAGE_PREVERIFY_FILE  *Entry
+  )
+{
+  EFI_STATUS  Status;
+  CHAR8       *VaultFilePath;
+  CHAR16      FilePath[OC_STORAGE_SAFE_PATH_MAX];
+
+  for (; *Index < Context->Vault.Files.Count; ++(*Index)) {
+    VaultFilePath = OC_BLOB_GET (Context->Vault.Files.Keys[*Index]);
+
+    Status = AsciiStrToUnicodeStrS (VaultFilePath, FilePath, ARRAY_SIZE (FilePath));
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "OCST: Cannot preverify %a with long path\n", VaultFilePath));
+      continue;
+    }
+
+    Entry->StartTime = GetPerformanceCounter ();
+
+    Status = OcSafeFileOpen (
+      Context->Storage,
+      &Entry->File,
+      FilePath,
+      EFI_FILE_MODE_READ,
+      0
+      );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "OCST: Cannot open %a for preverification - %r\n", VaultFilePath, Status));
+      continue;
+    }
+
+    Status = OcGetFileSize (Entry->File, &Entry->Size);
+    if (EFI_ERROR (Status) || Entry->Size >= MAX_UINT32 - 1 || Entry->Size + 2 > *Budget) {
+      DEBUG ((DEBUG_INFO, "OCST: Not preverifying %a (%u) - %r\n", VaultFilePath, Entry->Size, Status));
+      Entry->File->Close (Entry->File);
+      continue;
+    }
+
+    Entry->Buffer = AllocatePool (Entry->Size + 2);
+    if (Entry->Buffer == NULL) {
+      Entry->File->Close (Entry->File);
+      continue;
+    }
+
+    *Budget       -= Entry->Size + 2;
+    Entry->Index   = (*Index)++;
+    Entry->Offset  = 0;
+    Entry->Pending = FALSE;
+    Entry->Status  = EFI_SUCCESS;
+    Sha256Init (&Entry->Hash);
+    return TRUE;
+  }
+
+  Entry->File = NULL;
+  return FALSE;
+}
+
+/**
+  Start reading the next portion of vault file being preverified.
+  Non-blocking I/O is used when supported by the file protocol,
+  otherwise the portion is read right away.
+
+  @param[in,out]  Entry     Preverification state of the file.
+  @param[in,out]  Token     I/O token, its event is closed when non-blocking
+                            I/O turns out to be unsupported.
+**/
+STATIC
+VOID
+OcStoragePreverifyIssue (
+  IN OUT OC_STORAGE_PREVERIFY_FILE  *Entry,
+  IN OUT EFI_FILE_IO_TOKEN          *Token
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       ReadSize;
+
+  Entry->ChunkSize = MIN (Entry->Size - Entry->Offset, OC_STORAGE_READ_CHUNK_SIZE);
+  Entry->Pending   = FALSE;
+
+  if (Entry->ChunkSize == 0) {
+    Entry->Status = EFI_SUCCESS;
+    return;
+  }
+
+  //
+  // Reposition before every portion, see OcGetFileData.
+  //
+  Entry->Status = Entry->File->SetPosition (Entry->File, Entry->Offset);
+  if (EFI_ERROR (Entry->Status)) {
+    return;
+  }
+
+  if (Token->Event != NULL && Entry->File->Revision >= EFI_FILE_PROTOCOL_REVISION2) {
+    Token->Status     = EFI_NOT_READY;
+    Token->BufferSize = Entry->ChunkSize;
+    Token->Buffer     = &Entry->Buffer[Entry->Offset];
+
+    Status = Entry->File->ReadEx (Entry->File, Token);
+    if (!EFI_ERROR (Status)) {
+      Entry->Pending = TRUE;
+      return;
+    }
+
+    if (Status != EFI_UNSUPPORTED) {
+      Entry->Status = Status;
+      return;
+    }
+
+    DEBUG ((DEBUG_INFO, "OCST: Non-blocking file I/O is unsupported\n"));
+    gBS->CloseEvent (Token->Event);
+    Token->Event = NULL;
+  }
+
+  ReadSize = Entry->ChunkSize;
+  Entry->Status = Entry->File->Read (Entry->File, &ReadSize, &Entry->Buffer[Entry->Offset]);
+  if (!EFI_ERROR (Entry->Status) && ReadSize != Entry->ChunkSize) {
+    Entry->Status = EFI_BAD_BUFFER_SIZE;
+  }
+}
+
+/**
+  Wait for the portion of vault file being preverified to be read.
+
+  On timeout the read is left pending with EFI_TIMEOUT status, and neither
+  its buffer nor the token may be reused.
+
+  @param[in,out]  Entry     Preverification state of the file.
+  @param[in]      Token     I/O token used for the read.
+**/
+STATIC
+VOID
+OcStoragePreverifyWait (
+  IN OUT OC_STORAGE_PREVERIFY_FILE  *Entry,
+  IN     EFI_FILE_IO_TOKEN          *Token
+  )
+{
+  UINT64  StartTime;
+
+  if (!Entry->Pending) {
+    return;
+  }
+
+  //
+  // Token status is updated right before the event is signaled, yet some
+  // drivers complete the request without signaling, so check both.
+  // CheckEvent also clears the signaled state for the next request.
+  //
+  StartTime = GetPerformanceCounter ();
+  while (Token->Status == EFI_NOT_READY) {
+    if (!EFI_ERROR (gBS->CheckEvent (Token->Event))) {
+      break;
+    }
+
+    if (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime) > OC_STORAGE_READ_TIMEOUT) {
+      DEBUG ((DEBUG_INFO, "OCST: Non-blocking read at %u timed out\n", Entry->Offset));
+      Entry->Status = EFI_TIMEOUT;
+      return;
+    }
+  }
+  gBS->CheckEvent (Token->Event);
+
+  Entry->Pending = FALSE;
+  Entry->Status  = Token->Status;
+  if (!EFI_ERROR (Entry->Status) && Token->BufferSize != Entry->ChunkSize) {
+    Entry->Status = EFI_BAD_BUFFER_SIZE;
+  }
+}
+
+/**
+  Complete preverification of vault file and keep its contents on success.
+
+  @param[in,out]  Context   Storage context.
+  @param[in,out]  Entry     Preverification state of the file.
+  @param[in,out]  Budget    Remaining memory budget, updated.
+
+  @retval EFI_SUCCESS when the file matches vault digest.
+**/
+STATIC
+EFI_STATUS
+OcStoragePreverifyFinish (
+  IN OUT OC_STORAGE_CONTEXT         *Context,
+  IN OUT OC_STORAGE_PREVERIFY_FILE  *Entry,
+  IN OUT UINT32                     *Budget
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       FileDigest[SHA256_DIGEST_SIZE];
+
+  //
+  // The file and the buffer of a timed out read may still be in use by the driver.
+  //
+  if (!Entry->Pending) {
+    Entry->File->Close (Entry->File);
+  }
+  Entry->File = NULL;
+
+  Status = Entry->Status;
+  if (!EFI_ERROR (Status)) {
+    Sha256Final (&Entry->Hash, FileDigest);
+    if (CompareMem (FileDigest, Context->Vault.Files.Values[Entry->Index]->Hash, SHA256_DIGEST_SIZE) != 0) {
+      Status = EFI_SECURITY_VIOLATION;
+    }
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OCST: Preverified %a (%u) in %Lu us - %r\n",
+    OC_BLOB_GET (Context->Vault.Files.Keys[Entry->Index]),
+    Entry->Size,
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - Entry->StartTime), 1000),
+    Status
+    ));
+
+  if (EFI_ERROR (Status)) {
+    if (!Entry->Pending) {
+      FreePool (Entry->Buffer);
+      *Budget += Entry->Size + 2;
+    }
+    return Status;
+  }
+
+  Entry->Buffer[Entry->Size]     = 0;
+  Entry->Buffer[Entry->Size + 1] = 0;
+
+  Context->VaultData[Entry->Index].Buffer = Entry->Buffer;
+  Context->VaultData[Entry->Index].Size   = Entry->Size;
+
+  return EFI_SUCCESS;
+}
+
 EFI_STATUS
 OcStorageInitFromFs (
   OUT OC_STORAGE_CONTEXT               *Context,
@@ -312,6 +638,25 @@ OcStorageInitFromFs (
   return Status;
 }
 
+VOID
+OcStorageFreePreverified (
+  IN OUT OC_STORAGE_CONTEXT            *Context
+  )
+{
+  UINT32  Index;
+
+  if (Context->VaultData != NULL) {
+    for (Index = 0; Index < Context->Vault.Files.Count; ++Index) {
+      if (Context->VaultData[Index].Buffer != NULL) {
+        FreePool (Context->VaultData[Index].Buffer);
+      }
+    }
+
+    FreePool (Context->VaultData);
+    Context->VaultData = NULL;
+  }
+}
+
 VOID
 OcStorageFree (
   IN OUT OC_STORAGE_CONTEXT            *Context
@@ -331,6 +676,8 @@ OcStorageFree (
     Context->Storage = NULL;
   }
 
+  OcStorageFreePreverified (Context);
+
   if (Context->HasVault) {
     OC_STORAGE_VAULT_DESTRUCT (&Context->Vault, sizeof (Context->Vault));
     Context->HasVault = FALSE;
@@ -354,7 +701,7 @@ OcStorageExistsFileUnicode (
   ASSERT (FilePath != NULL);
   ASSERT (StrLen (FilePath) > 0);
 
-  VaultDigest = OcStorageGetDigest (Context, FilePath);
+  VaultDigest = OcStorageGetDigest (Context, FilePath, NULL);
 
   if (VaultDigest != NULL) {
     return TRUE;
@@ -392,6 +739,7 @@ OcStorageReadFileUnicode (
   UINT32             Size;
   UINT8              *FileBuffer;
   UINT8              *VaultDigest;
+  UINT32             VaultIndex;
   UINT8              FileDigest[SHA256_DIGEST_SIZE];
 
   //
@@ -401,13 +749,30 @@ OcStorageReadFileUnicode (
   ASSERT (FilePath != NULL);
   ASSERT (StrLen (FilePath) > 0);
 
-  VaultDigest = OcStorageGetDigest (Context, FilePath);
+  VaultIndex  = 0;
+  VaultDigest = OcStorageGetDigest (Context, FilePath, &VaultIndex);
 
   if (Context->HasVault && VaultDigest == NULL) {
     DEBUG ((DEBUG_ERROR, "OCST: Aborting %s file access not present in vault\n", FilePath));
     return NULL;
   }
 
+  if (VaultDigest != NULL
+    && Context->VaultData != NULL
+    && Context->VaultData[VaultIndex].Buffer != NULL) {
+    //
+    // Hand over preverified contents, any later access reads the file again.
+    //
+    FileBuffer = Context->VaultData[VaultIndex].Buffer;
+    Context->VaultData[VaultIndex].Buffer = NULL;
+
+    if (FileSize != NULL) {
+      *FileSize = Context->VaultData[VaultIndex].Size;
+    }
+
+    return FileBuffer;
+  }
+
   if (Context->Storage == NULL) {
     //
     // TODO: expand support for other contexts.
@@ -439,15 +804,19 @@ OcStorageReadFileUnicode (
     return NULL;
   }
 
-  Status = OcGetFileData (File, 0, Size, FileBuffer);
+  Status = OcStorageReadAndHash (
+    File,
+    Size,
+    FileBuffer,
+    VaultDigest != NULL ? FileDigest : NULL
+    );
   File->Close (File);
   if (EFI_ERROR (Status)) {
     FreePool (FileBuffer);
     return NULL;
   }
 
-  if (VaultDigest != 0) {
-    Sha256 (FileDigest, FileBuffer, Size);
+  if (VaultDigest != NULL) {
     if (CompareMem (FileDigest, VaultDigest, SHA256_DIGEST_SIZE) != 0) {
       DEBUG ((DEBUG_ERROR, "OCST: Aborting corrupted %s file access\n", FilePath));
       FreePool (FileBuffer);
@@ -465,6 +834,143 @@ OcStorageReadFileUnicode (
   return FileBuffer;
 }
 
+EFI_STATUS
+OcStoragePreverifyVault (
+  IN OUT OC_STORAGE_CONTEXT            *Context
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_STATUS                 Result;
+  EFI_FILE_IO_TOKEN          *Token;
+  EFI_FILE_IO_TOKEN          BlockingToken;
+  OC_STORAGE_PREVERIFY_FILE  Files[2];
+  OC_STORAGE_PREVERIFY_FILE  *Current;
+  OC_STORAGE_PREVERIFY_FILE  *Next;
+  UINT32                     Index;
+  UINT32                     Budget;
+  UINT32                     Verified;
+  UINT32                     ChunkOffset;
+  UINT32                     ChunkSize;
+  EFI_STATUS                 ChunkStatus;
+  UINT64                     StartTime;
+
+  ASSERT (Context != NULL);
+
+  if (!Context->HasVault || Context->Storage == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (Context->VaultData != NULL) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  if (Context->Vault.Files.Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Context->VaultData = AllocateZeroPool (Context->Vault.Files.Count * sizeof (*Context->VaultData));
+  if (Context->VaultData == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem (&BlockingToken, sizeof (BlockingToken));
+  ZeroMem (Files, sizeof (Files));
+
+  //
+  // Without an event all reads are blocking. The token is allocated,
+  // as it must outlive a timed out request.
+  //
+  Token = AllocateZeroPool (sizeof (*Token));
+  if (Token != NULL) {
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Token->Event);
+    if (EFI_ERROR (Status)) {
+      FreePool (Token);
+      Token = NULL;
+    }
+  }
+
+  if (Token == NULL) {
+    Token = &BlockingToken;
+  }
+
+  StartTime = GetPerformanceCounter ();
+  Result    = EFI_SUCCESS;
+  Index     = 0;
+  Budget    = OC_STORAGE_PREVERIFY_MAX_SIZE;
+  Verified  = 0;
+  Current   = &Files[0];
+  Next      = &Files[1];
+
+  if (OcStoragePreverifyOpen (Context, &Index, &Budget, Current)) {
+    OcStoragePreverifyIssue (Current, Token);
+  }
+
+  //
+  // Only one read is in flight at a time: while it is served,
+  // the previous portion, possibly of the previous file, is hashed.
+  //
+  while (Current->File != NULL) {
+    OcStoragePreverifyWait (Current, Token);
+
+    if (Current->Pending) {
+      //
+      // Abandon the timed out request and its token, and read the rest blocking.
+      //
+      Token = &BlockingToken;
+    }
+
+    ChunkOffset      = Current->Offset;
+    ChunkSize        = Current->ChunkSize;
+    ChunkStatus      = Current->Status;
+    Current->Offset += ChunkSize;
+
+    if (EFI_ERROR (ChunkStatus)) {
+      Current->Offset = Current->Size;
+    }
+
+    if (Current->Offset < Current->Size) {
+      OcStoragePreverifyIssue (Current, Token);
+    } else if (OcStoragePreverifyOpen (Context, &Index, &Budget, Next)) {
+      OcStoragePreverifyIssue (Next, Token);
+    }
+
+    if (!EFI_ERROR (ChunkStatus)) {
+      Sha256Update (&Current->Hash, &Current->Buffer[ChunkOffset], ChunkSize);
+    }
+
+    if (Current->Offset == Current->Size) {
+      Current->Status = ChunkStatus;
+      Status = OcStoragePreverifyFinish (Context, Current, &Budget);
+      if (!EFI_ERROR (Status)) {
+        ++Verified;
+      } else if (Result != EFI_SECURITY_VIOLATION) {
+        Result = Status;
+      }
+
+      Current = Next;
+      Next    = Current == &Files[0] ? &Files[1] : &Files[0];
+    }
+  }
+
+  if (Token != &BlockingToken) {
+    if (Token->Event != NULL) {
+      gBS->CloseEvent (Token->Event);
+    }
+    FreePool (Token);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OCST: Preverified %u of %u vault files in %Lu us - %r\n",
+    Verified,
+    Context->Vault.Files.Count,
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000),
+    Result
+    ));
+
+  return Result;
+}
+
 EFI_STATUS
 OcStorageGetInfo (
   IN  OC_STORAGE_CONTEXT               *Context,
@@ -48,17 +48,32 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/OcStringLib.h>
 
 /**
-  Minimal extra allocation size during export.
+  Minimal arena block size allocated when the initial estimate is exhausted.
 **/
-#define XML_EXPORT_MIN_ALLOCATION_SIZE 4096
+#define XML_ARENA_MIN_BLOCK_SIZE 65536
+
+/**
+  Minimal number of plist dictionary entries to build a key index for.
+  Smaller dictionaries are scanned linearly.
+**/
+#define XML_DICT_INDEX_MIN_ENTRIES 16
+
+//
+// Source fixups keep the buffer offset in the lower bits and the original
+// ASCII character overwritten by the parser in the upper bits.
+//
+#define XML_FIXUP_OFFSET_BITS 25
+#define XML_FIXUP_OFFSET_MASK ((1U << XML_FIXUP_OFFSET_BITS) - 1)
 
 #define XML_PLIST_HEADER  "<?xml version=\"1.0\" encoding=\"UTF-8\"?><!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">"
 
 struct XML_NODE_LIST_;
 struct XML_PARSER_;
+struct XML_ARENA_;
 
 typedef struct XML_NODE_LIST_ XML_NODE_LIST;
 typedef struct XML_PARSER_ XML_PARSER;
+typedef struct XML_ARENA_ XML_ARENA;
 
 /**
   An XML_NODE will always contain a tag name and possibly a list of
@@ -70,12 +85,62 @@ struct XML_NODE_ {
   CONST CHAR8    *Content;
   XML_NODE       *Real;
   XML_NODE_LIST  *Children;
+  //
+  // Document arena owning the node, its children and child list, or NULL.
+  //
+  XML_ARENA      *Arena;
+  //
+  // Unmodified node source range, SourceLength is 0 when unavailable.
+  //
+  UINT32         SourceOffset;
+  UINT32         SourceLength;
 };
 
+/**
+  Plist dictionary key index, open addressing with linear probing.
+**/
+typedef struct {
+  //
+  // Link in the arena index list for arena documents.
+  //
+  LIST_ENTRY  Link;
+  UINT32      Mask;
+  //
+  // Dictionary entry index + 1, 0 for empty slots.
+  //
+  UINT32      Slots[];
+} XML_DICT_INDEX;
+
 struct XML_NODE_LIST_ {
-  UINT32    NodeCount;
-  UINT32    AllocCount;
-  XML_NODE  *NodeList[];
+  UINT32          NodeCount;
+  UINT32          AllocCount;
+  //
+  // Lazily built by PlistDictLookup, dropped on modification.
+  //
+  XML_DICT_INDEX  *DictIndex;
+  XML_NODE        *NodeList[];
+};
+
+/**
+  Arena block, allocations are served from Data.
+**/
+typedef struct XML_ARENA_BLOCK_ XML_ARENA_BLOCK;
+struct XML_ARENA_BLOCK_ {
+  XML_ARENA_BLOCK  *Next;
+  UINT32           Size;
+  UINT32           Used;
+  UINT64           Data[];
+};
+
+/**
+  Arena of document nodes and child lists, including the ones created
+  after parsing, e.g. by XmlNodeAppend. Dictionary indices are allocated
+  from pool, as they are dropped on modification, and linked here.
+**/
+struct XML_ARENA_ {
+  XML_ARENA_BLOCK  *Blocks;
+  UINT32           NextBlockSize;
+  LIST_ENTRY       DictIndices;
 };
 
 typedef struct {
@@ -95,18 +160,46 @@ struct XML_DOCUMENT_ {
 
   XML_NODE      *Root;
   XML_REFLIST   References;
+  XML_ARENA     Arena;
+  //
+  // Characters overwritten in Buffer by parsing, so that unmodified nodes
+  // can be exported from Buffer. Sorted by offset, NULL when unavailable.
+  //
+  UINT32        *SourceFixups;
+  UINT32        SourceFixupCount;
 };
 
 /**
   Parser context.
 **/
 struct XML_PARSER_ {
-  CHAR8  *Buffer;
-  UINT32 Position;
-  UINT32 Length;
-  UINT32 Level;
+  CHAR8           *Buffer;
+  UINT32          Position;
+  UINT32          Length;
+  UINT32          Level;
+  XML_ARENA       *Arena;
+  UINT32          *ChildCounts;
+  UINT32          ChildCountsSize;
+  BOOLEAN         KeepSource;
+  UINT32          *Fixups;
+  UINT32          FixupCount;
+  UINT32          FixupAllocCount;
+  XML_PARSE_STATS Stats;
 };
 
+/**
+  Export context, nothing is written past Capacity or while Buffer is NULL.
+**/
+typedef struct {
+  CHAR8         *Buffer;
+  UINT32        Capacity;
+  UINT32        Size;
+  CONST CHAR8   *Source;
+  CONST UINT32  *SourceFixups;
+  UINT32        SourceFixupCount;
+  BOOLEAN       Overflow;
+} XML_EXPORT_CONTEXT;
+
 /**
   Character offsets.
 **/
@@ -186,9 +279,167 @@ XmlParseAttributeNumber (
   return TRUE;
 }
 
+/**
+  Add a new block to the arena.
+
+  @param[in,out]  Arena      A pointer to the arena.
+  @param[in]      BlockSize  Block data size.
+
+  @retval  TRUE on successful allocation.
+**/
+STATIC
+BOOLEAN
+XmlArenaGrow (
+  IN OUT  XML_ARENA  *Arena,
+  IN      UINT32     BlockSize
+  )
+{
+  XML_ARENA_BLOCK  *Block;
+
+  ASSERT (Arena != NULL);
+
+  Block = AllocatePool (sizeof (XML_ARENA_BLOCK) + BlockSize);
+  if (Block == NULL) {
+    return FALSE;
+  }
+
+  Block->Next   = Arena->Blocks;
+  Block->Size   = BlockSize;
+  Block->Used   = 0;
+  Arena->Blocks = Block;
+
+  return TRUE;
+}
+
+/**
+  Free all arena blocks and dictionary indices.
+
+  @param[in,out]  Arena  A pointer to the arena.
+**/
+STATIC
+VOID
+XmlArenaFree (
+  IN OUT  XML_ARENA  *Arena
+  )
+{
+  XML_ARENA_BLOCK  *Block;
+  XML_DICT_INDEX   *DictIndex;
+
+  ASSERT (Arena != NULL);
+
+  while (!IsListEmpty (&Arena->DictIndices)) {
+    DictIndex = BASE_CR (GetFirstNode (&Arena->DictIndices), XML_DICT_INDEX, Link);
+    RemoveEntryList (&DictIndex->Link);
+    FreePool (DictIndex);
+  }
+
+  while (Arena->Blocks != NULL) {
+    Block         = Arena->Blocks;
+    Arena->Blocks = Block->Next;
+    FreePool (Block);
+  }
+}
+
+/**
+  Allocate memory for nodes and child lists.
+
+  @param[in,out]  Parser  A pointer to the XML parser. Optional.
+  @param[in,out]  Arena   A pointer to the document arena. Optional.
+  @param[in]      Size    Allocation size.
+
+  @return  Allocated memory from pool or document arena, or NULL.
+**/
+STATIC
+VOID *
+XmlAllocate (
+  IN OUT  XML_PARSER  *Parser  OPTIONAL,
+  IN OUT  XML_ARENA   *Arena   OPTIONAL,
+  IN      UINT32      Size
+  )
+{
+  XML_ARENA_BLOCK  *Block;
+  VOID             *Memory;
+
+  if (Parser != NULL) {
+    Parser->Stats.BytesUsed += Size;
+  }
+
+  if (Arena == NULL) {
+    if (Parser != NULL) {
+      ++Parser->Stats.AllocationCount;
+    }
+    return AllocatePool (Size);
+  }
+
+  Size  = (UINT32) ALIGN_VALUE (Size, sizeof (UINT64));
+  Block = Arena->Blocks;
+  if (Block == NULL || Block->Size - Block->Used < Size) {
+    if (!XmlArenaGrow (Arena, MAX (Arena->NextBlockSize, Size))) {
+      return NULL;
+    }
+
+    if (Parser != NULL) {
+      ++Parser->Stats.AllocationCount;
+    }
+    Block = Arena->Blocks;
+
+    //
+    // Grow geometrically to keep block count small.
+    //
+    if (Arena->NextBlockSize < XML_PARSER_MAX_SIZE) {
+      Arena->NextBlockSize *= 2;
+    }
+  }
+
+  Memory       = (UINT8 *) Block->Data + Block->Used;
+  Block->Used += Size;
+
+  return Memory;
+}
+
+/**
+  Create a new XML node list.
+
+  @param[in,out]  Parser      A pointer to the XML parser. Optional.
+  @param[in,out]  Arena       A pointer to the document arena. Optional.
+  @param[in]      AllocCount  Number of nodes to allocate room for.
+
+  @return  The created XML node list.
+**/
+STATIC
+XML_NODE_LIST *
+XmlNodeListCreate (
+  IN OUT  XML_PARSER  *Parser  OPTIONAL,
+  IN OUT  XML_ARENA   *Arena   OPTIONAL,
+  IN      UINT32      AllocCount
+  )
+{
+  XML_NODE_LIST  *List;
+
+  List = XmlAllocate (
+    Parser,
+    Arena,
+    (UINT32) (sizeof (XML_NODE_LIST) + sizeof (List->NodeList[0]) * AllocCount)
+    );
+
+  if (List != NULL) {
+    List->NodeCount  = 0;
+    List->AllocCount = AllocCount;
+    List->DictIndex  = NULL;
+
+    if (Parser != NULL) {
+      ++Parser->Stats.ListCount;
+    }
+  }
+
+  return List;
+}
+
 /**
   Create a new XML node.
 
+  @param[in,out]  Parser  A pointer to the XML parser. Optional.
+  @param[in,out]  Arena   A pointer to the document arena. Optional.
   @param[in]  Name        Name of the new node.
   @param[in]  Attributes  Attributes of the new node. Optional.
   @param[in]  Content     Content of the new node. Optional.
@@ -200,6 +451,8 @@ XmlParseAttributeNumber (
 STATIC
 XML_NODE *
 XmlNodeCreate (
+  IN OUT  XML_PARSER       *Parser      OPTIONAL,
+  IN OUT  XML_ARENA        *Arena       OPTIONAL,
   IN  CONST CHAR8          *Name,
   IN  CONST CHAR8          *Attributes  OPTIONAL,
   IN  CONST CHAR8          *Content     OPTIONAL,
@@ -211,7 +464,7 @@ XmlNodeCreate (
 
   ASSERT (Name != NULL);
 
-  Node = AllocatePool (sizeof (XML_NODE));
+  Node = XmlAllocate (Parser, Arena, sizeof (XML_NODE));
 
   if (Node != NULL) {
     Node->Name       = Name;
@@ -219,6 +472,9 @@ XmlNodeCreate (
     Node->Content    = Content;
     Node->Real       = Real;
     Node->Children   = Children;
+    Node->Arena      = Arena;
+    Node->SourceOffset = 0;
+    Node->SourceLength = 0;
   }
 
   return Node;
@@ -227,16 +483,18 @@ XmlNodeCreate (
 /**
   Add a child node to the node given.
 
-  @param[in,out]  Node   Pointer to the XML node to which the child will be added.
-  @param[in]      Child  Pointer to the child XML node.
+  @param[in,out]  Parser  A pointer to the XML parser. Optional.
+  @param[in,out]  Node    Pointer to the XML node to which the child will be added.
+  @param[in]      Child   Pointer to the child XML node.
 
   @retval  TRUE on successful adding.
 **/
 STATIC
 BOOLEAN
 XmlNodeChildPush (
-  IN OUT  XML_NODE  *Node,
-  IN      XML_NODE  *Child
+  IN OUT  XML_PARSER  *Parser  OPTIONAL,
+  IN OUT  XML_NODE    *Node,
+  IN      XML_NODE    *Child
   )
 {
   UINT32         NodeCount;
@@ -249,6 +507,19 @@ XmlNodeChildPush (
   NodeCount  = 0;
   AllocCount = 1;
 
+  //
+  // Node is modified and needs to be exported from scratch.
+  //
+  Node->SourceLength = 0;
+
+  if (Node->Children != NULL && Node->Children->DictIndex != NULL) {
+    if (Node->Arena != NULL) {
+      RemoveEntryList (&Node->Children->DictIndex->Link);
+    }
+    FreePool (Node->Children->DictIndex);
+    Node->Children->DictIndex = NULL;
+  }
+
   //
   // Push new node if there is enough room.
   //
@@ -276,16 +547,13 @@ XmlNodeChildPush (
   //
   AllocCount *= 3;
 
-  NewList = (XML_NODE_LIST *) AllocatePool (
-    sizeof (XML_NODE_LIST) + sizeof (NewList->NodeList[0]) * AllocCount
-    );
+  NewList = XmlNodeListCreate (Parser, Node->Arena, AllocCount);
 
   if (NewList == NULL) {
     return FALSE;
   }
 
-  NewList->NodeCount  = NodeCount + 1;
-  NewList->AllocCount = AllocCount;
+  NewList->NodeCount = NodeCount + 1;
 
   if (Node->Children != NULL) {
     CopyMem (
@@ -294,7 +562,12 @@ XmlNodeChildPush (
       sizeof (NewList->NodeList[0]) * NodeCount
       );
 
-    FreePool (Node->Children);
+    //
+    // Arena lists are released with the document.
+    //
+    if (Node->Arena == NULL) {
+      FreePool (Node->Children);
+    }
   }
 
   NewList->NodeList[NodeCount] = Child;
@@ -398,9 +671,10 @@ XmlNodeReal (
 }
 
 /**
-  Free the resources allocated by the node.
+  Free the resources allocated by the node. Arena nodes, their children
+  and dictionary indices are only released with the document arena.
 
-  @param[in,out]  Node  A pointer to the XML node to be freed.
+  @param[in,out]  Node   A pointer to the XML node to be freed.
 **/
 STATIC
 VOID
@@ -412,10 +686,17 @@ XmlNodeFree (
 
   ASSERT (Node != NULL);
 
+  if (Node->Arena != NULL) {
+    return;
+  }
+
   if (Node->Children != NULL) {
     for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
       XmlNodeFree (Node->Children->NodeList[Index]);
     }
+    if (Node->Children->DictIndex != NULL) {
+      FreePool (Node->Children->DictIndex);
+    }
     FreePool (Node->Children);
   }
 
@@ -613,6 +894,65 @@ XmlParserConsume (
   }
 }
 
+/**
+  Terminate a string in the buffer. When the source is kept for export,
+  the overwritten character is recorded, offsets must be increasing.
+
+  @param[in,out]  Parser  A pointer to the XML parser.
+  @param[in]      Offset  Buffer offset of the terminator.
+**/
+STATIC
+VOID
+XmlParserTerminate (
+  IN OUT  XML_PARSER  *Parser,
+  IN      UINT32      Offset
+  )
+{
+  UINT32  *NewFixups;
+  UINT32  NewAllocCount;
+  UINT8   Original;
+
+  ASSERT (Parser != NULL);
+  ASSERT (Offset < Parser->Length);
+
+  Original = (UINT8) Parser->Buffer[Offset];
+
+  if (Parser->KeepSource && Original != '\0') {
+    ASSERT (Parser->FixupCount == 0
+      || (Parser->Fixups[Parser->FixupCount - 1] & XML_FIXUP_OFFSET_MASK) < Offset);
+
+    if (Parser->FixupCount == Parser->FixupAllocCount) {
+      NewFixups = NULL;
+      if (!OcOverflowMulU32 (MAX (Parser->FixupAllocCount, 512), 2, &NewAllocCount)) {
+        NewFixups = AllocatePool (NewAllocCount * sizeof (Parser->Fixups[0]));
+      }
+
+      if (NewFixups != NULL && Parser->Fixups != NULL) {
+        CopyMem (NewFixups, Parser->Fixups, Parser->FixupCount * sizeof (Parser->Fixups[0]));
+        FreePool (Parser->Fixups);
+      }
+
+      if (NewFixups != NULL) {
+        Parser->Fixups          = NewFixups;
+        Parser->FixupAllocCount = NewAllocCount;
+      }
+    }
+
+    //
+    // Nodes completed so far have all their fixups, the rest will not keep
+    // their source. Terminators replace ASCII delimiters and whitespace only.
+    //
+    if (Parser->FixupCount < Parser->FixupAllocCount && Original < 0x80) {
+      Parser->Fixups[Parser->FixupCount] = ((UINT32) Original << XML_FIXUP_OFFSET_BITS) | Offset;
+      ++Parser->FixupCount;
+    } else {
+      Parser->KeepSource = FALSE;
+    }
+  }
+
+  Parser->Buffer[Offset] = '\0';
+}
+
 /**
   Skip to the next non-whitespace character.
 
@@ -655,16 +995,19 @@ XmlParseTagEnd (
      OUT  CONST CHAR8  **Attributes  OPTIONAL
   )
 {
-  CHAR8   Current;
-  UINT32  Start;
-  UINT32  AttributeStart;
-  UINT32  Length = 0;
-  UINT32  NameLength = 0;
+  CHAR8    Current;
+  UINT32   Start;
+  UINT32   AttributeStart;
+  UINT32   Length = 0;
+  UINT32   NameLength = 0;
+  BOOLEAN  HasAttributes;
 
   ASSERT (Parser != NULL);
 
   XML_PARSER_INFO (Parser, "tag_end");
 
+  HasAttributes = FALSE;
+
   Current = XmlParserPeek (Parser, CURRENT_CHARACTER);
   Start = Parser->Position;
 
@@ -702,7 +1045,7 @@ XmlParseTagEnd (
         ++(*Attributes);
         ++AttributeStart;
       }
-      Parser->Buffer[Start + Length] = '\0';
+      HasAttributes = TRUE;
     }
   } else {
     //
@@ -732,9 +1075,12 @@ XmlParseTagEnd (
   XmlParserConsume (Parser, 1);
 
   //
-  // Return parsed tag name.
+  // Return parsed tag name, terminators are placed in buffer order.
   //
-  Parser->Buffer[Start + NameLength] = 0;
+  XmlParserTerminate (Parser, Start + NameLength);
+  if (HasAttributes) {
+    XmlParserTerminate (Parser, Start + Length);
+  }
   XML_PARSER_TAG (Parser, &Parser->Buffer[Start]);
   return &Parser->Buffer[Start];
 }
@@ -989,127 +1335,397 @@ XmlParseContent (
   //
   // Return text.
   //
-  Parser->Buffer[Start + Length] = 0;
+  XmlParserTerminate (Parser, (UINT32) (Start + Length));
   XmlParserConsume (Parser, 1);
   return &Parser->Buffer[Start];
 }
 
 /**
-  Print to growing buffer always preserving one byte extra.
+  Append data to export buffer or only account for its size.
+
+  @param[in,out]  Context     A pointer to the export context.
+  @param[in]      Data        Data to be appended.
+  @param[in]      DataLength  Length of Data.
+**/
+STATIC
+VOID
+XmlExportAppend (
+  IN OUT  XML_EXPORT_CONTEXT  *Context,
+  IN      CONST CHAR8         *Data,
+  IN      UINT32              DataLength
+  )
+{
+  ASSERT (Context != NULL);
+  ASSERT (Data    != NULL);
+
+  if (Context->Overflow) {
+    return;
+  }
+
+  if (Context->Buffer != NULL && Context->Size <= Context->Capacity
+    && DataLength <= Context->Capacity - Context->Size) {
+    CopyMem (&Context->Buffer[Context->Size], Data, DataLength);
+  }
+
+  Context->Overflow = OcOverflowAddU32 (Context->Size, DataLength, &Context->Size);
+}
+
+/**
+  Append unmodified node source to export buffer or only account for its size.
 
-  @param[in,out]  Buffer       A pointer to the buffer holding contents.
-  @param[in,out]  AllocSize    Size of Buffer to be allocated.
-  @param[in,out]  CurrentSize  Current size of Buffer before appending.
-  @param[in]      Data         Data to be appended.
-  @param[in]      DataLength   Length of Data.
+  @param[in,out]  Context       A pointer to the export context.
+  @param[in]      SourceOffset  Node source offset.
+  @param[in]      SourceLength  Node source length.
 **/
 STATIC
 VOID
-XmlBufferAppend (
-  IN OUT  CHAR8        **Buffer,
-  IN OUT  UINT32       *AllocSize,
-  IN OUT  UINT32       *CurrentSize,
-  IN      CONST CHAR8  *Data,
-  IN      UINT32       DataLength
+XmlExportAppendSource (
+  IN OUT  XML_EXPORT_CONTEXT  *Context,
+  IN      UINT32              SourceOffset,
+  IN      UINT32              SourceLength
   )
 {
-  CHAR8   *NewBuffer;
-  UINT32  NewSize;
+  CHAR8   *Destination;
+  UINT32  Start;
+  UINT32  End;
+  UINT32  Middle;
+  UINT32  Offset;
+
+  ASSERT (Context != NULL);
 
-  ASSERT (Buffer      != NULL);
-  ASSERT (AllocSize   != NULL);
-  ASSERT (CurrentSize != NULL);
-  ASSERT (Data        != NULL);
+  if (Context->Overflow) {
+    return;
+  }
 
-  NewSize = *AllocSize;
+  if (Context->Buffer == NULL || Context->Size > Context->Capacity
+    || SourceLength > Context->Capacity - Context->Size) {
+    XmlExportAppend (Context, &Context->Source[SourceOffset], SourceLength);
+    return;
+  }
 
-  if (NewSize - *CurrentSize <= DataLength) {
-    if (DataLength + 1 <= XML_EXPORT_MIN_ALLOCATION_SIZE) {
-      NewSize += XML_EXPORT_MIN_ALLOCATION_SIZE;
+  Destination = &Context->Buffer[Context->Size];
+  XmlExportAppend (Context, &Context->Source[SourceOffset], SourceLength);
+
+  //
+  // Restore the characters replaced by terminators during parsing.
+  //
+  Start = 0;
+  End   = Context->SourceFixupCount;
+  while (Start < End) {
+    Middle = Start + (End - Start) / 2;
+    if ((Context->SourceFixups[Middle] & XML_FIXUP_OFFSET_MASK) < SourceOffset) {
+      Start = Middle + 1;
     } else {
-      NewSize += DataLength + 1;
+      End = Middle;
+    }
+  }
+
+  for (; Start < Context->SourceFixupCount; ++Start) {
+    Offset = Context->SourceFixups[Start] & XML_FIXUP_OFFSET_MASK;
+    if (Offset - SourceOffset >= SourceLength) {
+      break;
     }
 
-    NewBuffer = AllocatePool (NewSize);
-    if (NewBuffer == NULL) {
-      XML_USAGE_ERROR("XmlBufferAppend::failed to allocate");
-      return;
+    Destination[Offset - SourceOffset] = (CHAR8) (Context->SourceFixups[Start] >> XML_FIXUP_OFFSET_BITS);
+  }
+}
+
+/**
+  Invalidate source ranges of modified nodes and their parents.
+
+  @param[in,out]  Node  A pointer to the XML node.
+
+  @retval  TRUE if Node source range can be reused.
+**/
+STATIC
+BOOLEAN
+XmlNodeValidateSource (
+  IN OUT  XML_NODE  *Node
+  )
+{
+  UINT32   Index;
+  BOOLEAN  Valid;
+
+  ASSERT (Node != NULL);
+
+  Valid = Node->SourceLength != 0;
+
+  //
+  // All children must be visited to invalidate nested modifications.
+  //
+  if (Node->Children != NULL) {
+    for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
+      if (!XmlNodeValidateSource (Node->Children->NodeList[Index])) {
+        Valid = FALSE;
+      }
     }
+  }
 
-    CopyMem (NewBuffer, *Buffer, *CurrentSize);
-    FreePool (*Buffer);
-    *Buffer    = NewBuffer;
-    *AllocSize = NewSize;
+  if (!Valid) {
+    Node->SourceLength = 0;
   }
 
-  CopyMem (&(*Buffer)[*CurrentSize], Data, DataLength);
-  *CurrentSize += DataLength;
+  return Valid;
 }
 
 /**
-  Print node to growing buffer always preserving one byte extra.
+  Export node, copying unmodified subtrees from document source.
 
-  @param[in]      Node         A pointer to the XML node.
-  @param[in,out]  Buffer       A pointer to the buffer holding contents exported.
-  @param[in,out]  AllocSize    Size of Buffer to be allocated.
-  @param[in,out]  CurrentSize  Current size of Buffer.
-  @param[in]      Skip         Levels of XML contents to be skipped.
+  @param[in,out]  Context  A pointer to the export context.
+  @param[in]      Node     A pointer to the XML node.
+  @param[in]      Skip     Levels of XML contents to be skipped.
 **/
 STATIC
 VOID
 XmlNodeExportRecursive (
-  IN      CONST XML_NODE  *Node,
-  IN OUT  CHAR8           **Buffer,
-  IN OUT  UINT32          *AllocSize,
-  IN OUT  UINT32          *CurrentSize,
-  IN      UINT32          Skip
+  IN OUT  XML_EXPORT_CONTEXT  *Context,
+  IN      CONST XML_NODE      *Node,
+  IN      UINT32              Skip
   )
 {
   UINT32  Index;
   UINT32  NameLength;
 
-  ASSERT (Node        != NULL);
-  ASSERT (Buffer      != NULL);
-  ASSERT (AllocSize   != NULL);
-  ASSERT (CurrentSize != NULL);
+  ASSERT (Context != NULL);
+  ASSERT (Node    != NULL);
 
   if (Skip != 0) {
     if (Node->Children != NULL) {
       for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
-        XmlNodeExportRecursive (Node->Children->NodeList[Index], Buffer, AllocSize, CurrentSize, Skip - 1);
+        XmlNodeExportRecursive (Context, Node->Children->NodeList[Index], Skip - 1);
       }
     }
 
     return;
   }
 
+  if (Context->Source != NULL && Node->SourceLength != 0) {
+    XmlExportAppendSource (Context, Node->SourceOffset, Node->SourceLength);
+    return;
+  }
+
   NameLength = (UINT32) AsciiStrLen (Node->Name);
 
-  XmlBufferAppend (Buffer, AllocSize, CurrentSize, "<", L_STR_LEN ("<"));
-  XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Name, NameLength);
+  XmlExportAppend (Context, "<", L_STR_LEN ("<"));
+  XmlExportAppend (Context, Node->Name, NameLength);
 
   if (Node->Attributes != NULL) {
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, " ", L_STR_LEN (" "));
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Attributes, (UINT32) AsciiStrLen (Node->Attributes));
+    XmlExportAppend (Context, " ", L_STR_LEN (" "));
+    XmlExportAppend (Context, Node->Attributes, (UINT32) AsciiStrLen (Node->Attributes));
   }
 
   if (Node->Children != NULL || Node->Content != NULL) {
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, ">", L_STR_LEN (">"));
+    XmlExportAppend (Context, ">", L_STR_LEN (">"));
 
     if (Node->Children != NULL) {
       for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
-        XmlNodeExportRecursive (Node->Children->NodeList[Index], Buffer, AllocSize, CurrentSize, 0);
+        XmlNodeExportRecursive (Context, Node->Children->NodeList[Index], 0);
       }
     } else {
-      XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Content, (UINT32) AsciiStrLen (Node->Content));
+      XmlExportAppend (Context, Node->Content, (UINT32) AsciiStrLen (Node->Content));
     }
 
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, "</", L_STR_LEN ("</"));
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Name, NameLength);
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, ">", L_STR_LEN (">"));
+    XmlExportAppend (Context, "</", L_STR_LEN ("</"));
+    XmlExportAppend (Context, Node->Name, NameLength);
+    XmlExportAppend (Context, ">", L_STR_LEN (">"));
   } else {
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, "/>", L_STR_LEN ("/>"));
+    XmlExportAppend (Context, "/>", L_STR_LEN ("/>"));
+  }
+}
+
+/**
+  Export document or only calculate its size in a single pass.
+  Source ranges must be validated by the caller.
+
+  @param[in]   Document          A pointer to the XML document.
+  @param[out]  Buffer            Destination buffer, NULL to calculate size.
+  @param[in]   Capacity          Destination buffer size without trailing '\0'.
+  @param[in]   Skip              Number of root levels to be skipped.
+  @param[in]   PrependPlistInfo  TRUE to prepend XML plist doc info.
+
+  @return  Exported size without trailing '\0' or MAX_UINT32 on overflow.
+           Buffer is only fully written when this is at most Capacity.
+**/
+STATIC
+UINT32
+XmlDocumentExportWorker (
+  IN   CONST XML_DOCUMENT  *Document,
+  OUT  CHAR8               *Buffer  OPTIONAL,
+  IN   UINT32              Capacity,
+  IN   UINT32              Skip,
+  IN   BOOLEAN             PrependPlistInfo
+  )
+{
+  XML_EXPORT_CONTEXT  Context;
+
+  ZeroMem (&Context, sizeof (Context));
+  Context.Buffer   = Buffer;
+  Context.Capacity = Capacity;
+
+  if (Document->SourceFixups != NULL) {
+    Context.Source           = Document->Buffer.Buffer;
+    Context.SourceFixups     = Document->SourceFixups;
+    Context.SourceFixupCount = Document->SourceFixupCount;
+  }
+
+  if (PrependPlistInfo) {
+    XmlExportAppend (&Context, XML_PLIST_HEADER, L_STR_LEN (XML_PLIST_HEADER));
+  }
+
+  XmlNodeExportRecursive (&Context, Document->Root, Skip);
+
+  //
+  // Leave room for the null terminator.
+  //
+  if (Context.Overflow || Context.Size == MAX_UINT32) {
+    return MAX_UINT32;
+  }
+
+  return Context.Size;
+}
+
+/**
+  Map plist tag name to its static copy, so that casts may compare pointers.
+
+  @param[in]  Name  Tag name.
+
+  @return  Interned tag name or Name.
+**/
+STATIC
+CONST CHAR8 *
+XmlInternName (
+  IN  CONST CHAR8  *Name
+  )
+{
+  UINT32  Index;
+
+  for (Index = PLIST_NODE_TYPE_ARRAY; Index < PLIST_NODE_TYPE_MAX; ++Index) {
+    if (Name[0] == PlistNodeTypes[Index][0]
+      && AsciiStrCmp (Name, PlistNodeTypes[Index]) == 0) {
+      return PlistNodeTypes[Index];
+    }
   }
+
+  return Name;
+}
+
+/**
+  Count direct children of every node in document order without parsing.
+  This only needs to agree with XmlParseNode on valid documents, as child
+  lists still grow when the count is wrong.
+
+  @param[in]   Buffer     Chunk to be parsed.
+  @param[in]   Length     Size of the buffer.
+  @param[out]  NodeCount  Number of counted nodes.
+
+  @return  Child counts allocated from pool or NULL.
+**/
+STATIC
+UINT32 *
+XmlCountChildren (
+  IN   CONST CHAR8  *Buffer,
+  IN   UINT32       Length,
+  OUT  UINT32       *NodeCount
+  )
+{
+  UINT32   *Counts;
+  UINT32   *NewCounts;
+  UINT32   CountsSize;
+  UINT32   Count;
+  UINT32   Stack[XML_PARSER_NEST_LEVEL + 2];
+  UINT32   Level;
+  UINT32   Position;
+
+  Counts     = NULL;
+  CountsSize = 0;
+  Count      = 0;
+  Level      = 0;
+  Position   = 0;
+
+  while (Position < Length) {
+    if (Buffer[Position] != '<') {
+      ++Position;
+      continue;
+    }
+
+    ++Position;
+    if (Position >= Length) {
+      break;
+    }
+
+    if (Buffer[Position] == '!'
+      && Length - Position > 2
+      && Buffer[Position + 1] == '-'
+      && Buffer[Position + 2] == '-') {
+      //
+      // Skip comment up to `-->'.
+      //
+      Position += 3;
+      while (Length - Position > 2
+        && (Buffer[Position] != '-' || Buffer[Position + 1] != '-' || Buffer[Position + 2] != '>')) {
+        ++Position;
+      }
+      Position += 3;
+      continue;
+    }
+
+    if (Buffer[Position] == '?' || Buffer[Position] == '!') {
+      //
+      // Control sequences end with `>', which is skipped with content.
+      //
+      continue;
+    }
+
+    if (Buffer[Position] == '/') {
+      if (Level > 0) {
+        --Level;
+      }
+      continue;
+    }
+
+    if (Count == CountsSize) {
+      CountsSize = CountsSize == 0 ? 1024 : CountsSize * 2;
+      NewCounts  = AllocatePool (CountsSize * sizeof (Counts[0]));
+      if (NewCounts == NULL) {
+        if (Counts != NULL) {
+          FreePool (Counts);
+        }
+        return NULL;
+      }
+
+      if (Counts != NULL) {
+        CopyMem (NewCounts, Counts, Count * sizeof (Counts[0]));
+        FreePool (Counts);
+      }
+      Counts = NewCounts;
+    }
+
+    Counts[Count] = 0;
+    if (Level > 0) {
+      ++Counts[Stack[Level - 1]];
+    }
+
+    //
+    // Tags not ending with `/>' have children or content.
+    //
+    while (Position < Length && Buffer[Position] != '/' && Buffer[Position] != '>') {
+      ++Position;
+    }
+
+    if (Position < Length && Buffer[Position] == '>') {
+      if (Level == XML_PARSER_NEST_LEVEL + 2) {
+        FreePool (Counts);
+        return NULL;
+      }
+      Stack[Level] = Count;
+      ++Level;
+    }
+
+    ++Count;
+  }
+
+  *NodeCount = Count;
+  return Counts;
 }
 
 /**
@@ -1145,6 +1761,9 @@ XmlParseNode (
   XML_NODE     *Node;
   XML_NODE     *Child;
   UINT32       ReferenceNumber;
+  UINT32       NodeIndex;
+  UINT32       SourceOffset;
+  UINT32       SourceEnd;
   BOOLEAN      IsReference;
   BOOLEAN      SelfClosing;
   BOOLEAN      Unprefixed;
@@ -1171,18 +1790,34 @@ XmlParseNode (
     return NULL;
   }
 
+  //
+  // Node source starts right at `<' before the tag name.
+  //
+  SourceOffset = (UINT32) (TagOpen - Parser->Buffer) - 1;
+  SourceEnd    = Parser->Position;
+
   XmlSkipWhitespace (Parser);
 
-  Node = XmlNodeCreate (TagOpen, Attributes, NULL, XmlNodeReal (References, Attributes), NULL);
+  if (Parser->Arena != NULL) {
+    TagOpen = XmlInternName (TagOpen);
+  }
+
+  Node = XmlNodeCreate (Parser, Parser->Arena, TagOpen, Attributes, NULL, XmlNodeReal (References, Attributes), NULL);
   if (Node == NULL) {
     XML_PARSER_ERROR (Parser, NO_CHARACTER, "XmlParseNode::node alloc fail");
     return NULL;
   }
 
+  NodeIndex = Parser->Stats.NodeCount++;
+
   //
   // If tag ends with `/' it's self closing, skip content lookup.
   //
   if (SelfClosing) {
+    if (Parser->KeepSource) {
+      Node->SourceOffset = SourceOffset;
+      Node->SourceLength = SourceEnd - SourceOffset;
+    }
     return Node;
   }
 
@@ -1226,6 +1861,22 @@ XmlParseNode (
 
     HasChildren = FALSE;
 
+    //
+    // Preallocate exactly sized child list when children were counted.
+    //
+    if (NodeIndex < Parser->ChildCountsSize && Parser->ChildCounts[NodeIndex] > 0) {
+      Node->Children = XmlNodeListCreate (
+        Parser,
+        Parser->Arena,
+        (UINT32) MIN (Parser->ChildCounts[NodeIndex], XML_PARSER_NODE_COUNT)
+        );
+      if (Node->Children == NULL) {
+        XML_PARSER_ERROR (Parser, NO_CHARACTER, "XmlParseNode::list alloc fail");
+        XmlNodeFree (Node);
+        return NULL;
+      }
+    }
+
     while ('/' != XmlParserPeek (Parser, NEXT_CHARACTER)) {
 
       //
@@ -1244,7 +1895,7 @@ XmlParseNode (
         return NULL;
       }
 
-      if (!XmlNodeChildPush (Node, Child)) {
+      if (!XmlNodeChildPush (Parser, Node, Child)) {
         XML_PARSER_ERROR (Parser, NO_CHARACTER, "XmlParseNode::node push fail");
         XmlNodeFree (Node);
         XmlNodeFree (Child);
@@ -1256,6 +1907,16 @@ XmlParseNode (
 
     --Parser->Level;
 
+    //
+    // Keep childless nodes without a list if the child count was wrong.
+    //
+    if (!HasChildren && Node->Children != NULL) {
+      if (Node->Arena == NULL) {
+        FreePool (Node->Children);
+      }
+      Node->Children = NULL;
+    }
+
     if (!HasChildren && References != NULL && Attributes != NULL) {
       IsReference = XmlParseAttributeNumber (
         Node->Attributes,
@@ -1291,20 +1952,29 @@ XmlParseNode (
     return NULL;
   }
 
+  if (Parser->KeepSource) {
+    Node->SourceOffset = SourceOffset;
+    Node->SourceLength = Parser->Position - SourceOffset;
+  }
+
   return Node;
 }
 
 XML_DOCUMENT *
-XmlDocumentParse (
-  IN OUT  CHAR8    *Buffer,
-  IN      UINT32   Length,
-  IN      BOOLEAN  WithRefs
+XmlDocumentParseEx (
+  IN OUT  CHAR8            *Buffer,
+  IN      UINT32           Length,
+  IN      BOOLEAN          WithRefs,
+  IN      UINT32           Flags,
+     OUT  XML_PARSE_STATS  *Stats  OPTIONAL
   )
 {
   XML_NODE      *Root;
   XML_DOCUMENT  *Document;
   XML_REFLIST   References;
   XML_PARSER    Parser;
+  UINT64        ArenaSize;
+  UINT32        Index;
 
   ASSERT (Buffer != NULL);
 
@@ -1325,34 +1995,107 @@ XmlDocumentParse (
   }
 
   //
-  // Parse the root node.
+  // Arena nodes reference the document arena, so allocate the document first.
   //
-  Root = XmlParseNode (&Parser, WithRefs ? &References : NULL);
-  if (Root == NULL) {
-    XML_PARSER_ERROR (&Parser, NO_CHARACTER, "XmlDocumentParse::parsing document failed");
+  Document = AllocateZeroPool (sizeof (XML_DOCUMENT));
+  if (Document == NULL) {
+    XML_PARSER_ERROR (&Parser, NO_CHARACTER, "XmlDocumentParse::document allocation failed");
     return NULL;
   }
 
+  InitializeListHead (&Document->Arena.DictIndices);
+
   //
-  // Return parsed document.
+  // Parsing terminates strings in the buffer, record the overwritten characters
+  // for export. Failing to allocate them is not fatal, the nodes parsed after
+  // that will be serialised.
   //
-  Document = AllocatePool (sizeof(XML_DOCUMENT));
+  Parser.KeepSource = (Flags & XML_PARSE_KEEP_SOURCE) != 0;
 
-  if (Document == NULL) {
-    XML_PARSER_ERROR (&Parser, NO_CHARACTER, "XmlDocumentParse::document allocation failed");
-    XmlNodeFree (Root);
+  //
+  // Failing to count children is not fatal, lists will grow as usual.
+  //
+  if ((Flags & XML_PARSE_COUNT_CHILDREN) != 0) {
+    Parser.ChildCounts = XmlCountChildren (Buffer, Length, &Parser.ChildCountsSize);
+    if (Parser.ChildCounts == NULL) {
+      Parser.ChildCountsSize = 0;
+    }
+  }
+
+  if ((Flags & XML_PARSE_ARENA) != 0) {
+    //
+    // Size the first block exactly with counted children, otherwise assume
+    // roughly one node per 16 bytes of text with list overhead.
+    //
+    if (Parser.ChildCounts != NULL) {
+      ArenaSize = (UINT64) Parser.ChildCountsSize * ALIGN_VALUE (sizeof (XML_NODE), sizeof (UINT64));
+      for (Index = 0; Index < Parser.ChildCountsSize; ++Index) {
+        if (Parser.ChildCounts[Index] > 0) {
+          ArenaSize += ALIGN_VALUE (
+            sizeof (XML_NODE_LIST) + sizeof (XML_NODE *) * MIN (Parser.ChildCounts[Index], XML_PARSER_NODE_COUNT),
+            sizeof (UINT64)
+            );
+        }
+      }
+    } else {
+      ArenaSize = (UINT64) Length * 4;
+    }
+
+    ArenaSize = MIN (MAX (ArenaSize, XML_ARENA_MIN_BLOCK_SIZE), XML_PARSER_MAX_SIZE * 4);
+    if (XmlArenaGrow (&Document->Arena, (UINT32) ArenaSize)) {
+      ++Parser.Stats.AllocationCount;
+      Document->Arena.NextBlockSize = XML_ARENA_MIN_BLOCK_SIZE;
+      Parser.Arena                  = &Document->Arena;
+    }
+  }
+
+  //
+  // Parse the root node.
+  //
+  Root = XmlParseNode (&Parser, WithRefs ? &References : NULL);
+
+  if (Parser.ChildCounts != NULL) {
+    FreePool (Parser.ChildCounts);
+  }
+
+  if (Root == NULL) {
+    XML_PARSER_ERROR (&Parser, NO_CHARACTER, "XmlDocumentParse::parsing document failed");
     XmlFreeRefs (&References);
+    XmlArenaFree (&Document->Arena);
+    FreePool (Document);
+    if (Parser.Fixups != NULL) {
+      FreePool (Parser.Fixups);
+    }
     return NULL;
   }
 
+  //
+  // Return parsed document.
+  //
   Document->Buffer.Buffer = Buffer;
   Document->Buffer.Length = Length;
   Document->Root = Root;
+  Document->SourceFixups     = Parser.Fixups;
+  Document->SourceFixupCount = Parser.FixupCount;
   CopyMem (&Document->References, &References, sizeof (References));
 
+  if (Stats != NULL) {
+    CopyMem (Stats, &Parser.Stats, sizeof (*Stats));
+  }
+
   return Document;
 }
 
+XML_DOCUMENT *
+XmlDocumentParse (
+  IN OUT  CHAR8    *Buffer,
+  IN      UINT32   Length,
+  IN      BOOLEAN  WithRefs
+  )
+{
+  return XmlDocumentParseEx (Buffer, Length, WithRefs, 0, NULL);
+}
+
 CHAR8 *
 XmlDocumentExport (
   IN   CONST XML_DOCUMENT  *Document,
@@ -1362,62 +2105,83 @@ XmlDocumentExport (
   )
 {
   CHAR8   *Buffer;
-  CHAR8   *NewBuffer;
-  UINT32  AllocSize;
-  UINT32  CurrentSize;
-  UINT32  NewSize;
+  UINT32  Size;
 
   ASSERT (Document != NULL);
 
-  AllocSize = Document->Buffer.Length + 1;
-  Buffer    = AllocatePool (AllocSize);
+  if (Document->SourceFixups != NULL) {
+    XmlNodeValidateSource (Document->Root);
+  }
+
+  Size = XmlDocumentExportWorker (Document, NULL, 0, Skip, PrependPlistInfo);
+  if (Size == MAX_UINT32) {
+    XML_USAGE_ERROR ("XmlDocumentExport::document is too large");
+    return NULL;
+  }
+
+  //
+  // Include null terminator.
+  //
+  Buffer = AllocatePool (Size + 1);
   if (Buffer == NULL) {
     XML_USAGE_ERROR ("XmlDocumentExport::failed to allocate");
     return NULL;
   }
 
-  CurrentSize = 0;
-  XmlNodeExportRecursive (Document->Root, &Buffer, &AllocSize, &CurrentSize, Skip);
+  XmlDocumentExportWorker (Document, Buffer, Size, Skip, PrependPlistInfo);
+  Buffer[Size] = '\0';
 
-  if (PrependPlistInfo) {
-    //
-    // XmlNodeExportRecursive returns a size that does not include the null terminator,
-    // but the allocated buffer does. During this reallocation, we count the null terminator
-    // of the plist header instead to ensure allocated buffer is the proper size.
-    //
-    if (OcOverflowAddU32 (CurrentSize, L_STR_SIZE (XML_PLIST_HEADER), &NewSize)) {
-      FreePool (Buffer);
-      return NULL;
-    }
+  if (Length != NULL) {
+    *Length = Size;
+  }
 
-    NewBuffer = AllocatePool (NewSize);
-    if (NewBuffer == NULL) {
-      FreePool (Buffer);
-      XML_USAGE_ERROR ("XmlDocumentExport::failed to allocate");
-      return NULL;
-    }
-    CopyMem (NewBuffer, XML_PLIST_HEADER, L_STR_SIZE_NT (XML_PLIST_HEADER));
-    CopyMem (&NewBuffer[L_STR_LEN (XML_PLIST_HEADER)], Buffer, CurrentSize);
-    FreePool (Buffer);
+  return Buffer;
+}
 
-    //
-    // Null terminator is not included in size returned by XmlBufferAppend.
-    //
-    CurrentSize = NewSize - 1;
-    Buffer      = NewBuffer;
-  }
+BOOLEAN
+XmlDocumentExportTo (
+  IN      CONST XML_DOCUMENT  *Document,
+     OUT  CHAR8               *Buffer  OPTIONAL,
+  IN OUT  UINT32              *Size,
+  IN      UINT32              Skip,
+  IN      BOOLEAN             PrependPlistInfo
+  )
+{
+  UINT32  ExportedSize;
 
-  if (Length != NULL) {
-    *Length = CurrentSize;
+  ASSERT (Document != NULL);
+  ASSERT (Size     != NULL);
+
+  if (Document->SourceFixups != NULL) {
+    XmlNodeValidateSource (Document->Root);
   }
 
   //
-  // Null terminator is not included in size returned by XmlBufferAppend,
-  // but the buffer is allocated to include it.
+  // Export and calculate the size at once, leaving room for null terminator.
   //
-  Buffer[CurrentSize] = '\0';
+  ExportedSize = XmlDocumentExportWorker (
+    Document,
+    Buffer,
+    *Size > 0 ? *Size - 1 : 0,
+    Skip,
+    PrependPlistInfo
+    );
+  if (ExportedSize == MAX_UINT32) {
+    *Size = 0;
+    return FALSE;
+  }
 
-  return Buffer;
+  ++ExportedSize;
+
+  if (Buffer == NULL || *Size < ExportedSize) {
+    *Size = ExportedSize;
+    return FALSE;
+  }
+
+  Buffer[ExportedSize - 1] = '\0';
+  *Size = ExportedSize;
+
+  return TRUE;
 }
 
 VOID
@@ -1427,8 +2191,15 @@ XmlDocumentFree (
 {
   ASSERT (Document != NULL);
 
+  //
+  // Arena documents are released at once without visiting the nodes.
+  //
   XmlNodeFree (Document->Root);
   XmlFreeRefs (&Document->References);
+  XmlArenaFree (&Document->Arena);
+  if (Document->SourceFixups != NULL) {
+    FreePool (Document->SourceFixups);
+  }
   FreePool (Document);
 }
 
@@ -1472,9 +2243,11 @@ XmlNodeChangeContent (
   ASSERT (Content != NULL);
 
   if (Node->Real != NULL) {
-    Node->Real->Content = Content;
+    Node->Real->Content      = Content;
+    Node->Real->SourceLength = 0;
   }
-  Node->Content = Content;
+  Node->Content      = Content;
+  Node->SourceLength = 0;
 }
 
 UINT32
@@ -1578,12 +2351,12 @@ XmlNodeAppend (
   ASSERT (Node != NULL);
   ASSERT (Name != NULL);
 
-  NewNode = XmlNodeCreate (Name, Attributes, Content, NULL, NULL);
+  NewNode = XmlNodeCreate (NULL, Node->Arena, Name, Attributes, Content, NULL, NULL);
   if (NewNode == NULL) {
     return NULL;
   }
 
-  if (!XmlNodeChildPush (Node, NewNode)) {
+  if (!XmlNodeChildPush (NULL, Node, NewNode)) {
     XmlNodeFree (NewNode);
     return NULL;
   }
@@ -1653,7 +2426,11 @@ PlistNodeCast (
     return Node;
   }
 
-  if (AsciiStrCmp (XmlNodeName (Node), PlistNodeTypes[Type]) != 0) {
+  //
+  // Interned names are compared by pointer first.
+  //
+  if (XmlNodeName (Node) != PlistNodeTypes[Type]
+    && AsciiStrCmp (XmlNodeName (Node), PlistNodeTypes[Type]) != 0) {
     // XML_USAGE_ERROR ("PlistNodeType::wrong type");
     return NULL;
   }
@@ -1719,6 +2496,164 @@ PlistDictChild (
   return XmlNodeChild (Node, Child);
 }
 
+/**
+  Calculate plist dictionary key hash.
+
+  @param[in]  Key  Key name.
+
+  @return  Key hash.
+**/
+STATIC
+UINT32
+PlistKeyHash (
+  IN  CONST CHAR8  *Key
+  )
+{
+  UINT32  Hash;
+
+  //
+  // FNV-1a.
+  //
+  Hash = 0x811C9DC5U;
+  while (*Key != '\0') {
+    Hash ^= (UINT8) *Key;
+    Hash *= 0x01000193U;
+    ++Key;
+  }
+
+  return Hash;
+}
+
+/**
+  Build plist dictionary key index, the first entry wins for duplicate keys.
+
+  @param[in]  Node   A pointer to the XML node.
+  @param[in]  Count  Number of dictionary entries.
+
+  @return  Allocated dictionary index or NULL.
+**/
+STATIC
+XML_DICT_INDEX *
+PlistDictIndexCreate (
+  IN  CONST XML_NODE  *Node,
+  IN  UINT32          Count
+  )
+{
+  XML_DICT_INDEX  *DictIndex;
+  CONST CHAR8     *Key;
+  UINT32          Size;
+  UINT32          Index;
+  UINT32          Slot;
+
+  //
+  // Keep load factor at most 1/2, Count is limited by XML_PARSER_NODE_COUNT.
+  //
+  Size = XML_DICT_INDEX_MIN_ENTRIES * 2;
+  while (Size < Count * 2) {
+    Size *= 2;
+  }
+
+  DictIndex = AllocateZeroPool (sizeof (XML_DICT_INDEX) + Size * sizeof (DictIndex->Slots[0]));
+  if (DictIndex == NULL) {
+    return NULL;
+  }
+
+  DictIndex->Mask = Size - 1;
+
+  for (Index = 0; Index < Count; ++Index) {
+    Key = PlistKeyValue (PlistDictChild (Node, Index, NULL));
+    if (Key == NULL) {
+      continue;
+    }
+
+    Slot = PlistKeyHash (Key) & DictIndex->Mask;
+    while (DictIndex->Slots[Slot] != 0
+      && AsciiStrCmp (PlistKeyValue (PlistDictChild (Node, DictIndex->Slots[Slot] - 1, NULL)), Key) != 0) {
+      Slot = (Slot + 1) & DictIndex->Mask;
+    }
+
+    if (DictIndex->Slots[Slot] == 0) {
+      DictIndex->Slots[Slot] = Index + 1;
+    }
+  }
+
+  return DictIndex;
+}
+
+XML_NODE *
+PlistDictLookup (
+  IN OUT  XML_NODE     *Node,
+  IN      CONST CHAR8  *Key,
+     OUT  XML_NODE     **Value OPTIONAL
+  )
+{
+  XML_DICT_INDEX  *DictIndex;
+  XML_NODE        *ChildKey;
+  XML_NODE        *ChildValue;
+  CONST CHAR8     *ChildKeyName;
+  UINT32          Count;
+  UINT32          Index;
+  UINT32          Slot;
+
+  ASSERT (Node != NULL);
+  ASSERT (Key  != NULL);
+
+  ChildKey   = NULL;
+  ChildValue = NULL;
+
+  Count = PlistDictChildren (Node);
+  if (Count == 0) {
+    return NULL;
+  }
+
+  DictIndex = Node->Children->DictIndex;
+  if (DictIndex == NULL && Count >= XML_DICT_INDEX_MIN_ENTRIES) {
+    //
+    // Failing to build the index is not fatal, fallback to linear lookup.
+    //
+    DictIndex = PlistDictIndexCreate (Node, Count);
+    Node->Children->DictIndex = DictIndex;
+    if (DictIndex != NULL && Node->Arena != NULL) {
+      InsertTailList (&Node->Arena->DictIndices, &DictIndex->Link);
+    }
+  }
+
+  if (DictIndex != NULL) {
+    Slot = PlistKeyHash (Key) & DictIndex->Mask;
+    while (DictIndex->Slots[Slot] != 0) {
+      ChildKey     = PlistDictChild (Node, DictIndex->Slots[Slot] - 1, &ChildValue);
+      ChildKeyName = PlistKeyValue (ChildKey);
+      if (ChildKeyName != NULL && AsciiStrCmp (ChildKeyName, Key) == 0) {
+        break;
+      }
+
+      Slot = (Slot + 1) & DictIndex->Mask;
+    }
+
+    if (DictIndex->Slots[Slot] == 0) {
+      return NULL;
+    }
+  } else {
+    for (Index = 0; Index < Count; ++Index) {
+      ChildKey     = PlistDictChild (Node, Index, &ChildValue);
+      ChildKeyName = PlistKeyValue (ChildKey);
+      if (ChildKeyName != NULL && AsciiStrCmp (ChildKeyName, Key) == 0) {
+        break;
+      }
+    }
+
+    if (Index == Count) {
+      return NULL;
+    }
+  }
+
+  if (Value != NULL) {
+    *Value = ChildValue;
+  }
+
+  return ChildKey;
+}
+
 CONST CHAR8 *
 PlistKeyValue (
   IN  XML_NODE  *Node  OPTIONAL
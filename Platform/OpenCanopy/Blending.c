@@ -14,83 +14,133 @@
 #include "OpenCanopy.h"
 #include "Blending.h"
 
-#define PIXEL_TO_UINT32(Pixel)  \
-  ((UINT32) SIGNATURE_32 ((Pixel)->Blue, (Pixel)->Green, (Pixel)->Red, (Pixel)->Reserved))
+//
+// Pixels are blended as two UINT32 values with 16-bit lanes, Blue and Red in
+// one and Green and Reserved in the other, so that products of 8-bit channels
+// do not carry into each other.
+//
+#define BLEND_LANE_MASK  0x00FF00FFU
+#define BLEND_LANE_ONE   0x00010001U
+
+STATIC_ASSERT (
+  sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL) == sizeof (UINT32),
+  "Blending requires 32-bit pixels"
+  );
 
-#define RGB_ALPHA_BLEND(Back, Front, InvFrontOpacity)  \
-  ((Front) + RGB_APPLY_OPACITY (InvFrontOpacity, Back))
+STATIC
+UINT32
+InternalLanesApplyOpacity (
+  IN UINT32  Lanes,
+  IN UINT32  Opacity
+  )
+{
+  //
+  // Per-lane RGB_APPLY_OPACITY, the division by 0xFF is exact for products
+  // of two 8-bit values.
+  //
+  Lanes *= Opacity;
+  return ((Lanes + BLEND_LANE_ONE + ((Lanes >> 8U) & BLEND_LANE_MASK)) >> 8U) & BLEND_LANE_MASK;
+}
 
 STATIC
+UINT32
+InternalBlendPixelValue (
+  IN UINT32  BackPixel,
+  IN UINT32  FrontPixel
+  )
+{
+  UINT32 InvFrontOpacity;
+  UINT32 BlueRed;
+  UINT32 GreenReserved;
+  UINT32 Result;
+
+  InvFrontOpacity = 0xFF - (FrontPixel >> 24U);
+
+  BlueRed = (FrontPixel & BLEND_LANE_MASK)
+    + InternalLanesApplyOpacity (BackPixel & BLEND_LANE_MASK, InvFrontOpacity);
+  GreenReserved = ((FrontPixel >> 8U) & BLEND_LANE_MASK)
+    + InternalLanesApplyOpacity ((BackPixel >> 8U) & BLEND_LANE_MASK, InvFrontOpacity);
+
+  Result = (BlueRed & BLEND_LANE_MASK) | ((GreenReserved & BLEND_LANE_MASK) << 8U);
+
+  if ((BackPixel >> 24U) == 0xFF) {
+    Result |= 0xFF000000U;
+  }
+
+  return Result;
+}
+
 VOID
-InternalBlendPixel (
-  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackPixel,
-  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontPixel
+GuiBlendRowSolid (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     UINT32                               Width
   )
 {
-  UINT8 InvFrontOpacity;
-
-  InvFrontOpacity = (0xFF - FrontPixel->Reserved);
-
-  BackPixel->Blue = RGB_ALPHA_BLEND (
-                      BackPixel->Blue,
-                      FrontPixel->Blue,
-                      InvFrontOpacity
-                      );
-  BackPixel->Green = RGB_ALPHA_BLEND (
-                       BackPixel->Green,
-                       FrontPixel->Green,
-                       InvFrontOpacity
-                       );
-  BackPixel->Red = RGB_ALPHA_BLEND (
-                     BackPixel->Red,
-                     FrontPixel->Red,
-                     InvFrontOpacity
-                     );
-
-  if (BackPixel->Reserved != 0xFF) {
-    BackPixel->Reserved = RGB_ALPHA_BLEND (
-                            BackPixel->Reserved,
-                            FrontPixel->Reserved,
-                            InvFrontOpacity
-                            );
+  UINT32        *BackPixels;
+  CONST UINT32  *FrontPixels;
+  UINT32        FrontPixel;
+  UINT32        Index;
+
+  ASSERT (BackRow != NULL);
+  ASSERT (FrontRow != NULL);
+
+  BackPixels  = (UINT32 *) BackRow;
+  FrontPixels = (CONST UINT32 *) FrontRow;
+
+  for (Index = 0; Index < Width; ++Index) {
+    FrontPixel = FrontPixels[Index];
+    if (FrontPixel >= 0xFF000000U) {
+      BackPixels[Index] = FrontPixel;
+    } else if (FrontPixel > 0x00FFFFFFU) {
+      BackPixels[Index] = InternalBlendPixelValue (BackPixels[Index], FrontPixel);
+    }
   }
 }
 
 VOID
-GuiBlendPixelOpaque (
-  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackPixel,
-  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontPixel,
+GuiBlendRowOpaque (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     UINT32                               Width,
   IN     UINT8                                Opacity
   )
 {
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL OpacFrontPixel;
-  //
-  // FIXME: Optimise with SIMD or such.
-  // qt_blend_argb32_on_argb32 in QT
-  //
-  ASSERT (BackPixel != NULL);
-  ASSERT (FrontPixel != NULL);
+  UINT32        *BackPixels;
+  CONST UINT32  *FrontPixels;
+  UINT32        FrontPixel;
+  UINT32        Index;
+
+  ASSERT (BackRow != NULL);
+  ASSERT (FrontRow != NULL);
   ASSERT (Opacity > 0);
   ASSERT (Opacity < 0xFF);
 
-  if (FrontPixel->Reserved == 0) {
-    return;
-  }
+  BackPixels  = (UINT32 *) BackRow;
+  FrontPixels = (CONST UINT32 *) FrontRow;
 
-  if (FrontPixel->Reserved == 0xFF) {
-    OpacFrontPixel.Reserved = Opacity;
-  } else {
-    OpacFrontPixel.Reserved = RGB_APPLY_OPACITY (FrontPixel->Reserved, Opacity);
-    if (OpacFrontPixel.Reserved == 0) {
-      return;
+  for (Index = 0; Index < Width; ++Index) {
+    FrontPixel = FrontPixels[Index];
+    if (FrontPixel <= 0x00FFFFFFU) {
+      continue;
     }
-  }
 
-  OpacFrontPixel.Blue     = RGB_APPLY_OPACITY (FrontPixel->Blue,  Opacity);
-  OpacFrontPixel.Green    = RGB_APPLY_OPACITY (FrontPixel->Green, Opacity);
-  OpacFrontPixel.Red      = RGB_APPLY_OPACITY (FrontPixel->Red,   Opacity);
+    FrontPixel = InternalLanesApplyOpacity (FrontPixel & BLEND_LANE_MASK, Opacity)
+      | (InternalLanesApplyOpacity ((FrontPixel >> 8U) & BLEND_LANE_MASK, Opacity) << 8U);
+    if (FrontPixel > 0x00FFFFFFU) {
+      BackPixels[Index] = InternalBlendPixelValue (BackPixels[Index], FrontPixel);
+    }
+  }
+}
 
-  InternalBlendPixel (BackPixel, &OpacFrontPixel);
+VOID
+GuiBlendPixelOpaque (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackPixel,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontPixel,
+  IN     UINT8                                Opacity
+  )
+{
+  GuiBlendRowOpaque (BackPixel, FrontPixel, 1, Opacity);
 }
 
 VOID
@@ -99,26 +149,7 @@ GuiBlendPixelSolid (
   IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontPixel
   )
 {
-  //
-  // FIXME: Optimise with SIMD or such.
-  // qt_blend_argb32_on_argb32 in QT
-  //
-  ASSERT (BackPixel != NULL);
-  ASSERT (FrontPixel != NULL);
-
-  if (FrontPixel->Reserved == 0) {
-    return;
-  }
-
-  if (FrontPixel->Reserved == 0xFF) {
-    BackPixel->Blue     = FrontPixel->Blue;
-    BackPixel->Green    = FrontPixel->Green;
-    BackPixel->Red      = FrontPixel->Red;
-    BackPixel->Reserved = FrontPixel->Reserved;
-    return;
-  }
-
-  InternalBlendPixel (BackPixel, FrontPixel);
+  GuiBlendRowSolid (BackPixel, FrontPixel, 1);
 }
 
 VOID
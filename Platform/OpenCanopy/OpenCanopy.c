@@ -360,10 +360,6 @@ GuiDrawToBuffer (
   UINT32                              RowIndex;
   UINT32                              SourceRowOffset;
   UINT32                              TargetRowOffset;
-  UINT32                              SourceColumnOffset;
-  UINT32                              TargetColumnOffset;
-  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL *SourcePixel;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL       *TargetPixel;
 
   ASSERT (Image != NULL);
   ASSERT (DrawContext != NULL);
@@ -416,18 +412,11 @@ GuiDrawToBuffer (
         SourceRowOffset += Image->Width,
         TargetRowOffset += DrawContext->Screen.Width
       ) {
-      //
-      // Blend the row pixel-by-pixel.
-      //
-      for (
-        TargetColumnOffset = PosX, SourceColumnOffset = OffsetX;
-        TargetColumnOffset < PosX + Width;
-        ++TargetColumnOffset, ++SourceColumnOffset
-        ) {
-        TargetPixel = &mScreenBuffer[TargetRowOffset + TargetColumnOffset];
-        SourcePixel = &Image->Buffer[SourceRowOffset + SourceColumnOffset];
-        GuiBlendPixelSolid (TargetPixel, SourcePixel);
-      }
+      GuiBlendRowSolid (
+        &mScreenBuffer[TargetRowOffset + PosX],
+        &Image->Buffer[SourceRowOffset + OffsetX],
+        Width
+        );
     }
   } else {
     //
@@ -442,18 +431,12 @@ GuiDrawToBuffer (
         SourceRowOffset += Image->Width,
         TargetRowOffset += DrawContext->Screen.Width
       ) {
-      //
-      // Blend the row pixel-by-pixel.
-      //
-      for (
-        TargetColumnOffset = PosX, SourceColumnOffset = OffsetX;
-        TargetColumnOffset < PosX + Width;
-        ++TargetColumnOffset, ++SourceColumnOffset
-        ) {
-        TargetPixel = &mScreenBuffer[TargetRowOffset + TargetColumnOffset];
-        SourcePixel = &Image->Buffer[SourceRowOffset + SourceColumnOffset];
-        GuiBlendPixelOpaque (TargetPixel, SourcePixel, Opacity);
-      }
+      GuiBlendRowOpaque (
+        &mScreenBuffer[TargetRowOffset + PosX],
+        &Image->Buffer[SourceRowOffset + OffsetX],
+        Width,
+        Opacity
+        );
     }
   }
 }
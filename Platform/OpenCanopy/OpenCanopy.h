@@ -338,6 +338,37 @@ GuiBlendPixelOpaque (
   IN     UINT8                                Opacity
   );
 
+/**
+  Blend a row of premultiplied pixels onto a row of the back buffer.
+
+  @param[in,out] BackRow   Back buffer row.
+  @param[in]     FrontRow  Pixels to blend onto BackRow.
+  @param[in]     Width     Number of pixels in both rows.
+**/
+VOID
+GuiBlendRowSolid (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     UINT32                               Width
+  );
+
+/**
+  Blend a row of premultiplied pixels with additional opacity onto a row of
+  the back buffer.
+
+  @param[in,out] BackRow   Back buffer row.
+  @param[in]     FrontRow  Pixels to blend onto BackRow.
+  @param[in]     Width     Number of pixels in both rows.
+  @param[in]     Opacity   Opacity applied to FrontRow, must be within (0, 0xFF).
+**/
+VOID
+GuiBlendRowOpaque (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     UINT32                               Width,
+  IN     UINT8                                Opacity
+  );
+
 EFI_STATUS
 GuiCreateHighlightedImage (
   OUT GUI_IMAGE                            *SelectedImage,
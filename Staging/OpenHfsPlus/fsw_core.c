@@ -40,10 +40,18 @@
 
 // functions
 
+static fsw_status_t fsw_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer);
+static fsw_status_t fsw_blockcache_init(struct fsw_volume *vol);
+static fsw_status_t fsw_blockcache_grow(struct fsw_volume *vol, fsw_u32 new_bcache_size);
+static fsw_u32 fsw_blockcache_lookup(struct fsw_volume *vol, fsw_u32 phys_bno);
+static void fsw_blockcache_hash_insert(struct fsw_volume *vol, fsw_u32 i);
+static void fsw_blockcache_hash_remove(struct fsw_volume *vol, fsw_u32 i);
+static void fsw_blockcache_lru_insert(struct fsw_volume *vol, fsw_u32 i, int most_recent);
+static void fsw_blockcache_lru_unlink(struct fsw_volume *vol, fsw_u32 i);
+static fsw_status_t fsw_blockcache_alloc(struct fsw_volume *vol, fsw_u32 max_level, int overflow, fsw_u32 *index_out);
+static void fsw_blockcache_discard(struct fsw_volume *vol, fsw_u32 i);
 static void fsw_blockcache_free(struct fsw_volume *vol);
 
-#define MAX_CACHE_LEVEL (5)
-
 
 /**
  * Mount a volume with a given file system driver. This function is called by the
@@ -112,6 +120,10 @@ void fsw_unmount(struct fsw_volume *vol)
     
     vol->fstype_table->volume_free(vol);
     
+    FSW_MSG_DEBUG((FSW_MSGSTR("fsw_unmount: block cache %lu hits, %lu misses\n"),
+                   vol->bcache_hits, vol->bcache_misses));
+    FSW_MSG_DEBUG((FSW_MSGSTR("fsw_unmount: %lu bytes in %lu reads\n"),
+                   vol->read_bytes, vol->read_count));
     fsw_blockcache_free(vol);
     fsw_strfree(&vol->label);
     fsw_free(vol);
@@ -172,6 +184,11 @@ void fsw_set_blocksize(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32 l
  *  - 2: File system metadata
  *  - 3..5: File system metadata with a high rate of access
  *
+ * Cached blocks are looked up by hash. The cache is capped at FSW_BCACHE_MAX_SIZE bytes,
+ * beyond that the least recently used unreferenced block of the lowest level is reused.
+ * On a miss, up to FSW_BCACHE_READAHEAD following uncached blocks are fetched with the
+ * same read_block call.
+ *
  * If this function returns successfully, the returned data pointer is valid until the
  * caller calls fsw_block_release.
  */
@@ -179,86 +196,108 @@ void fsw_set_blocksize(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32 l
 fsw_status_t fsw_block_get(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32 cache_level, void **buffer_out)
 {
     fsw_status_t    status;
-    fsw_u32         i, discard_level, new_bcache_size;
-    struct fsw_blockcache *new_bcache;
+    fsw_u32         i, count, index[FSW_BCACHE_READAHEAD];
     
     // TODO: allow the host driver to do its own caching; just call through if
     //  the appropriate function pointers are set
     
-    if (cache_level > MAX_CACHE_LEVEL)
-        cache_level = MAX_CACHE_LEVEL;
+    if (cache_level > FSW_BCACHE_MAX_LEVEL)
+        cache_level = FSW_BCACHE_MAX_LEVEL;
     
-    // check block cache
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == phys_bno) {
-            // cache hit!
-            if (vol->bcache[i].cache_level < cache_level)
-                vol->bcache[i].cache_level = cache_level;  // promote the entry
-            vol->bcache[i].refcount++;
-            *buffer_out = vol->bcache[i].data;
-            return FSW_SUCCESS;
-        }
+    if (vol->bcache_hash == NULL) {
+        status = fsw_blockcache_init(vol);
+        if (status)
+            return status;
     }
     
-    // find a free entry in the cache table
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == FSW_INVALID_BNO)
-            break;
+    // check block cache
+    i = fsw_blockcache_lookup(vol, phys_bno);
+    if (i != FSW_BCACHE_NONE) {
+        // cache hit!
+        vol->bcache_hits++;
+        if (vol->bcache[i].refcount == 0)
+            fsw_blockcache_lru_unlink(vol, i);
+        if (vol->bcache[i].cache_level < cache_level)
+            vol->bcache[i].cache_level = cache_level;  // promote the entry
+        vol->bcache[i].refcount++;
+        *buffer_out = vol->bcache[i].data;
+        return FSW_SUCCESS;
     }
-    if (i >= vol->bcache_size) {
-        for (discard_level = 0; discard_level <= MAX_CACHE_LEVEL; discard_level++) {
-            for (i = 0; i < vol->bcache_size; i++) {
-                if (vol->bcache[i].refcount == 0 && vol->bcache[i].cache_level <= discard_level)
-                    break;
-            }
-            if (i < vol->bcache_size)
+    vol->bcache_misses++;
+    
+    // get an entry for the requested block, it is referenced right away so that
+    //  making room for the read-ahead blocks cannot evict it
+    status = fsw_blockcache_alloc(vol, FSW_BCACHE_MAX_LEVEL, 1, &index[0]);
+    if (status)
+        return status;
+    vol->bcache[index[0]].refcount = 1;
+    
+    // get entries for the following blocks that are not cached yet, only evicting
+    //  blocks that are not more important than the requested one
+    if (vol->bcache_readahead == NULL)
+        fsw_alloc(FSW_BCACHE_READAHEAD * vol->phys_blocksize, &vol->bcache_readahead);
+    count = 1;
+    if (vol->bcache_readahead != NULL) {
+        for (; count < FSW_BCACHE_READAHEAD; count++) {
+            if (phys_bno + count == FSW_INVALID_BNO ||
+                fsw_blockcache_lookup(vol, phys_bno + count) != FSW_BCACHE_NONE)
+                break;
+            if (fsw_blockcache_alloc(vol, cache_level, 0, &index[count]))
                 break;
+            vol->bcache[index[count]].refcount = 1;
         }
     }
-    if (i >= vol->bcache_size) {
-        // enlarge / create the cache
-        if (vol->bcache_size < 16)
-            new_bcache_size = 16;
-        else
-            new_bcache_size = vol->bcache_size << 1;
-        status = fsw_alloc(new_bcache_size * sizeof(struct fsw_blockcache), &new_bcache);
-        if (status)
+    
+    // read the data with a single call, falling back to the requested block alone
+    //  if the longer read fails (e.g. when it crosses the end of the device)
+    status = FSW_IO_ERROR;
+    if (count > 1) {
+        status = fsw_read_blocks(vol, phys_bno, count, vol->bcache_readahead);
+        if (status == FSW_SUCCESS) {
+            for (i = 0; i < count; i++)
+                fsw_memcpy(vol->bcache[index[i]].data,
+                           vol->bcache_readahead + i * vol->phys_blocksize,
+                           vol->phys_blocksize);
+        }
+    }
+    if (status) {
+        for (i = 1; i < count; i++)
+            fsw_blockcache_discard(vol, index[i]);
+        count = 1;
+        status = fsw_read_blocks(vol, phys_bno, 1, vol->bcache[index[0]].data);
+        if (status) {
+            fsw_blockcache_discard(vol, index[0]);
             return status;
-        if (vol->bcache_size > 0)
-            fsw_memcpy(new_bcache, vol->bcache, vol->bcache_size * sizeof(struct fsw_blockcache));
-        for (i = vol->bcache_size; i < new_bcache_size; i++) {
-            new_bcache[i].refcount = 0;
-            new_bcache[i].cache_level = 0;
-            new_bcache[i].phys_bno = FSW_INVALID_BNO;
-            new_bcache[i].data = NULL;
         }
-        i = vol->bcache_size;
-        
-        // switch caches
-        if (vol->bcache != NULL)
-            fsw_free(vol->bcache);
-        vol->bcache = new_bcache;
-        vol->bcache_size = new_bcache_size;
     }
-    vol->bcache[i].phys_bno = FSW_INVALID_BNO;
     
-    // read the data
-    if (vol->bcache[i].data == NULL) {
-        status = fsw_alloc(vol->phys_blocksize, &vol->bcache[i].data);
-        if (status)
-            return status;
+    for (i = 0; i < count; i++) {
+        vol->bcache[index[i]].phys_bno = phys_bno + i;
+        vol->bcache[index[i]].cache_level = cache_level;
+        fsw_blockcache_hash_insert(vol, index[i]);
+    }
+    // read-ahead blocks are not referenced by anybody yet
+    for (i = 1; i < count; i++) {
+        vol->bcache[index[i]].refcount = 0;
+        fsw_blockcache_lru_insert(vol, index[i], 1);
     }
-    status = vol->host_table->read_block(vol, phys_bno, vol->bcache[i].data);
-    if (status)
-        return status;
     
-    vol->bcache[i].phys_bno = phys_bno;
-    vol->bcache[i].cache_level = cache_level;
-    vol->bcache[i].refcount = 1;
-    *buffer_out = vol->bcache[i].data;
+    *buffer_out = vol->bcache[index[0]].data;
     return FSW_SUCCESS;
 }
 
+/**
+ * Read consecutive physical blocks through the host driver, bypassing the block cache.
+ * Keeps track of the amount of reads and bytes read for the volume.
+ */
+
+static fsw_status_t fsw_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer)
+{
+    vol->read_count++;
+    vol->read_bytes += (fsw_u64)count * vol->phys_blocksize;
+    return vol->host_table->read_block(vol, phys_bno, count, buffer);
+}
+
 /**
  * Releases a disk block. This function must be called to release disk blocks returned
  * from fsw_block_get.
@@ -272,10 +311,237 @@ void fsw_block_release(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, void *buffer
     //  the appropriate function pointers are set
     
     // update block cache
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == phys_bno && vol->bcache[i].refcount > 0)
-            vol->bcache[i].refcount--;
+    i = fsw_blockcache_lookup(vol, phys_bno);
+    if (i != FSW_BCACHE_NONE && vol->bcache[i].refcount > 0) {
+        vol->bcache[i].refcount--;
+        if (vol->bcache[i].refcount == 0)
+            fsw_blockcache_lru_insert(vol, i, 1);
+    }
+}
+
+/**
+ * Set up an empty block cache. The number of entries is capped so that the cached
+ * data does not exceed FSW_BCACHE_MAX_SIZE, the hash table is sized for that cap.
+ * The entry array itself is only grown on demand.
+ */
+
+static fsw_status_t fsw_blockcache_init(struct fsw_volume *vol)
+{
+    fsw_status_t    status;
+    fsw_u32         i, bucket_count;
+    
+    vol->bcache_max = FSW_BCACHE_MAX_SIZE / vol->phys_blocksize;
+    if (vol->bcache_max < 16)
+        vol->bcache_max = 16;
+    
+    for (bucket_count = 16; bucket_count < vol->bcache_max; bucket_count <<= 1)
+        ;
+    status = fsw_alloc(bucket_count * sizeof(fsw_u32), &vol->bcache_hash);
+    if (status)
+        return status;
+    for (i = 0; i < bucket_count; i++)
+        vol->bcache_hash[i] = FSW_BCACHE_NONE;
+    vol->bcache_hash_mask = bucket_count - 1;
+    
+    for (i = 0; i <= FSW_BCACHE_MAX_LEVEL; i++) {
+        vol->bcache_lru_head[i] = FSW_BCACHE_NONE;
+        vol->bcache_lru_tail[i] = FSW_BCACHE_NONE;
+    }
+    vol->bcache_used = 0;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Enlarge the block cache entry array. Entries keep their indices and data buffers,
+ * so blocks returned from fsw_block_get stay valid.
+ */
+
+static fsw_status_t fsw_blockcache_grow(struct fsw_volume *vol, fsw_u32 new_bcache_size)
+{
+    fsw_status_t    status;
+    fsw_u32         i;
+    struct fsw_blockcache *new_bcache;
+    
+    status = fsw_alloc(new_bcache_size * sizeof(struct fsw_blockcache), &new_bcache);
+    if (status)
+        return status;
+    if (vol->bcache_size > 0)
+        fsw_memcpy(new_bcache, vol->bcache, vol->bcache_size * sizeof(struct fsw_blockcache));
+    for (i = vol->bcache_size; i < new_bcache_size; i++) {
+        new_bcache[i].refcount = 0;
+        new_bcache[i].cache_level = 0;
+        new_bcache[i].phys_bno = FSW_INVALID_BNO;
+        new_bcache[i].data = NULL;
+        new_bcache[i].hash_next = FSW_BCACHE_NONE;
+        new_bcache[i].lru_prev = FSW_BCACHE_NONE;
+        new_bcache[i].lru_next = FSW_BCACHE_NONE;
+    }
+    
+    // switch caches
+    if (vol->bcache != NULL)
+        fsw_free(vol->bcache);
+    vol->bcache = new_bcache;
+    vol->bcache_size = new_bcache_size;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Find the cache entry holding a physical block. Returns FSW_BCACHE_NONE if the
+ * block is not cached.
+ */
+
+static fsw_u32 fsw_blockcache_lookup(struct fsw_volume *vol, fsw_u32 phys_bno)
+{
+    fsw_u32 i;
+    
+    if (vol->bcache_hash == NULL)
+        return FSW_BCACHE_NONE;
+    for (i = vol->bcache_hash[phys_bno & vol->bcache_hash_mask]; i != FSW_BCACHE_NONE; i = vol->bcache[i].hash_next) {
+        if (vol->bcache[i].phys_bno == phys_bno)
+            return i;
     }
+    return FSW_BCACHE_NONE;
+}
+
+static void fsw_blockcache_hash_insert(struct fsw_volume *vol, fsw_u32 i)
+{
+    fsw_u32 *bucket = &vol->bcache_hash[vol->bcache[i].phys_bno & vol->bcache_hash_mask];
+    
+    vol->bcache[i].hash_next = *bucket;
+    *bucket = i;
+}
+
+static void fsw_blockcache_hash_remove(struct fsw_volume *vol, fsw_u32 i)
+{
+    fsw_u32 *link = &vol->bcache_hash[vol->bcache[i].phys_bno & vol->bcache_hash_mask];
+    
+    while (*link != i)
+        link = &vol->bcache[*link].hash_next;
+    *link = vol->bcache[i].hash_next;
+    vol->bcache[i].hash_next = FSW_BCACHE_NONE;
+}
+
+/**
+ * Put an unreferenced entry on the LRU list of its cache level, either as the most
+ * recently used one or as the first one to be evicted.
+ */
+
+static void fsw_blockcache_lru_insert(struct fsw_volume *vol, fsw_u32 i, int most_recent)
+{
+    struct fsw_blockcache *entry = &vol->bcache[i];
+    fsw_u32 level = entry->cache_level;
+    
+    if (most_recent) {
+        entry->lru_prev = FSW_BCACHE_NONE;
+        entry->lru_next = vol->bcache_lru_head[level];
+        if (entry->lru_next != FSW_BCACHE_NONE)
+            vol->bcache[entry->lru_next].lru_prev = i;
+        else
+            vol->bcache_lru_tail[level] = i;
+        vol->bcache_lru_head[level] = i;
+    } else {
+        entry->lru_next = FSW_BCACHE_NONE;
+        entry->lru_prev = vol->bcache_lru_tail[level];
+        if (entry->lru_prev != FSW_BCACHE_NONE)
+            vol->bcache[entry->lru_prev].lru_next = i;
+        else
+            vol->bcache_lru_head[level] = i;
+        vol->bcache_lru_tail[level] = i;
+    }
+}
+
+static void fsw_blockcache_lru_unlink(struct fsw_volume *vol, fsw_u32 i)
+{
+    struct fsw_blockcache *entry = &vol->bcache[i];
+    fsw_u32 level = entry->cache_level;
+    
+    if (entry->lru_prev != FSW_BCACHE_NONE)
+        vol->bcache[entry->lru_prev].lru_next = entry->lru_next;
+    else
+        vol->bcache_lru_head[level] = entry->lru_next;
+    if (entry->lru_next != FSW_BCACHE_NONE)
+        vol->bcache[entry->lru_next].lru_prev = entry->lru_prev;
+    else
+        vol->bcache_lru_tail[level] = entry->lru_prev;
+    entry->lru_prev = FSW_BCACHE_NONE;
+    entry->lru_next = FSW_BCACHE_NONE;
+}
+
+/**
+ * Get a cache entry with a data buffer for a new block. The entry array is grown up to
+ * its cap first. Once the cap is reached, the least recently used unreferenced block of
+ * the lowest cache level up to max_level is evicted. If there is no such block, the
+ * cache may only grow beyond its cap when overflow is set, which is needed when all
+ * blocks are referenced at the same time.
+ *
+ * The returned entry is neither hashed nor on an LRU list.
+ */
+
+static fsw_status_t fsw_blockcache_alloc(struct fsw_volume *vol, fsw_u32 max_level, int overflow, fsw_u32 *index_out)
+{
+    fsw_status_t    status;
+    fsw_u32         i, level, new_bcache_size;
+    
+    if (vol->bcache_used == vol->bcache_size && vol->bcache_size < vol->bcache_max) {
+        // enlarge / create the cache
+        if (vol->bcache_size < 16)
+            new_bcache_size = 16;
+        else
+            new_bcache_size = vol->bcache_size << 1;
+        if (new_bcache_size > vol->bcache_max)
+            new_bcache_size = vol->bcache_max;
+        status = fsw_blockcache_grow(vol, new_bcache_size);
+        if (status)
+            return status;
+    }
+    
+    if (vol->bcache_used < vol->bcache_size) {
+        i = vol->bcache_used++;
+    } else {
+        // evict the least recently used block of the least important level
+        i = FSW_BCACHE_NONE;
+        for (level = 0; level <= max_level && i == FSW_BCACHE_NONE; level++)
+            i = vol->bcache_lru_tail[level];
+        
+        if (i != FSW_BCACHE_NONE) {
+            fsw_blockcache_lru_unlink(vol, i);
+            if (vol->bcache[i].phys_bno != FSW_INVALID_BNO)
+                fsw_blockcache_hash_remove(vol, i);
+        } else {
+            if (!overflow)
+                return FSW_OUT_OF_MEMORY;
+            status = fsw_blockcache_grow(vol, vol->bcache_size << 1);
+            if (status)
+                return status;
+            i = vol->bcache_used++;
+        }
+    }
+    
+    vol->bcache[i].phys_bno = FSW_INVALID_BNO;
+    vol->bcache[i].cache_level = 0;
+    if (vol->bcache[i].data == NULL) {
+        status = fsw_alloc(vol->phys_blocksize, &vol->bcache[i].data);
+        if (status) {
+            fsw_blockcache_lru_insert(vol, i, 0);
+            return status;
+        }
+    }
+    
+    *index_out = i;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Return an entry obtained from fsw_blockcache_alloc that did not receive a block.
+ * It is put at the end of the lowest LRU list to be reused first.
+ */
+
+static void fsw_blockcache_discard(struct fsw_volume *vol, fsw_u32 i)
+{
+    vol->bcache[i].phys_bno = FSW_INVALID_BNO;
+    vol->bcache[i].cache_level = 0;
+    vol->bcache[i].refcount = 0;
+    fsw_blockcache_lru_insert(vol, i, 0);
 }
 
 /**
@@ -295,7 +561,16 @@ static void fsw_blockcache_free(struct fsw_volume *vol)
         fsw_free(vol->bcache);
         vol->bcache = NULL;
     }
+    if (vol->bcache_hash != NULL) {
+        fsw_free(vol->bcache_hash);
+        vol->bcache_hash = NULL;
+    }
+    if (vol->bcache_readahead != NULL) {
+        fsw_free(vol->bcache_readahead);
+        vol->bcache_readahead = NULL;
+    }
     vol->bcache_size = 0;
+    vol->bcache_used = 0;
 }
 
 /**
@@ -855,6 +1130,9 @@ void fsw_shandle_close(struct fsw_shandle *shand)
 /**
  * Read data from a shandle (storage handle for a dnode). This function is called by the
  * host driver or internally when data is read from a file. TODO: more
+ *
+ * Whole blocks of file data are read directly into the caller's buffer with one host
+ * request per extent. Partial blocks and directory data go through the block cache.
  */
 
 fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_inout, void *buffer_in)
@@ -865,6 +1143,7 @@ fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_in
     fsw_u8          *buffer, *block_buffer;
     fsw_u32         buflen, copylen, pos;
     fsw_u32         log_bno, pos_in_extent, phys_bno, pos_in_physblock;
+    fsw_u64         extent_left;
     fsw_u32         cache_level;
     
     if (shand->pos >= dno->size) {   // already at EOF
@@ -907,6 +1186,22 @@ fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_in
             // convert to physical block number and offset
             phys_bno = shand->extent.phys_start + pos_in_extent / vol->phys_blocksize;
             pos_in_physblock = pos_in_extent & (vol->phys_blocksize - 1);
+            
+            // read whole blocks of file data straight into the caller's buffer,
+            //  as many as the extent and the buffer allow with a single request
+            extent_left = (fsw_u64)shand->extent.log_count * vol->log_blocksize - pos_in_extent;
+            if (cache_level == 0 && pos_in_physblock == 0 && buflen >= vol->phys_blocksize) {
+                copylen = (buflen < extent_left ? buflen : (fsw_u32)extent_left) & ~(vol->phys_blocksize - 1);
+                status = fsw_read_blocks(vol, phys_bno, copylen / vol->phys_blocksize, buffer);
+                if (status)
+                    return status;
+                
+                buffer += copylen;
+                buflen -= copylen;
+                pos    += copylen;
+                continue;
+            }
+            
             copylen = vol->phys_blocksize - pos_in_physblock;
             if (copylen > buflen)
                 copylen = buflen;
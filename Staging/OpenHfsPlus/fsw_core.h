@@ -207,11 +207,23 @@ struct fsw_dnode;
 struct fsw_host_table;
 struct fsw_fstype_table;
 
+/** Highest cache level accepted by fsw_block_get. */
+#define FSW_BCACHE_MAX_LEVEL (5)
+/** Upper bound on the block data held by the block cache, in bytes. */
+#define FSW_BCACHE_MAX_SIZE (4 * 1024 * 1024)
+/** Maximum number of blocks fetched with a single read_block call on a cache miss. */
+#define FSW_BCACHE_READAHEAD (8)
+/** Marks the end of a block cache hash chain or LRU list. */
+#define FSW_BCACHE_NONE (0xFFFFFFFF)
+
 struct fsw_blockcache {
     fsw_u32     refcount;           //!< Reference count
     fsw_u32     cache_level;        //!< Level of importance of this block
     fsw_u32     phys_bno;           //!< Physical block number
     void        *data;              //!< Block data buffer
+    fsw_u32     hash_next;          //!< Next entry in the same hash bucket
+    fsw_u32     lru_prev;           //!< LRU list of unreferenced entries: more recently used entry
+    fsw_u32     lru_next;           //!< LRU list of unreferenced entries: less recently used entry
 };
 
 /**
@@ -229,6 +241,17 @@ struct fsw_volume {
     
     struct fsw_blockcache *bcache;  //!< Array of block cache entries
     fsw_u32     bcache_size;        //!< Number of entries in the block cache array
+    fsw_u32     bcache_used;        //!< Number of block cache entries handed out so far
+    fsw_u32     bcache_max;         //!< Number of entries the block cache is capped at
+    fsw_u32     *bcache_hash;       //!< Hash buckets with the first entry of each chain
+    fsw_u32     bcache_hash_mask;   //!< Number of hash buckets minus one
+    fsw_u32     bcache_lru_head[FSW_BCACHE_MAX_LEVEL + 1];  //!< Most recently released entry per cache level
+    fsw_u32     bcache_lru_tail[FSW_BCACHE_MAX_LEVEL + 1];  //!< Least recently released entry per cache level
+    fsw_u8      *bcache_readahead;  //!< Bounce buffer for multi-block reads
+    fsw_u64     bcache_hits;        //!< Number of block requests served from the cache
+    fsw_u64     bcache_misses;      //!< Number of block requests that needed a disk read
+    fsw_u64     read_count;         //!< Number of read requests issued to the host driver
+    fsw_u64     read_bytes;         //!< Number of bytes read through the host driver
     
     void        *host_data;         //!< Hook for a host-specific data structure
     struct fsw_host_table *host_table;      //!< Dispatch table for host-specific functions
@@ -349,7 +372,7 @@ struct fsw_host_table
     void         (*change_blocksize)(struct fsw_volume *vol,
                                      fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                                      fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
-    fsw_status_t (*read_block)(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+    fsw_status_t (*read_block)(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer);
 };
 
 /**
@@ -75,7 +75,7 @@ EFI_STATUS EFIAPI fsw_efi_ComponentName_GetControllerName(IN  EFI_COMPONENT_NAME
 void fsw_efi_change_blocksize(struct fsw_volume *vol,
                               fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                               fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
-fsw_status_t fsw_efi_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+fsw_status_t fsw_efi_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer);
 
 EFI_STATUS fsw_efi_map_status(fsw_status_t fsw_status, FSW_VOLUME_DATA *Volume);
 
@@ -428,20 +428,21 @@ void fsw_efi_change_blocksize(struct fsw_volume *vol,
 
 /**
  * FSW interface function to read data blocks. This function is called by the FSW core
- * to read a block of data from the device. The buffer is allocated by the core code.
+ * to read count consecutive blocks of data from the device with a single Disk I/O
+ * request. The buffer is allocated by the core code.
  */
 
-fsw_status_t fsw_efi_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer)
+fsw_status_t fsw_efi_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer)
 {
     EFI_STATUS          Status;
     FSW_VOLUME_DATA     *Volume = (FSW_VOLUME_DATA *)vol->host_data;
     
-    FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_efi_read_block: %d  (%d)\n"), phys_bno, vol->phys_blocksize));
+    FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_efi_read_block: %d x %d  (%d)\n"), phys_bno, count, vol->phys_blocksize));
     
     // read from disk
     Status = Volume->DiskIo->ReadDisk(Volume->DiskIo, Volume->MediaId,
                                       (UINT64)phys_bno * vol->phys_blocksize,
-                                      vol->phys_blocksize,
+                                      (UINTN)count * vol->phys_blocksize,
                                       buffer);
     Volume->LastIOStatus = Status;
     if (EFI_ERROR(Status))
@@ -61,6 +61,12 @@ typedef struct RSA2048SHA256_SIGN_SAMPLE_ {
   UINT8 PublicKey[528];
 } RSA2048SHA256_SIGN_SAMPLE;
 
+typedef struct RSA2048SHA256_EXPONENT_SAMPLE_ {
+  UINT32 Exponent;
+  UINT8  Modulus[256];
+  UINT8  Signature[256];
+} RSA2048SHA256_EXPONENT_SAMPLE;
+
 //
 // RSA2048SHA256
 // Signature
@@ -628,4 +634,236 @@ STATIC UINT8 CONST ChaChaCipherText[375] = {
   0xC4, 0xFD, 0x80, 0x6C, 0x22, 0xF2, 0x21 
 };
 
+//
+// SHA-256 samples longer than a block from FIPS 180-2,
+// the last one is one million repetitions of 'a'.
+//
+#define SHA256_MULTI_SAMPLES_NUM  2
+#define SHA256_MILLION_A_LEN      1000000
+
+STATIC CONST CHAR8 Sha256TwoBlockSample[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+STATIC UINT8 CONST Sha256MultiSampleHashes[SHA256_MULTI_SAMPLES_NUM][SHA256_DIGEST_SIZE] = {
+  {
+    0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+    0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+    0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+    0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+  },
+  {
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92,
+    0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+    0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+    0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+  }
+};
+
+//
+// RSA2048SHA256 signatures of Rsa2048Sha256Sample.Data made with keys of less
+// common exponents, which take the dedicated 2^k + 1 and the sliding window
+// exponentiation paths.
+//
+#define RSA_EXPONENT_SAMPLES_NUM  2
+
+STATIC RSA2048SHA256_EXPONENT_SAMPLE Rsa2048Sha256ExponentSamples[RSA_EXPONENT_SAMPLES_NUM] = {
+  {
+    0x3,
+    //
+    // Modulus
+    //
+    {
+      0xa3, 0x6b, 0xb9, 0x21, 0x93, 0xd7,
+      0xaf, 0xe6, 0xe2, 0x11, 0x07, 0x5d,
+      0x7e, 0x6e, 0x2e, 0x7d, 0xce, 0xb0,
+      0x45, 0x91, 0xc4, 0x8c, 0xc1, 0x4d,
+      0x20, 0x3b, 0x4d, 0x32, 0x9f, 0x74,
+      0x80, 0xe2, 0xe6, 0x71, 0x07, 0xe1,
+      0xc2, 0x6c, 0x86, 0x56, 0x55, 0x55,
+      0x22, 0x39, 0x4f, 0xb7, 0xce, 0xd9,
+      0x17, 0x5e, 0x32, 0xa9, 0xbb, 0x51,
+      0x9c, 0xf5, 0xc9, 0x7c, 0xed, 0xc5,
+      0xd0, 0xa0, 0x8a, 0x9d, 0xd3, 0x8d,
+      0x13, 0x07, 0xff, 0x7f, 0x22, 0xe4,
+      0xb9, 0xec, 0xb9, 0x00, 0xd0, 0xd2,
+      0x68, 0xa1, 0x2f, 0x9d, 0x2f, 0xac,
+      0x00, 0xe7, 0x91, 0x50, 0x12, 0xed,
+      0x0c, 0x60, 0x48, 0x08, 0xd0, 0x97,
+      0x16, 0xc9, 0xf5, 0x8c, 0x4b, 0x82,
+      0x42, 0xa4, 0x82, 0xe4, 0xd1, 0xca,
+      0xd1, 0xf4, 0x1d, 0x7f, 0x00, 0x32,
+      0xc3, 0xe1, 0x4b, 0x05, 0xf1, 0x8d,
+      0xaf, 0x23, 0xdf, 0x50, 0xa2, 0x80,
+      0x39, 0xe4, 0x4f, 0x42, 0xbd, 0xf6,
+      0x1f, 0xcc, 0x70, 0xb8, 0xc9, 0xd3,
+      0xc7, 0x42, 0x78, 0x2a, 0xf2, 0xaa,
+      0x7d, 0x9b, 0xc6, 0x3c, 0x04, 0xd2,
+      0x6c, 0xdf, 0x21, 0xeb, 0xb0, 0x4d,
+      0xd3, 0x35, 0x46, 0x7a, 0x61, 0xfa,
+      0xbd, 0xcc, 0x2a, 0x5e, 0x4b, 0x37,
+      0x64, 0x72, 0x23, 0x9e, 0xe7, 0x83,
+      0xe2, 0xda, 0x26, 0xae, 0x86, 0xb7,
+      0x6d, 0xfb, 0x90, 0xc3, 0x0b, 0x08,
+      0x0f, 0x37, 0xed, 0xb8, 0x73, 0xe8,
+      0xed, 0x46, 0x85, 0x89, 0x82, 0x50,
+      0xe0, 0x4b, 0x7b, 0x83, 0x6d, 0x04,
+      0x05, 0xbc, 0x10, 0xf4, 0xfe, 0x39,
+      0xf0, 0x7f, 0x15, 0x2f, 0xb4, 0xfe,
+      0xab, 0x25, 0x5f, 0xfe, 0x45, 0xbf,
+      0x7a, 0x01, 0x0d, 0xf9, 0x0d, 0x11,
+      0xae, 0x9a, 0x9c, 0xc6, 0x18, 0x8a,
+      0xf6, 0x81, 0xa4, 0x14, 0x31, 0x63,
+      0xa1, 0xf6, 0x3c, 0x61, 0xd0, 0xb9,
+      0x7a, 0x4d, 0x1a, 0x6a, 0xaf, 0x5e,
+      0x2c, 0x0c, 0x2d, 0x31
+    },
+    //
+    // Signature
+    //
+    {
+      0x14, 0xe7, 0xfc, 0x9f, 0x91, 0x70,
+      0x9b, 0x3d, 0x4b, 0x75, 0x64, 0x73,
+      0x52, 0x7d, 0xbb, 0x8c, 0xdc, 0xe1,
+      0x38, 0xed, 0x1a, 0x9e, 0x01, 0xca,
+      0x6c, 0x7c, 0xe2, 0x23, 0x86, 0x73,
+      0x4c, 0xdb, 0x08, 0x8f, 0xa4, 0x70,
+      0x95, 0x67, 0xb2, 0xbf, 0x28, 0xb1,
+      0x7b, 0x89, 0xa4, 0x7a, 0x6e, 0xf8,
+      0x4f, 0x77, 0x6c, 0xdd, 0x1f, 0xd0,
+      0x79, 0x78, 0x32, 0x8c, 0x3d, 0x62,
+      0x08, 0xfb, 0x60, 0xb4, 0x00, 0x12,
+      0x6e, 0x78, 0x5c, 0x4b, 0xc0, 0xe4,
+      0x02, 0xc2, 0x7d, 0x34, 0xec, 0xdf,
+      0xce, 0x38, 0xa8, 0x2e, 0x9b, 0x20,
+      0x3a, 0x9a, 0x6a, 0xdb, 0x90, 0xac,
+      0x80, 0xee, 0x2b, 0xd8, 0x76, 0xff,
+      0x8d, 0x83, 0x58, 0xcd, 0x43, 0x24,
+      0xef, 0xfd, 0xef, 0xf3, 0xd0, 0x08,
+      0xcf, 0x57, 0x1b, 0x57, 0xb5, 0x60,
+      0x00, 0x75, 0x66, 0xab, 0x38, 0xf8,
+      0x5d, 0x99, 0x39, 0xd7, 0xd3, 0xa2,
+      0x4f, 0x59, 0x23, 0x06, 0xd0, 0xc6,
+      0x68, 0x16, 0x8a, 0xeb, 0x64, 0x38,
+      0x5e, 0x7a, 0x9b, 0x5b, 0x54, 0x5f,
+      0x3b, 0x04, 0x49, 0x0f, 0x52, 0xfc,
+      0x6a, 0x11, 0xcc, 0xcd, 0x03, 0xf7,
+      0x2d, 0x16, 0x8e, 0x14, 0x9f, 0x06,
+      0x35, 0x1c, 0x8b, 0x35, 0xc1, 0x1f,
+      0x33, 0xe2, 0xfe, 0x60, 0x6b, 0x1f,
+      0xf1, 0x71, 0x34, 0x98, 0x96, 0xcf,
+      0x1a, 0x12, 0xa3, 0x94, 0xad, 0xa9,
+      0x9b, 0x87, 0xd4, 0x96, 0x97, 0x74,
+      0xb6, 0x5d, 0x3a, 0x1e, 0x5a, 0x11,
+      0xb8, 0xf6, 0xcf, 0xd1, 0x84, 0xf2,
+      0x1d, 0x11, 0x26, 0xf8, 0xb5, 0xcf,
+      0x0b, 0xed, 0xde, 0x42, 0x49, 0x98,
+      0xf5, 0xba, 0x4c, 0x17, 0x0c, 0xd8,
+      0xbf, 0x94, 0xa5, 0x54, 0x9c, 0x51,
+      0xce, 0xcb, 0x37, 0x86, 0x85, 0xeb,
+      0x16, 0xd9, 0xc8, 0xc4, 0x05, 0x0b,
+      0xb2, 0x85, 0x20, 0xec, 0x82, 0x9d,
+      0xba, 0xad, 0xd3, 0xb2, 0xc7, 0xe2,
+      0x12, 0x3a, 0xf0, 0x13
+    }
+  },
+  {
+    0xB5C3A9E7,
+    //
+    // Modulus
+    //
+    {
+      0xe2, 0x67, 0xc5, 0x01, 0x80, 0xec,
+      0xcd, 0xc7, 0xff, 0x7b, 0x20, 0x33,
+      0x70, 0x50, 0x32, 0xa7, 0x61, 0x24,
+      0x51, 0xd6, 0x9c, 0x30, 0x49, 0xd6,
+      0x1e, 0x3a, 0x51, 0xe0, 0xb8, 0xb5,
+      0x98, 0x16, 0x2e, 0xf6, 0x75, 0x54,
+      0xb5, 0xba, 0x33, 0xb5, 0x0d, 0x7b,
+      0x3c, 0xff, 0x94, 0x5b, 0xbc, 0xa5,
+      0xbc, 0x85, 0x70, 0xb0, 0x74, 0x55,
+      0xce, 0x8e, 0x86, 0x70, 0x7f, 0xe4,
+      0xba, 0xb1, 0xa6, 0xd4, 0x60, 0x06,
+      0xce, 0x75, 0xd6, 0xe8, 0xcd, 0xbb,
+      0x5a, 0x4f, 0xec, 0x72, 0xf9, 0xe7,
+      0x0a, 0xab, 0x18, 0x0f, 0x4b, 0xca,
+      0x3f, 0xf1, 0x69, 0xea, 0x8f, 0xb9,
+      0xf1, 0xf9, 0x52, 0xa7, 0x74, 0xac,
+      0x95, 0x87, 0x5d, 0xc1, 0x38, 0x63,
+      0x56, 0x25, 0x66, 0xcd, 0x29, 0xad,
+      0xd1, 0x53, 0x8b, 0x3f, 0xd2, 0x31,
+      0x87, 0xdc, 0xc5, 0x09, 0x97, 0xcb,
+      0x9b, 0xd0, 0x13, 0x92, 0x7a, 0xe7,
+      0xb3, 0x07, 0x0a, 0x90, 0xfb, 0x72,
+      0x37, 0x7a, 0x4e, 0x4b, 0x0a, 0x69,
+      0x97, 0x7f, 0x76, 0xc6, 0xf3, 0x8b,
+      0xb4, 0xc0, 0x5a, 0x95, 0xaa, 0x77,
+      0x44, 0x32, 0x5e, 0x5f, 0x83, 0xfb,
+      0x64, 0x48, 0xc0, 0x00, 0xce, 0xe1,
+      0x68, 0x1a, 0x0c, 0xa0, 0x3d, 0xc2,
+      0x2a, 0xd5, 0xcb, 0xe6, 0x55, 0x9e,
+      0x67, 0x18, 0x9a, 0x69, 0xc4, 0x19,
+      0xf7, 0x78, 0xdf, 0xd4, 0x6f, 0xf3,
+      0x6b, 0xc3, 0x27, 0xf9, 0x08, 0xd5,
+      0x02, 0x4a, 0x69, 0x56, 0xe4, 0xe7,
+      0x9a, 0x40, 0xfd, 0x3c, 0x10, 0x84,
+      0xd8, 0x3c, 0xb5, 0xfc, 0xd8, 0xdd,
+      0x03, 0x3a, 0x01, 0x69, 0x60, 0x38,
+      0x09, 0xcb, 0xa9, 0xbe, 0x56, 0x43,
+      0x45, 0x4a, 0x04, 0xf2, 0x0a, 0x5b,
+      0xcf, 0x65, 0x4e, 0x72, 0xe1, 0xff,
+      0x49, 0x6e, 0x4f, 0xbd, 0x8a, 0x05,
+      0x04, 0x70, 0x07, 0x10, 0x71, 0x30,
+      0xd7, 0xd5, 0x4b, 0xc4, 0x2c, 0xd4,
+      0x75, 0xf8, 0x47, 0x81
+    },
+    //
+    // Signature
+    //
+    {
+      0x0d, 0xbb, 0x1b, 0x1f, 0x09, 0xa0,
+      0xf7, 0xcb, 0x24, 0x02, 0xc7, 0xe5,
+      0xed, 0x34, 0x62, 0x4d, 0x0e, 0x58,
+      0x42, 0x9e, 0x19, 0x61, 0x3a, 0x26,
+      0xe0, 0x4f, 0x27, 0xf1, 0xc6, 0x07,
+      0x7a, 0x88, 0x6c, 0xe8, 0xe6, 0xf7,
+      0xd0, 0x42, 0x0d, 0x6c, 0x47, 0x01,
+      0x73, 0x9d, 0x25, 0xb6, 0xb5, 0x24,
+      0xbf, 0xd7, 0x95, 0x48, 0x4c, 0xad,
+      0x91, 0x24, 0x05, 0x8a, 0xe8, 0x02,
+      0xfd, 0x98, 0xf8, 0x16, 0xb4, 0xfe,
+      0xf1, 0xb5, 0xee, 0x13, 0xea, 0xf8,
+      0x24, 0x32, 0x7d, 0x34, 0x53, 0xf6,
+      0x5b, 0xf1, 0x8f, 0x8f, 0x0a, 0x08,
+      0xdf, 0xc5, 0xd7, 0xb3, 0xb8, 0xaf,
+      0x14, 0xd3, 0x58, 0x93, 0x8b, 0x6e,
+      0x3d, 0xe8, 0xaf, 0xb0, 0xd1, 0xc4,
+      0xbf, 0xdc, 0x14, 0x39, 0xa2, 0xaf,
+      0x20, 0x9c, 0x16, 0x32, 0xbf, 0x7f,
+      0xdb, 0x68, 0x1d, 0x92, 0x73, 0x88,
+      0x61, 0xc6, 0x94, 0xb2, 0x50, 0x6a,
+      0x90, 0x9b, 0x54, 0xd1, 0xcd, 0x60,
+      0xea, 0x8f, 0xba, 0xe7, 0xe0, 0xec,
+      0x1c, 0x1f, 0xb3, 0xa9, 0x7d, 0x64,
+      0x43, 0xa3, 0x73, 0xb8, 0xdc, 0xd3,
+      0x54, 0x93, 0xe8, 0x15, 0x7c, 0xc6,
+      0x35, 0xff, 0xf1, 0xe2, 0x78, 0x2c,
+      0x6b, 0xd3, 0x74, 0x95, 0x17, 0x2b,
+      0x4a, 0x9a, 0x58, 0x1e, 0xf5, 0x21,
+      0x28, 0xb5, 0xc6, 0xf0, 0x30, 0x0a,
+      0x31, 0x74, 0x49, 0xfe, 0xac, 0xab,
+      0xa0, 0x82, 0x52, 0x48, 0x47, 0x8e,
+      0xeb, 0x32, 0xf7, 0x40, 0x63, 0x19,
+      0xf3, 0x9d, 0x83, 0x75, 0x41, 0xcc,
+      0x96, 0x0f, 0xf9, 0x9f, 0x46, 0x68,
+      0x02, 0x1b, 0x8b, 0x7c, 0xf1, 0x98,
+      0xb2, 0x0d, 0x62, 0xaa, 0xdf, 0x6d,
+      0x3b, 0xeb, 0x5a, 0xdc, 0xd6, 0x69,
+      0x5c, 0x14, 0xd4, 0x69, 0x14, 0x96,
+      0x84, 0x3a, 0x81, 0xbf, 0x3b, 0xcd,
+      0x93, 0xb9, 0x30, 0xe4, 0x05, 0x79,
+      0x86, 0x80, 0x73, 0xb7, 0x29, 0x4a,
+      0x16, 0x3b, 0xd1, 0x8f
+    }
+  }
+};
+
 #endif // CRYPTO_SAMPLES_H
@@ -15,6 +15,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Uefi.h>
 #include <PiDxe.h>
 #include <Library/PcdLib.h>
+#include <Library/BaseLib.h>
 #include <Library/UefiLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -26,11 +27,35 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Library/OcMiscLib.h>
 #include <Library/PrintLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Protocol/SimpleTextInEx.h>
 
 #include "CryptoSamples.h"
 
+//
+// Generated message sizes for multi-buffer SHA-256 tests, covering padding
+// corner cases and lanes running out of data at different times.
+//
+STATIC CONST UINTN mSha256MultiLengths[] = {
+  0, 55, 56, 64, 119, 1000, 4099, 65536, 100003
+};
+
+#define SHA256_GENERATED_NUM   ARRAY_SIZE (mSha256MultiLengths)
+#define SHA256_GENERATED_SIZE  (100003 + SHA256_GENERATED_NUM)
+#define SHA256_MULTI_TEST_NUM  (HASH_SAMPLES_NUM + SHA256_MULTI_SAMPLES_NUM + SHA256_GENERATED_NUM)
+
+//
+// Messages hashed by the SHA-256 throughput test.
+//
+#define SHA256_THROUGHPUT_NUM   8
+#define SHA256_THROUGHPUT_SIZE  BASE_4MB
+
+//
+// Signature verifications timed by the RSA throughput test.
+//
+#define RSA_THROUGHPUT_NUM  64
+
 EFI_STATUS
 EFIAPI
 TestRsa2048Sha256Verify (
@@ -67,6 +92,111 @@ TestRsa2048Sha256Verify (
   return Status;
 }
 
+EFI_STATUS
+EFIAPI
+TestRsa2048Sha256Exponents (
+  VOID
+  )
+{
+  UINTN   Index;
+  BOOLEAN SignatureVerified;
+
+  for (Index = 0; Index < RSA_EXPONENT_SAMPLES_NUM; ++Index) {
+    SignatureVerified = RsaVerifySigDataFromData (
+      Rsa2048Sha256ExponentSamples[Index].Modulus,
+      sizeof (Rsa2048Sha256ExponentSamples[Index].Modulus),
+      Rsa2048Sha256ExponentSamples[Index].Exponent,
+      Rsa2048Sha256ExponentSamples[Index].Signature,
+      sizeof (Rsa2048Sha256ExponentSamples[Index].Signature),
+      Rsa2048Sha256Sample.Data,
+      SIGNED_DATA_LEN,
+      OcSigHashTypeSha256
+      );
+
+    if (!SignatureVerified) {
+      Print (
+        L"Rsa2048Sha256 exponent %x signature verifying failed!\n",
+        Rsa2048Sha256ExponentSamples[Index].Exponent
+        );
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  Print (L"Rsa2048Sha256 exponent signatures verifying passed!\n");
+  return EFI_SUCCESS;
+}
+
+STATIC
+UINT64
+GetRsaVerifyTime (
+  IN UINT64  StartCounter,
+  IN UINT64  EndCounter
+  )
+{
+  return DivU64x32 (
+    GetTimeInNanoSecond (EndCounter - StartCounter),
+    RSA_THROUGHPUT_NUM * 1000
+    );
+}
+
+VOID
+EFIAPI
+TestRsaThroughput (
+  VOID
+  )
+{
+  UINT8   DataSha256Hash[SHA256_DIGEST_SIZE];
+  UINTN   Index;
+  UINTN   SampleIndex;
+  UINT64  Start;
+
+  Sha256 (
+    DataSha256Hash,
+    Rsa2048Sha256Sample.Data,
+    SIGNED_DATA_LEN
+    );
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < RSA_THROUGHPUT_NUM; ++Index) {
+    RsaVerifySigHashFromKey (
+      (CONST OC_RSA_PUBLIC_KEY *) Rsa2048Sha256Sample.PublicKey,
+      Rsa2048Sha256Sample.Signature,
+      sizeof (Rsa2048Sha256Sample.Signature),
+      DataSha256Hash,
+      sizeof (DataSha256Hash),
+      OcSigHashTypeSha256
+      );
+  }
+  Print (
+    L"Rsa2048Sha256 exponent 10001 - %Lu us per signature\n",
+    GetRsaVerifyTime (Start, GetPerformanceCounter ())
+    );
+
+  //
+  // These also include the hashing and the calculation of R^2 mod N.
+  //
+  for (SampleIndex = 0; SampleIndex < RSA_EXPONENT_SAMPLES_NUM; ++SampleIndex) {
+    Start = GetPerformanceCounter ();
+    for (Index = 0; Index < RSA_THROUGHPUT_NUM; ++Index) {
+      RsaVerifySigDataFromData (
+        Rsa2048Sha256ExponentSamples[SampleIndex].Modulus,
+        sizeof (Rsa2048Sha256ExponentSamples[SampleIndex].Modulus),
+        Rsa2048Sha256ExponentSamples[SampleIndex].Exponent,
+        Rsa2048Sha256ExponentSamples[SampleIndex].Signature,
+        sizeof (Rsa2048Sha256ExponentSamples[SampleIndex].Signature),
+        Rsa2048Sha256Sample.Data,
+        SIGNED_DATA_LEN,
+        OcSigHashTypeSha256
+        );
+    }
+    Print (
+      L"Rsa2048Sha256 exponent %x - %Lu us per signature\n",
+      Rsa2048Sha256ExponentSamples[SampleIndex].Exponent,
+      GetRsaVerifyTime (Start, GetPerformanceCounter ())
+      );
+  }
+}
+
 EFI_STATUS
 EFIAPI
 TestAesCtr (
@@ -398,6 +528,153 @@ TestHash (
   return Status;
 }
 
+EFI_STATUS
+EFIAPI
+TestSha256Multi (
+  VOID
+  )
+{
+  UINT8        *MillionA;
+  UINT8        *Generated;
+  CONST UINT8  *Data[SHA256_MULTI_TEST_NUM];
+  UINTN        Lengths[SHA256_MULTI_TEST_NUM];
+  UINT8        Hashes[SHA256_MULTI_TEST_NUM * SHA256_DIGEST_SIZE];
+  UINT8        Sha256Hash[SHA256_DIGEST_SIZE];
+  UINTN        Index;
+  UINTN        Count;
+  BOOLEAN      HashTestPassed;
+
+  MillionA  = AllocatePool (SHA256_MILLION_A_LEN);
+  Generated = AllocatePool (SHA256_GENERATED_SIZE);
+  if (MillionA == NULL || Generated == NULL) {
+    if (MillionA != NULL) {
+      FreePool (MillionA);
+    }
+    if (Generated != NULL) {
+      FreePool (Generated);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem (MillionA, SHA256_MILLION_A_LEN, 'a');
+  for (Index = 0; Index < SHA256_GENERATED_SIZE; ++Index) {
+    Generated[Index] = (UINT8) (Index * 7 + (Index >> 8));
+  }
+
+  //
+  // Known answers first, then messages checked against single buffer hashing.
+  // Generated messages start at different offsets to vary the alignment.
+  //
+  Count = 0;
+  for (Index = 0; Index < HASH_SAMPLES_NUM; ++Index, ++Count) {
+    Data[Count]    = HashSamples[Index].PlainText;
+    Lengths[Count] = HashSamples[Index].PlainTextLen;
+  }
+
+  Data[Count]    = (CONST UINT8 *) Sha256TwoBlockSample;
+  Lengths[Count] = sizeof (Sha256TwoBlockSample) - 1;
+  ++Count;
+  Data[Count]    = MillionA;
+  Lengths[Count] = SHA256_MILLION_A_LEN;
+  ++Count;
+
+  for (Index = 0; Index < SHA256_GENERATED_NUM; ++Index, ++Count) {
+    Data[Count]    = &Generated[Index];
+    Lengths[Count] = mSha256MultiLengths[Index];
+  }
+
+  Sha256Multi (Hashes, Data, Lengths, Count);
+
+  HashTestPassed = TRUE;
+  for (Index = 0; Index < Count; ++Index) {
+    if (Index < HASH_SAMPLES_NUM) {
+      CopyMem (Sha256Hash, HashSamples[Index].Sha256Hash, SHA256_DIGEST_SIZE);
+    } else if (Index < HASH_SAMPLES_NUM + SHA256_MULTI_SAMPLES_NUM) {
+      CopyMem (Sha256Hash, Sha256MultiSampleHashes[Index - HASH_SAMPLES_NUM], SHA256_DIGEST_SIZE);
+    } else {
+      Sha256 (Sha256Hash, Data[Index], Lengths[Index]);
+    }
+
+    if (CompareMem (&Hashes[Index * SHA256_DIGEST_SIZE], Sha256Hash, SHA256_DIGEST_SIZE) == 0) {
+      Print (L"Sha256Multi hash test №%lu (%lu bytes) passed\n", (UINT64) Index, (UINT64) Lengths[Index]);
+    } else {
+      Print (L"Sha256Multi hash test №%lu (%lu bytes) failed\n", (UINT64) Index, (UINT64) Lengths[Index]);
+      HashTestPassed = FALSE;
+    }
+  }
+
+  FreePool (MillionA);
+  FreePool (Generated);
+
+  if (HashTestPassed) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_INVALID_PARAMETER;
+}
+
+STATIC
+UINT64
+GetSha256Throughput (
+  IN UINT64  StartCounter,
+  IN UINT64  EndCounter
+  )
+{
+  UINT64  Nanoseconds;
+
+  Nanoseconds = GetTimeInNanoSecond (EndCounter - StartCounter);
+  if (Nanoseconds == 0) {
+    return 0;
+  }
+
+  return DivU64x64Remainder (
+    MultU64x32 (SHA256_THROUGHPUT_NUM * SHA256_THROUGHPUT_SIZE, 1000),
+    Nanoseconds,
+    NULL
+    );
+}
+
+VOID
+EFIAPI
+TestSha256Throughput (
+  IN CONST CHAR16  *Mode
+  )
+{
+  UINT8        *Buffer;
+  CONST UINT8  *Data[SHA256_THROUGHPUT_NUM];
+  UINTN        Lengths[SHA256_THROUGHPUT_NUM];
+  UINT8        Hashes[SHA256_THROUGHPUT_NUM * SHA256_DIGEST_SIZE];
+  UINTN        Index;
+  UINT64       Start;
+
+  Buffer = AllocatePool (SHA256_THROUGHPUT_NUM * SHA256_THROUGHPUT_SIZE);
+  if (Buffer == NULL) {
+    Print (L"Sha256 throughput test skipped, out of memory\n");
+    return;
+  }
+
+  for (Index = 0; Index < SHA256_THROUGHPUT_NUM * SHA256_THROUGHPUT_SIZE; ++Index) {
+    Buffer[Index] = (UINT8) Index;
+  }
+
+  for (Index = 0; Index < SHA256_THROUGHPUT_NUM; ++Index) {
+    Data[Index]    = &Buffer[Index * SHA256_THROUGHPUT_SIZE];
+    Lengths[Index] = SHA256_THROUGHPUT_SIZE;
+  }
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < SHA256_THROUGHPUT_NUM; ++Index) {
+    Sha256 (&Hashes[Index * SHA256_DIGEST_SIZE], Data[Index], Lengths[Index]);
+  }
+  Print (L"Sha256 %s single buffer - %Lu MB/s\n", Mode, GetSha256Throughput (Start, GetPerformanceCounter ()));
+
+  Start = GetPerformanceCounter ();
+  Sha256Multi (Hashes, Data, Lengths, SHA256_THROUGHPUT_NUM);
+  Print (L"Sha256 %s multi-buffer - %Lu MB/s\n", Mode, GetSha256Throughput (Start, GetPerformanceCounter ()));
+
+  FreePool (Buffer);
+}
+
 EFI_STATUS
 EFIAPI
 UefiDriverMain (
@@ -421,6 +698,23 @@ UefiDriverMain (
     Print (L"All hash tests passed!\n");
   }
 
+  //
+  // Test SHA-256 multi-buffer hashing without and with acceleration
+  //
+  TestSha256Throughput (L"default");
+  Status = TestSha256Multi ();
+  Print (L"AVX enabled - %u\n", TryEnableAvx ());
+  if (!EFI_ERROR (Status)) {
+    Status = TestSha256Multi ();
+  }
+  TestSha256Throughput (L"accelerated");
+  if (EFI_ERROR (Status)) {
+    Print (L"Sha256Multi failed!\n");
+    Failure = TRUE;
+  } else {
+    Print (L"Sha256Multi passed!\n");
+  }
+
   //
   // Test AES-128-CBC
   //
@@ -462,6 +756,19 @@ UefiDriverMain (
     Print (L"Rsa2048Sha256 passed!\n");
   }
 
+  //
+  // Test Rsa2048Sha256 signatures with other exponents
+  //
+  Status = TestRsa2048Sha256Exponents ();
+  if (EFI_ERROR (Status)) {
+    Print (L"Rsa2048Sha256 exponents failed!\n");
+    Failure = TRUE;
+  } else {
+    Print (L"Rsa2048Sha256 exponents passed!\n");
+  }
+
+  TestRsaThroughput ();
+
   if (Failure) {
     Print (L"Some tests failed\n");
     return EFI_INVALID_PARAMETER;
@@ -498,6 +805,25 @@ UefiAppMain (
 
   WaitForKeyPress (L"Press any key...");
 
+  //
+  // Test SHA-256 multi-buffer hashing without and with acceleration
+  //
+  TestSha256Throughput (L"default");
+  Status = TestSha256Multi ();
+  Print (L"AVX enabled - %u\n", TryEnableAvx ());
+  if (!EFI_ERROR (Status)) {
+    Status = TestSha256Multi ();
+  }
+  TestSha256Throughput (L"accelerated");
+  if (EFI_ERROR (Status)) {
+    Print (L"Sha256Multi failed!\n");
+    Failure = TRUE;
+  } else {
+    Print (L"Sha256Multi passed!\n");
+  }
+
+  WaitForKeyPress (L"Press any key...");
+
   //
   // Test AES-128-CBC
   //
@@ -547,6 +873,19 @@ UefiAppMain (
   } else {
     Print(L"Rsa2048Sha256 passed!\n");
   }
+
+  //
+  // Test Rsa2048Sha256 signatures with other exponents
+  //
+  Status = TestRsa2048Sha256Exponents ();
+  if (EFI_ERROR (Status)) {
+    Print (L"Rsa2048Sha256 exponents failed!\n");
+    Failure = TRUE;
+  } else {
+    Print (L"Rsa2048Sha256 exponents passed!\n");
+  }
+
+  TestRsaThroughput ();
   WaitForKeyPress (L"Press any key to exit");
 
 
@@ -0,0 +1,16 @@
+/** @file
+  Copyright (c) 2026, agent. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#ifndef OC_USER_TIME_H
+#define OC_USER_TIME_H
+
+#include <stdint.h>
+
+/**
+  Get current timestamp in microseconds for time measurement.
+**/
+int64_t UserCurrentTimestamp(void);
+
+#endif // OC_USER_TIME_H
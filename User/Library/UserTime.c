@@ -0,0 +1,16 @@
+/** @file
+  Copyright (c) 2026, agent. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <UserTime.h>
+
+#include <stddef.h>
+#include <sys/time.h>
+
+int64_t UserCurrentTimestamp(void) {
+  struct timeval Time;
+
+  gettimeofday(&Time, NULL);
+  return Time.tv_sec * 1000000LL + Time.tv_usec;
+}
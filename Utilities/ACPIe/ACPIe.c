@@ -15,6 +15,12 @@
 #include <Library/OcGuardLib.h>
 #include <IndustryStandard/AcpiAml.h>
 #include <UserFile.h>
+#include <UserTime.h>
+
+//
+// Amount of lookup rounds for time measurement.
+//
+#define BENCH_ROUND_COUNT  64
 
 /**
   Prints description of error occured in the perser.
@@ -99,11 +105,343 @@ AcpiFindEntryInFile (
   return Status;
 }
 
+/**
+  Finds offset of required entry in ACPI table using namespace index.
+
+  @param[in]  FileName   Path to file containing ACPI table.
+  @param[in]  PathString Path to entry which must be found.
+  @param[in]  Entry      Number of entry which must be found.
+  @param[out] Offset     Offset of the entry if it was found.
+
+  @retval EFI_SUCCESS           Required entry was found.
+  @retval EFI_NOT_FOUND         Required entry was not found.
+  @retval EFI_DEVICE_ERROR      Error occured during parsing ACPI table.
+  @retval EFI_OUT_OF_RESOURCES  Nesting limit has been reached.
+  @retval EFI_INVALID_PARAMETER Got wrong path to the entry.
+  @retval EFI_LOAD_ERROR        Wrong path to the file or the file can't
+                                be opened.
+**/
+EFI_STATUS
+AcpiFindEntryInFileIndex (
+  IN     CONST CHAR8 *FileName,
+  IN     CONST CHAR8 *PathString,
+  IN     UINT8       Entry,
+     OUT UINT32      *Offset
+  )
+{
+  UINT8                    *TableStart;
+  EFI_STATUS               Status;
+  UINT32                   TableLength;
+  OC_ACPI_NAMESPACE_INDEX  Index;
+
+  TableStart = UserReadFile (FileName, &TableLength);
+  if (TableStart == NULL) {
+    DEBUG ((DEBUG_INFO, "No file %a\n", FileName));
+    return EFI_LOAD_ERROR;
+  }
+
+  ZeroMem (&Index, sizeof (Index));
+  Status = AcpiFindEntryInIndex (&Index, TableStart, PathString, Entry, Offset, TableLength);
+  AcpiFreeNamespaceIndex (&Index);
+
+  FreePool(TableStart);
+
+  return Status;
+}
+
+/**
+  Prints namespace index node name.
+
+  @param[in] Table  ACPI table.
+  @param[in] Node   Namespace index node.
+**/
+VOID
+PrintNodeName (
+  IN CONST UINT8                   *Table,
+  IN CONST OC_ACPI_NAMESPACE_NODE  *Node
+  )
+{
+  UINT32  Index;
+
+  if ((Node->Flags & OC_ACPI_NODE_ROOT_PATH) != 0) {
+    printf ("\\");
+  }
+
+  for (Index = 0; Index < Node->NameLength; ++Index) {
+    printf ("%s%.4s", Index > 0 ? "." : "", (CONST CHAR8 *) Table + Node->Name + Index * 4);
+  }
+
+  if (Node->Name2 != 0) {
+    printf (" %.4s", (CONST CHAR8 *) Table + Node->Name2);
+  }
+}
+
+/**
+  Prints namespace index of ACPI table.
+
+  @param[in] FileName  Path to file containing ACPI table.
+
+  @retval EFI_SUCCESS     Index was printed.
+  @retval EFI_LOAD_ERROR  Wrong path to the file or the file can't
+                          be opened.
+**/
+EFI_STATUS
+DumpIndexOfFile (
+  IN CONST CHAR8  *FileName
+  )
+{
+  UINT8                   *TableStart;
+  EFI_STATUS              Status;
+  UINT32                  TableLength;
+  UINT32                  Depth;
+  UINT32                  NodeIndex;
+  OC_ACPI_NAMESPACE_INDEX Index;
+  OC_ACPI_NAMESPACE_NODE  *Node;
+  CONST CHAR8             *Type;
+
+  TableStart = UserReadFile (FileName, &TableLength);
+  if (TableStart == NULL) {
+    DEBUG ((DEBUG_INFO, "No file %a\n", FileName));
+    return EFI_LOAD_ERROR;
+  }
+
+  Status = AcpiInitNamespaceIndex (&Index, TableStart, TableLength);
+  if (EFI_ERROR (Status)) {
+    FreePool (TableStart);
+    return Status;
+  }
+
+  Depth = 0;
+
+  for (NodeIndex = 0; NodeIndex < Index.NumberOfNodes; ++NodeIndex) {
+    Node = &Index.Nodes[NodeIndex];
+
+    switch (Node->Type) {
+      case OC_ACPI_NODE_SCOPE:
+        Type = Node->Opcode == AML_SCOPE_OP ? "Scope" : "Device";
+        break;
+      case OC_ACPI_NODE_IF:
+        Type = "If";
+        break;
+      case OC_ACPI_NODE_METHOD:
+        Type = "Method";
+        break;
+      case OC_ACPI_NODE_FIELD:
+        Type = "Field";
+        break;
+      case OC_ACPI_NODE_CREATE_FIELD:
+        Type = "CreateField";
+        break;
+      case OC_ACPI_NODE_BANK_FIELD:
+        Type = "BankField";
+        break;
+      case OC_ACPI_NODE_INDEX_FIELD:
+        Type = "IndexField";
+        break;
+      case OC_ACPI_NODE_SCOPE_END:
+      case OC_ACPI_NODE_IF_END:
+        --Depth;
+        continue;
+      case OC_ACPI_NODE_RECOVER:
+        Depth = Node->Length;
+        continue;
+      default:
+        continue;
+    }
+
+    printf ("%08X %02X %*s%s ", Node->Offset, Node->Opcode, (int) Depth * 2, "", Type);
+    PrintNodeName (TableStart, Node);
+    printf (" (%u)\n", Node->Length);
+
+    if (Node->Type == OC_ACPI_NODE_SCOPE || Node->Type == OC_ACPI_NODE_IF) {
+      ++Depth;
+    }
+  }
+
+  printf ("Indexed %u nodes with depth %u\n", Index.NumberOfNodes, Index.MaxDepth);
+  PrintParserError (Index.Status == EFI_NOT_FOUND ? EFI_SUCCESS : Index.Status);
+
+  AcpiFreeNamespaceIndex (&Index);
+  FreePool (TableStart);
+  return EFI_SUCCESS;
+}
+
+/**
+  Compares entry lookup time with table parsing and namespace index.
+
+  @param[in] FileName    Path to file containing ACPI table.
+  @param[in] PathString  Path to entry which must be found.
+  @param[in] Entry       Number of entry which must be found.
+
+  @retval EFI_SUCCESS     Both lookups returned the same result.
+  @retval EFI_ABORTED     Lookup results differ.
+  @retval EFI_LOAD_ERROR  Wrong path to the file or the file can't
+                          be opened.
+**/
+EFI_STATUS
+BenchIndexOfFile (
+  IN CONST CHAR8  *FileName,
+  IN CONST CHAR8  *PathString,
+  IN UINT8        Entry
+  )
+{
+  UINT8                   *TableStart;
+  EFI_STATUS              Status;
+  EFI_STATUS              IndexStatus;
+  UINT32                  TableLength;
+  UINT32                  Offset;
+  UINT32                  IndexOffset;
+  UINT32                  Round;
+  long long               Start;
+  long long               ParseTime;
+  long long               BuildTime;
+  long long               IndexTime;
+  OC_ACPI_NAMESPACE_INDEX Index;
+
+  TableStart = UserReadFile (FileName, &TableLength);
+  if (TableStart == NULL) {
+    DEBUG ((DEBUG_INFO, "No file %a\n", FileName));
+    return EFI_LOAD_ERROR;
+  }
+
+  Offset      = 0;
+  IndexOffset = 0;
+  Status      = EFI_NOT_FOUND;
+  IndexStatus = EFI_NOT_FOUND;
+
+  Start = UserCurrentTimestamp ();
+  for (Round = 0; Round < BENCH_ROUND_COUNT; ++Round) {
+    Status = AcpiFindEntryInMemory (TableStart, PathString, Entry, &Offset, TableLength);
+  }
+  ParseTime = UserCurrentTimestamp () - Start;
+
+  Start = UserCurrentTimestamp ();
+  ZeroMem (&Index, sizeof (Index));
+  AcpiInitNamespaceIndex (&Index, TableStart, TableLength);
+  BuildTime = UserCurrentTimestamp () - Start;
+
+  Start = UserCurrentTimestamp ();
+  for (Round = 0; Round < BENCH_ROUND_COUNT; ++Round) {
+    IndexStatus = AcpiFindEntryInIndex (&Index, TableStart, PathString, Entry, &IndexOffset, TableLength);
+  }
+  IndexTime = UserCurrentTimestamp () - Start;
+
+  printf ("Parse lookup: %lld us\n", ParseTime / BENCH_ROUND_COUNT);
+  printf ("Index build: %lld us, %u nodes\n", BuildTime, Index.NumberOfNodes);
+  printf ("Index lookup: %lld us\n", IndexTime / BENCH_ROUND_COUNT);
+
+  AcpiFreeNamespaceIndex (&Index);
+  FreePool (TableStart);
+
+  if (Status != IndexStatus || (Status == EFI_SUCCESS && Offset != IndexOffset)) {
+    printf ("Index mismatch: %d at %u vs %d at %u\n", Status == EFI_SUCCESS, Offset, IndexStatus == EFI_SUCCESS, IndexOffset);
+    return EFI_ABORTED;
+  }
+
+  if (Status == EFI_SUCCESS) {
+    printf ("Returned offset: %d\n", Offset);
+  } else {
+    PrintParserError (Status);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Applies patches to ACPI table loaded as DSDT and prints replacement counts.
+
+  @param[in] FileName    Path to file containing ACPI table.
+  @param[in] PatchArgs   Find, Replace and Base strings of every patch,
+                         with - for no Base.
+  @param[in] PatchCount  Number of patches.
+
+  @retval EFI_SUCCESS            Patches were applied.
+  @retval EFI_INVALID_PARAMETER  Patch or table is malformed.
+  @retval EFI_LOAD_ERROR         Wrong path to the file or the file can't
+                                 be opened.
+**/
+EFI_STATUS
+PatchFile (
+  IN CONST CHAR8  *FileName,
+  IN CONST CHAR8  **PatchArgs,
+  IN UINT32       PatchCount
+  )
+{
+  UINT8            *TableStart;
+  EFI_STATUS       Status;
+  UINT32           TableLength;
+  UINT32           Index;
+  OC_ACPI_CONTEXT  Context;
+  OC_ACPI_PATCH    *Patches;
+  UINT32           *ReplaceCounts;
+
+  TableStart = UserReadFile (FileName, &TableLength);
+  if (TableStart == NULL) {
+    DEBUG ((DEBUG_INFO, "No file %a\n", FileName));
+    return EFI_LOAD_ERROR;
+  }
+
+  if (TableLength < sizeof (EFI_ACPI_DESCRIPTION_HEADER)
+    || ((EFI_ACPI_COMMON_HEADER *) TableStart)->Length > TableLength) {
+    FreePool (TableStart);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Patches       = AllocateZeroPool (PatchCount * sizeof (*Patches));
+  ReplaceCounts = AllocatePool (PatchCount * sizeof (*ReplaceCounts));
+  if (Patches == NULL || ReplaceCounts == NULL) {
+    if (Patches != NULL) {
+      FreePool (Patches);
+    }
+    if (ReplaceCounts != NULL) {
+      FreePool (ReplaceCounts);
+    }
+    FreePool (TableStart);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < PatchCount; ++Index) {
+    Patches[Index].Find    = (CONST UINT8 *) PatchArgs[Index * 3];
+    Patches[Index].Replace = (CONST UINT8 *) PatchArgs[Index * 3 + 1];
+    Patches[Index].Size    = (UINT32) strlen (PatchArgs[Index * 3]);
+    if (strcmp (PatchArgs[Index * 3 + 2], "-") != 0) {
+      Patches[Index].Base = PatchArgs[Index * 3 + 2];
+    }
+
+    if (Patches[Index].Size == 0 || Patches[Index].Size != strlen (PatchArgs[Index * 3 + 1])) {
+      Status = EFI_INVALID_PARAMETER;
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    ZeroMem (&Context, sizeof (Context));
+    Context.Dsdt = (EFI_ACPI_DESCRIPTION_HEADER *) TableStart;
+
+    Status = AcpiApplyPatches (&Context, Patches, PatchCount, ReplaceCounts);
+    for (Index = 0; Index < PatchCount && !EFI_ERROR (Status); ++Index) {
+      printf ("Patch %u replaced %u\n", Index + 1, ReplaceCounts[Index]);
+    }
+
+    AcpiFreeContext (&Context);
+  }
+
+  FreePool (Patches);
+  FreePool (ReplaceCounts);
+  FreePool (TableStart);
+
+  return Status;
+}
+
 // -[f|a] , CHAR8 ** memory_location , CHAR8 ** path , UINT8 occurance
 /**
    Finds sought entry in ACPI table.
    Usage:
    ./ACPIe -f FileName Path [Entry]
+   ./ACPIe -i FileName Path [Entry]  (lookup with namespace index)
+   ./ACPIe -b FileName Path [Entry]  (benchmark namespace index)
+   ./ACPIe -d FileName               (dump namespace index)
+   ./ACPIe -p FileName Find Replace Base [...]  (apply patches, - for no Base)
 
    @param[in] FileName  Path to file with ACPI table.
    @param[in] Path      Path to required entry.
@@ -125,6 +463,49 @@ ENTRY_POINT (
   PcdGet32 (PcdDebugPrintErrorLevel)      |= DEBUG_VERBOSE | DEBUG_INFO;
 #endif
 
+  if (argc == 3 && argv[1][0] == '-' && argv[1][1] == 'd') {
+    Status = DumpIndexOfFile (argv[2]);
+    PrintParserError (Status);
+    return 0;
+  }
+
+  if (argc >= 6 && (argc - 3) % 3 == 0 && argv[1][0] == '-' && argv[1][1] == 'p') {
+    Status = PatchFile (argv[2], &argv[3], (UINT32) (argc - 3) / 3);
+    PrintParserError (Status);
+    return 0;
+  }
+
+  if ((argc == 4 || argc == 5) && argv[1][0] == '-' && (argv[1][1] == 'i' || argv[1][1] == 'b')) {
+    if (argv[1][1] == 'b') {
+      Status = BenchIndexOfFile (
+        argv[2],
+        argv[3],
+        argc == 5 ? atoi (argv[4]) : 1
+        );
+      if (Status == EFI_ABORTED) {
+        return 1;
+      }
+      PrintParserError (Status);
+      return 0;
+    }
+
+    ReturnedOffset = 0;
+    Status = AcpiFindEntryInFileIndex (
+      argv[2],
+      argv[3],
+      argc == 5 ? atoi (argv[4]) : 1,
+      &ReturnedOffset
+      );
+
+    if (Status == EFI_SUCCESS) {
+      printf ("Returned offset: %d\n", ReturnedOffset);
+    } else {
+      PrintParserError (Status);
+    }
+
+    return 0;
+  }
+
   switch (argc) {
     case 5:
 
@@ -232,12 +613,30 @@ LLVMFuzzerTestOneInput (
 {
   if (Size > 0) {
     UINT32 offset = 0;
-    AcpiFindEntryInMemory (
+    UINT32 index_offset = 0;
+    EFI_STATUS status;
+    EFI_STATUS index_status;
+    OC_ACPI_NAMESPACE_INDEX index;
+
+    status = AcpiFindEntryInMemory (
       (UINT8 *)Data, "_SB.PCI0.GFX0",
       1,
       &offset,
       (UINT32) Size
       );
+
+    ZeroMem (&index, sizeof (index));
+    index_status = AcpiFindEntryInIndex (
+      &index,
+      (UINT8 *)Data, "_SB.PCI0.GFX0",
+      1,
+      &index_offset,
+      (UINT32) Size
+      );
+    AcpiFreeNamespaceIndex (&index);
+
+    ASSERT (status == index_status);
+    ASSERT (status != EFI_SUCCESS || offset == index_offset);
   }
 
   return 0;
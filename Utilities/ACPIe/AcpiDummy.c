@@ -0,0 +1,36 @@
+/** @file
+  Copyright (c) 2026, agent. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Library/DebugLib.h>
+#include <Library/OcMemoryLib.h>
+#include <Library/TimerLib.h>
+
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  )
+{
+  return 0;
+}
+
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN UINT64  Ticks
+  )
+{
+  return 0;
+}
+
+EFI_STATUS
+LegacyRegionUnlock (
+  IN UINT32  LegacyAddress,
+  IN UINT32  LegacyLength
+  )
+{
+  ASSERT (FALSE);
+  return EFI_UNSUPPORTED;
+}
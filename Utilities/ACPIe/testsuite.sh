@@ -178,4 +178,44 @@ then echo FAIL && code=1
 else (echo OK; rm -f Tests/Output/test21_output.txt)
 fi
 
+printf "%s" "Test_22(Tests/Input/SSDT-x4_0.bin, \\_PR.PR00._PPC, 2, index): "
+./ACPIe -i Tests/Input/SSDT-x4_0.bin \\_PR.PR00._PPC 2 > Tests/Output/test22_output.txt
+diff -q Tests/Output/test22_output.txt Tests/Correct/test2_output.txt
+if (($? == 1))
+then echo FAIL && code=1
+else (echo OK; rm -f Tests/Output/test22_output.txt)
+fi
+
+printf "%s" "Test_23(Tests/Input/SSDT-0.bin, \\_SB.PCI0.SAT0.TMD0.DMA0, 1, index): "
+./ACPIe -i Tests/Input/SSDT-0.bin \\_SB.PCI0.SAT0.TMD0.DMA0 1 > Tests/Output/test23_output.txt
+diff -q Tests/Output/test23_output.txt Tests/Correct/test4_output.txt
+if (($? == 1))
+then echo FAIL && code=1
+else (echo OK; rm -f Tests/Output/test23_output.txt)
+fi
+
+printf "%s" "Test_24(Tests/Input/DSDT-legacy.bin, \\HPET, 1, index): "
+./ACPIe -i Tests/Input/DSDT-legacy.bin \\HPET > Tests/Output/test24_output.txt
+diff -q Tests/Output/test24_output.txt Tests/Correct/test19_output.txt
+if (($? == 1))
+then echo FAIL && code=1
+else (echo OK; rm -f Tests/Output/test24_output.txt)
+fi
+
+printf "%s" "Test_25(Tests/Input/DSDT.bin, _OSI->XOSI, XOSI->YOSI, patch): "
+./ACPIe -p Tests/Input/DSDT.bin _OSI XOSI - XOSI YOSI - > Tests/Output/test25_output.txt
+diff -q Tests/Output/test25_output.txt Tests/Correct/test25_output.txt
+if (($? == 1))
+then echo FAIL && code=1
+else (echo OK; rm -f Tests/Output/test25_output.txt)
+fi
+
+printf "%s" "Test_26(Tests/Input/DSDT.bin, _OSI->XOSI at \\MBAR, XOSI->YOSI, patch): "
+./ACPIe -p Tests/Input/DSDT.bin _OSI XOSI \\MBAR XOSI YOSI - > Tests/Output/test26_output.txt
+diff -q Tests/Output/test26_output.txt Tests/Correct/test26_output.txt
+if (($? == 1))
+then echo FAIL && code=1
+else (echo OK; rm -f Tests/Output/test26_output.txt)
+fi
+
 exit $code
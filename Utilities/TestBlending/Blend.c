@@ -0,0 +1,273 @@
+/** @file
+  This file is part of OpenCanopy, OpenCore GUI.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Base.h>
+#include <Library/DebugLib.h>
+
+#include "OpenCanopy.h"
+#include "Blending.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <UserTime.h>
+
+//
+// Width and height of the screen used for throughput measurement.
+//
+#define TEST_SCREEN_WIDTH   3840
+#define TEST_SCREEN_HEIGHT  2160
+#define TEST_FRAME_COUNT    30
+
+#define RGB_ALPHA_BLEND(Back, Front, InvFrontOpacity)  \
+  ((Front) + RGB_APPLY_OPACITY (InvFrontOpacity, Back))
+
+//
+// Reference per-channel implementation the row kernels must match exactly.
+//
+STATIC
+VOID
+ReferenceBlendPixel (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackPixel,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontPixel
+  )
+{
+  UINT8 InvFrontOpacity;
+
+  InvFrontOpacity = (0xFF - FrontPixel->Reserved);
+
+  BackPixel->Blue  = RGB_ALPHA_BLEND (BackPixel->Blue,  FrontPixel->Blue,  InvFrontOpacity);
+  BackPixel->Green = RGB_ALPHA_BLEND (BackPixel->Green, FrontPixel->Green, InvFrontOpacity);
+  BackPixel->Red   = RGB_ALPHA_BLEND (BackPixel->Red,   FrontPixel->Red,   InvFrontOpacity);
+
+  if (BackPixel->Reserved != 0xFF) {
+    BackPixel->Reserved = RGB_ALPHA_BLEND (BackPixel->Reserved, FrontPixel->Reserved, InvFrontOpacity);
+  }
+}
+
+STATIC
+VOID
+ReferenceBlend (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackPixel,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontPixel,
+  IN     UINT8                                Opacity
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL OpacFrontPixel;
+
+  if (FrontPixel->Reserved == 0) {
+    return;
+  }
+
+  if (Opacity == 0xFF) {
+    if (FrontPixel->Reserved == 0xFF) {
+      *BackPixel = *FrontPixel;
+    } else {
+      ReferenceBlendPixel (BackPixel, FrontPixel);
+    }
+
+    return;
+  }
+
+  if (FrontPixel->Reserved == 0xFF) {
+    OpacFrontPixel.Reserved = Opacity;
+  } else {
+    OpacFrontPixel.Reserved = RGB_APPLY_OPACITY (FrontPixel->Reserved, Opacity);
+    if (OpacFrontPixel.Reserved == 0) {
+      return;
+    }
+  }
+
+  OpacFrontPixel.Blue  = RGB_APPLY_OPACITY (FrontPixel->Blue,  Opacity);
+  OpacFrontPixel.Green = RGB_APPLY_OPACITY (FrontPixel->Green, Opacity);
+  OpacFrontPixel.Red   = RGB_APPLY_OPACITY (FrontPixel->Red,   Opacity);
+
+  ReferenceBlendPixel (BackPixel, &OpacFrontPixel);
+}
+
+STATIC
+VOID
+RandomPixels (
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Pixels,
+  IN  UINT32                         Count,
+  IN  BOOLEAN                        Premultiplied
+  )
+{
+  UINT32 Index;
+  UINT8  Alpha;
+
+  for (Index = 0; Index < Count; ++Index) {
+    //
+    // Favour fully transparent and fully opaque pixels like real images do.
+    //
+    switch (rand () % 4) {
+      case 0:
+        Alpha = 0;
+        break;
+      case 1:
+        Alpha = 0xFF;
+        break;
+      default:
+        Alpha = (UINT8) rand ();
+        break;
+    }
+
+    Pixels[Index].Reserved = Alpha;
+    Pixels[Index].Blue     = (UINT8) rand ();
+    Pixels[Index].Green    = (UINT8) rand ();
+    Pixels[Index].Red      = (UINT8) rand ();
+
+    if (Premultiplied) {
+      Pixels[Index].Blue  = RGB_APPLY_OPACITY (Pixels[Index].Blue,  Alpha);
+      Pixels[Index].Green = RGB_APPLY_OPACITY (Pixels[Index].Green, Alpha);
+      Pixels[Index].Red   = RGB_APPLY_OPACITY (Pixels[Index].Red,   Alpha);
+    }
+  }
+}
+
+STATIC
+BOOLEAN
+TestExactness (
+  VOID
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL Back[257];
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL Front[257];
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL Expected[257];
+  UINT32                        Round;
+  UINT32                        Opacity;
+  UINT32                        Width;
+  UINT32                        Index;
+
+  for (Round = 0; Round < 512; ++Round) {
+    for (Opacity = 1; Opacity <= 0xFF; ++Opacity) {
+      Width = 1 + rand () % ARRAY_SIZE (Back);
+
+      RandomPixels (Back, Width, FALSE);
+      RandomPixels (Front, Width, (Round & 1U) == 0);
+
+      for (Index = 0; Index < Width; ++Index) {
+        Expected[Index] = Back[Index];
+        ReferenceBlend (&Expected[Index], &Front[Index], (UINT8) Opacity);
+      }
+
+      if (Opacity == 0xFF) {
+        GuiBlendRowSolid (Back, Front, Width);
+      } else {
+        GuiBlendRowOpaque (Back, Front, Width, (UINT8) Opacity);
+      }
+
+      if (memcmp (Back, Expected, Width * sizeof (Back[0])) != 0) {
+        printf ("Blending mismatch for opacity %u width %u\n", Opacity, Width);
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+VOID
+TestThroughput (
+  VOID
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Screen;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Image;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Expected;
+  UINT32                        Frame;
+  UINT32                        Row;
+  UINT32                        Index;
+  UINT8                         Opacity;
+  long long                     Start;
+  long long                     ReferenceTime;
+  long long                     RowTime;
+
+  Screen   = malloc (TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT * sizeof (*Screen));
+  Expected = malloc (TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT * sizeof (*Expected));
+  Image    = malloc (TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT * sizeof (*Image));
+  if (Screen == NULL || Expected == NULL || Image == NULL) {
+    printf ("Throughput buffer allocation failed\n");
+    free (Screen);
+    free (Expected);
+    free (Image);
+    return;
+  }
+
+  RandomPixels (Screen, TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT, FALSE);
+  RandomPixels (Image, TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT, TRUE);
+  memcpy (Expected, Screen, TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT * sizeof (*Screen));
+
+  //
+  // Simulate a picker fade-in animation over the whole screen.
+  //
+  Start = UserCurrentTimestamp ();
+  for (Frame = 0; Frame < TEST_FRAME_COUNT; ++Frame) {
+    Opacity = (UINT8) (0xFF * (Frame + 1) / TEST_FRAME_COUNT);
+    for (Index = 0; Index < TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT; ++Index) {
+      ReferenceBlend (&Expected[Index], &Image[Index], Opacity);
+    }
+  }
+  ReferenceTime = UserCurrentTimestamp () - Start;
+
+  Start = UserCurrentTimestamp ();
+  for (Frame = 0; Frame < TEST_FRAME_COUNT; ++Frame) {
+    Opacity = (UINT8) (0xFF * (Frame + 1) / TEST_FRAME_COUNT);
+    for (Row = 0; Row < TEST_SCREEN_HEIGHT; ++Row) {
+      if (Opacity == 0xFF) {
+        GuiBlendRowSolid (
+          &Screen[Row * TEST_SCREEN_WIDTH],
+          &Image[Row * TEST_SCREEN_WIDTH],
+          TEST_SCREEN_WIDTH
+          );
+      } else {
+        GuiBlendRowOpaque (
+          &Screen[Row * TEST_SCREEN_WIDTH],
+          &Image[Row * TEST_SCREEN_WIDTH],
+          TEST_SCREEN_WIDTH,
+          Opacity
+          );
+      }
+    }
+  }
+  RowTime = UserCurrentTimestamp () - Start;
+
+  printf (
+    "Blended %u %ux%u frames: per-pixel %lld ms, per-row %lld ms, %s\n",
+    TEST_FRAME_COUNT,
+    TEST_SCREEN_WIDTH,
+    TEST_SCREEN_HEIGHT,
+    ReferenceTime / 1000,
+    RowTime / 1000,
+    memcmp (Screen, Expected, TEST_SCREEN_WIDTH * TEST_SCREEN_HEIGHT * sizeof (*Screen)) == 0 ? "match" : "MISMATCH"
+    );
+
+  free (Screen);
+  free (Expected);
+  free (Image);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  srand (argc > 1 ? (unsigned) atoi (argv[1]) : 0);
+
+  if (!TestExactness ()) {
+    return -1;
+  }
+
+  printf ("Row blending matches per-pixel blending\n");
+
+  TestThroughput ();
+
+  return 0;
+}
@@ -0,0 +1,498 @@
+/** @file
+  Copyright (c) 2026, agent. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Base.h>
+
+#include <IndustryStandard/AppleCompressedBinaryImage.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcCompressionLib.h>
+#include <Library/OcMachoLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <UserFile.h>
+#include <UserTime.h>
+
+//
+// Amount of decompression rounds for throughput measurement.
+//
+#define TEST_ROUND_COUNT  8
+
+//
+// Amount of corrupted streams checked for adler32 failure.
+//
+#define TEST_CORRUPTION_COUNT  64
+
+//
+// Compressed data block sizes for split stream checks. Single byte blocks
+// put a block boundary at every offset of the compressed data.
+//
+STATIC CONST UINT32 mSplitBlockSizes[] = {
+  1, 2, 3, 7, 61, 4093, OC_DECOMPRESS_STREAM_BLOCK_SIZE
+};
+
+typedef struct {
+  CONST UINT8  *Data;
+  UINT32       Size;
+} MEMORY_STREAM;
+
+STATIC
+BOOLEAN
+ReadMemoryStream (
+  IN  VOID    *Context,
+  IN  UINT32  Offset,
+  IN  UINT32  Size,
+  OUT UINT8   *Buffer
+  )
+{
+  MEMORY_STREAM  *Stream;
+
+  Stream = Context;
+  if (Offset > Stream->Size || Size > Stream->Size - Offset) {
+    return FALSE;
+  }
+
+  CopyMem (Buffer, Stream->Data + Offset, Size);
+  return TRUE;
+}
+
+//
+// Buffer decompression, LZVN uses the fast path for most of the data.
+//
+STATIC
+UINT32
+DecompressBuffer (
+  IN  UINT32       Compression,
+  OUT UINT8        *Dst,
+  IN  UINT32       DstLen,
+  IN  CONST UINT8  *Src,
+  IN  UINT32       SrcLen
+  )
+{
+  if (Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+    return (UINT32) DecompressLZVN (Dst, DstLen, Src, SrcLen);
+  }
+
+  return DecompressLZSS (Dst, DstLen, (UINT8 *) Src, SrcLen);
+}
+
+//
+// Reference decompression through the resumable state machine decoders.
+//
+STATIC
+UINT32
+DecompressReference (
+  IN  UINT32       Compression,
+  OUT UINT8        *Dst,
+  IN  UINT32       DstLen,
+  IN  CONST UINT8  *Src,
+  IN  UINT32       SrcLen,
+  IN  UINT32       BlockSize,
+  OUT UINT32       *Adler  OPTIONAL
+  )
+{
+  MEMORY_STREAM  Stream;
+
+  Stream.Data = Src;
+  Stream.Size = SrcLen;
+
+  if (Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+    return DecompressLZVNStream (Dst, DstLen, SrcLen, BlockSize, ReadMemoryStream, &Stream, Adler);
+  }
+
+  return DecompressLZSSStream (Dst, DstLen, SrcLen, BlockSize, ReadMemoryStream, &Stream, Adler);
+}
+
+//
+// Streamed decompression must not depend on where compressed data is split
+// into blocks, and corrupted data must be rejected like ParseCompressedHeader
+// does, by decompressed size or adler32 mismatch.
+//
+STATIC
+int
+TestStreamSplits (
+  IN CONST CHAR8  *Name,
+  IN UINT32       Compression,
+  IN CONST UINT8  *Src,
+  IN UINT32       SrcLen,
+  IN CONST UINT8  *Expected,
+  IN UINT32       ExpectedLen
+  )
+{
+  UINT8   *Corrupted;
+  UINT8   *Decompressed;
+  UINT32  DecompressedSize;
+  UINT32  ExpectedAdler;
+  UINT32  Adler;
+  UINT32  Index;
+  UINT32  Offset;
+  UINT32  Detected;
+  int     Code;
+
+  Corrupted    = AllocateCopyPool (SrcLen + 1, Src);
+  Decompressed = AllocatePool (ExpectedLen + 1);
+  if (Corrupted == NULL || Decompressed == NULL) {
+    printf ("%s: cannot allocate %u bytes\n", Name, ExpectedLen);
+    if (Corrupted != NULL) {
+      FreePool (Corrupted);
+    }
+    if (Decompressed != NULL) {
+      FreePool (Decompressed);
+    }
+    return -1;
+  }
+
+  Code          = 0;
+  ExpectedAdler = Adler32 (Expected, ExpectedLen);
+
+  for (Index = 0; Index < ARRAY_SIZE (mSplitBlockSizes); ++Index) {
+    Adler            = 0;
+    DecompressedSize = DecompressReference (
+      Compression,
+      Decompressed,
+      ExpectedLen,
+      Src,
+      SrcLen,
+      mSplitBlockSizes[Index],
+      &Adler
+      );
+    if (DecompressedSize != ExpectedLen
+      || Adler != ExpectedAdler
+      || CompareMem (Decompressed, Expected, ExpectedLen) != 0) {
+      printf ("%s: %u byte block stream MISMATCH\n", Name, mSplitBlockSizes[Index]);
+      Code = -1;
+    }
+  }
+
+  Detected = 0;
+  for (Index = 0; Index < TEST_CORRUPTION_COUNT && SrcLen > 0; ++Index) {
+    Offset             = (UINT32) DivU64x32 (MultU64x32 (SrcLen, Index), TEST_CORRUPTION_COUNT);
+    Corrupted[Offset] ^= 0x01;
+    DecompressedSize   = DecompressReference (
+      Compression,
+      Decompressed,
+      ExpectedLen,
+      Corrupted,
+      SrcLen,
+      OC_DECOMPRESS_STREAM_BLOCK_SIZE,
+      &Adler
+      );
+    Corrupted[Offset] ^= 0x01;
+
+    if (DecompressedSize != ExpectedLen) {
+      continue;
+    }
+
+    if (Adler != ExpectedAdler) {
+      ++Detected;
+    } else if (CompareMem (Decompressed, Expected, ExpectedLen) != 0) {
+      printf ("%s: corruption at %u is not detected\n", Name, Offset);
+      Code = -1;
+    }
+  }
+
+  //
+  // Most corruptions only alter literals and are caught by adler32 alone.
+  //
+  if (Detected == 0 && SrcLen > 0) {
+    Code = -1;
+  }
+
+  printf (
+    "%s: %u split streams, %u of %u corrupted streams fail adler32%s\n",
+    Name,
+    (UINT32) ARRAY_SIZE (mSplitBlockSizes),
+    Detected,
+    TEST_CORRUPTION_COUNT,
+    Code != 0 ? ", MISMATCH" : ""
+    );
+
+  FreePool (Corrupted);
+  FreePool (Decompressed);
+  return Code;
+}
+
+STATIC
+int
+BenchKernel (
+  IN CONST CHAR8  *Name,
+  IN UINT8        *Data,
+  IN UINT32       Size
+  )
+{
+  EFI_STATUS        Status;
+  UINT32            Offset;
+  UINT32            SliceSize;
+  MACH_COMP_HEADER  *CompHeader;
+  UINT32            Compression;
+  UINT32            CompressedSize;
+  UINT32            DecompressedSize;
+  UINT8             *Fast;
+  UINT8             *Reference;
+  UINT32            FastSize;
+  UINT32            ReferenceSize;
+  UINT32            Round;
+  long long         FastTime;
+  long long         ReferenceTime;
+  long long         Start;
+  int               Code;
+
+  Status = FatGetArchitectureOffset (Data, Size, Size, MachCpuTypeX8664, &Offset, &SliceSize);
+  if (EFI_ERROR (Status) || SliceSize < sizeof (MACH_COMP_HEADER)) {
+    printf ("%s: no x86_64 slice\n", Name);
+    return -1;
+  }
+
+  CompHeader       = (MACH_COMP_HEADER *) (Data + Offset);
+  Compression      = CompHeader->Compression;
+  CompressedSize   = SwapBytes32 (CompHeader->Compressed);
+  DecompressedSize = SwapBytes32 (CompHeader->Decompressed);
+
+  if (CompHeader->Signature != MACH_COMPRESSED_BINARY_INVERT_SIGNATURE
+    || (Compression != MACH_COMPRESSED_BINARY_INVERT_LZVN && Compression != MACH_COMPRESSED_BINARY_INVERT_LZSS)
+    || CompressedSize > SliceSize - sizeof (MACH_COMP_HEADER)
+    || DecompressedSize > OC_COMPRESSION_MAX_LENGTH) {
+    printf ("%s: not a compressed kernel\n", Name);
+    return -1;
+  }
+
+  Fast      = AllocatePool (DecompressedSize);
+  Reference = AllocatePool (DecompressedSize);
+  if (Fast == NULL || Reference == NULL) {
+    printf ("%s: cannot allocate %u bytes\n", Name, DecompressedSize);
+    if (Fast != NULL) {
+      FreePool (Fast);
+    }
+    if (Reference != NULL) {
+      FreePool (Reference);
+    }
+    return -1;
+  }
+
+  FastSize      = 0;
+  ReferenceSize = 0;
+  FastTime      = 0;
+  ReferenceTime = 0;
+
+  for (Round = 0; Round < TEST_ROUND_COUNT; ++Round) {
+    Start          = UserCurrentTimestamp ();
+    ReferenceSize  = DecompressReference (
+      Compression,
+      Reference,
+      DecompressedSize,
+      (UINT8 *) (CompHeader + 1),
+      CompressedSize,
+      OC_DECOMPRESS_STREAM_BLOCK_SIZE,
+      NULL
+      );
+    ReferenceTime += UserCurrentTimestamp () - Start;
+
+    Start     = UserCurrentTimestamp ();
+    FastSize  = DecompressBuffer (Compression, Fast, DecompressedSize, (UINT8 *) (CompHeader + 1), CompressedSize);
+    FastTime += UserCurrentTimestamp () - Start;
+  }
+
+  Code = FastSize != DecompressedSize
+    || ReferenceSize != DecompressedSize
+    || CompareMem (Fast, Reference, DecompressedSize) != 0
+    || Adler32 (Fast, DecompressedSize) != SwapBytes32 (CompHeader->Hash);
+
+  printf (
+    "%s: %s %u -> %u bytes, reference %.1f MB/s, buffer %.1f MB/s%s\n",
+    Name,
+    Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN ? "lzvn" : "lzss",
+    CompressedSize,
+    DecompressedSize,
+    (double) DecompressedSize * TEST_ROUND_COUNT / (ReferenceTime + 1),
+    (double) DecompressedSize * TEST_ROUND_COUNT / (FastTime + 1),
+    Code != 0 ? ", MISMATCH" : ""
+    );
+
+  if (Code == 0) {
+    Code = TestStreamSplits (Name, Compression, (UINT8 *) (CompHeader + 1), CompressedSize, Fast, DecompressedSize);
+  }
+
+  FreePool (Fast);
+  FreePool (Reference);
+  return Code;
+}
+
+STATIC
+int
+RoundTripLzss (
+  IN CONST CHAR8  *Name,
+  IN UINT8        *Data,
+  IN UINT32       Size
+  )
+{
+  UINT8      *Compressed;
+  UINT8      *Decompressed;
+  UINT8      *Reference;
+  UINT8      *CompressedEnd;
+  UINT32     CompressedLen;
+  UINT32     CompressedSize;
+  UINT32     DecompressedSize;
+  UINT32     ReferenceSize;
+  UINT32     Effort;
+  long long  CompressTime;
+  long long  DecompressTime;
+  long long  Start;
+  int        Code;
+
+  //
+  // LZSS expands incompressible data by one flag byte per eight literals.
+  //
+  CompressedLen = Size + Size / 8 + 1;
+  Compressed    = AllocatePool (CompressedLen);
+  Decompressed  = AllocatePool (Size + 1);
+  Reference     = AllocatePool (Size + 1);
+  if (Compressed == NULL || Decompressed == NULL || Reference == NULL) {
+    printf ("%s: cannot allocate %u bytes\n", Name, CompressedLen);
+    if (Compressed != NULL) {
+      FreePool (Compressed);
+    }
+    if (Decompressed != NULL) {
+      FreePool (Decompressed);
+    }
+    if (Reference != NULL) {
+      FreePool (Reference);
+    }
+    return -1;
+  }
+
+  Code = 0;
+  for (Effort = OC_LZSS_EFFORT_MIN; Effort <= OC_LZSS_EFFORT_MAX; ++Effort) {
+    Start         = UserCurrentTimestamp ();
+    CompressedEnd = CompressLZSSEx (Compressed, CompressedLen, Data, Size, Effort);
+    CompressTime  = UserCurrentTimestamp () - Start;
+    if (CompressedEnd == NULL) {
+      printf ("%s: lzss effort %u compression failure\n", Name, Effort);
+      Code = -1;
+      continue;
+    }
+
+    CompressedSize   = (UINT32) (CompressedEnd - Compressed);
+    Start            = UserCurrentTimestamp ();
+    DecompressedSize = DecompressBuffer (MACH_COMPRESSED_BINARY_INVERT_LZSS, Decompressed, Size, Compressed, CompressedSize);
+    DecompressTime   = UserCurrentTimestamp () - Start;
+    ReferenceSize    = DecompressReference (
+      MACH_COMPRESSED_BINARY_INVERT_LZSS,
+      Reference,
+      Size,
+      Compressed,
+      CompressedSize,
+      OC_DECOMPRESS_STREAM_BLOCK_SIZE,
+      NULL
+      );
+
+    if (DecompressedSize != Size
+      || ReferenceSize != Size
+      || CompareMem (Decompressed, Data, Size) != 0
+      || CompareMem (Reference, Data, Size) != 0) {
+      Code = -1;
+    }
+
+    printf (
+      "%s: lzss effort %u %u -> %u bytes, compress %.1f MB/s, decompress %.1f MB/s%s\n",
+      Name,
+      Effort,
+      Size,
+      CompressedSize,
+      (double) Size / (CompressTime + 1),
+      (double) Size / (DecompressTime + 1),
+      Code != 0 ? ", MISMATCH" : ""
+      );
+
+    if (Code == 0) {
+      Code = TestStreamSplits (Name, MACH_COMPRESSED_BINARY_INVERT_LZSS, Compressed, CompressedSize, Data, Size);
+    }
+  }
+
+  FreePool (Compressed);
+  FreePool (Decompressed);
+  FreePool (Reference);
+  return Code;
+}
+
+int ENTRY_POINT(int argc, char** argv) {
+  uint32_t f;
+  uint8_t *b;
+  int i;
+  int code;
+  int roundtrip;
+
+  roundtrip = argc > 1 && strcmp (argv[1], "-lzss") == 0;
+  if (argc < (roundtrip ? 3 : 2)) {
+    printf ("Usage: %s kernelcache...\n", argv[0]);
+    printf ("       %s -lzss file...\n", argv[0]);
+    return -1;
+  }
+
+  code = 0;
+  for (i = roundtrip ? 2 : 1; i < argc; ++i) {
+    if ((b = UserReadFile(argv[i], &f)) == NULL) {
+      printf("Read fail %s\n", argv[i]);
+      return -1;
+    }
+
+    if (roundtrip) {
+      code |= RoundTripLzss (argv[i], b, f);
+    } else {
+      code |= BenchKernel (argv[i], b, f);
+    }
+    FreePool (b);
+  }
+
+  return code;
+}
+
+INT32 LLVMFuzzerTestOneInput(CONST UINT8 *Data, UINTN Size) {
+  UINT8   *Fast;
+  UINT8   *Reference;
+  UINT32  FastSize;
+  UINT32  ReferenceSize;
+  UINT32  DstLen;
+  UINT32  BlockSize;
+
+  if (Size < sizeof (UINT16) || Size > BASE_16MB) {
+    return 0;
+  }
+
+  //
+  // Buffer and stream decoding must agree on arbitrary data and block splits.
+  //
+  DstLen    = (UINT32) (*(CONST UINT16 *) Data) * 64;
+  BlockSize = (UINT32) (Size % 64) + 1;
+  Fast      = AllocatePool (DstLen + 1);
+  Reference = AllocatePool (DstLen + 1);
+  if (Fast != NULL && Reference != NULL) {
+    FastSize      = DecompressBuffer (MACH_COMPRESSED_BINARY_INVERT_LZVN, Fast, DstLen, Data + 2, (UINT32) Size - 2);
+    ReferenceSize = DecompressReference (MACH_COMPRESSED_BINARY_INVERT_LZVN, Reference, DstLen, Data + 2, (UINT32) Size - 2, BlockSize, NULL);
+    if (FastSize != ReferenceSize || CompareMem (Fast, Reference, FastSize) != 0) {
+      abort ();
+    }
+
+    FastSize      = DecompressBuffer (MACH_COMPRESSED_BINARY_INVERT_LZSS, Fast, DstLen, Data + 2, (UINT32) Size - 2);
+    ReferenceSize = DecompressReference (MACH_COMPRESSED_BINARY_INVERT_LZSS, Reference, DstLen, Data + 2, (UINT32) Size - 2, BlockSize, NULL);
+    if (FastSize != ReferenceSize || CompareMem (Fast, Reference, FastSize) != 0) {
+      abort ();
+    }
+  }
+
+  if (Fast != NULL) {
+    FreePool (Fast);
+  }
+
+  if (Reference != NULL) {
+    FreePool (Reference);
+  }
+
+  return 0;
+}
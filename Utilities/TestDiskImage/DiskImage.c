@@ -15,7 +15,172 @@
 
 #include <string.h>
 
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
 #include <UserFile.h>
+#include <UserTime.h>
+
+//
+// Amount of decompression rounds for throughput measurement.
+//
+#define TEST_ROUND_COUNT  4
+
+//
+// Stock zlib uncompress from the host, used as the baseline.
+//
+typedef int (*STOCK_ZLIB_UNCOMPRESS) (
+  unsigned char        *Dest,
+  unsigned long        *DestLen,
+  const unsigned char  *Source,
+  unsigned long        SourceLen
+  );
+
+STATIC
+STOCK_ZLIB_UNCOMPRESS
+LoadStockZlib (
+  VOID
+  )
+{
+#ifndef _WIN32
+  STATIC CONST char  *Names[] = { "libz.so.1", "libz.so", "libz.dylib", "/usr/lib/libz.dylib" };
+  void               *Handle;
+  UINT32             Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (Names); ++Index) {
+    //
+    // Local binding keeps host zlib symbols from clashing with ours.
+    //
+    Handle = dlopen (Names[Index], RTLD_NOW | RTLD_LOCAL);
+    if (Handle != NULL) {
+      return (STOCK_ZLIB_UNCOMPRESS) dlsym (Handle, "uncompress");
+    }
+  }
+#endif
+
+  return NULL;
+}
+
+//
+// Decompress all ZLIB chunks of the disk image with host zlib as the baseline,
+// and with and without reusing the decompression state, and report the throughput.
+//
+STATIC
+BOOLEAN
+BenchmarkChunkDecompression (
+  IN OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN CONST UINT8                  *Dmg,
+  IN UINT32                       DmgSize
+  )
+{
+  STATIC CONST char         *ModeNames[] = { "stock host", "per-chunk", "reused" };
+  OC_ZLIB_DECOMPRESS_STATE  *State;
+  STOCK_ZLIB_UNCOMPRESS     StockUncompress;
+  APPLE_DISK_IMAGE_CHUNK    *Chunk;
+  UINT8                     *Buffer;
+  UINT64                    ChunkSize;
+  UINT64                    TotalSize;
+  UINTN                     OutSize;
+  unsigned long             StockOutSize;
+  UINT32                    BlockIndex;
+  UINT32                    ChunkIndex;
+  UINT32                    Round;
+  UINT32                    Mode;
+  long long                 Start;
+  long long                 Best;
+
+  State  = CreateZLIBDecompressState ();
+  Buffer = malloc (BASE_16MB);
+  if (State == NULL || Buffer == NULL) {
+    printf ("Benchmark allocation failed\n");
+    free (Buffer);
+    if (State != NULL) {
+      FreeZLIBDecompressState (State);
+    }
+    return FALSE;
+  }
+
+  StockUncompress = LoadStockZlib ();
+  if (StockUncompress == NULL) {
+    printf ("ZLIB stock host state: unavailable, no baseline\n");
+  }
+
+  for (Mode = StockUncompress != NULL ? 0 : 1; Mode < ARRAY_SIZE (ModeNames); ++Mode) {
+    Best      = 0;
+    TotalSize = 0;
+
+    for (Round = 0; Round < TEST_ROUND_COUNT; ++Round) {
+      TotalSize = 0;
+      Start     = UserCurrentTimestamp ();
+
+      for (BlockIndex = 0; BlockIndex < Context->BlockCount; ++BlockIndex) {
+        for (ChunkIndex = 0; ChunkIndex < Context->Blocks[BlockIndex]->ChunkCount; ++ChunkIndex) {
+          Chunk = &Context->Blocks[BlockIndex]->Chunks[ChunkIndex];
+          if (Chunk->Type != APPLE_DISK_IMAGE_CHUNK_TYPE_ZLIB) {
+            continue;
+          }
+
+          ChunkSize = Chunk->SectorCount * APPLE_DISK_IMAGE_SECTOR_SIZE;
+          if (ChunkSize > BASE_16MB
+            || Chunk->CompressedOffset > DmgSize
+            || Chunk->CompressedLength > DmgSize - Chunk->CompressedOffset) {
+            printf ("DMG chunk %u:%u is out of range\n", BlockIndex, ChunkIndex);
+            continue;
+          }
+
+          if (Mode == 0) {
+            StockOutSize = (unsigned long) ChunkSize;
+            OutSize      = StockUncompress (
+              Buffer,
+              &StockOutSize,
+              Dmg + Chunk->CompressedOffset,
+              (unsigned long) Chunk->CompressedLength
+              ) == 0 ? (UINTN) StockOutSize : 0;
+          } else if (Mode == 1) {
+            OutSize = DecompressZLIB (
+              Buffer,
+              (UINTN) ChunkSize,
+              Dmg + Chunk->CompressedOffset,
+              (UINTN) Chunk->CompressedLength
+              );
+          } else {
+            OutSize = DecompressZLIBWithState (
+              State,
+              Buffer,
+              (UINTN) ChunkSize,
+              Dmg + Chunk->CompressedOffset,
+              (UINTN) Chunk->CompressedLength
+              );
+          }
+
+          if (OutSize != ChunkSize) {
+            printf ("DMG chunk %u:%u decompression error\n", BlockIndex, ChunkIndex);
+          }
+
+          TotalSize += ChunkSize;
+        }
+      }
+
+      Start = UserCurrentTimestamp () - Start;
+      if (Round == 0 || Start < Best) {
+        Best = Start;
+      }
+    }
+
+    printf (
+      "ZLIB %s state: %llu bytes in %lld us, %llu MB/s\n",
+      ModeNames[Mode],
+      (unsigned long long) TotalSize,
+      Best,
+      Best > 0 ? (unsigned long long) (TotalSize / (UINT64) Best) : 0ULL
+      );
+  }
+
+  FreeZLIBDecompressState (State);
+  free (Buffer);
+  return TRUE;
+}
 
 int ENTRY_POINT (int argc, char *argv[]) {
   if (argc < 2) {
@@ -115,6 +280,38 @@ int ENTRY_POINT (int argc, char *argv[]) {
 
     printf ("Decompressed the entire DMG...\n");
 
+    //
+    // Read the DMG again in file system block sized pieces to measure chunk cache efficiency.
+    //
+#define READ_BLOCK_SIZE 4096
+
+    uint8_t ReadBlock[READ_BLOCK_SIZE];
+    uint32_t ReadOffset;
+    uint32_t ReadSize;
+
+    for (ReadOffset = 0; ReadOffset < UncompSize; ReadOffset += ReadSize) {
+      ReadSize = MIN (READ_BLOCK_SIZE, UncompSize - ReadOffset);
+      Result = OcAppleDiskImageRead (
+        &DmgContext,
+        ReadOffset / APPLE_DISK_IMAGE_SECTOR_SIZE,
+        ReadSize,
+        ReadBlock
+        );
+      if (!Result || memcmp (ReadBlock, UncompDmg + ReadOffset, ReadSize) != 0) {
+        printf ("DMG block read error at %u\n", ReadOffset);
+        goto ContinueDmgLoop;
+      }
+    }
+
+    printf (
+      "Chunk cache hits %llu, misses %llu, read-aheads %llu\n",
+      (unsigned long long) DmgContext.CacheHits,
+      (unsigned long long) DmgContext.CacheMisses,
+      (unsigned long long) DmgContext.CacheReadAheads
+      );
+
+    BenchmarkChunkDecompression (&DmgContext, Dmg, DmgSize);
+
 #if 0
     FILE *Fh = fopen("out.bin", "wb");
     if (Fh != NULL) {
@@ -0,0 +1,218 @@
+/** @file
+  Copyright (c) 2026, agent. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <fsw_core.h>
+
+#include <string.h>
+
+#include <UserFile.h>
+#include <UserTime.h>
+
+//
+// Amount of mount and traversal rounds for time measurement.
+//
+#define TEST_ROUND_COUNT  4
+
+//
+// Maximum directory depth to descend into.
+//
+#define TEST_MAX_DEPTH    64
+
+typedef struct {
+  UINT8   *Data;
+  UINT32  Size;
+} TEST_HFS_IMAGE;
+
+extern struct fsw_fstype_table FSW_FSTYPE_TABLE_NAME (hfsplus);
+
+STATIC
+VOID
+TestChangeBlocksize (
+  struct fsw_volume  *Vol,
+  fsw_u32            OldPhysBlocksize,
+  fsw_u32            OldLogBlocksize,
+  fsw_u32            NewPhysBlocksize,
+  fsw_u32            NewLogBlocksize
+  )
+{
+}
+
+STATIC
+fsw_status_t
+TestReadBlock (
+  struct fsw_volume  *Vol,
+  fsw_u32            PhysBno,
+  fsw_u32            Count,
+  VOID               *Buffer
+  )
+{
+  TEST_HFS_IMAGE  *Image;
+  UINT64          Offset;
+  UINT64          Size;
+
+  Image  = Vol->host_data;
+  Offset = (UINT64) PhysBno * Vol->phys_blocksize;
+  Size   = (UINT64) Count * Vol->phys_blocksize;
+
+  if (Offset > Image->Size || Size > Image->Size - Offset) {
+    return FSW_IO_ERROR;
+  }
+
+  memcpy (Buffer, Image->Data + Offset, (size_t) Size);
+  return FSW_SUCCESS;
+}
+
+STATIC
+struct fsw_host_table
+mTestHostTable = {
+  FSW_STRING_TYPE_UTF16,
+  TestChangeBlocksize,
+  TestReadBlock
+};
+
+//
+// Read the whole file at once and return the amount of bytes read.
+//
+STATIC
+UINT64
+ReadFileData (
+  IN struct fsw_dnode  *File
+  )
+{
+  fsw_status_t        Status;
+  struct fsw_shandle  Shand;
+  VOID                *Buffer;
+  fsw_u32             Size;
+
+  if (File->size == 0 || File->size > MAX_UINT32) {
+    return 0;
+  }
+
+  Buffer = malloc ((size_t) File->size);
+  if (Buffer == NULL) {
+    return 0;
+  }
+
+  Size   = 0;
+  Status = fsw_shandle_open (File, &Shand);
+  if (Status == FSW_SUCCESS) {
+    Size   = (fsw_u32) File->size;
+    Status = fsw_shandle_read (&Shand, &Size, Buffer);
+    if (Status != FSW_SUCCESS) {
+      Size = 0;
+    }
+    fsw_shandle_close (&Shand);
+  }
+
+  free (Buffer);
+  return Size;
+}
+
+//
+// Visit every catalog entry under the directory and return their amount.
+// Optionally read the contents of every file.
+//
+STATIC
+UINT32
+TraverseDirectory (
+  IN     struct fsw_dnode  *Dir,
+  IN     UINT32            Depth,
+  IN OUT UINT64            *DataSize  OPTIONAL
+  )
+{
+  fsw_status_t        Status;
+  struct fsw_shandle  Shand;
+  struct fsw_dnode    *Child;
+  UINT32              Count;
+
+  Status = fsw_dnode_fill (Dir);
+  if (Status != FSW_SUCCESS) {
+    return 0;
+  }
+
+  Status = fsw_shandle_open (Dir, &Shand);
+  if (Status != FSW_SUCCESS) {
+    return 0;
+  }
+
+  Count = 0;
+  while (fsw_dnode_dir_read (&Shand, &Child) == FSW_SUCCESS) {
+    ++Count;
+    if (fsw_dnode_fill (Child) == FSW_SUCCESS) {
+      if (Child->type == FSW_DNODE_TYPE_DIR && Depth < TEST_MAX_DEPTH) {
+        Count += TraverseDirectory (Child, Depth + 1, DataSize);
+      } else if (Child->type == FSW_DNODE_TYPE_FILE && DataSize != NULL) {
+        *DataSize += ReadFileData (Child);
+      }
+    }
+    fsw_dnode_release (Child);
+  }
+
+  fsw_shandle_close (&Shand);
+  return Count;
+}
+
+int ENTRY_POINT (int argc, char *argv[]) {
+  TEST_HFS_IMAGE     Image;
+  struct fsw_volume  *Vol;
+  fsw_status_t       Status;
+  UINT32             Round;
+  UINT32             Entries;
+  UINT64             DataSize;
+  BOOLEAN            ReadData;
+  long long          Start;
+  long long          Best;
+
+  if (argc < 2) {
+    printf ("Please provide a valid HFS+ image path, add -d to read file data\n");
+    return -1;
+  }
+
+  ReadData = argc > 2 && strcmp (argv[2], "-d") == 0;
+
+  Image.Data = UserReadFile (argv[1], &Image.Size);
+  if (Image.Data == NULL) {
+    printf ("Read fail\n");
+    return -1;
+  }
+
+  Best = 0;
+
+  for (Round = 0; Round < TEST_ROUND_COUNT; ++Round) {
+    DataSize = 0;
+    Start = UserCurrentTimestamp ();
+
+    Status = fsw_mount (&Image, &mTestHostTable, &FSW_FSTYPE_TABLE_NAME (hfsplus), &Vol);
+    if (Status != FSW_SUCCESS) {
+      printf ("Mount fail - %d\n", Status);
+      free (Image.Data);
+      return -1;
+    }
+
+    Entries = TraverseDirectory (Vol->root, 0, ReadData ? &DataSize : NULL);
+    Start   = UserCurrentTimestamp () - Start;
+    if (Round == 0 || Start < Best) {
+      Best = Start;
+    }
+
+    printf (
+      "Catalog traversal: %u entries, %llu data bytes in %lld us, %llu hits, %llu misses, %llu reads, %llu bytes per read\n",
+      Entries,
+      (unsigned long long) DataSize,
+      Start,
+      (unsigned long long) Vol->bcache_hits,
+      (unsigned long long) Vol->bcache_misses,
+      (unsigned long long) Vol->read_count,
+      Vol->read_count > 0 ? (unsigned long long) (Vol->read_bytes / Vol->read_count) : 0ULL
+      );
+
+    fsw_unmount (Vol);
+  }
+
+  printf ("Best catalog traversal time: %lld us\n", Best);
+
+  free (Image.Data);
+  return 0;
+}
@@ -18,6 +18,7 @@
 #include <Library/OcMiscLib.h>
 #include <Library/OcAppleKernelLib.h>
 
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 
@@ -497,6 +498,405 @@ ApplyKernelPatches (
   }
 }
 
+//
+// Amount of patterns used for kernel patching benchmark.
+//
+#define BENCH_PATCH_COUNT  32
+
+STATIC
+VOID
+BenchmarkKernelPatches (
+  IN CONST UINT8   *Kernel,
+  IN       UINT32  Size
+  )
+{
+  UINT8          *Data;
+  OC_DATA_PATCH  Patches[BENCH_PATCH_COUNT];
+  UINT32         ReplaceCounts[BENCH_PATCH_COUNT];
+  UINT32         Index;
+  long long      Start;
+  long long      SeparateTime;
+  long long      SinglePassTime;
+
+  if (Size < BENCH_PATCH_COUNT * 16) {
+    return;
+  }
+
+  Data = malloc (Size);
+  if (Data == NULL) {
+    return;
+  }
+
+  memcpy (Data, Kernel, Size);
+
+  //
+  // Sample patterns across the whole kernel. Replace matches Find,
+  // so that both approaches run on identical data.
+  //
+  memset (Patches, 0, sizeof (Patches));
+  for (Index = 0; Index < BENCH_PATCH_COUNT; ++Index) {
+    Patches[Index].Pattern     = &Kernel[(Size / BENCH_PATCH_COUNT) * Index];
+    Patches[Index].Replace     = Patches[Index].Pattern;
+    Patches[Index].PatternSize = 8 + Index % 8;
+  }
+
+  Start = current_timestamp ();
+  for (Index = 0; Index < BENCH_PATCH_COUNT; ++Index) {
+    ReplaceCounts[Index] = ApplyPatch (
+      Patches[Index].Pattern,
+      Patches[Index].PatternMask,
+      Patches[Index].PatternSize,
+      Patches[Index].Replace,
+      Patches[Index].ReplaceMask,
+      Data,
+      Size,
+      Patches[Index].Count,
+      Patches[Index].Skip
+      );
+  }
+  SeparateTime = current_timestamp () - Start;
+
+  Start = current_timestamp ();
+  ApplyPatches (Patches, BENCH_PATCH_COUNT, Data, Size);
+  SinglePassTime = current_timestamp () - Start;
+
+  for (Index = 0; Index < BENCH_PATCH_COUNT; ++Index) {
+    if (ReplaceCounts[Index] != Patches[Index].ReplaceCount) {
+      DEBUG ((
+        DEBUG_WARN,
+        "[FAIL] Patch %u replace count mismatch %u vs %u\n",
+        Index,
+        ReplaceCounts[Index],
+        Patches[Index].ReplaceCount
+        ));
+      FailedToProcess = TRUE;
+    }
+  }
+
+  DEBUG ((
+    DEBUG_WARN,
+    "[OK] %u kernel patches took %Lu ms separately and %Lu ms in a single pass\n",
+    BENCH_PATCH_COUNT,
+    (UINT64) SeparateTime,
+    (UINT64) SinglePassTime
+    ));
+
+  free (Data);
+}
+
+//
+// Chained and overlapping patches, which must give the same result as
+// separate patching in order.
+//
+STATIC CONST CHAR8  mChainedData[] = "ABCDABCDxyzABCDxyz_OSI_OSI_OSI.XOSI";
+
+STATIC CONST OC_DATA_PATCH  mChainedPatches[] = {
+  { (CONST UINT8 *) "ABCD", NULL, (CONST UINT8 *) "XBCD", NULL, 4, 0, 0, 0, 0 },
+  { (CONST UINT8 *) "XBCD", NULL, (CONST UINT8 *) "YBCD", NULL, 4, 0, 1, 0, 0 },
+  { (CONST UINT8 *) "CDxy", NULL, (CONST UINT8 *) "CDXY", NULL, 4, 1, 0, 0, 0 },
+  { (CONST UINT8 *) "_OSI", NULL, (CONST UINT8 *) "XOSI", NULL, 4, 2, 0, 0, 0 },
+  { (CONST UINT8 *) "XOSI", NULL, (CONST UINT8 *) "YOSI", NULL, 4, 0, 0, 0, 0 },
+  { (CONST UINT8 *) "XOSI", (CONST UINT8 *) "\xDE\xFF\xFF\xFF", (CONST UINT8 *) "\x20OSI", (CONST UINT8 *) "\x20\x00\x00\x00", 4, 0, 0, 0, 0 },
+  { (CONST UINT8 *) "zAB", NULL, (CONST UINT8 *) "zab", NULL, 3, 0, 0, 0, 0 }
+};
+
+STATIC
+VOID
+TestChainedPatches (
+  IN CONST UINT8   *Kernel,
+  IN       UINT32  Size
+  )
+{
+  UINT8                  Expected[sizeof (mChainedData)];
+  UINT8                  Data[sizeof (mChainedData)];
+  OC_DATA_PATCH          Patches[ARRAY_SIZE (mChainedPatches)];
+  UINT32                 ReplaceCounts[ARRAY_SIZE (mChainedPatches)];
+  UINT8                  *KernelExpected;
+  UINT8                  *KernelData;
+  UINT8                  Find[16];
+  UINT8                  Replace[16];
+  UINT8                  Final[16];
+  PATCHER_GENERIC_PATCH  KernelPatches[2];
+  EFI_STATUS             Results[ARRAY_SIZE (KernelPatches)];
+  PATCHER_CONTEXT        Patcher;
+  UINT32                 Index;
+  EFI_STATUS             Status;
+
+  CopyMem (Expected, mChainedData, sizeof (mChainedData));
+  CopyMem (Data, mChainedData, sizeof (mChainedData));
+  CopyMem (Patches, mChainedPatches, sizeof (mChainedPatches));
+
+  for (Index = 0; Index < ARRAY_SIZE (mChainedPatches); ++Index) {
+    ReplaceCounts[Index] = ApplyPatch (
+      Patches[Index].Pattern,
+      Patches[Index].PatternMask,
+      Patches[Index].PatternSize,
+      Patches[Index].Replace,
+      Patches[Index].ReplaceMask,
+      Expected,
+      sizeof (Expected),
+      Patches[Index].Count,
+      Patches[Index].Skip
+      );
+  }
+
+  ApplyPatches (Patches, ARRAY_SIZE (Patches), Data, sizeof (Data));
+
+  for (Index = 0; Index < ARRAY_SIZE (mChainedPatches); ++Index) {
+    if (ReplaceCounts[Index] != Patches[Index].ReplaceCount) {
+      DEBUG ((
+        DEBUG_WARN,
+        "[FAIL] Chained patch %u replace count mismatch %u vs %u\n",
+        Index,
+        ReplaceCounts[Index],
+        Patches[Index].ReplaceCount
+        ));
+      FailedToProcess = TRUE;
+    }
+  }
+
+  if (CompareMem (Data, Expected, sizeof (Data)) != 0) {
+    DEBUG ((DEBUG_WARN, "[FAIL] Chained patches give %a instead of %a\n", Data, Expected));
+    FailedToProcess = TRUE;
+  } else {
+    DEBUG ((DEBUG_WARN, "[OK] Chained patches give %a\n", Data));
+  }
+
+  //
+  // Chain A->B->C on kernel bytes through the generic patcher.
+  //
+  if (Size < sizeof (Find) * 2) {
+    return;
+  }
+
+  KernelExpected = malloc (Size);
+  KernelData     = malloc (Size);
+  if (KernelExpected == NULL || KernelData == NULL) {
+    free (KernelExpected);
+    free (KernelData);
+    return;
+  }
+
+  CopyMem (KernelExpected, Kernel, Size);
+  CopyMem (KernelData, Kernel, Size);
+
+  CopyMem (Find, &Kernel[Size / 2], sizeof (Find));
+  CopyMem (Replace, Find, sizeof (Replace));
+  Replace[sizeof (Replace) - 1] ^= 0xFF;
+  CopyMem (Final, Replace, sizeof (Final));
+  Final[0] ^= 0xFF;
+
+  ZeroMem (KernelPatches, sizeof (KernelPatches));
+  KernelPatches[0].Comment = "Chain A->B";
+  KernelPatches[0].Find    = Find;
+  KernelPatches[0].Replace = Replace;
+  KernelPatches[0].Size    = sizeof (Find);
+  KernelPatches[1].Comment = "Chain B->C";
+  KernelPatches[1].Find    = Replace;
+  KernelPatches[1].Replace = Final;
+  KernelPatches[1].Size    = sizeof (Replace);
+
+  Status = PatcherInitContextFromBuffer (&Patcher, KernelExpected, Size, FALSE);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 0; Index < ARRAY_SIZE (KernelPatches); ++Index) {
+      PatcherApplyGenericPatch (&Patcher, &KernelPatches[Index]);
+    }
+
+    Status = PatcherInitContextFromBuffer (&Patcher, KernelData, Size, FALSE);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = PatcherApplyGenericPatches (&Patcher, KernelPatches, ARRAY_SIZE (KernelPatches), Results);
+  }
+
+  if (EFI_ERROR (Status) || CompareMem (KernelData, KernelExpected, Size) != 0) {
+    DEBUG ((DEBUG_WARN, "[FAIL] Chained kernel patches mismatch - %r\n", Status));
+    FailedToProcess = TRUE;
+  } else {
+    DEBUG ((DEBUG_WARN, "[OK] Chained kernel patches match separate patching\n"));
+  }
+
+  free (KernelExpected);
+  free (KernelData);
+}
+
+STATIC
+BOOLEAN
+CheckPatchCacheRuns (
+  IN CONST UINT8   *Original,
+  IN       UINT32  OriginalSize,
+  IN CONST UINT8   *Patched,
+  IN       UINT32  PatchedSize
+  )
+{
+  UINT8    *Data;
+  UINT8    *Kernel;
+  UINT32   DataSize;
+  UINT32   RunCount;
+  UINT32   FilledRunCount;
+  BOOLEAN  Success;
+
+  DataSize = KernelPatchCacheDiff (Original, OriginalSize, Patched, PatchedSize, NULL, &RunCount);
+  Data     = malloc (DataSize + 1);
+  Kernel   = malloc (MAX (OriginalSize, PatchedSize) + 1);
+  if (Data == NULL || Kernel == NULL) {
+    free (Data);
+    free (Kernel);
+    return FALSE;
+  }
+
+  Success = KernelPatchCacheDiff (Original, OriginalSize, Patched, PatchedSize, Data, &FilledRunCount) == DataSize
+    && FilledRunCount == RunCount;
+
+  CopyMem (Kernel, Original, OriginalSize);
+  Success = Success
+    && KernelPatchCacheApplyRuns (Kernel, PatchedSize, Data, DataSize, RunCount)
+    && CompareMem (Kernel, Patched, PatchedSize) == 0;
+
+  //
+  // Truncated or mismatching run data must be rejected without touching the kernel.
+  //
+  if (Success && RunCount > 0) {
+    CopyMem (Kernel, Original, OriginalSize);
+    Success = !KernelPatchCacheApplyRuns (Kernel, PatchedSize, Data, DataSize - 1, RunCount)
+      && !KernelPatchCacheApplyRuns (Kernel, PatchedSize, Data, DataSize, RunCount - 1)
+      && !KernelPatchCacheApplyRuns (Kernel, PatchedSize, Data, DataSize, RunCount + 1)
+      && CompareMem (Kernel, Original, MIN (OriginalSize, PatchedSize)) == 0;
+  }
+
+  free (Data);
+  free (Kernel);
+  return Success;
+}
+
+STATIC
+VOID
+TestPatchCacheRuns (
+  VOID
+  )
+{
+  UINT8   Original[64];
+  UINT8   Patched[96];
+  UINT32  Index;
+
+  STATIC CONST struct {
+    UINT32  OriginalSize;
+    UINT32  PatchedSize;
+    UINT32  Changes[4];
+  } Cases[] = {
+    { 64, 64, { 0 } },
+    { 64, 64, { 1 } },
+    { 64, 64, { 64 } },
+    { 64, 64, { 1, 8 } },
+    { 64, 64, { 1, 9, 40 } },
+    { 64, 64, { 1, 2, 3, 4 } },
+    { 64, 96, { 0 } },
+    { 64, 96, { 10, 63 } },
+    { 64, 40, { 0 } },
+    { 64, 40, { 40 } },
+    { 0,  32, { 0 } },
+    { 64, 0,  { 0 } }
+  };
+
+  for (Index = 0; Index < ARRAY_SIZE (Original); ++Index) {
+    Original[Index] = (UINT8) (Index * 7);
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (Cases); ++Index) {
+    UINT32  Change;
+
+    CopyMem (Patched, Original, sizeof (Original));
+    SetMem (Patched + sizeof (Original), sizeof (Patched) - sizeof (Original), 0xA5);
+    //
+    // Changes are 1-based offsets, zero terminates the list.
+    //
+    for (Change = 0; Change < ARRAY_SIZE (Cases[Index].Changes) && Cases[Index].Changes[Change] != 0; ++Change) {
+      Patched[Cases[Index].Changes[Change] - 1] ^= 0xFF;
+    }
+
+    if (CheckPatchCacheRuns (Original, Cases[Index].OriginalSize, Patched, Cases[Index].PatchedSize)) {
+      DEBUG ((DEBUG_WARN, "[OK] Patch cache runs %u\n", Index));
+    } else {
+      DEBUG ((DEBUG_WARN, "[FAIL] Patch cache runs %u\n", Index));
+      FailedToProcess = TRUE;
+    }
+  }
+}
+
+STATIC
+VOID
+BenchmarkPlistParse (
+  IN CONST XML_DOCUMENT  *Document
+  )
+{
+  STATIC CONST UINT32  Modes[] = {
+    0,
+    XML_PARSE_ARENA,
+    XML_PARSE_ARENA | XML_PARSE_COUNT_CHILDREN
+  };
+
+  CHAR8            *Exported;
+  UINT32           ExportedSize;
+  CHAR8            *Buffer;
+  XML_DOCUMENT     *Parsed;
+  XML_PARSE_STATS  Stats;
+  UINT32           Index;
+  long long        Start;
+  long long        ParseTime;
+
+  Start    = current_timestamp ();
+  Exported = XmlDocumentExport (Document, &ExportedSize, 0, FALSE);
+  if (Exported == NULL) {
+    return;
+  }
+
+  DEBUG ((
+    DEBUG_WARN,
+    "[OK] Prelinked plist exported in %Lu ms - %u bytes\n",
+    (UINT64) (current_timestamp () - Start),
+    ExportedSize
+    ));
+
+  Buffer = malloc (ExportedSize);
+  if (Buffer == NULL) {
+    FreePool (Exported);
+    return;
+  }
+
+  for (Index = 0; Index < sizeof (Modes) / sizeof (Modes[0]); ++Index) {
+    //
+    // Parsing modifies the buffer.
+    //
+    memcpy (Buffer, Exported, ExportedSize);
+
+    Start     = current_timestamp ();
+    Parsed    = XmlDocumentParseEx (Buffer, ExportedSize, TRUE, Modes[Index], &Stats);
+    ParseTime = current_timestamp () - Start;
+
+    if (Parsed == NULL) {
+      DEBUG ((DEBUG_WARN, "[FAIL] Prelinked plist parse failure in mode %u\n", Modes[Index]));
+      FailedToProcess = TRUE;
+      continue;
+    }
+
+    DEBUG ((
+      DEBUG_WARN,
+      "[OK] Prelinked plist mode %u parsed in %Lu ms - %u nodes, %u lists, %u allocations, %u bytes\n",
+      Modes[Index],
+      (UINT64) ParseTime,
+      Stats.NodeCount,
+      Stats.ListCount,
+      Stats.AllocationCount,
+      Stats.BytesUsed
+      ));
+
+    XmlDocumentFree (Parsed);
+  }
+
+  free (Buffer);
+  FreePool (Exported);
+}
+
 static EFI_FILE_PROTOCOL nilFilProtocol;
 
 UINT8  *Prelinked;
@@ -639,6 +1039,19 @@ int wrap_main(int argc, char** argv) {
   }
 
 
+  BenchmarkKernelPatches (Prelinked, PrelinkedSize);
+
+  TestChainedPatches (Prelinked, PrelinkedSize);
+
+  TestPatchCacheRuns ();
+
+  UINT8 *OriginalPrelinked = AllocateCopyPool (PrelinkedSize, Prelinked);
+  UINT32 OriginalPrelinkedSize = PrelinkedSize;
+  if (OriginalPrelinked == NULL) {
+    FailedToProcess = TRUE;
+    return -1;
+  }
+
   ApplyKernelPatches (Prelinked, PrelinkedSize);
 
   PATCHER_CONTEXT        Patcher;
@@ -658,6 +1071,13 @@ int wrap_main(int argc, char** argv) {
   Status = PrelinkedContextInit (&Context, Prelinked, PrelinkedSize, AllocSize, FALSE);
 
   if (!EFI_ERROR (Status)) {
+    //
+    // Allow comparing link time against linear symbol lookup.
+    //
+    Context.DisableSymbolIndex = getenv ("KEXTINJECT_NO_SYMBOL_INDEX") != NULL;
+
+    BenchmarkPlistParse (Context.PrelinkedInfoDocument);
+
     Status = PrelinkedInjectPrepare (&Context, LinkedExpansion, ReservedExeSize);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_WARN, "[FAIL] Prelink inject prepare error %r\n", Status));
@@ -717,6 +1137,10 @@ int wrap_main(int argc, char** argv) {
       char KextPath[64];
       snprintf(KextPath, sizeof(KextPath), "/Library/Extensions/Kex%d.kext", c);
 
+      long long InjectStart = current_timestamp ();
+      UINT64 NameLookups    = Context.SymbolNameLookups;
+      UINT64 ValueLookups   = Context.SymbolValueLookups;
+
       Status = PrelinkedInjectKext (
         &Context,
         NULL,
@@ -728,6 +1152,16 @@ int wrap_main(int argc, char** argv) {
         TestDataSize
         );
 
+      DEBUG ((
+        DEBUG_WARN,
+        "[INFO] %a linked in %Lu ms with %Lu name and %Lu value lookups (%a)\n",
+        argv[2],
+        (UINT64) (current_timestamp () - InjectStart),
+        Context.SymbolNameLookups - NameLookups,
+        Context.SymbolValueLookups - ValueLookups,
+        Context.DisableSymbolIndex ? "linear" : "indexed"
+        ));
+
       if (!EFI_ERROR (Status)) {
         DEBUG ((DEBUG_WARN, "[OK] %a injected - %r\n", argv[2], Status));
       } else {
@@ -751,6 +1185,13 @@ int wrap_main(int argc, char** argv) {
 
     UserWriteFile("out.bin", Prelinked, Context.PrelinkedSize);
 
+    if (CheckPatchCacheRuns (OriginalPrelinked, OriginalPrelinkedSize, Prelinked, Context.PrelinkedSize)) {
+      DEBUG ((DEBUG_WARN, "[OK] Patch cache runs reproduce patched kernel\n"));
+    } else {
+      DEBUG ((DEBUG_WARN, "[FAIL] Patch cache runs do not reproduce patched kernel\n"));
+      FailedToProcess = TRUE;
+    }
+
     if (!EFI_ERROR (Status)) {
       DEBUG ((DEBUG_WARN, "[OK] Prelink inject complete success\n"));
     } else {
@@ -764,6 +1205,7 @@ int wrap_main(int argc, char** argv) {
     FailedToProcess = TRUE;
   }
 
+  FreePool (OriginalPrelinked);
   free(Prelinked);
 
   return 0;
@@ -21,6 +21,7 @@
 #include <sys/time.h>
 
 #include <UserFile.h>
+#include <UserTime.h>
 
 MACH_HEADER_64 Header;
 MACH_SECTION_64 Sect;
@@ -268,12 +269,82 @@ static int FeedMacho(void *file, uint32_t size) {
     }
   }
 
+  MachoFreeContext (&Context);
+
   return code != 963;
 }
 
+extern UINT8  LiluKextData[];
+extern UINT32 LiluKextDataSize;
+extern UINT8  VsmcKextData[];
+extern UINT32 VsmcKextDataSize;
+
+static int BenchRelocations(const char *name, void *file, uint32_t size) {
+  OC_MACHO_CONTEXT Context;
+  if (!MachoInitializeContext64 (&Context, file, size, 0)) {
+    printf("%s: Mach-O init fail\n", name);
+    return -1;
+  }
+
+  //
+  // Resolve every pointer sized slot, as vtable processing does for its entries.
+  //
+  uint32_t count = size / sizeof (UINT64);
+  MACH_NLIST_64 **linear = calloc(count, sizeof (*linear));
+  MACH_NLIST_64 **indexed = calloc(count, sizeof (*indexed));
+  if (linear == NULL || indexed == NULL) {
+    free(linear);
+    free(indexed);
+    return -1;
+  }
+
+  uint32_t found = 0;
+  MACH_NLIST_64 *Symbol;
+
+  //
+  // Relocation tables are only visible once symtabs are retrieved.
+  //
+  MachoGetSymbolByIndex64 (&Context, 0);
+
+  Context.NoRelocationIndex = TRUE;
+  long long start = UserCurrentTimestamp();
+  for (uint32_t i = 0; i < count; ++i) {
+    Symbol = NULL;
+    if (MachoGetSymbolByRelocationOffset64 (&Context, i * sizeof (UINT64), &Symbol)) {
+      linear[i] = Symbol != NULL ? Symbol : (MACH_NLIST_64 *) &Context;
+      found++;
+    }
+  }
+  long long linear_time = UserCurrentTimestamp() - start;
+
+  MachoFreeContext (&Context);
+  start = UserCurrentTimestamp();
+  for (uint32_t i = 0; i < count; ++i) {
+    Symbol = NULL;
+    if (MachoGetSymbolByRelocationOffset64 (&Context, i * sizeof (UINT64), &Symbol)) {
+      indexed[i] = Symbol != NULL ? Symbol : (MACH_NLIST_64 *) &Context;
+    }
+  }
+  long long indexed_time = UserCurrentTimestamp() - start;
+
+  int code = memcmp(linear, indexed, count * sizeof (*linear)) != 0;
+  printf("%s: %u slots, %u relocated, linear %lld us, indexed %lld us%s\n",
+    name, count, found, linear_time, indexed_time, code != 0 ? ", MISMATCH" : "");
+
+  MachoFreeContext (&Context);
+  free(linear);
+  free(indexed);
+  return code;
+}
+
 int ENTRY_POINT(int argc, char** argv) {
   uint32_t f;
   uint8_t *b;
+  if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+    return BenchRelocations("Lilu", LiluKextData, LiluKextDataSize)
+      | BenchRelocations("VirtualSMC", VsmcKextData, VsmcKextDataSize);
+  }
+
   if ((b = UserReadFile(argc > 1 ? argv[1] : "kernel", &f)) == NULL) {
     printf("Read fail\n");
     return -1;
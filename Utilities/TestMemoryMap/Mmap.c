@@ -0,0 +1,531 @@
+/** @file
+  Copyright (c) 2026, agent. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Uefi.h>
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcMemoryLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <UserFile.h>
+#include <UserTime.h>
+
+//
+// Descriptor size used by most firmwares, larger than EFI_MEMORY_DESCRIPTOR.
+//
+#define TEST_DESCRIPTOR_SIZE  48
+
+//
+// Amount of descriptors in generated memory maps, server boards have 300+.
+//
+#define TEST_ENTRY_COUNT      512
+
+//
+// Amount of generated memory maps and rounds for time measurement.
+//
+#define TEST_MAP_COUNT        64
+#define TEST_ROUND_COUNT      256
+
+typedef struct {
+  UINT32  Type;
+  UINT64  PhysicalStart;
+  UINT64  NumberOfPages;
+  UINT64  Attribute;
+} TEST_MEMORY_ENTRY;
+
+//
+// Sample desktop board memory map in the order firmware returns it.
+//
+STATIC CONST TEST_MEMORY_ENTRY mSampleMap[] = {
+  { EfiBootServicesCode,     0x0,        0x1,     0xF },
+  { EfiConventionalMemory,   0x1000,     0x9F,    0xF },
+  { EfiConventionalMemory,   0x100000,   0x700,   0xF },
+  { EfiACPIMemoryNVS,        0x800000,   0x8,     0xF },
+  { EfiConventionalMemory,   0x808000,   0x3,     0xF },
+  { EfiACPIMemoryNVS,        0x80B000,   0x1,     0xF },
+  { EfiConventionalMemory,   0x80C000,   0x4,     0xF },
+  { EfiACPIMemoryNVS,        0x810000,   0xF0,    0xF },
+  { EfiBootServicesData,     0x900000,   0x18000, 0xF },
+  { EfiConventionalMemory,   0x18900000, 0x2000,  0xF },
+  { EfiLoaderCode,           0x1A900000, 0x120,   0xF },
+  { EfiLoaderData,           0x1AA20000, 0x80,    0xF },
+  { EfiBootServicesData,     0x1AAA0000, 0x2400,  0xF },
+  { EfiBootServicesCode,     0x1CEA0000, 0x300,   0xF },
+  { EfiRuntimeServicesData,  0x1D400000, 0x40,    0x800000000000000F },
+  { EfiRuntimeServicesData,  0x1D440000, 0x20,    0x800000000000000F },
+  { EfiRuntimeServicesCode,  0x1D460000, 0x60,    0x800000000000000F },
+  { EfiRuntimeServicesCode,  0x1D4C0000, 0x30,    0x800000000000000F },
+  { EfiBootServicesCode,     0x1D1A0000, 0x260,   0xF },
+  { EfiReservedMemoryType,   0x1D4F0000, 0x110,   0xF },
+  { EfiACPIReclaimMemory,    0x1D600000, 0x20,    0xF },
+  { EfiACPIMemoryNVS,        0x1D620000, 0x400,   0xF },
+  { EfiReservedMemoryType,   0x1DA20000, 0x1E0,   0xF },
+  { EfiBootServicesData,     0x1DC00000, 0x100,   0xF },
+  { EfiConventionalMemory,   0x1DD00000, 0x1300,  0xF },
+  { EfiReservedMemoryType,   0x1F000000, 0x1000,  0x0 },
+  { EfiMemoryMappedIO,       0xE0000000, 0x10000, 0x8000000000000001 },
+  { EfiMemoryMappedIO,       0xFE000000, 0x11,    0x8000000000000001 },
+  { EfiMemoryMappedIO,       0xFEC00000, 0x1,     0x8000000000000001 },
+  { EfiMemoryMappedIO,       0xFED00000, 0x1,     0x8000000000000001 },
+  { EfiMemoryMappedIO,       0xFEE00000, 0x1,     0x8000000000000001 },
+  { EfiMemoryMappedIO,       0xFF000000, 0x1000,  0x8000000000000001 },
+  { EfiConventionalMemory,   0x100000000, 0x3E0000, 0xF },
+  { EfiRuntimeServicesData,  0x1D440000, 0x20,    0x800000000000000F },
+  { EfiReservedMemoryType,   0x4E0000000, 0x20000, 0x0 },
+};
+
+/**
+  Reference exchange sort moving whole descriptors.
+**/
+STATIC
+VOID
+ReferenceSortMemoryMap (
+  IN     UINTN                  MemoryMapSize,
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN     UINTN                  DescriptorSize
+  )
+{
+  EFI_MEMORY_DESCRIPTOR  *MemoryMapEntry;
+  EFI_MEMORY_DESCRIPTOR  *NextMemoryMapEntry;
+  EFI_MEMORY_DESCRIPTOR  *MemoryMapEnd;
+  UINT8                  TempMemoryMap[256];
+
+  ASSERT (DescriptorSize <= sizeof (TempMemoryMap));
+
+  MemoryMapEntry = MemoryMap;
+  MemoryMapEnd   = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + MemoryMapSize);
+  while (MemoryMapEntry < MemoryMapEnd) {
+    NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
+    while (NextMemoryMapEntry < MemoryMapEnd) {
+      if (MemoryMapEntry->PhysicalStart > NextMemoryMapEntry->PhysicalStart) {
+        CopyMem (TempMemoryMap, MemoryMapEntry, DescriptorSize);
+        CopyMem (MemoryMapEntry, NextMemoryMapEntry, DescriptorSize);
+        CopyMem (NextMemoryMapEntry, TempMemoryMap, DescriptorSize);
+      }
+
+      NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (NextMemoryMapEntry, DescriptorSize);
+    }
+
+    MemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
+  }
+}
+
+STATIC
+BOOLEAN
+ReferenceIsFree (
+  IN UINT32  Type
+  )
+{
+  return Type == EfiBootServicesCode
+    || Type == EfiBootServicesData
+    || Type == EfiConventionalMemory
+    || Type == EfiLoaderCode
+    || Type == EfiLoaderData;
+}
+
+/**
+  Reference descriptor removal by moving the rest of the memory map.
+**/
+STATIC
+VOID
+ReferenceCompactMemoryMap (
+  IN OUT UINTN                  *MemoryMapSize,
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN     UINTN                  DescriptorSize,
+  IN     BOOLEAN                Join,
+  IN     BOOLEAN                Deduplicate
+  )
+{
+  UINTN                  EntryCount;
+  UINTN                  Index;
+  EFI_MEMORY_DESCRIPTOR  *PrevDesc;
+  EFI_MEMORY_DESCRIPTOR  *Desc;
+  BOOLEAN                Remove;
+
+  EntryCount = *MemoryMapSize / DescriptorSize;
+  Index      = 1;
+
+  while (Index < EntryCount) {
+    PrevDesc = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + (Index - 1) * DescriptorSize);
+    Desc     = NEXT_MEMORY_DESCRIPTOR (PrevDesc, DescriptorSize);
+    Remove   = FALSE;
+
+    if (Deduplicate
+      && Desc->PhysicalStart == PrevDesc->PhysicalStart
+      && Desc->NumberOfPages == PrevDesc->NumberOfPages) {
+      Remove = TRUE;
+    } else if (Join
+      && Desc->Attribute == PrevDesc->Attribute
+      && PrevDesc->PhysicalStart + EFI_PAGES_TO_SIZE (PrevDesc->NumberOfPages) == Desc->PhysicalStart) {
+      if (ReferenceIsFree (Desc->Type) && ReferenceIsFree (PrevDesc->Type)) {
+        PrevDesc->Type           = EfiConventionalMemory;
+        PrevDesc->NumberOfPages += Desc->NumberOfPages;
+        Remove                   = TRUE;
+      } else if ((Desc->Type == EfiRuntimeServicesCode || Desc->Type == EfiRuntimeServicesData)
+        && Desc->Type == PrevDesc->Type) {
+        PrevDesc->NumberOfPages += Desc->NumberOfPages;
+        Remove                   = TRUE;
+      }
+    }
+
+    if (Remove) {
+      CopyMem (Desc, NEXT_MEMORY_DESCRIPTOR (Desc, DescriptorSize), (EntryCount - Index - 1) * DescriptorSize);
+      --EntryCount;
+    } else {
+      ++Index;
+    }
+  }
+
+  *MemoryMapSize = EntryCount * DescriptorSize;
+}
+
+/**
+  Fill memory map descriptor, vendor area is filled with a pattern
+  derived from its range to check that whole descriptors are moved.
+**/
+STATIC
+VOID
+FillDescriptor (
+  OUT EFI_MEMORY_DESCRIPTOR  *Desc,
+  IN  UINTN                  DescriptorSize,
+  IN  UINT32                 Type,
+  IN  UINT64                 PhysicalStart,
+  IN  UINT64                 NumberOfPages,
+  IN  UINT64                 Attribute
+  )
+{
+  UINTN  Index;
+
+  ZeroMem (Desc, DescriptorSize);
+  Desc->Type          = Type;
+  Desc->PhysicalStart = PhysicalStart;
+  Desc->NumberOfPages = NumberOfPages;
+  Desc->Attribute     = Attribute;
+
+  for (Index = sizeof (*Desc); Index < DescriptorSize; ++Index) {
+    ((UINT8 *) Desc)[Index] = (UINT8) (PhysicalStart >> 12) + (UINT8) Index;
+  }
+}
+
+/**
+  Generate shuffled memory map of contiguous descriptors with duplicates.
+  Memory map must have space for one more descriptor used for shuffling.
+**/
+STATIC
+VOID
+GenerateMemoryMap (
+  OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN  UINTN                  EntryCount,
+  IN  UINTN                  DescriptorSize
+  )
+{
+  STATIC CONST UINT32  Types[] = {
+    EfiBootServicesCode,
+    EfiBootServicesData,
+    EfiConventionalMemory,
+    EfiLoaderData,
+    EfiRuntimeServicesCode,
+    EfiRuntimeServicesData,
+    EfiReservedMemoryType,
+    EfiACPIMemoryNVS,
+    EfiMemoryMappedIO
+  };
+
+  UINTN   Index;
+  UINTN   Other;
+  UINT64  Address;
+  UINT64  Pages;
+  UINT8   *Walker;
+
+  Address = 0;
+  Walker  = (UINT8 *) MemoryMap;
+
+  for (Index = 0; Index < EntryCount; ++Index) {
+    if (Index > 0 && rand () % 16 == 0) {
+      //
+      // Exact copy of some previous descriptor.
+      //
+      CopyMem (Walker, (UINT8 *) MemoryMap + (rand () % Index) * DescriptorSize, DescriptorSize);
+    } else {
+      Pages = 1 + rand () % 64;
+      if (rand () % 8 == 0) {
+        Address += EFI_PAGES_TO_SIZE (1 + rand () % 16);
+      }
+
+      FillDescriptor (
+        (EFI_MEMORY_DESCRIPTOR *) Walker,
+        DescriptorSize,
+        Types[rand () % ARRAY_SIZE (Types)],
+        Address,
+        Pages,
+        rand () % 4 == 0 ? EFI_MEMORY_RUNTIME | EFI_MEMORY_WB : EFI_MEMORY_WB
+        );
+      Address += EFI_PAGES_TO_SIZE (Pages);
+    }
+
+    Walker += DescriptorSize;
+  }
+
+  for (Index = EntryCount - 1; Index > 0; --Index) {
+    Other = rand () % (Index + 1);
+    if (Other != Index) {
+      CopyMem (Walker, (UINT8 *) MemoryMap + Index * DescriptorSize, DescriptorSize);
+      CopyMem ((UINT8 *) MemoryMap + Index * DescriptorSize, (UINT8 *) MemoryMap + Other * DescriptorSize, DescriptorSize);
+      CopyMem ((UINT8 *) MemoryMap + Other * DescriptorSize, Walker, DescriptorSize);
+    }
+  }
+}
+
+/**
+  Check normalisation results against the reference implementation.
+
+  @retval TRUE on match.
+**/
+STATIC
+BOOLEAN
+TestMemoryMap (
+  IN CONST EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN UINTN                        MemoryMapSize,
+  IN UINTN                        DescriptorSize,
+  IN CONST CHAR8                  *Name
+  )
+{
+  EFI_MEMORY_DESCRIPTOR  *Expected;
+  EFI_MEMORY_DESCRIPTOR  *Actual;
+  UINTN                  ExpectedSize;
+  UINTN                  ActualSize;
+  UINT32                 EntryCount;
+  UINTN                  Step;
+  BOOLEAN                Result;
+
+  Expected = AllocatePool (MemoryMapSize);
+  Actual   = AllocatePool (MemoryMapSize);
+  if (Expected == NULL || Actual == NULL) {
+    abort ();
+  }
+
+  Result = TRUE;
+
+  for (Step = 0; Step < 6 && Result; ++Step) {
+    CopyMem (Expected, MemoryMap, MemoryMapSize);
+    CopyMem (Actual, MemoryMap, MemoryMapSize);
+    ExpectedSize = MemoryMapSize;
+    ActualSize   = MemoryMapSize;
+
+    if (Step < 4) {
+      ReferenceSortMemoryMap (ExpectedSize, Expected, DescriptorSize);
+    }
+
+    switch (Step) {
+      case 0:
+        OcSortMemoryMap (ActualSize, Actual, DescriptorSize);
+        break;
+      case 1:
+        ReferenceCompactMemoryMap (&ExpectedSize, Expected, DescriptorSize, TRUE, FALSE);
+        OcSortMemoryMap (ActualSize, Actual, DescriptorSize);
+        OcShrinkMemoryMap (&ActualSize, Actual, DescriptorSize);
+        break;
+      case 2:
+        ReferenceCompactMemoryMap (&ExpectedSize, Expected, DescriptorSize, FALSE, TRUE);
+        OcSortMemoryMap (ActualSize, Actual, DescriptorSize);
+        EntryCount = (UINT32) (ActualSize / DescriptorSize);
+        OcDeduplicateDescriptors (&EntryCount, Actual, DescriptorSize);
+        ActualSize = EntryCount * DescriptorSize;
+        break;
+      case 3:
+        ReferenceCompactMemoryMap (&ExpectedSize, Expected, DescriptorSize, FALSE, TRUE);
+        ReferenceCompactMemoryMap (&ExpectedSize, Expected, DescriptorSize, TRUE, FALSE);
+        OcNormalizeMemoryMap (ActualSize, &ActualSize, Actual, DescriptorSize, FALSE, TRUE);
+        break;
+      case 4:
+        //
+        // Normalisation must match the public functions called in sequence.
+        //
+        OcSortMemoryMap (ExpectedSize, Expected, DescriptorSize);
+        OcSplitMemoryMapByAttributes (ExpectedSize, &ExpectedSize, Expected, DescriptorSize);
+        EntryCount = (UINT32) (ExpectedSize / DescriptorSize);
+        OcDeduplicateDescriptors (&EntryCount, Expected, DescriptorSize);
+        ExpectedSize = EntryCount * DescriptorSize;
+        OcShrinkMemoryMap (&ExpectedSize, Expected, DescriptorSize);
+        OcNormalizeMemoryMap (ActualSize, &ActualSize, Actual, DescriptorSize, TRUE, TRUE);
+        break;
+      default:
+        //
+        // RebuildAppleMemoryMap keeps duplicate descriptors.
+        //
+        OcSortMemoryMap (ExpectedSize, Expected, DescriptorSize);
+        OcSplitMemoryMapByAttributes (ExpectedSize, &ExpectedSize, Expected, DescriptorSize);
+        OcShrinkMemoryMap (&ExpectedSize, Expected, DescriptorSize);
+        OcNormalizeMemoryMap (ActualSize, &ActualSize, Actual, DescriptorSize, TRUE, FALSE);
+        break;
+    }
+
+    if (ExpectedSize != ActualSize || CompareMem (Expected, Actual, ActualSize) != 0) {
+      printf ("%s: step %u mismatch, %u vs %u entries\n", Name, (UINT32) Step,
+        (UINT32) (ExpectedSize / DescriptorSize), (UINT32) (ActualSize / DescriptorSize));
+      Result = FALSE;
+    }
+  }
+
+  FreePool (Expected);
+  FreePool (Actual);
+  return Result;
+}
+
+/**
+  Compare normalisation time with the reference implementation.
+**/
+STATIC
+VOID
+BenchMemoryMap (
+  IN CONST EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN UINTN                        MemoryMapSize,
+  IN UINTN                        DescriptorSize
+  )
+{
+  EFI_MEMORY_DESCRIPTOR  *Work;
+  UINTN                  WorkSize;
+  UINTN                  Round;
+  long long              Start;
+  long long              ReferenceTime;
+  long long              NormalizeTime;
+
+  Work = AllocatePool (MemoryMapSize);
+  if (Work == NULL) {
+    abort ();
+  }
+
+  Start = UserCurrentTimestamp ();
+  for (Round = 0; Round < TEST_ROUND_COUNT; ++Round) {
+    CopyMem (Work, MemoryMap, MemoryMapSize);
+    WorkSize = MemoryMapSize;
+    ReferenceSortMemoryMap (WorkSize, Work, DescriptorSize);
+    ReferenceCompactMemoryMap (&WorkSize, Work, DescriptorSize, FALSE, TRUE);
+    ReferenceCompactMemoryMap (&WorkSize, Work, DescriptorSize, TRUE, FALSE);
+  }
+  ReferenceTime = UserCurrentTimestamp () - Start;
+
+  Start = UserCurrentTimestamp ();
+  for (Round = 0; Round < TEST_ROUND_COUNT; ++Round) {
+    CopyMem (Work, MemoryMap, MemoryMapSize);
+    WorkSize = MemoryMapSize;
+    OcNormalizeMemoryMap (WorkSize, &WorkSize, Work, DescriptorSize, FALSE, TRUE);
+  }
+  NormalizeTime = UserCurrentTimestamp () - Start;
+
+  printf (
+    "Normalised %u entries: reference %lld us, pipeline %lld us per map\n",
+    (UINT32) (MemoryMapSize / DescriptorSize),
+    ReferenceTime / TEST_ROUND_COUNT,
+    NormalizeTime / TEST_ROUND_COUNT
+    );
+
+  FreePool (Work);
+}
+
+/**
+  Tests memory map normalisation.
+  Usage:
+  ./Mmap [-s DescriptorSize] [memory map dumps...]
+
+  Memory map dumps contain raw descriptor arrays as returned by GetMemoryMap.
+  Without them a sample and generated memory maps are used.
+**/
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  EFI_MEMORY_DESCRIPTOR  *MemoryMap;
+  UINT8                  *Data;
+  UINT32                 DataSize;
+  UINTN                  DescriptorSize;
+  UINTN                  Index;
+  int                    ArgIndex;
+  int                    Code;
+  CHAR8                  Name[32];
+
+  DescriptorSize = TEST_DESCRIPTOR_SIZE;
+  ArgIndex       = 1;
+  Code           = 0;
+
+  if (argc > 2 && strcmp (argv[1], "-s") == 0) {
+    DescriptorSize = (UINTN) strtoul (argv[2], NULL, 0);
+    ArgIndex       = 3;
+  }
+
+  if (DescriptorSize < sizeof (EFI_MEMORY_DESCRIPTOR) || DescriptorSize > 256) {
+    printf ("Invalid descriptor size %u\n", (UINT32) DescriptorSize);
+    return -1;
+  }
+
+  if (ArgIndex < argc) {
+    for (; ArgIndex < argc; ++ArgIndex) {
+      Data = UserReadFile (argv[ArgIndex], &DataSize);
+      if (Data == NULL) {
+        printf ("Read fail %s\n", argv[ArgIndex]);
+        return -1;
+      }
+
+      DataSize -= DataSize % DescriptorSize;
+      if (DataSize > 0) {
+        if (!TestMemoryMap ((EFI_MEMORY_DESCRIPTOR *) Data, DataSize, DescriptorSize, argv[ArgIndex])) {
+          Code = -1;
+        }
+        BenchMemoryMap ((EFI_MEMORY_DESCRIPTOR *) Data, DataSize, DescriptorSize);
+      }
+
+      FreePool (Data);
+    }
+
+    return Code;
+  }
+
+  //
+  // One more descriptor is used as scratch space for shuffling.
+  //
+  MemoryMap = AllocatePool ((TEST_ENTRY_COUNT + 1) * DescriptorSize);
+  if (MemoryMap == NULL) {
+    return -1;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mSampleMap); ++Index) {
+    FillDescriptor (
+      (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + Index * DescriptorSize),
+      DescriptorSize,
+      mSampleMap[Index].Type,
+      mSampleMap[Index].PhysicalStart,
+      mSampleMap[Index].NumberOfPages,
+      mSampleMap[Index].Attribute
+      );
+  }
+
+  if (!TestMemoryMap (MemoryMap, ARRAY_SIZE (mSampleMap) * DescriptorSize, DescriptorSize, "sample")) {
+    Code = -1;
+  }
+
+  srand (1);
+
+  for (Index = 0; Index < TEST_MAP_COUNT; ++Index) {
+    GenerateMemoryMap (MemoryMap, TEST_ENTRY_COUNT, DescriptorSize);
+    snprintf (Name, sizeof (Name), "generated %u", (UINT32) Index);
+    if (!TestMemoryMap (MemoryMap, TEST_ENTRY_COUNT * DescriptorSize, DescriptorSize, Name)) {
+      Code = -1;
+    }
+  }
+
+  BenchMemoryMap (MemoryMap, TEST_ENTRY_COUNT * DescriptorSize, DescriptorSize);
+
+  FreePool (MemoryMap);
+
+  printf ("%s\n", Code == 0 ? "OK" : "FAIL");
+  return Code;
+}
@@ -9,12 +9,16 @@ UTILS=(
     "macserial"
     "ocvalidate"
     "ocpasswordgen"
+    "TestBlending"
     "TestBmf"
+    "TestCompression"
     "TestDiskImage"
+    "TestHfsPlus"
     "TestHelloWorld"
     "TestImg4"
     "TestKextInject"
     "TestMacho"
+    "TestMemoryMap"
     "TestMp3"
     "TestPeCoff"
     "TestRsaPreprocess"